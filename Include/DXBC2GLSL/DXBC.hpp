@@ -87,7 +87,7 @@ struct DXBCShaderVariableDesc
 	char const* name;
 	uint32_t start_offset;
 	uint32_t size;
-	uint32_t flags;
+	uint32_t flags; // Combination of DXBCShaderVariableFlags
 	void const * default_val;
 	uint32_t start_texture;
 	uint32_t texture_size;
@@ -118,11 +118,22 @@ struct DXBCShaderBufferDesc
 	uint32_t flags;
 };
 
+// A member of a struct type. type_desc.offset is the byte offset inside the parent struct.
+struct DXBCShaderTypeMember
+{
+	char const * name;
+	DXBCShaderTypeDesc type_desc;
+	char const * struct_name; // HLSL name of a struct type, only in shader model 5 resource chunks
+	std::vector<DXBCShaderTypeMember> members;
+};
+
 struct DXBCShaderVariable
 {
 	DXBCShaderVariableDesc var_desc;
 	DXBCShaderTypeDesc type_desc;
 	bool has_type_desc;
+	char const * struct_name;
+	std::vector<DXBCShaderTypeMember> members;
 };
 
 struct DXBCConstantBuffer
@@ -146,6 +157,15 @@ struct DXBCSignatureParamDesc
 	uint32_t min_precision;
 };
 
+enum DXBCShaderVariableFlags
+{
+	DSVF_UserPacked = 0x1,
+	DSVF_Used = 0x2,
+	DSVF_InterfacePointer = 0x4,
+	DSVF_InterfaceParameter = 0x8,
+	DSVF_ForceDWORD = 0x7FFFFFFF
+};
+
 enum DXBCShaderInputFlags
 {
 	DSIF_UserPacked = 0x1,
@@ -201,6 +221,8 @@ enum DXBCFindSignature
 };
 
 std::shared_ptr<DXBCContainer> DXBCParse(void const * data);
+// Rejects blobs whose chunk table or chunks don't fit in size bytes
+std::shared_ptr<DXBCContainer> DXBCParse(void const * data, uint32_t size);
 DXBCChunkHeader const * DXBCFindChunk(void const * data, uint32_t fourcc);
 DXBCChunkHeader const * DXBCFindShaderBytecode(void const * data);
 DXBCChunkSignatureHeader const * DXBCFindSignature(void const * data, uint32_t kind);
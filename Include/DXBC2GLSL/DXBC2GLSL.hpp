@@ -36,20 +36,89 @@
 #include <DXBC2GLSL/DXBC.hpp>
 #include <DXBC2GLSL/Shader.hpp>
 #include <DXBC2GLSL/GLSLGen.hpp>
+#include <string>
 
 namespace DXBC2GLSL
 {
+	enum ConvertStatus
+	{
+		CR_OK = 0,
+		CR_InvalidContainer,	// Not a DXBC blob, or its chunks don't fit in the given size
+		CR_NoShaderChunk,
+		CR_ParseError,			// Malformed SHDR/SHEX, RDEF or signature chunk
+		CR_InvalidProgram,		// Well formed tokens that don't make a valid program
+		CR_Unsupported			// Instruction or declaration without a GLSL translation
+	};
+
+	struct ConvertResult
+	{
+		ConvertStatus status;
+		char const * message;	// Static string, nullptr on success
+		uint32_t insn_index;	// Failing instruction as an index into ShaderProgram::insns, declarations don't count.
+								// -1 when the failure isn't in an instruction.
+		uint32_t opcode;		// Opcode of the failing instruction or declaration, 0 if none
+	};
+
+	struct GLSLTarget
+	{
+		GLSLVersion version;
+		uint64_t glsl_rules;
+	};
+
+	struct GLSLTargetOutput
+	{
+		ConvertResult result;
+		std::string glsl;
+		std::vector<GLSLBinding> bindings;
+		std::vector<GLSLUniformLocation> uniform_locations;
+	};
+
 	class DXBC2GLSL
 	{
 	public:
-		static uint32_t DefaultRules(GLSLVersion version);
+		static uint64_t DefaultRules(GLSLVersion version);
+
+		// Packs the user varyings between a VS, DS or GS producer and a PS consumer into shared vec4 slots. Give the
+		// layout to both stages' VaryingLayouts before converting them. CR_Unsupported for other stage pairs.
+		static ConvertResult PackVaryings(void const * producer_dxbc, uint32_t producer_size,
+			void const * consumer_dxbc, uint32_t consumer_size, VaryingLayout& layout);
+
+		// Layouts the following conversions emit the inputs and outputs against, nullptr for a varying per element
+		void VaryingLayouts(std::shared_ptr<VaryingLayout const> const & input_layout,
+			std::shared_ptr<VaryingLayout const> const & output_layout);
+
+		// Units the following conversions give to samplers and images
+		void BindingPolicy(GLSLBindingPolicy const & policy);
+
+		// cbuffer members the following conversions bake into constants, e.g. per quality tier settings
+		void CBufferSpecializations(std::vector<CBufferSpecialization> const & specializations);
+
+		// Never throws or writes to stdout on bad input, failures come back in the result.
+		// GLSLString() and the reflection are only valid when the status is CR_OK.
+		ConvertResult Convert(void const * dxbc_data, uint32_t size,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version);
+		ConvertResult Convert(void const * dxbc_data, uint32_t size,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version, uint64_t glsl_rules);
+
+		// Parses and analyzes the program once, then emits it for every target, on a thread per target when parallel.
+		// outputs gets an entry per target with its own result. Returns the first failure, the reflection is valid
+		// once the parse succeeded. GLSLString(), the bindings and the uniform locations stay empty.
+		ConvertResult ConvertTargets(void const * dxbc_data, uint32_t size,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			std::vector<GLSLTarget> const & targets, bool parallel, std::vector<GLSLTargetOutput>& outputs);
+
+		// Fills the reflection (params, cbuffers, resources, GS/HS/DS/CS metadata) without decoding instructions or
+		// generating GLSL. GLSLString() stays empty.
+		ConvertResult ReflectDXBC(void const * dxbc_data, uint32_t size);
 
 		void FeedDXBC(void const * dxbc_data,
 			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
 			GLSLVersion version);
 		void FeedDXBC(void const * dxbc_data,
 			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
-			GLSLVersion version, uint32_t glsl_rules);
+			GLSLVersion version, uint64_t glsl_rules);
 
 		std::string const & GLSLString() const;
 
@@ -71,6 +140,13 @@ namespace DXBC2GLSL
 		ShaderSRVDimension ResourceDimension(uint32_t index) const;
 		bool ResourceUsed(uint32_t index) const;
 
+		// Combined samplers and images of the GLSL with their units, only after a successful conversion
+		uint32_t NumBindings() const;
+		GLSLBinding const & Binding(uint32_t index) const;
+		// Free standing uniforms in use with their locations, only after a successful conversion with GSR_UniformLocations
+		uint32_t NumUniformLocations() const;
+		GLSLUniformLocation const & UniformLocation(uint32_t index) const;
+
 		ShaderPrimitive GSInputPrimitive() const;
 		uint32_t NumGSOutputTopology() const;
 		ShaderPrimitiveTopology GSOutputTopology(uint32_t index) const;
@@ -80,10 +156,22 @@ namespace DXBC2GLSL
 		ShaderTessellatorPartitioning DSPartitioning() const;
 		ShaderTessellatorOutputPrimitive DSOutputPrimitive() const;
 
+	private:
+		ConvertResult ConvertContainer(bool has_gs, bool has_ps,
+			ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version, uint64_t glsl_rules);
+		ConvertResult ParseContainer(ShaderParseMode mode);
+
 	private:
 		std::shared_ptr<DXBCContainer> dxbc_;
 		std::shared_ptr<ShaderProgram> shader_;
 		std::string glsl_;
+		std::shared_ptr<VaryingLayout const> input_layout_;
+		std::shared_ptr<VaryingLayout const> output_layout_;
+		std::vector<CBufferSpecialization> specializations_;
+		GLSLBindingPolicy binding_policy_;
+		std::vector<GLSLBinding> bindings_;
+		std::vector<GLSLUniformLocation> uniform_locations_;
 	};
 }
 
@@ -35,6 +35,7 @@
 
 #include <DXBC2GLSL/Shader.hpp>
 #include <map>
+#include <string>
 
 enum GLSLVersion
 {
@@ -60,34 +61,149 @@ enum GLSLVersion
 	GSV_NumVersions
 };
 
-enum GLSLRules : uint32_t
-{
-	GSR_UniformBlockBinding = 1UL << 0,		// Set means allow uniform block layout bindings e.g.layout(binding=N) uniform {};.
-	GSR_GlobalUniformsInUBO = 1UL << 1,		// Set means collect global uniforms in uniform block named $Globals.
-	GSR_UseUBO = 1UL << 2,					// Set means generating uniform blocks.
-	GSR_ExplicitPSOutputLayout = 1UL << 3,
-	GSR_ExplicitInputLayout = 1UL << 4,
-	GSR_UIntType = 1UL << 5,
-	GSR_GenericTexture = 1UL << 6,
-	GSR_PSInterpolation = 1UL << 7,
-	GSR_InOutPrefix = 1UL << 8,
-	GSR_Int64Type = 1UL << 9,
-	GSR_TextureGrad = 1UL << 10,
-	GSR_BitwiseOp = 1UL << 11,
-	GSR_MultiStreamGS = 1UL << 12,
-	GSR_CoreGS = 1UL << 13,
-	GSR_Precision = 1UL << 14,
-	GSR_VersionDecl = 1UL << 15,
-	GSR_MatrixType = 1UL << 16,
-	GSR_ArrayConstructors = 1UL << 17,
-	GSR_DrawBuffers = 1UL << 18,
-	GSR_EXTShaderTextureLod = 1UL << 19,
-	GSR_EXTDrawBuffers = 1UL << 20,
-	GSR_OESStandardDerivatives = 1UL << 21,
-	GSR_EXTFragDepth = 1UL << 22,
-	GSR_EXTTessellationShader = 1UL << 23,
-	GSR_PrecisionOnSampler = 1UL << 24,
-	GSR_ExplicitMultiSample = 1UL << 25
+enum GLSLRules : uint64_t
+{
+	GSR_UniformBlockBinding = 1ULL << 0,		// Set means allow uniform block layout bindings e.g.layout(binding=N) uniform {};.
+	GSR_GlobalUniformsInUBO = 1ULL << 1,		// Set means collect global uniforms in uniform block named $Globals.
+	GSR_UseUBO = 1ULL << 2,					// Set means generating uniform blocks.
+	GSR_ExplicitPSOutputLayout = 1ULL << 3,
+	GSR_ExplicitInputLayout = 1ULL << 4,
+	GSR_UIntType = 1ULL << 5,
+	GSR_GenericTexture = 1ULL << 6,
+	GSR_PSInterpolation = 1ULL << 7,
+	GSR_InOutPrefix = 1ULL << 8,
+	GSR_Int64Type = 1ULL << 9,
+	GSR_TextureGrad = 1ULL << 10,
+	GSR_BitwiseOp = 1ULL << 11,
+	GSR_MultiStreamGS = 1ULL << 12,
+	GSR_CoreGS = 1ULL << 13,
+	GSR_Precision = 1ULL << 14,
+	GSR_VersionDecl = 1ULL << 15,
+	GSR_MatrixType = 1ULL << 16,
+	GSR_ArrayConstructors = 1ULL << 17,
+	GSR_DrawBuffers = 1ULL << 18,
+	GSR_EXTShaderTextureLod = 1ULL << 19,
+	GSR_EXTDrawBuffers = 1ULL << 20,
+	GSR_OESStandardDerivatives = 1ULL << 21,
+	GSR_EXTFragDepth = 1ULL << 22,
+	GSR_EXTTessellationShader = 1ULL << 23,
+	GSR_PrecisionOnSampler = 1ULL << 24,
+	GSR_ExplicitMultiSample = 1ULL << 25,
+	GSR_EarlyFragmentTests = 1ULL << 26,		// layout(early_fragment_tests) in;
+	GSR_PreciseQualifier = 1ULL << 27,
+	GSR_DoubleType = 1ULL << 28,				// Core double precision, otherwise needs GL_ARB_gpu_shader_fp64
+	GSR_BooleanMix = 1ULL << 29,				// mix(genType, genType, genBType)
+	GSR_IntegerMix = 1ULL << 30,				// mix(genIType, genIType, genBType) and the uint version
+	GSR_HSForkInvocations = 1ULL << 31,		// Spread HS fork/join phase instances over gl_InvocationID, synchronized by barrier()
+	GSR_ExplicitVaryingLocation = 1ULL << 32,	// layout(location=N) on inter-stage in/out variables
+	GSR_D3DCBufferLayout = 1ULL << 33,		// Not in DefaultRules. std140 uniform blocks with the byte layout of the D3D cbuffers
+	GSR_UniformBlockMemberOffset = 1ULL << 34,	// layout(offset=N) on uniform block members
+	GSR_DynamicCBufferRegisters = 1ULL << 35,	// Not in DefaultRules. Dynamically indexed cbuffers are declared as vec4 cb_#[] in block <name>_registers
+	GSR_SamplerBinding = 1ULL << 36,			// layout(binding=N) on samplers
+	GSR_BindlessTexture = 1ULL << 37,			// Not in DefaultRules. Samplers are GL_ARB_bindless_texture handles in a uniform block
+	GSR_UniformLocations = 1ULL << 38,			// Not in DefaultRules. layout(location=N) on free standing uniforms, unused ones are dropped
+	GSR_PruneUnused = 1ULL << 39,				// Not in DefaultRules. Unused resources, cbuffers and members outside blocks aren't declared
+	GSR_Minify = 1ULL << 40						// Not in DefaultRules. Compact output from MinifyGLSL, global names are kept
+};
+
+enum GLSLGenStatus
+{
+	GGS_OK = 0,
+	GGS_InvalidProgram,		// Decodes fine but doesn't make a valid program, e.g. unbalanced flow control
+	GGS_Unsupported			// Instruction or declaration that has no GLSL translation yet
+};
+
+struct GLSLGenResult
+{
+	GLSLGenStatus status;
+	char const * message;
+	uint32_t insn_index;	// Index into ShaderProgram::insns, or -1 when the error isn't tied to an instruction
+	uint32_t opcode;
+
+	GLSLGenResult()
+		: status(GGS_OK), message(nullptr), insn_index(static_cast<uint32_t>(-1)), opcode(0)
+	{
+	}
+};
+
+// A signature element inside a packed varying slot
+struct PackedVarying
+{
+	std::string semantic_name;
+	uint32_t semantic_index;
+	uint32_t location;				// Slot index, also the layout(location=N) with GSR_ExplicitVaryingLocation
+	uint32_t component;				// Slot component that register_component lands in
+	uint32_t register_component;	// First register component of the element in either stage
+};
+
+struct VaryingSlot
+{
+	ShaderRegisterComponentType component_type;
+	ShaderInterpolationMode interpolation;
+	uint32_t min_precision;	// Shared by every element in the slot, otherwise 0
+	uint32_t used_comps;
+};
+
+// User varyings between a producer and a PS, packed into vec4 slots v_SLOT<location>. See GLSLGen::PackVaryings.
+struct VaryingLayout
+{
+	std::vector<PackedVarying> varyings;
+	std::vector<VaryingSlot> slots;
+};
+
+// Replaces a cbuffer member with a GLSL constant. See GLSLGen::CBufferSpecializations.
+struct CBufferSpecialization
+{
+	std::string cbuffer_name;
+	std::string member_name;
+	std::vector<uint8_t> value;		// Laid out like the member in the D3D cbuffer, the same as RDEF default values
+};
+
+// Numbering of the binding=N of combined samplers and images, and of the location=N of free standing uniforms
+struct GLSLBindingPolicy
+{
+	uint32_t sampler_base;	// Unit of t0, or of the first combined sampler when sequential
+	uint32_t image_base;	// Unit of u0, or of the first image when sequential
+	// false: the first combined sampler of t# gets sampler_base + #, the others follow the highest t#, and u# gets
+	// image_base + #. true: both are numbered in declaration order.
+	bool sequential;
+	// Uniform blocks of the sampler handles with GSR_BindlessTexture, after the 14 cbuffer slots by default. Every stage
+	// declares its own block, BindlessTexturesPS, VS, GS, HS, DS or CS, at handle_block_binding + its ShaderType.
+	uint32_t handle_block_binding;
+	// With GSR_UniformLocations, a member of cb# at byte offset o gets uniform_location_base + # * uniform_location_stride + o / 4.
+	// Keyed on the offset so the stages compiled from one source agree on the $Globals members they share.
+	uint32_t uniform_location_base;
+	uint32_t uniform_location_stride;
+
+	GLSLBindingPolicy()
+		: sampler_base(0), image_base(0), sequential(false), handle_block_binding(14),
+			uniform_location_base(0), uniform_location_stride(256)
+	{
+	}
+};
+
+// The unit a combined sampler or an image is bound to. See GLSLGen::Bindings.
+struct GLSLBinding
+{
+	std::string name;				// GLSL uniform
+	ShaderInputType type;			// SIT_TEXTURE for a combined sampler, SIT_UAV_RWTYPED for an image
+	uint32_t bind_point;			// t# or u#
+	int32_t sampler_bind_point;		// s# of a combined sampler, -1 for a texture without sampler or an image
+	uint32_t binding;
+	std::string handle_block;		// Uniform block of the stage holding the handle with GSR_BindlessTexture, empty for an image
+	uint32_t handle_block_binding;	// Binding of handle_block, -1 for an image
+	uint32_t handle_offset;			// Byte offset of the handle in handle_block, -1 for an image
+};
+
+// The location of a free standing uniform with GSR_UniformLocations. See GLSLGen::UniformLocations.
+struct GLSLUniformLocation
+{
+	std::string name;				// GLSL uniform
+	uint32_t cb_bind_point;
+	uint32_t var_index;				// Into the variables of the cbuffer
+	uint32_t offset;				// Byte offset in the cbuffer
+	int32_t location;				// -1 when the member doesn't fit in uniform_location_stride
+	uint32_t num_locations;			// One per array element, matrices included
 };
 
 struct RegisterDesc
@@ -98,6 +214,72 @@ struct RegisterDesc
 	bool is_depth;
 };
 
+enum SignatureSemanticKind
+{
+	SSK_User = 0,
+	SSK_Position,
+	SSK_ClipDistance,
+	SSK_VertexID,
+	SSK_InstanceID,
+	SSK_PrimitiveID,
+	SSK_SampleIndex,
+	SSK_Target,
+	SSK_Depth,
+	SSK_TessFactor,
+	SSK_InsideTessFactor
+};
+
+// Signature element classified once per program, indexed by register number
+struct SignatureRegister
+{
+	DXBCSignatureParamDesc const * desc;	// First element packed into the register, nullptr for unused registers
+	SignatureSemanticKind kind;
+	char const * builtin;					// GLSL builtin the register is read or written as, nullptr for varyings
+	bool builtin_scalar;
+	ShaderRegisterComponentType component_type;
+	ShaderInterpolationMode interpolation;
+	std::string varying;					// Varying the register is accessed as directly, empty when it goes through i_REGISTER/o_REGISTER
+};
+
+// Where a 32-bit word of a structured buffer element lives in the GLSL declaration
+struct StructuredWord
+{
+	std::string leaf;		// Path from the element to the scalar or vector holding the word, empty for padding
+	int comp;				// Component of a vector leaf, -1 for scalars
+	ShaderImmType type;
+};
+
+struct StructuredLayout
+{
+	ShaderOperandType op_type;
+	uint32_t index;
+	uint32_t stride;
+	// true when the RDEF element type has the same layout in std430 and every access has an immediate byte offset.
+	// Otherwise the buffer is declared as uint words.
+	bool typed;
+	bool row_major;
+	DXBCShaderVariable const * element;		// $Element of the RDEF resource bind info, nullptr if there's none
+	std::string element_type;
+	std::vector<StructuredWord> words;
+};
+
+// Built once per program, so cb# operands don't search the RDEF members
+struct CBufferLayout
+{
+	uint32_t bind_point;
+	DXBCConstantBuffer const * cb;
+	bool dynamic_indexed;
+	// true when declared as vec4 cb_#[], for dynamic indexing or because std140 can't reproduce the D3D layout.
+	// int and uint members are read back with floatBitsToInt/floatBitsToUint. The block is named <name>_registers.
+	bool register_view;
+	// Index into cb->vars of the member covering each 4 byte component, -1 for padding
+	std::vector<int32_t> members;
+	// Per member of cb->vars, the specialization baking it into a constant, nullptr if there's none
+	std::vector<CBufferSpecialization const *> constants;
+	// Per member of cb->vars, the index into GLSLGen::UniformLocations, -1 if it isn't a free standing uniform in use
+	std::vector<int32_t> uniform_locations;
+};
+
 struct HSForkPhase
 {
 	uint32_t fork_instance_count;
@@ -131,21 +313,51 @@ struct HSControlPointPhase
 class GLSLGen
 {
 public:
-	static uint32_t DefaultRules(GLSLVersion version);
+	static uint64_t DefaultRules(GLSLVersion version);
+	// Packs the user varyings the consumer PS reads from a VS, DS or GS producer. Elements sharing component type
+	// and interpolation mode go into the same vec4 slot. Returns false for other stage pairs.
+	static bool PackVaryings(ShaderProgram const & producer, ShaderProgram const & consumer, VaryingLayout& layout);
+
+	// Emits the stage's inputs or outputs against a layout from PackVaryings, nullptr for a varying per element.
+	// Has to be set before FeedDXBC.
+	void VaryingLayouts(std::shared_ptr<VaryingLayout const> const & input_layout, std::shared_ptr<VaryingLayout const> const & output_layout);
+
+	// cbuffer members declared as constants with the given values instead of uniforms, so the GLSL compiler can fold
+	// them. Ignored for cbuffers declared as vec4 cb_#[]. Has to be set before FeedDXBC.
+	void CBufferSpecializations(std::vector<CBufferSpecialization> const & specializations);
 
-	void FeedDXBC(std::shared_ptr<ShaderProgram> const & program,
+	// Has to be set before FeedDXBC
+	void BindingPolicy(GLSLBindingPolicy const & policy);
+
+	void FeedDXBC(std::shared_ptr<ShaderProgram const> const & program,
 		bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
-		GLSLVersion version, uint32_t glsl_rules);
+		GLSLVersion version, uint64_t glsl_rules);
+	// FeedDXBC in two steps. AnalyzeDXBC runs the passes that only depend on the program and the stages around it,
+	// FeedTarget the ones that depend on the GLSL version and rules, and takes the setters above. A copy made after
+	// AnalyzeDXBC gets a FeedTarget of its own, so many targets share one analysis. The program is only read, the
+	// copies can be fed and emitted on different threads.
+	void AnalyzeDXBC(std::shared_ptr<ShaderProgram const> const & program,
+		bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive);
+	void FeedTarget(GLSLVersion version, uint64_t glsl_rules);
 	void ToGLSL(std::ostream& out);
+	// The first error found by FeedDXBC or ToGLSL. Nothing is emitted once FeedDXBC has failed.
+	GLSLGenResult const & Result() const;
+	// Units of the samplers and images, valid after FeedDXBC. They're in the GLSL for images and with
+	// GSR_SamplerBinding, otherwise the samplers still have to be set by glUniform1i.
+	std::vector<GLSLBinding> const & Bindings() const;
+	// Free standing uniforms in use with their locations, valid after FeedDXBC. Empty without GSR_UniformLocations.
+	std::vector<GLSLUniformLocation> const & UniformLocations() const;
 	void ToHSControlPointPhase(std::ostream& out);
 	void ToHSForkPhases(std::ostream& out);
 	void ToHSJoinPhases(std::ostream& out);
 
 private:
+	void ToProgram(std::ostream& out);
 	void ToDeclarations(std::ostream& out);
 	void ToDclInterShaderInputRecords(std::ostream& out);
 	void ToDclInterShaderOutputRecords(std::ostream& out);
 	void ToDclInterShaderPatchConstantRecords(std::ostream& out);
+	void ToDclVaryingSlots(std::ostream& out, VaryingLayout const & layout, bool output) const;
 	void ToDeclInterShaderInputRegisters(std::ostream& out) const;
 	void ToCopyToInterShaderInputRegisters(std::ostream& out) const;
 	void ToDeclInterShaderOutputRegisters(std::ostream& out) const;
@@ -155,6 +367,10 @@ private:
 	void ToCopyToInterShaderPatchConstantRegisters(std::ostream& out)const;
 	void ToDefaultHSControlPointPhase(std::ostream& out)const;
 	void ToDeclaration(std::ostream& out, ShaderDecl const & dcl);
+	void ToDclSamplers(std::ostream& out, ShaderDecl const & dcl, bool block_member) const;
+	void ToSamplerType(std::ostream& out, ShaderDecl const & dcl, bool shadow) const;
+	void ToDclBindlessTextures(std::ostream& out) const;
+	void ToDclCBufferMember(std::ostream& out, DXBCShaderVariable const & var, char const * uniform, bool block_member);
 	void ToInstruction(std::ostream& out, ShaderInstruction const & insn) const;
 	void ToOperands(std::ostream& out, ShaderOperand const & op, uint32_t imm_as_type,
 		bool mask = true, bool dcl_array = false, bool no_swizzle = false, bool no_idx = false, bool no_cast = false,
@@ -165,6 +381,14 @@ private:
 		bool* need_idx, bool* need_comps, bool no_swizzle = false, bool no_idx = false,
 		ShaderInputType const & sit = SIT_UNDEFINED) const;
 	void ToComponentSelectors(std::ostream& out, ShaderOperand const & op, bool dot = true, uint32_t offset = 0) const;
+	uint32_t ImmediateComponent(ShaderOperand const & op) const;
+	void ToBufferName(std::ostream& out, ShaderOperand const & buffer, bool structured) const;
+	void ToBufferWord(std::ostream& out, ShaderOperand const & buffer, ShaderOperand const * element, uint32_t stride,
+		ShaderOperand const & byte_offset, uint32_t word) const;
+	void ToStructDeclaration(std::ostream& out, std::string const & name, std::vector<DXBCShaderTypeMember> const & members);
+	void ToStructuredDeclaration(std::ostream& out, ShaderDecl const & dcl);
+	void ToStructuredLoad(std::ostream& out, ShaderInstruction const & insn, ShaderImmType& oot) const;
+	void ToStructuredStore(std::ostream& out, ShaderInstruction const & insn) const;
 	void ToTemps(std::ostream& out, ShaderDecl const & dcl);
 	void ToImmConstBuffer(std::ostream& out, ShaderDecl const & dcl);
 	void ToDefaultValue(std::ostream& out, DXBCShaderVariable const & var);
@@ -180,17 +404,40 @@ private:
 	// return:the idx of selector:0 1 2 3 stand for x y z w
 	// example: for .xw i=0 return 0 i=1 return 3
 	int GetComponentSelector(ShaderOperand const & op, int i) const;
+	bool IsRawTemp(ShaderOperand const & op) const;
 	int GetOperandComponentNum(ShaderOperand const & op) const;
 	uint32_t GetMaxComponentSelector(ShaderOperand const & op) const;
 	uint32_t GetMinComponentSelector(ShaderOperand const & op) const;
 	ShaderRegisterComponentType GetOutputParamType(ShaderOperand const & op) const;
 	DXBCSignatureParamDesc const & GetOutputParamDesc(ShaderOperand const & op, uint32_t index = 0) const;
 	DXBCSignatureParamDesc const & GetInputParamDesc(ShaderOperand const & op, uint32_t index = 0) const;
+	SignatureRegister const & GetInputRegister(ShaderOperand const & op, uint32_t index = 0) const;
+	SignatureRegister const & GetOutputRegister(ShaderOperand const & op, uint32_t index = 0) const;
 	DXBCInputBindDesc const & GetResourceDesc(ShaderInputType type, uint32_t bind_point) const;
 	DXBCConstantBuffer const & GetConstantBuffer(ShaderCBufferType type, char const * name) const;
 	uint32_t GetNumPatchConstantSignatureRegisters(std::vector<DXBCSignatureParamDesc> const & params_patch)const;
+	void BuildSignatureRegisters();
+	void ValidateProgram();
+	// The error message when op refers to a register that isn't declared, nullptr if it's fine
+	char const * ValidateOperand(ShaderOperand const & op, uint32_t num_temps, bool patch_phase) const;
+	void FindGlobalFlags();
+	void FindStructuredBuffers();
+	StructuredLayout const * FindStructuredLayout(ShaderOperand const & op) const;
+	void FindMinPrecision();
+	void ToMinPrecision(std::ostream& out, uint32_t min_precision) const;
 	void FindDclIndexRange();
+	void FindDirectRegisters();
+	bool IsDirectRegister(ShaderOperandType type, std::vector<DXBCSignatureParamDesc> const & params, uint32_t register_index) const;
 	void FindSamplers();
+	void FindBindings();
+	uint32_t FindBinding(ShaderInputType type, int64_t bind_point, int64_t sampler_bind_point) const;
+	void FindCBufferLayouts();
+	CBufferLayout const * FindCBufferLayout(uint32_t bind_point) const;
+	DXBCShaderVariable const * FindCBufferMember(uint32_t bind_point, uint32_t offset) const;
+	CBufferSpecialization const * FindCBufferConstant(uint32_t bind_point, uint32_t var_index) const;
+	bool IsCBufferRegisterView(uint32_t bind_point) const;
+	bool IsResourcePruned(ShaderOperandType type, int64_t bind_point) const;
+	void FindUniformLocations();
 	void LinkCFInsns();
 	void FindLabels();
 	void FindEndOfProgram();
@@ -198,10 +445,12 @@ private:
 	void FindHSControlPointPhase();
 	void FindHSForkPhases();
 	void FindHSJoinPhases();
+	void FindHSForkInvocations();
 	ShaderImmType FindTextureReturnType(ShaderOperand const & op) const;
+	void ReportError(GLSLGenStatus status, char const * message, ShaderInstruction const * insn) const;
 
 private:
-	std::shared_ptr<ShaderProgram> program_;
+	std::shared_ptr<ShaderProgram const> program_;
 
 	ShaderType shader_type_;
 	bool has_gs_;
@@ -209,16 +458,34 @@ private:
 	ShaderTessellatorPartitioning ds_partitioning_;
 	ShaderTessellatorOutputPrimitive ds_output_primitive_;
 	std::vector<DclIndexRangeInfo> idx_range_info_;
+	std::vector<SignatureRegister> input_registers_;
+	std::vector<SignatureRegister> output_registers_;
+	std::shared_ptr<VaryingLayout const> input_layout_;
+	std::shared_ptr<VaryingLayout const> output_layout_;
+	std::vector<CBufferSpecialization> specializations_;
 	std::vector<TextureSamplerInfo> textures_;
+	GLSLBindingPolicy binding_policy_;
+	std::vector<GLSLBinding> bindings_;
+	std::vector<StructuredLayout> structured_layouts_;
+	std::vector<std::string> declared_structs_;
 	std::vector<ShaderDecl> temp_dcls_;
-	std::map<int64_t, bool> cb_index_mode_;
+	std::vector<CBufferLayout> cb_layouts_;
+	std::vector<GLSLUniformLocation> uniform_locations_;
 	std::vector<HSControlPointPhase> hs_control_point_phase_;
 	std::vector<HSForkPhase> hs_fork_phases_;
 	std::vector<HSJoinPhase> hs_join_phases_;
+	// from dcl_globalFlags
+	bool allow_refactoring_;
+	bool early_depth_stencil_;
+	bool enable_double_;
+	bool enable_minimum_precision_;
+
 	bool enter_hs_fork_phase_;
 	bool enter_final_hs_fork_phase_;
 	bool enter_hs_join_phase_;
 	bool enter_final_hs_join_phase_;
+	// fork/join phases run once per patch, shared through patch out p_REGISTER
+	bool hs_fork_invocations_;
 
 	// for ifs, the insn number of the else or endif if there is no else
 	// for elses, the insn number of the endif
@@ -233,9 +500,16 @@ private:
 	uint32_t end_of_program_;
 
 	GLSLVersion glsl_version_;
-	uint32_t glsl_rules_;
+	uint64_t glsl_rules_;
 
 	mutable std::vector<uint8_t> temp_as_type_;
+	// r# components holding the bits ld_raw loaded into the int temps, a float read reinterprets them
+	mutable std::vector<uint8_t> temp_raw_;
+	// ShaderMinPrecision every write to r# agrees on, 0xFF if none is written
+	std::vector<uint8_t> temp_min_precision_;
+
+	mutable GLSLGenResult result_;
+	mutable ShaderInstruction const * cur_insn_;
 };
 
 #endif		// _DXBC2GLSL_GLSLGEN_HPP
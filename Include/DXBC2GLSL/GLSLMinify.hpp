@@ -0,0 +1,43 @@
+/**
+ * @file GLSLMinify.hpp
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _DXBC2GLSL_GLSLMINIFY_HPP
+#define _DXBC2GLSL_GLSLMINIFY_HPP
+
+#pragma once
+
+#include <string>
+
+// Compacts GLSL written by GLSLGen: drops comments and whitespace, gives the variables declared inside functions the
+// shortest free names, folds T(T(x)) into T(x), removes parentheses around operands that don't need them, and trims
+// float literals. Everything declared outside a function keeps its name, so uniforms, blocks and varyings still match
+// the reflection.
+std::string MinifyGLSL(std::string const & glsl);
+
+#endif		// _DXBC2GLSL_GLSLMINIFY_HPP
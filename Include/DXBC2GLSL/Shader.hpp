@@ -51,6 +51,7 @@ struct TextureSamplerInfo
 	int64_t tex_index;
 	std::vector<SamplerInfo> samplers;
 	uint32_t type;
+	uint32_t min_precision; // Highest min precision of the values sampled from it
 };
 
 struct DclIndexRangeInfo
@@ -242,6 +243,9 @@ struct TokenizedShaderOperandExtended
 	uint32_t type : 6;
 	uint32_t neg : 1;
 	uint32_t abs : 1;
+	uint32_t _8_13 : 6;
+	uint32_t min_precision : 3; // ShaderMinPrecision, D3D 11.1
+	uint32_t non_uniform : 1;
 };
 
 union ShaderAny
@@ -254,15 +258,6 @@ union ShaderAny
 	int64_t u32;
 };
 
-enum ShaderImmType
-{
-	SIT_Unknown,
-	SIT_Int,
-	SIT_UInt,
-	SIT_Float,
-	SIT_Double
-};
-
 struct ShaderOperand
 {
 	uint8_t mode;
@@ -274,6 +269,7 @@ struct ShaderOperand
 	ShaderAny imm_values[4];
 	bool neg;
 	bool abs;
+	uint8_t min_precision;
 	struct
 	{
 		int64_t disp;
@@ -293,7 +289,7 @@ struct ShaderOperand
 
 	ShaderOperand()
 		: mode(0), comps(0), mask(0), num_indices(0),
-			type(SOT_TEMP), neg(false), abs(false)
+			type(SOT_TEMP), neg(false), abs(false), min_precision(SMP_Default)
 	{
 		memset(swizzle, 0, sizeof(swizzle));
 		memset(imm_values, 0, sizeof(imm_values));
@@ -303,6 +299,8 @@ struct ShaderOperand
 
 // for sample_d
 uint32_t const SM_MAX_OPS = 6;
+// dcl_stream m0..m3
+uint32_t const SM_MAX_GS_STREAMS = 4;
 
 struct ShaderInstruction : public TokenizedShaderInstruction
 {
@@ -371,6 +369,9 @@ struct ShaderProgram
 	TokenizedShaderVersion version;//program version
 	std::vector<std::shared_ptr<ShaderDecl>> dcls;//declarations
 	std::vector<std::shared_ptr<ShaderInstruction>> insns;//instructions
+	std::vector<uint32_t> insn_offsets;//SPM_InstructionOffsets only, token offset of each instruction from code
+	uint32_t const * code;//program tokens after the length token, points into the DXBC blob
+	uint32_t code_size;
 
 	std::vector<DXBCSignatureParamDesc> params_in; //input signature
 	std::vector<DXBCSignatureParamDesc> params_out;//output signature
@@ -392,7 +393,8 @@ struct ShaderProgram
 	uint32_t cs_thread_group_size[3];
 
 	ShaderProgram()
-		: gs_input_primitive(SP_Undefined), max_gs_output_vertex(0),
+		: code(nullptr), code_size(0),
+			gs_input_primitive(SP_Undefined), max_gs_output_vertex(0),
 			gs_instance_count(0), hs_input_control_point_count(0),
 			hs_output_control_point_count(0), ds_tessellator_domain(SDT_Undefined),
 			ds_tessellator_partitioning(STP_Undefined), ds_tessellator_output_primitive(STOP_Undefined)
@@ -402,242 +404,62 @@ struct ShaderProgram
 	}
 };
 
-std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc);
+enum ShaderParseStatus
+{
+	SPS_OK = 0,
+	SPS_InvalidLength,			// The program or an instruction length token doesn't fit in the shader chunk
+	SPS_TruncatedInstruction,	// Decoding ran past the end of an instruction
+	SPS_InvalidOpcode,
+	SPS_InvalidOperand,
+	SPS_TooManyOperands,
+	SPS_MissingOperands,		// Fewer operands than the opcode needs
+	SPS_InvalidResourceChunk,	// RDEF offsets or counts point outside the chunk
+	SPS_InvalidSignature		// ISGN/OSGN/PCSG offsets or counts point outside the chunk
+};
 
-// Return the opcode's input type
-inline ShaderImmType GetOpInType(uint32_t opcode)
+struct ShaderParseResult
 {
-	ShaderImmType sit;
-	switch (opcode)
+	ShaderParseStatus status;
+	uint32_t insn_index;	// Index the failing instruction would have in ShaderProgram::insns, -1 for declarations and headers
+	uint32_t opcode;
+
+	ShaderParseResult()
+		: status(SPS_OK), insn_index(static_cast<uint32_t>(-1)), opcode(0)
 	{
-	case SO_IADD:
-	case SO_IEQ:
-	case SO_IGE:
-	case SO_ILT:
-	case SO_IMAD:
-	case SO_IMAX:
-	case SO_IMIN:
-	case SO_IMUL:
-	case SO_INE:
-	case SO_INEG:
-	case SO_ISHL:
-	case SO_ISHR:
-	case SO_ITOF:
-	case SO_ATOMIC_IADD:
-	case SO_ATOMIC_IMAX:
-	case SO_ATOMIC_IMIN:
-	case SO_IMM_ATOMIC_IADD:
-	case SO_IMM_ATOMIC_IMAX:
-	case SO_IMM_ATOMIC_IMIN:
-	case SO_CASE:
-	case SO_IBFE:
-	case SO_FIRSTBIT_SHI:
-	case SO_BREAKC:
-	case SO_IF:
-	case SO_CONTINUEC:
-	case SO_RETC:
-	case SO_DISCARD:
-	case SO_CALL:
-	case SO_CALLC:
-		sit = SIT_Int;
-		break;
-
-	case SO_AND:
-	case SO_XOR:
-	case SO_OR:
-	case SO_NOT:
-	case SO_ATOMIC_AND:
-	case SO_ATOMIC_OR:
-	case SO_ATOMIC_XOR:
-	case SO_IMM_ATOMIC_AND:
-	case SO_IMM_ATOMIC_OR:
-	case SO_IMM_ATOMIC_XOR:
-	case SO_UDIV:
-	case SO_ULT:
-	case SO_UGE:
-	case SO_UMUL:
-	case SO_UMAD:
-	case SO_UMAX:
-	case SO_UMIN:
-	case SO_USHR:
-	case SO_UTOF:
-	case SO_UADDC:
-	case SO_USUBB:
-	case SO_ATOMIC_UMAX:
-	case SO_ATOMIC_UMIN:
-	case SO_IMM_ATOMIC_UMAX:
-	case SO_IMM_ATOMIC_UMIN:
-	case SO_COUNTBITS:
-	case SO_BFI:
-	case SO_BFREV:
-	case SO_UBFE:
-	case SO_FIRSTBIT_LO:
-	case SO_FIRSTBIT_HI:
-	case SO_F16TOF32:
-	case SO_F32TOF16:
-	case SO_RESINFO:
-		sit = SIT_UInt;
-		break;
-
-	case SO_DADD:
-	case SO_DMAX:
-	case SO_DMIN:
-	case SO_DMUL:
-	case SO_DEQ:
-	case SO_DGE:
-	case SO_DLT:
-	case SO_DNE:
-	case SO_DMOV:
-	case SO_DMOVC:
-	case SO_DTOF:
-		sit = SIT_Double;
-		break;
-
-	default:
-		sit = SIT_Float;
-		break;
 	}
+};
+
+enum ShaderParseMode
+{
+	SPM_Full = 0,
+	SPM_Reflection,			// Declarations, RDEF and signatures only. insns stays empty.
+	SPM_DeclarationsOnly,	// Like SPM_Reflection, but stops at the first instruction. Hull shaders are still walked to the end.
+	SPM_InstructionOffsets	// Declarations are decoded, instructions only get an entry in insn_offsets. See ShaderDecodeInstruction.
+};
+
+std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc);
+// Returns a null program and fills result on malformed input
+std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc, ShaderParseResult& result);
+std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc, ShaderParseMode mode, ShaderParseResult& result);
+// Decodes one instruction of a program parsed with SPM_InstructionOffsets. The DXBC blob has to be still alive.
+ShaderParseStatus ShaderDecodeInstruction(ShaderProgram const & program, uint32_t index, ShaderInstruction& insn);
 
-	return sit;
+// Return the opcode's input type
+inline ShaderImmType GetOpInType(uint32_t opcode)
+{
+	return ShaderOpcodeDescription(opcode).in_type;
 }
 
 // Return the opcode's output type
 inline ShaderImmType GetOpOutType(uint32_t opcode)
 {
-	ShaderImmType sit;
-	switch (opcode)
-	{
-	case SO_EQ:
-	case SO_FTOI:
-	case SO_IADD:
-	case SO_IEQ:
-	case SO_IGE:
-	case SO_ILT:
-	case SO_IMAD:
-	case SO_IMAX:
-	case SO_IMIN:
-	case SO_IMUL:
-	case SO_INE:
-	case SO_INEG:
-	case SO_ISHL:
-	case SO_ISHR:
-	case SO_ATOMIC_IADD:
-	case SO_ATOMIC_IMAX:
-	case SO_ATOMIC_IMIN:
-	case SO_IMM_ATOMIC_IADD:
-	case SO_IMM_ATOMIC_IMAX:
-	case SO_IMM_ATOMIC_IMIN:
-	case SO_CASE:
-	case SO_IBFE:
-	case SO_FIRSTBIT_SHI:
-	case SO_BREAKC:
-	case SO_IF:
-	case SO_CONTINUEC:
-	case SO_RETC:
-	case SO_DISCARD:
-	case SO_CALL:
-	case SO_CALLC:
-	case SO_NE:
-	case SO_LT:
-	case SO_ULT:
-	case SO_GE:
-	case SO_UGE:
-		sit = SIT_Int;
-		break;
-
-	case SO_AND:
-	case SO_XOR:
-	case SO_OR:
-	case SO_NOT:
-	case SO_ATOMIC_AND:
-	case SO_ATOMIC_OR:
-	case SO_ATOMIC_XOR:
-	case SO_IMM_ATOMIC_AND:
-	case SO_IMM_ATOMIC_OR:
-	case SO_IMM_ATOMIC_XOR:
-	case SO_UDIV:
-	case SO_UMUL:
-	case SO_UMAD:
-	case SO_UMAX:
-	case SO_UMIN:
-	case SO_USHR:
-	case SO_UADDC:
-	case SO_USUBB:
-	case SO_ATOMIC_UMAX:
-	case SO_ATOMIC_UMIN:
-	case SO_IMM_ATOMIC_UMAX:
-	case SO_IMM_ATOMIC_UMIN:
-	case SO_COUNTBITS:
-	case SO_BFI:
-	case SO_BFREV:
-	case SO_UBFE:
-	case SO_FIRSTBIT_LO:
-	case SO_FIRSTBIT_HI:
-	case SO_F16TOF32:
-	case SO_F32TOF16:
-	case SO_RESINFO:
-		sit = SIT_UInt;
-		break;
-
-	case SO_DADD:
-	case SO_DMAX:
-	case SO_DMIN:
-	case SO_DMUL:
-	case SO_DEQ:
-	case SO_DGE:
-	case SO_DLT:
-	case SO_DNE:
-	case SO_DMOV:
-	case SO_DMOVC:
-	case SO_FTOD:
-		sit = SIT_Double;
-		break;
-
-	default:
-		sit = SIT_Float;
-		break;
-	}
-
-	return sit;
+	return ShaderOpcodeDescription(opcode).out_type;
 }
 
 // Return the number of outputs
 inline uint32_t GetNumOutputs(uint32_t opcode)
 {
-	uint32_t ret;
-	switch (opcode)
-	{
-	case SO_SINCOS:
-	case SO_SWAPC:
-	case SO_IMUL:
-	case SO_UMUL:
-	case SO_UDIV:
-	case SO_UADDC:
-	case SO_USUBB:
-		ret = 2;
-		break;
-
-	case SO_RET:
-	case SO_NOP:
-	case SO_LOOP:
-	case SO_ENDLOOP:
-	case SO_BREAK:
-	case SO_CONTINUE:
-	case SO_DEFAULT:
-	case SO_ENDSWITCH:
-	case SO_ENDIF:
-	case SO_ELSE:
-	case SO_EMIT:
-	case SO_EMITTHENCUT:
-		ret = 0;
-		break;
-
-	default:
-		ret = 1;
-		break;
-	}
-
-	return ret;
+	return ShaderOpcodeDescription(opcode).num_outputs;
 }
 
 #endif		// _DXBC2GLSL_SHADER_HPP
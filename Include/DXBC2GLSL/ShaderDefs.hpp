@@ -33,6 +33,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 enum ShaderOperandType
 {
 	SOT_TEMP = 0,
@@ -619,6 +621,48 @@ enum ShaderTessellatorOutputPrimitive
 	STOP_Triangle_CCW = 4
 };
 
+// Same values as D3D_MIN_PRECISION
+enum ShaderMinPrecision
+{
+	SMP_Default = 0,
+	SMP_Float16 = 1,
+	SMP_Float2_8 = 2,
+	SMP_SInt16 = 4,
+	SMP_UInt16 = 5,
+	SMP_Any16 = 0xF0,
+	SMP_Any10 = 0xF1
+};
+
+enum ShaderImmType
+{
+	SIT_Unknown,
+	SIT_Int,
+	SIT_UInt,
+	SIT_Float,
+	SIT_Double
+};
+
+enum ShaderOpcodeFlag
+{
+	SOF_Declaration = 1UL << 0,
+	SOF_HSPhase = 1UL << 1,
+	SOF_ControlFlow = 1UL << 2,
+	SOF_Sample = 1UL << 3,	// Takes a resource and a sampler operand
+	SOF_Atomic = 1UL << 4
+};
+
+struct ShaderOpcodeDesc
+{
+	ShaderOpcode opcode;
+	char const * name;
+	ShaderImmType in_type;
+	ShaderImmType out_type;
+	uint8_t num_outputs;
+	uint8_t num_operands;	// Minimum number of operands of an instruction, 0 for declarations
+	uint16_t flags;			// Combination of ShaderOpcodeFlag
+};
+
+ShaderOpcodeDesc const & ShaderOpcodeDescription(uint32_t opcode);
 char const * ShaderOperandTypeName(ShaderOperandType v);
 char const * ShaderOperandTypeShortName(ShaderOperandType v);
 char const * ShaderInterpolationModeName(ShaderInterpolationMode v);
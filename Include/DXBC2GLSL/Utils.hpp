@@ -34,6 +34,7 @@
 #pragma once
 
 #include <cassert>
+#include <string>
 
 #define assert_msg(x, msg) assert(x && msg)
 
@@ -43,5 +44,9 @@
 #define unused(x) static_cast<void>(x)
 
 bool ValidFloat(float f);
+// Shortest decimal that reads back as the same bits, e.g. 0.1, 2.0, 1e-7, with a point or an exponent so it stays a
+// floating point literal. Doesn't depend on the stream precision or locale.
+std::string FloatToString(float f);
+std::string DoubleToString(double d);
 
 #endif		// _DXBC2GLSL_UTILS_HPP_
@@ -31,15 +31,114 @@
 #include <DXBC2GLSL/DXBC2GLSL.hpp>
 #include <DXBC2GLSL/DXBC.hpp>
 #include <DXBC2GLSL/GLSLGen.hpp>
+#include <functional>
 #include <sstream>
+#include <thread>
+
+namespace
+{
+	char const * ShaderParseStatusMessage(ShaderParseStatus status)
+	{
+		switch (status)
+		{
+		case SPS_InvalidLength:
+			return "Program or instruction length doesn't fit in the shader chunk";
+		case SPS_TruncatedInstruction:
+			return "Instruction is shorter than its operands";
+		case SPS_InvalidOpcode:
+			return "Unknown opcode";
+		case SPS_InvalidOperand:
+			return "Malformed operand";
+		case SPS_TooManyOperands:
+			return "Too many operands";
+		case SPS_MissingOperands:
+			return "Too few operands for the opcode";
+		case SPS_InvalidResourceChunk:
+			return "Malformed resource definition chunk";
+		case SPS_InvalidSignature:
+			return "Malformed signature chunk";
+		default:
+			return "Unknown parse error";
+		}
+	}
+
+	void EmitTarget(GLSLGen& converter, DXBC2GLSL::GLSLTarget const & target, DXBC2GLSL::GLSLTargetOutput& output)
+	{
+		std::stringstream ss;
+
+		converter.FeedTarget(target.version, target.glsl_rules);
+		converter.ToGLSL(ss);
+
+		DXBC2GLSL::ConvertResult result = { DXBC2GLSL::CR_OK, nullptr, static_cast<uint32_t>(-1), 0 };
+		GLSLGenResult const & gen_result = converter.Result();
+		if (gen_result.status != GGS_OK)
+		{
+			result.status = (GGS_Unsupported == gen_result.status) ? DXBC2GLSL::CR_Unsupported : DXBC2GLSL::CR_InvalidProgram;
+			result.message = gen_result.message;
+			result.insn_index = gen_result.insn_index;
+			result.opcode = gen_result.opcode;
+		}
+		else
+		{
+			output.glsl = ss.str();
+			output.bindings = converter.Bindings();
+			output.uniform_locations = converter.UniformLocations();
+		}
+		output.result = result;
+	}
+}
 
 namespace DXBC2GLSL
 {
-	uint32_t DXBC2GLSL::DefaultRules(GLSLVersion version)
+	uint64_t DXBC2GLSL::DefaultRules(GLSLVersion version)
 	{
 		return GLSLGen::DefaultRules(version);
 	}
 
+	ConvertResult DXBC2GLSL::PackVaryings(void const * producer_dxbc, uint32_t producer_size,
+			void const * consumer_dxbc, uint32_t consumer_size, VaryingLayout& layout)
+	{
+		DXBC2GLSL producer;
+		producer.dxbc_ = DXBCParse(producer_dxbc, producer_size);
+		ConvertResult result = producer.ParseContainer(SPM_DeclarationsOnly);
+		if (result.status != CR_OK)
+		{
+			return result;
+		}
+
+		DXBC2GLSL consumer;
+		consumer.dxbc_ = DXBCParse(consumer_dxbc, consumer_size);
+		result = consumer.ParseContainer(SPM_DeclarationsOnly);
+		if (result.status != CR_OK)
+		{
+			return result;
+		}
+
+		if (!GLSLGen::PackVaryings(*producer.shader_, *consumer.shader_, layout))
+		{
+			result.status = CR_Unsupported;
+			result.message = "Varyings are only packed from a VS, DS or GS into a PS";
+		}
+		return result;
+	}
+
+	void DXBC2GLSL::VaryingLayouts(std::shared_ptr<VaryingLayout const> const & input_layout,
+			std::shared_ptr<VaryingLayout const> const & output_layout)
+	{
+		input_layout_ = input_layout;
+		output_layout_ = output_layout;
+	}
+
+	void DXBC2GLSL::BindingPolicy(GLSLBindingPolicy const & policy)
+	{
+		binding_policy_ = policy;
+	}
+
+	void DXBC2GLSL::CBufferSpecializations(std::vector<CBufferSpecialization> const & specializations)
+	{
+		specializations_ = specializations;
+	}
+
 	void DXBC2GLSL::FeedDXBC(void const * dxbc_data,
 			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
 			GLSLVersion version)
@@ -49,24 +148,146 @@ namespace DXBC2GLSL
 
 	void DXBC2GLSL::FeedDXBC(void const * dxbc_data,
 			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
-			GLSLVersion version, uint32_t glsl_rules)
+			GLSLVersion version, uint64_t glsl_rules)
 	{
 		dxbc_ = DXBCParse(dxbc_data);
-		if (dxbc_)
+		this->ConvertContainer(has_gs, has_ps, ds_partitioning, ds_output_primitive, version, glsl_rules);
+	}
+
+	ConvertResult DXBC2GLSL::Convert(void const * dxbc_data, uint32_t size,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version)
+	{
+		return this->Convert(dxbc_data, size, has_gs, has_ps, ds_partitioning, ds_output_primitive, version, this->DefaultRules(version));
+	}
+
+	ConvertResult DXBC2GLSL::Convert(void const * dxbc_data, uint32_t size,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version, uint64_t glsl_rules)
+	{
+		dxbc_ = DXBCParse(dxbc_data, size);
+		return this->ConvertContainer(has_gs, has_ps, ds_partitioning, ds_output_primitive, version, glsl_rules);
+	}
+
+	ConvertResult DXBC2GLSL::ConvertTargets(void const * dxbc_data, uint32_t size,
+			bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			std::vector<GLSLTarget> const & targets, bool parallel, std::vector<GLSLTargetOutput>& outputs)
+	{
+		outputs.clear();
+
+		dxbc_ = DXBCParse(dxbc_data, size);
+		ConvertResult result = this->ParseContainer(SPM_Full);
+		if (result.status != CR_OK)
 		{
-			if (dxbc_->shader_chunk)
-			{
-				shader_ = ShaderParse(*dxbc_);
+			return result;
+		}
 
-				std::stringstream ss;
+		GLSLGen analyzed;
+		analyzed.VaryingLayouts(input_layout_, output_layout_);
+		analyzed.CBufferSpecializations(specializations_);
+		analyzed.BindingPolicy(binding_policy_);
+		analyzed.AnalyzeDXBC(shader_, has_gs, has_ps, ds_partitioning, ds_output_primitive);
 
-				GLSLGen converter;
-				converter.FeedDXBC(shader_, has_gs, has_ps, ds_partitioning, ds_output_primitive, version, glsl_rules);
-				converter.ToGLSL(ss);
+		outputs.resize(targets.size());
+		std::vector<GLSLGen> converters(targets.size(), analyzed);
+		if (parallel && (targets.size() > 1))
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(targets.size());
+			for (size_t i = 0; i < targets.size(); ++ i)
+			{
+				threads.emplace_back(EmitTarget, std::ref(converters[i]), std::cref(targets[i]), std::ref(outputs[i]));
+			}
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < targets.size(); ++ i)
+			{
+				EmitTarget(converters[i], targets[i], outputs[i]);
+			}
+		}
 
-                glsl_ = ss.str();
+		for (auto const & output : outputs)
+		{
+			if (output.result.status != CR_OK)
+			{
+				return output.result;
 			}
 		}
+		return result;
+	}
+
+	ConvertResult DXBC2GLSL::ReflectDXBC(void const * dxbc_data, uint32_t size)
+	{
+		dxbc_ = DXBCParse(dxbc_data, size);
+		return this->ParseContainer(SPM_Reflection);
+	}
+
+	ConvertResult DXBC2GLSL::ParseContainer(ShaderParseMode mode)
+	{
+		ConvertResult result = { CR_OK, nullptr, static_cast<uint32_t>(-1), 0 };
+
+		shader_.reset();
+		glsl_.clear();
+		bindings_.clear();
+		uniform_locations_.clear();
+
+		if (!dxbc_)
+		{
+			result.status = CR_InvalidContainer;
+			result.message = "Not a DXBC container, or its chunks are out of bounds";
+			return result;
+		}
+		if (!dxbc_->shader_chunk)
+		{
+			result.status = CR_NoShaderChunk;
+			result.message = "No SHDR or SHEX chunk";
+			return result;
+		}
+
+		ShaderParseResult parse_result;
+		shader_ = ShaderParse(*dxbc_, mode, parse_result);
+		if (!shader_)
+		{
+			result.status = CR_ParseError;
+			result.message = ShaderParseStatusMessage(parse_result.status);
+			result.insn_index = parse_result.insn_index;
+			result.opcode = parse_result.opcode;
+		}
+
+		return result;
+	}
+
+	ConvertResult DXBC2GLSL::ConvertContainer(bool has_gs, bool has_ps,
+			ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+			GLSLVersion version, uint64_t glsl_rules)
+	{
+		ConvertResult result = this->ParseContainer(SPM_Full);
+		if (result.status != CR_OK)
+		{
+			return result;
+		}
+
+		GLSLGen converter;
+		converter.VaryingLayouts(input_layout_, output_layout_);
+		converter.CBufferSpecializations(specializations_);
+		converter.BindingPolicy(binding_policy_);
+		converter.AnalyzeDXBC(shader_, has_gs, has_ps, ds_partitioning, ds_output_primitive);
+
+		GLSLTarget const target = { version, glsl_rules };
+		GLSLTargetOutput output;
+		EmitTarget(converter, target, output);
+		if (CR_OK == output.result.status)
+		{
+			glsl_.swap(output.glsl);
+			bindings_.swap(output.bindings);
+			uniform_locations_.swap(output.uniform_locations);
+		}
+		return output.result;
 	}
 
 	std::string const & DXBC2GLSL::GLSLString() const
@@ -118,7 +339,7 @@ namespace DXBC2GLSL
 	{
 		assert(cb_index < shader_->cbuffers.size());
 		assert(var_index < shader_->cbuffers[cb_index].vars.size());
-		return shader_->cbuffers[cb_index].vars[var_index].var_desc.flags ? true : false;
+		return (shader_->cbuffers[cb_index].vars[var_index].var_desc.flags & DSVF_Used) ? true : false;
 	}
 
 	uint32_t DXBC2GLSL::NumResources() const
@@ -156,6 +377,28 @@ namespace DXBC2GLSL
 		return !(shader_->resource_bindings[index].flags & DSIF_Unused);
 	}
 
+	uint32_t DXBC2GLSL::NumBindings() const
+	{
+		return static_cast<uint32_t>(bindings_.size());
+	}
+
+	GLSLBinding const & DXBC2GLSL::Binding(uint32_t index) const
+	{
+		assert(index < bindings_.size());
+		return bindings_[index];
+	}
+
+	uint32_t DXBC2GLSL::NumUniformLocations() const
+	{
+		return static_cast<uint32_t>(uniform_locations_.size());
+	}
+
+	GLSLUniformLocation const & DXBC2GLSL::UniformLocation(uint32_t index) const
+	{
+		assert(index < uniform_locations_.size());
+		return uniform_locations_[index];
+	}
+
 	ShaderPrimitive DXBC2GLSL::GSInputPrimitive() const
 	{
 		return shader_->gs_input_primitive;
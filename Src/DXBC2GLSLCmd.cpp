@@ -76,7 +76,24 @@ int main(int argc, char** argv)
 	try
 	{
 		DXBC2GLSL::DXBC2GLSL dxbc2glsl;
-		dxbc2glsl.FeedDXBC(&data[0], true, true, STP_Fractional_Odd, STOP_Triangle_CW, GSV_430);
+		DXBC2GLSL::ConvertResult result = dxbc2glsl.Convert(data.data(), static_cast<uint32_t>(data.size()),
+			true, true, STP_Fractional_Odd, STOP_Triangle_CW, GSV_430);
+		if (result.status != DXBC2GLSL::CR_OK)
+		{
+			std::cout << "Error(s) in conversion:" << std::endl;
+			std::cout << result.message;
+			if (result.insn_index != static_cast<uint32_t>(-1))
+			{
+				std::cout << " at instruction " << result.insn_index;
+				if (result.opcode < SO_COUNT)
+				{
+					std::cout << " (" << ShaderOpcodeName(static_cast<ShaderOpcode>(result.opcode)) << ")";
+				}
+			}
+			std::cout << std::endl;
+			return 1;
+		}
+
 		std::string glsl = dxbc2glsl.GLSLString();
 		if (!screen_only)
 		{
@@ -31,17 +31,65 @@
 #include <DXBC2GLSL/DXBC.hpp>
 #include <memory>
 
+namespace
+{
+	// Every chunk offset and chunk body has to lie inside the blob, so the parsers only need to check
+	// their own offsets against the chunk size.
+	bool DXBCValidateChunks(void const * data, uint32_t size)
+	{
+		if (size < sizeof(DXBCContainerHeader))
+		{
+			return false;
+		}
+
+		DXBCContainerHeader const * header = reinterpret_cast<DXBCContainerHeader const *>(data);
+		uint32_t num_chunks = le2native(header->chunk_count);
+		if (num_chunks > (size - sizeof(DXBCContainerHeader)) / sizeof(uint32_t))
+		{
+			return false;
+		}
+
+		uint32_t const * chunk_offsets = reinterpret_cast<uint32_t const *>(header + 1);
+		for (uint32_t i = 0; i < num_chunks; ++ i)
+		{
+			uint32_t offset = le2native(chunk_offsets[i]);
+			if ((offset & 3) || (offset > size) || (size - offset < sizeof(DXBCChunkHeader)))
+			{
+				return false;
+			}
+			DXBCChunkHeader const * chunk = reinterpret_cast<DXBCChunkHeader const *>(reinterpret_cast<char const *>(data) + offset);
+			if (le2native(chunk->size) > size - offset - sizeof(DXBCChunkHeader))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
 std::shared_ptr<DXBCContainer> DXBCParse(void const * data)
 {
-	std::shared_ptr<DXBCContainer> container = std::make_shared<DXBCContainer>();
+	DXBCContainerHeader const * header = reinterpret_cast<DXBCContainerHeader const *>(data);
+	return DXBCParse(data, le2native(header->total_size));
+}
+
+std::shared_ptr<DXBCContainer> DXBCParse(void const * data, uint32_t size)
+{
+	if (size < sizeof(DXBCContainerHeader))
+	{
+		return std::shared_ptr<DXBCContainer>();
+	}
 
 	DXBCContainerHeader const * header = reinterpret_cast<DXBCContainerHeader const *>(data);
 	uint32_t fourcc = le2native(header->fourcc);
 
-	if (fourcc != FOURCC_DXBC)
+	if ((fourcc != FOURCC_DXBC) || !DXBCValidateChunks(data, size))
 	{
 		return std::shared_ptr<DXBCContainer>();
 	}
+
+	std::shared_ptr<DXBCContainer> container = std::make_shared<DXBCContainer>();
 	container->shader_chunk = DXBCFindShaderBytecode(data);
 	container->input_signature = DXBCFindSignature(data, DFS_INPUT1);
 	if (!container->input_signature)
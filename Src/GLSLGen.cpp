@@ -36,11 +36,14 @@
 //--------------------------------------------------------------------
 
 #include <DXBC2GLSL/GLSLGen.hpp>
+#include <DXBC2GLSL/GLSLMinify.hpp>
 
 #include <iterator>
 #include <string>
 #include <ostream>
+#include <sstream>
 #include <algorithm>
+#include <cmath>
 
 namespace
 {
@@ -135,3962 +138,5216 @@ namespace
 
 		return num_vertices;
 	}
-}
 
-uint32_t GLSLGen::DefaultRules(GLSLVersion version)
-{
-	uint32_t rules = GSR_VersionDecl;
-	if (version < GSV_100_ES)
+	char const * MinPrecisionQualifier(uint32_t min_precision)
 	{
-		if (version >= GSV_110)
-		{
-			rules |= GSR_MatrixType;
-			rules |= GSR_DrawBuffers;
-		}
-		if (version >= GSV_120)
-		{
-			rules |= GSR_ArrayConstructors;
-		}
-		if (version >= GSV_130)
-		{
-			rules |= GSR_UIntType;
-			rules |= GSR_GenericTexture;
-			rules |= GSR_PSInterpolation;
-			rules |= GSR_InOutPrefix;
-			rules |= GSR_TextureGrad;
-			rules |= GSR_BitwiseOp;
-		}
-		if (version >= GSV_140)
-		{
-			rules |= GSR_GlobalUniformsInUBO;
-			rules |= GSR_UseUBO;
-		}
-		if (version >= GSV_150)
-		{
-			rules |= GSR_CoreGS;
-		}
-		if (version >= GSV_330)
-		{
-			rules |= GSR_UniformBlockBinding;
-			rules |= GSR_ExplicitPSOutputLayout;
-			rules |= GSR_ExplicitInputLayout;
-		}
-		if (version >= GSV_400)
-		{
-			rules |= GSR_Int64Type;
-			rules |= GSR_MultiStreamGS;
-		}
-		if (version >= GSV_410)
-		{
-		}
-		if (version >= GSV_420)
-		{
-		}
-		if (version >= GSV_430)
-		{
-		}
-		if (version >= GSV_440)
-		{
-		}
-		if (version >= GSV_450)
-		{
-			rules |= GSR_ExplicitMultiSample;
-		}
-		if (version >= GSV_460)
+		switch (min_precision)
 		{
+		case SMP_Float16:
+		case SMP_SInt16:
+		case SMP_UInt16:
+		case SMP_Any16:
+			return "mediump ";
+
+		case SMP_Float2_8:
+		case SMP_Any10:
+			return "lowp ";
+
+		default:
+			return nullptr;
 		}
 	}
-	else
+
+	// Tells the per stage blocks apart, the stages linked into one program can't declare one block with different members
+	char const * BindlessBlockName(ShaderType type)
 	{
-		if (version >= GSV_100_ES)
+		switch (type)
 		{
-			rules |= GSR_Precision;
+		case ST_PS:
+			return "BindlessTexturesPS";
+		case ST_VS:
+			return "BindlessTexturesVS";
+		case ST_GS:
+			return "BindlessTexturesGS";
+		case ST_HS:
+			return "BindlessTexturesHS";
+		case ST_DS:
+			return "BindlessTexturesDS";
+		case ST_CS:
+			return "BindlessTexturesCS";
+
+		default:
+			assert(false);
+			return "BindlessTextures";
 		}
-		if (version >= GSV_300_ES)
+	}
+
+	// The precision both values fit in. 0xFF stands for no value yet.
+	uint32_t MergeMinPrecision(uint32_t lhs, uint32_t rhs)
+	{
+		if (0xFF == lhs)
 		{
-			rules |= GSR_UIntType;
-			rules |= GSR_GenericTexture;
-			rules |= GSR_PSInterpolation;
-			rules |= GSR_InOutPrefix;
-			rules |= GSR_TextureGrad;
-			rules |= GSR_BitwiseOp;
-			rules |= GSR_GlobalUniformsInUBO;
-			rules |= GSR_UseUBO;
-			rules |= GSR_CoreGS;
-			rules |= GSR_UniformBlockBinding;
-			rules |= GSR_ExplicitPSOutputLayout;
-			rules |= GSR_ExplicitInputLayout;
-			rules |= GSR_MatrixType;
-			rules |= GSR_ArrayConstructors;
-			rules |= GSR_DrawBuffers;
-			rules |= GSR_PrecisionOnSampler;
+			return rhs;
 		}
-		if (version >= GSV_310_ES)
+		if (!MinPrecisionQualifier(lhs) || !MinPrecisionQualifier(rhs))
 		{
+			return SMP_Default;
 		}
-		if (version >= GSV_320_ES)
+		if ((SMP_Float2_8 == lhs) || (SMP_Any10 == lhs))
 		{
+			return rhs;
 		}
+		return lhs;
 	}
 
-	return rules;
-}
-
-void GLSLGen::FeedDXBC(std::shared_ptr<ShaderProgram> const & program,
-		bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
-		GLSLVersion version, uint32_t glsl_rules)
-{
-	program_ = program;
-	shader_type_ = program_->version.type;
-	has_gs_ = has_gs;
-	has_ps_ = has_ps;
-	ds_partitioning_ = ds_partitioning;
-	ds_output_primitive_ = ds_output_primitive;
-	glsl_version_ = version;
-	glsl_rules_ = glsl_rules;
-	enter_hs_fork_phase_ = false;
-	enter_final_hs_fork_phase_ = false;
-	enter_hs_join_phase_ = false;
-	enter_final_hs_join_phase_ = false;
-	
-	if (!(glsl_rules_ & GSR_UseUBO))
+	void ToInterpolationQualifier(std::ostream& out, ShaderInterpolationMode interpolation)
 	{
-		glsl_rules_ &= ~GSR_UniformBlockBinding;
-		glsl_rules_ &= ~GSR_GlobalUniformsInUBO;
-	}
+		switch (interpolation)
+		{
+		case SIM_Constant:
+			out << "flat ";
+			break;
 
-	this->LinkCFInsns();
-	this->FindLabels();
-	this->FindEndOfProgram();
-	this->FindDclIndexRange();
-	this->FindSamplers();
-	this->FindTempDcls();
-	this->FindHSControlPointPhase();
-	this->FindHSForkPhases();
-	this->FindHSJoinPhases();
-}
+		case SIM_Undefined:
+		case SIM_Linear:
+			out << "smooth ";
+			break;
 
-void GLSLGen::ToGLSL(std::ostream& out)
-{
-	if (glsl_rules_ & GSR_VersionDecl)
-	{
-		out << "#version " << GLSLVersionStr[glsl_version_] << "\n";
-	}
-	if ((ST_GS == shader_type_) && !(glsl_rules_ & GSR_CoreGS))
-	{
-		out << "#extension GL_EXT_geometry_shader4 : enable\n";
-	}
-	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTShaderTextureLod))
-	{
-		out << "#extension GL_EXT_shader_texture_lod : enable\n";
-	}
-	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTDrawBuffers))
-	{
-		out << "#extension GL_EXT_draw_buffers : enable\n";
-	}
-	if (glsl_rules_ & GSR_OESStandardDerivatives)
-	{
-		out << "#extension GL_OES_standard_derivatives : enable\n";
-	}
-	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTFragDepth))
-	{
-		out << "#extension GL_EXT_frag_depth : enable\n";
-	}
-	if (((ST_HS == shader_type_) || (ST_DS == shader_type_)) && (glsl_rules_ & GSR_EXTTessellationShader))
-	{
-		out << "#extension GL_EXT_tessellation_shader : enable\n";
+		case SIM_LinearCentroid:
+			out << "smooth centroid ";
+			break;
+
+		case SIM_LinearNoPerspective:
+			out << "noperspective ";
+			break;
+
+		case SIM_LinearNoPerspectiveCentroid:
+			out << "noperspective centroid ";
+			break;
+
+		case SIM_LinearSample:
+			out << "smooth sample ";
+			break;
+
+		case SIM_LinearNoPerspectiveSample:
+			out << "noperspective sample ";
+			break;
+
+		default:
+			assert(false);
+			break;
+		}
 	}
-	out << "\n";
 
-	if (glsl_rules_ & GSR_Precision)
+	uint32_t FirstComponent(uint32_t mask)
 	{
-		out << "precision highp float;" << std::endl;
-		out << "precision highp int;" << std::endl << std::endl;
+		uint32_t comp = 0;
+		while ((comp < 4) && !(mask & (1UL << comp)))
+		{
+			++ comp;
+		}
+		return comp;
 	}
 
-	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTShaderTextureLod))
+	uint32_t LastComponent(uint32_t mask)
 	{
-		out << "#ifdef GL_EXT_shader_texture_lod\n";
-		out << "#define texture2DLod texture2DLodEXT\n";
-		out << "#define texture2DProjLod texture2DProjLodEXT\n";
-		out << "#define textureCubeLod textureCubeLodEXT\n";
-		out << "#define texture2DGrad texture2DGradEXT\n";
-		out << "#define texture2DProjGrad texture2DProjGradEXT\n";
-		out << "#define textureCubeGrad textureCubeGradEXT\n";
-		out << "#endif\n";
+		uint32_t comp = 3;
+		while ((comp > 0) && !(mask & (1UL << comp)))
+		{
+			-- comp;
+		}
+		return comp;
 	}
 
-	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTFragDepth))
+	// Where a signature element went in a packed layout, nullptr when it has a varying of its own
+	PackedVarying const * FindPackedVarying(std::shared_ptr<VaryingLayout const> const & layout, DXBCSignatureParamDesc const & desc)
 	{
-		out << "#ifdef GL_EXT_frag_depth\n";
-		out << "#define gl_FragDepth gl_FragDepthEXT\n";
-		out << "#endif\n";
+		if (layout && (SN_UNDEFINED == desc.system_value_type) && (0 == desc.stream))
+		{
+			for (auto const & varying : layout->varyings)
+			{
+				if ((varying.semantic_index == desc.semantic_index) && (varying.semantic_name == desc.semantic_name))
+				{
+					return &varying;
+				}
+			}
+		}
+		return nullptr;
 	}
 
-	if ((ST_GS == shader_type_) && (glsl_rules_ & GSR_CoreGS))
+	// D3D11 has at most 32 registers in any signature
+	uint32_t const MAX_SIGNATURE_REGISTERS = 32;
+	// Minimums of GL_MAX_TESS_PATCH_COMPONENTS and GL_MAX_TESS_CONTROL_TOTAL_OUTPUT_COMPONENTS
+	uint32_t const MAX_TESS_PATCH_COMPONENTS = 120;
+	uint32_t const MAX_TESS_CONTROL_TOTAL_OUTPUT_COMPONENTS = 4096;
+	// D3D11 limits on declarations, nothing gets sized from a larger one
+	uint32_t const MAX_TEMP_REGISTERS = 4096;
+	uint32_t const MAX_CBUFFER_SIZE = 4096 * 16;
+	uint32_t const MAX_STRUCTURE_STRIDE = 2048;
+
+	// Whether a declaration with this opcode declares registers of the operand type
+	// The register file a binding declaration declares, SOT_COUNT for other opcodes
+	ShaderOperandType DeclaredOperandType(uint32_t opcode)
 	{
-		out << "layout(";
-		switch (program_->gs_input_primitive)
+		switch (opcode)
 		{
-		case SP_Point:
-			out << "points";
-			break;
+		case SO_DCL_RESOURCE:
+		case SO_DCL_RESOURCE_RAW:
+		case SO_DCL_RESOURCE_STRUCTURED:
+			return SOT_RESOURCE;
 
-		case SP_Line:
-			out << "lines";
-			break;
+		case SO_DCL_UNORDERED_ACCESS_VIEW_TYPED:
+		case SO_DCL_UNORDERED_ACCESS_VIEW_RAW:
+		case SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED:
+			return SOT_UNORDERED_ACCESS_VIEW;
 
-		case SP_Triangle:
-			out << "triangles";
-			break;
+		case SO_DCL_SAMPLER:
+			return SOT_SAMPLER;
 
-		case SP_LineAdj:
-			out << "lines_adjacency";
-			break;
+		case SO_DCL_CONSTANT_BUFFER:
+			return SOT_CONSTANT_BUFFER;
 
-		case SP_TriangleAdj:
-			out << "triangles_adjacency";
-			break;
+		case SO_DCL_THREAD_GROUP_SHARED_MEMORY_RAW:
+		case SO_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED:
+			return SOT_THREAD_GROUP_SHARED_MEMORY;
 
 		default:
-			assert_msg(false, "Wrong input primitive name.");
-			break;
+			return SOT_COUNT;
 		}
-		if (program_->gs_instance_count > 0)
+	}
+
+	// cb# operands are mapped to members by the D3D packing rules: members are 4 byte aligned, a scalar or vector stays
+	// in one register, and arrays, matrices and structures start a new one
+	bool MemberFitsCBuffer(DXBCShaderVariable const & var, uint32_t cb_size)
+	{
+		DXBCShaderTypeDesc const & type = var.type_desc;
+		uint32_t const start = var.var_desc.start_offset;
+		if ((start & 3) || (start > cb_size) || (var.var_desc.size > cb_size - start))
 		{
-			out << ", invocations = " << program_->gs_instance_count;
+			return false;
 		}
-		out << ") in;\n";
-
-		out << "layout(";
-		switch (program_->gs_output_topology[0])
+		switch (type.var_class)
 		{
-		case SPT_PointList:
-			out << "points";
+		case SVC_SCALAR:
+		case SVC_VECTOR:
+		case SVC_MATRIX_ROWS:
+		case SVC_MATRIX_COLUMNS:
+			if ((type.rows < 1) || (type.rows > 4) || (type.columns < 1) || (type.columns > 4))
+			{
+				return false;
+			}
 			break;
 
-		case SPT_LineStrip:
-			out << "line_strip";
+		default:
 			break;
+		}
+		if ((type.elements > 0) || ((type.var_class != SVC_SCALAR) && (type.var_class != SVC_VECTOR)))
+		{
+			return 0 == (start & 15);
+		}
+		return (start & 15) + var.var_desc.size <= 16;
+	}
 
-		case SPT_TriangleStrip:
-			out << "triangle_strip";
-			break;
+	// Registers that always hold 4 components, selected by a mask or a swizzle
+	bool IsVectorRegister(ShaderOperandType type)
+	{
+		switch (type)
+		{
+		case SOT_TEMP:
+		case SOT_INPUT:
+		case SOT_OUTPUT:
+		case SOT_INDEXABLE_TEMP:
+		case SOT_CONSTANT_BUFFER:
+		case SOT_IMMEDIATE_CONSTANT_BUFFER:
+		case SOT_INPUT_CONTROL_POINT:
+		case SOT_OUTPUT_CONTROL_POINT:
+		case SOT_INPUT_PATCH_CONSTANT:
+			return true;
 
 		default:
-			assert_msg(false, "Wrong output primitive topology name.");
-			break;
+			return false;
 		}
-		out << ", max_vertices = " << program_->max_gs_output_vertex << ") out;\n\n";
 	}
 
-	if (ST_HS == shader_type_)
+	bool InSignature(std::vector<DXBCSignatureParamDesc> const & params, int64_t register_index)
 	{
-		out << "layout(vertices = " << program_->hs_output_control_point_count << ") out;\n\n";
+		if ((register_index >= 0) && (register_index < MAX_SIGNATURE_REGISTERS))
+		{
+			for (auto const & param : params)
+			{
+				if (param.register_index == register_index)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
 	}
 
-	if (ST_DS == shader_type_)
+	SignatureSemanticKind ClassifySemantic(DXBCSignatureParamDesc const & desc)
 	{
-		out << "layout(";
-		switch (program_->ds_tessellator_domain)
+		if (SN_VERTEX_ID == desc.system_value_type)
 		{
-		case SDT_Isoline:
-			out << "isolines";
-			break;
-		case SDT_Triangle:
-			out << "triangles";
-			break;
-		case SDT_Quad:
-			out << "quads";
-			break;
-		default:
-			assert(false);
-			break;
+			return SSK_VertexID;
 		}
-		out << ", ";
-		switch (ds_partitioning_)
+		if (SN_INSTANCE_ID == desc.system_value_type)
 		{
-		case STP_Integer:
-		case STP_Pow2:
-			out << "equal_spacing";
-			break;
-		case STP_Fractional_Odd:
-			out << "fractional_odd_spacing";
-			break;
-		case STP_Fractional_Even:
-			out << "fractional_even_spacing";
-			break;
-		default:
-			assert(false);
-			break;
+			return SSK_InstanceID;
 		}
-		switch (ds_output_primitive_)
+
+		static struct
 		{
-		case STOP_Point:
-		case STOP_Line:
-			break;
-		case STOP_Triangle_CW:
-			out << ", ccw";
-			break;
-		case STOP_Triangle_CCW:
-			out << ", cw";
-			break;
-		default:
-			assert(false);
-			break;
+			char const * name;
+			SignatureSemanticKind kind;
+		} const semantics[] =
+		{
+			{ "SV_Position", SSK_Position },
+			{ "SV_ClipDistance", SSK_ClipDistance },
+			{ "SV_PrimitiveID", SSK_PrimitiveID },
+			{ "SV_SampleIndex", SSK_SampleIndex },
+			{ "SV_Target", SSK_Target },
+			{ "SV_Depth", SSK_Depth },
+			{ "SV_TessFactor", SSK_TessFactor },
+			{ "SV_InsideTessFactor", SSK_InsideTessFactor }
+		};
+		for (auto const & semantic : semantics)
+		{
+			if (0 == strcmp(semantic.name, desc.semantic_name))
+			{
+				return semantic.kind;
+			}
 		}
-		out << ") in;\n\n";
+		return SSK_User;
 	}
 
-	if (ST_CS == shader_type_)
+	// GLSL scalar or vector type with comps components, e.g. float, ivec3
+	void ToImmTypeName(std::ostream& out, ShaderImmType type, int comps)
 	{
-		out << "layout(local_size_x = " << program_->cs_thread_group_size[0]
-		<<", local_size_y = " << program_->cs_thread_group_size[1]
-		<<", local_size_z = " << program_->cs_thread_group_size[2]
-		<<") in;\n\n";
-	}
-
-	this->ToDeclarations(out);
-
-	out << "\nvoid main()" << "\n" << "{" << "\n";
+		if (comps > 1)
+		{
+			switch (type)
+			{
+			case SIT_Int:
+				out << "ivec";
+				break;
 
-	this->ToDeclInterShaderInputRegisters(out);
-	this->ToCopyToInterShaderInputRegisters(out);
-	this->ToDeclInterShaderOutputRegisters(out);
+			case SIT_UInt:
+				out << "uvec";
+				break;
 
-	for (auto const & dcl : temp_dcls_)
-	{
-		this->ToTemps(out, dcl);
-	}
-	for (auto const & dcl : program_->dcls)
-	{
-		if (SO_IMMEDIATE_CONSTANT_BUFFER == dcl->opcode)
-		{
-			this->ToImmConstBuffer(out, *dcl);
+			default:
+				out << "vec";
+				break;
+			}
+			out << comps;
 		}
-	}
-	out << "ivec4 iTempX[2];\n";
-	if (glsl_rules_ & GSR_UIntType)
-	{
-		out << "u";
-	}
-	else
-	{
-		out << "i";
-	}
-	out << "vec4 uTempX[2];\n";
-	out << "\n";
-	if (ST_HS != shader_type_)
-	{
-		for (size_t i = 0; i < program_->insns.size(); ++i)
+		else
 		{
-			this->ToInstruction(out, *program_->insns[i]);
-			out << "\n";
-			if (i == end_of_program_)
+			switch (type)
 			{
+			case SIT_Int:
+				out << "int";
+				break;
+
+			case SIT_UInt:
+				out << "uint";
+				break;
+
+			default:
+				out << "float";
 				break;
 			}
 		}
 	}
-	else
-	{
-		this->ToHSControlPointPhase(out);
-		this->ToHSForkPhases(out);
-		this->ToHSJoinPhases(out);
-	}
-	out << "}" << "\n";
-}
 
-void GLSLGen::ToDeclarations(std::ostream& out)
-{
-	for (auto& po : program_->params_out)
+	// Opens a reinterpretation of comps components from one type to another. Returns false if nothing needs to be closed.
+	bool ToBitCast(std::ostream& out, ShaderImmType from, ShaderImmType to, int comps)
 	{
-		if ((SN_RENDER_TARGET_ARRAY_INDEX == po.system_value_type)
-			|| (SN_VIEWPORT_ARRAY_INDEX == po.system_value_type))
+		if (from == to)
+		{
+			return false;
+		}
+
+		if (SIT_Float == from)
 		{
-			po.component_type = SRCT_SINT32;
+			out << ((SIT_Int == to) ? "floatBitsToInt(" : "floatBitsToUint(");
 		}
+		else if (SIT_Float == to)
+		{
+			out << ((SIT_Int == from) ? "intBitsToFloat(" : "uintBitsToFloat(");
+		}
+		else
+		{
+			ToImmTypeName(out, to, comps);
+			out << "(";
+		}
+		return true;
 	}
 
-	this->ToDclInterShaderInputRecords(out);
-	this->ToDclInterShaderOutputRecords(out);
-	if ((ST_DS == shader_type_) || (ST_HS == shader_type_))
+	ShaderImmType StructuredComponentType(ShaderVariableType type)
 	{
-		this->ToDclInterShaderPatchConstantRecords(out);
+		ShaderImmType ret;
+		switch (type)
+		{
+		case SVT_FLOAT:
+			ret = SIT_Float;
+			break;
+
+		case SVT_INT:
+			ret = SIT_Int;
+			break;
+
+		case SVT_UINT:
+		case SVT_BOOL:
+			ret = SIT_UInt;
+			break;
+
+		default:
+			ret = SIT_Unknown;
+			break;
+		}
+		return ret;
 	}
-	for (auto const & dcl : program_->dcls)
+
+	uint32_t AlignUp(uint32_t x, uint32_t align)
 	{
-		this->ToDeclaration(out, *dcl);
+		return (x + align - 1) / align * align;
 	}
-}
 
-void GLSLGen::ToDclInterShaderInputRecords(std::ostream& out)
-{
-	for (size_t i = 0; i < program_->params_in.size(); ++ i)
+	// std430 alignment and size of an RDEF type. Fails when std430 can't reproduce the tight packing of structured
+	// buffers, e.g. for float3 arrays. majors gets 1 for column major and 2 for row major matrices.
+	bool Std430Layout(DXBCShaderTypeDesc const & desc, std::vector<DXBCShaderTypeMember> const & members,
+		uint32_t& align, uint32_t& size, uint32_t& majors)
 	{
-		if (SN_UNDEFINED == program_->params_in[i].system_value_type)
+		uint32_t packed_size;
+		switch (desc.var_class)
 		{
-			if ((shader_type_ != ST_VS) && (shader_type_ != ST_GS) && (shader_type_ != ST_HS) && (shader_type_ != ST_DS)
-				&& !strcmp("POSITION", program_->params_in[i].semantic_name))
-			{
-				continue;
-			}
-
-			ShaderRegisterComponentType type = program_->params_in[i].component_type;
-			uint32_t register_index = program_->params_in[i].register_index;
-
-			ShaderInterpolationMode interpolation = SIM_Undefined;
-			if (ST_PS == shader_type_)
+		case SVC_SCALAR:
+		case SVC_VECTOR:
 			{
-				for (auto const & dcl : program_->dcls)
+				if (SIT_Unknown == StructuredComponentType(desc.type))
 				{
-					if ((SO_DCL_INPUT_PS == dcl->opcode)
-						&& (dcl->op->indices[0].disp == register_index))
-					{
-						interpolation = dcl->dcl_input_ps.interpolation;
-						break;
-					}
+					return false;
 				}
+				uint32_t const comps = (SVC_SCALAR == desc.var_class) ? 1 : desc.columns;
+				align = (1 == comps) ? 4 : ((2 == comps) ? 8 : 16);
+				size = comps * 4;
+				packed_size = size;
 			}
+			break;
 
-			if ((glsl_rules_ & GSR_PSInterpolation) && (ST_PS == shader_type_))
+		case SVC_MATRIX_ROWS:
+		case SVC_MATRIX_COLUMNS:
 			{
-				switch (interpolation)
+				if ((desc.type != SVT_FLOAT) || (desc.rows < 2) || (desc.columns < 2))
 				{
-				case SIM_Constant:
-					out << "flat ";
-					break;
-
-				case SIM_Undefined:
-				case SIM_Linear:
-					out << "smooth ";
-					break;
-
-				case SIM_LinearCentroid:
-					out << "smooth centroid ";
-					break;
-
-				case SIM_LinearNoPerspective:
-					out << "noperspective ";
-					break;
-
-				case SIM_LinearNoPerspectiveCentroid:
-					out << "noperspective centroid ";
-					break;
-
-				case SIM_LinearSample:
-					out << "smooth sample ";
-					break;
-
-				case SIM_LinearNoPerspectiveSample:
-					out << "noperspective sample ";
-					break;
-
-				default:
-					assert(false);
-					break;
+					return false;
 				}
+				bool const row_major = (SVC_MATRIX_ROWS == desc.var_class);
+				uint32_t const vectors = row_major ? desc.rows : desc.columns;
+				uint32_t const comps = row_major ? desc.columns : desc.rows;
+				align = (2 == comps) ? 8 : 16;
+				size = vectors * AlignUp(comps * 4, align);
+				packed_size = vectors * comps * 4;
+				majors |= row_major ? 2 : 1;
 			}
+			break;
 
-			if (ST_VS == shader_type_)
+		case SVC_STRUCT:
 			{
-				if (glsl_rules_ & GSR_ExplicitInputLayout)
+				uint32_t offset = 0;
+				align = 4;
+				for (auto const & member : members)
 				{
-					// layout(location=N)
-					out << "layout(location=" << i << ") ";
+					uint32_t member_align;
+					uint32_t member_size;
+					if (!Std430Layout(member.type_desc, member.members, member_align, member_size, majors))
+					{
+						return false;
+					}
+					offset = AlignUp(offset, member_align);
+					if (offset != member.type_desc.offset)
+					{
+						return false;
+					}
+					offset += member_size;
+					align = std::max(align, member_align);
 				}
+				size = AlignUp(offset, align);
+				packed_size = offset;
 			}
+			break;
 
-			// No layout qualifier here see dcl_output
-			if (glsl_rules_ & GSR_InOutPrefix)
+		default:
+			return false;
+		}
+
+		if (size != packed_size)
+		{
+			return false;
+		}
+		if (desc.elements > 0)
+		{
+			if (size % align != 0)
 			{
-				out << "in ";
+				return false;
 			}
-			else
+			size *= desc.elements;
+		}
+		return true;
+	}
+
+	// std140 alignment and size of a cbuffer member, spelled the way SO_DCL_CONSTANT_BUFFER declares it
+	bool Std140Layout(DXBCShaderTypeDesc const & desc, bool matrix_type, uint32_t& align, uint32_t& size)
+	{
+		switch (desc.var_class)
+		{
+		case SVC_SCALAR:
+		case SVC_VECTOR:
 			{
-				if (ST_VS == shader_type_)
+				if ((SIT_Unknown == StructuredComponentType(desc.type))
+					|| ((SVT_BOOL == desc.type) && (SVC_VECTOR == desc.var_class)))
 				{
-					out << "attribute ";
+					return false;
 				}
-				else
+				uint32_t const comps = (SVC_SCALAR == desc.var_class) ? 1 : desc.columns;
+				align = (1 == comps) ? 4 : ((2 == comps) ? 8 : 16);
+				size = comps * 4;
+				if (desc.elements > 0)
 				{
-					out << "varying ";
+					// Array elements are rounded up to a vec4, like the D3D registers
+					align = 16;
+					size = 16 * desc.elements;
 				}
 			}
-			switch (type)
+			return true;
+
+		case SVC_MATRIX_ROWS:
+		case SVC_MATRIX_COLUMNS:
 			{
-			case SRCT_UINT32:
-				if (glsl_rules_ & GSR_UIntType)
+				if (desc.type != SVT_FLOAT)
 				{
-					out << "u";
+					return false;
+				}
+				bool const row_major = (SVC_MATRIX_ROWS == desc.var_class);
+				uint32_t vectors;
+				if (matrix_type)
+				{
+					vectors = row_major ? desc.rows : desc.columns;
 				}
 				else
 				{
-					out << "i";
+					vectors = row_major ? desc.columns : desc.rows;
 				}
-				break;
-
-			case SRCT_SINT32:
-				out << "i";
-				break;
+				align = 16;
+				size = 16 * vectors * std::max(desc.elements, 1U);
+			}
+			return true;
 
-			case SRCT_FLOAT32:
-				break;
+		default:
+			return false;
+		}
+	}
 
-			default:
-				assert(false);
-				break;
+	// D3D packs a member into the tail of the previous array or matrix, and lets a vector start at any 4 byte offset
+	// that doesn't cross a register. std140 does neither, but any other gap can be filled with float padding.
+	bool Std140MatchesD3D(DXBCConstantBuffer const & cb, bool matrix_type)
+	{
+		uint32_t offset = 0;
+		for (auto const & var : cb.vars)
+		{
+			uint32_t align;
+			uint32_t size;
+			if (!var.has_type_desc || !Std140Layout(var.type_desc, matrix_type, align, size)
+				|| (var.var_desc.start_offset < offset) || (var.var_desc.start_offset % align != 0))
+			{
+				return false;
 			}
-			out << "vec4 ";
-			if (shader_type_ != ST_VS)
-			{
-				out << "v_";
-			}
-			out << program_->params_in[i].semantic_name << program_->params_in[i].semantic_index;
-			if (ST_GS == shader_type_)
-			{
-				out << "In" << '[' << PrimitiveNumVertices(program_->gs_input_primitive) << ']';
-			}
-			else if (ST_HS == shader_type_)
-			{
-				out << "[gl_MaxPatchVertices]";
-			}
-			else if (ST_DS == shader_type_)
-			{
-				out << "In[gl_MaxPatchVertices]";
-			}
-			out << ";\n";
+			offset = var.var_desc.start_offset + size;
 		}
+		return offset <= cb.desc.size;
 	}
 
-	if (!program_->params_in.empty())
+	// A cbuffer with initializers is declared as constants instead of a uniform block
+	bool HasDefaultValues(DXBCConstantBuffer const & cb)
 	{
-		out << "\n";
+		for (auto const & var : cb.vars)
+		{
+			if (var.var_desc.default_val)
+			{
+				return true;
+			}
+		}
+		return false;
 	}
-}
 
-void GLSLGen::ToDclInterShaderOutputRecords(std::ostream& out)
-{
-	for (size_t i = 0; i < program_->params_out.size(); ++ i)
+	// Uniform locations taken by a member declared by ToDclCBufferMember, one per array element
+	uint32_t UniformLocationCount(DXBCShaderTypeDesc const & desc, bool matrix_type)
 	{
-		if ((SN_UNDEFINED == program_->params_out[i].system_value_type)
-			&& (strcmp("SV_Depth", program_->params_out[i].semantic_name) != 0))
+		uint32_t count = std::max(desc.elements, 1U);
+		if (!matrix_type)
 		{
-			if (ST_PS == shader_type_)
-			{
-				if (glsl_rules_ & GSR_ExplicitPSOutputLayout)
-				{
-					out << "layout(location=" << i << ") ";
-				}
-			}
-			
-			bool output_var = false;
-			if (glsl_rules_ & GSR_InOutPrefix)
+			// Declared as an array of its columns or rows
+			if (SVC_MATRIX_COLUMNS == desc.var_class)
 			{
-				if ((shader_type_ != ST_PS) && (glsl_rules_ & GSR_PSInterpolation))
-				{
-					out << "smooth ";
-				}
-
-				out << "out ";
-				output_var = true;
+				count *= desc.rows;
 			}
-			else
+			else if (SVC_MATRIX_ROWS == desc.var_class)
 			{
-				if (shader_type_ != ST_PS)
-				{
-					out << "varying ";
-					if (shader_type_ != ST_VS)
-					{
-						out << "out ";
-					}
-					output_var = true;
-				}
+				count *= desc.columns;
 			}
+		}
+		return count;
+	}
 
-			if (output_var)
-			{
-				int num_comps = 4;
-				if (((ST_VS == shader_type_) && !has_gs_ && !has_ps_) || ((ST_DS == shader_type_) && !has_gs_ && !has_ps_)
-					|| ((ST_GS == shader_type_) && !has_ps_)
-					|| (ST_PS == shader_type_))
-				{
-					num_comps = bitcount32(program_->params_out[i].mask);
-				}
-
-				if (1 == num_comps)
-				{
-					switch (program_->params_out[i].component_type)
-					{
-					case SRCT_UINT32:
-						if (glsl_rules_ & GSR_UIntType)
-						{
-							out << "u";
-						}
-						out << "int";
-						break;
-
-					case SRCT_SINT32:
-						out << "int";
-						break;
+	// Types ToDefaultValue can spell as an initializer
+	bool HasConstantInitializer(DXBCShaderTypeDesc const & desc)
+	{
+		if ((desc.type != SVT_INT) && (desc.type != SVT_UINT) && (desc.type != SVT_FLOAT))
+		{
+			return false;
+		}
+		switch (desc.var_class)
+		{
+		case SVC_SCALAR:
+		case SVC_VECTOR:
+			return true;
 
-					case SRCT_FLOAT32:
-						out << "float";
-						break;
+		case SVC_MATRIX_ROWS:
+		case SVC_MATRIX_COLUMNS:
+			return (SVT_FLOAT == desc.type) && (desc.rows == desc.columns);
 
-					default:
-						assert(false);
-						break;
-					}
-				}
-				else
-				{
-					switch (program_->params_out[i].component_type)
-					{
-					case SRCT_UINT32:
-						if (glsl_rules_ & GSR_UIntType)
-						{
-							out << "u";
-						}
-						else
-						{
-							out << "i";
-						}
-						break;
+		default:
+			return false;
+		}
+	}
 
-					case SRCT_SINT32:
-						out << "i";
-						break;
+	uint32_t PackedSize(DXBCShaderTypeDesc const & desc, std::vector<DXBCShaderTypeMember> const & members)
+	{
+		uint32_t size = 0;
+		switch (desc.var_class)
+		{
+		case SVC_SCALAR:
+			size = 4;
+			break;
 
-					case SRCT_FLOAT32:
-						break;
+		case SVC_VECTOR:
+			size = desc.columns * 4;
+			break;
 
-					default:
-						assert(false);
-						break;
-					}
-					out << "vec" << num_comps;
-				}
+		case SVC_MATRIX_ROWS:
+		case SVC_MATRIX_COLUMNS:
+			size = desc.rows * desc.columns * 4;
+			break;
 
-				out << " v_" << program_->params_out[i].semantic_name
-					<< program_->params_out[i].semantic_index;
-				if ((ST_VS == shader_type_) && has_gs_)
-				{
-					out << "In";
-				}
-				if (ST_HS == shader_type_)
-				{
-					out << "In[" << program_->hs_output_control_point_count << "]";
-				}
-				if (ST_DS == shader_type_ && has_gs_)
-				{
-					out << "In";
-				}
-				out << ";\n";
+		case SVC_STRUCT:
+			for (auto const & member : members)
+			{
+				size = std::max(size, member.type_desc.offset + PackedSize(member.type_desc, member.members));
 			}
+			break;
+
+		default:
+			break;
 		}
+		return size * std::max(desc.elements, 1U);
 	}
 
-	if (!program_->params_out.empty())
+	void SetStructuredWord(std::vector<StructuredWord>& words, uint32_t index, std::string const & leaf, int comp,
+		ShaderImmType type)
 	{
-		out << "\n";
+		if (index < words.size())
+		{
+			words[index].leaf = leaf;
+			words[index].comp = comp;
+			words[index].type = type;
+		}
 	}
-}
 
-void GLSLGen::ToDeclInterShaderInputRegisters(std::ostream& out) const
-{
-	std::vector<RegisterDesc> input_registers;
-	for (auto const & sig_desc : program_->params_in)
+	void FlattenStructuredWords(DXBCShaderTypeDesc const & desc, std::vector<DXBCShaderTypeMember> const & members,
+		std::string const & path, uint32_t offset, std::vector<StructuredWord>& words)
 	{
-		if (sig_desc.read_write_mask != 0)
+		uint32_t const count = std::max(desc.elements, 1U);
+		uint32_t const element_size = PackedSize(desc, members) / count;
+		ShaderImmType const type = StructuredComponentType(desc.type);
+		for (uint32_t e = 0; e < count; ++ e)
 		{
-			uint32_t register_index = sig_desc.register_index;
-			if (register_index != 0xFFFFFFFF)
+			std::string element_path = path;
+			if (desc.elements > 0)
 			{
-				ShaderRegisterComponentType type = sig_desc.component_type;
-				bool found = false;
-				for (auto const & reg : input_registers)
+				element_path += "[" + std::to_string(e) + "]";
+			}
+			uint32_t const base = (offset + e * element_size) / 4;
+			switch (desc.var_class)
+			{
+			case SVC_SCALAR:
+				SetStructuredWord(words, base, element_path, -1, type);
+				break;
+
+			case SVC_VECTOR:
+				for (uint32_t c = 0; c < desc.columns; ++ c)
 				{
-					if (reg.index == register_index)
-					{
-						found = true;
-						break;
-					}
+					SetStructuredWord(words, base + c, element_path, (desc.columns > 1) ? static_cast<int>(c) : -1, type);
 				}
+				break;
 
-				if (!found)
+			case SVC_MATRIX_COLUMNS:
+				for (uint32_t c = 0; c < desc.columns; ++ c)
 				{
-					RegisterDesc desc;
-					desc.index = register_index;
-					if ((SN_VERTEX_ID == sig_desc.system_value_type)
-						|| (SN_PRIMITIVE_ID == sig_desc.system_value_type)
-						|| (SN_INSTANCE_ID == sig_desc.system_value_type))
+					for (uint32_t r = 0; r < desc.rows; ++ r)
 					{
-						desc.type = SRCT_SINT32;
+						SetStructuredWord(words, base + c * desc.rows + r, element_path + "[" + std::to_string(c) + "]",
+							r, type);
 					}
-					else
+				}
+				break;
+
+			case SVC_MATRIX_ROWS:
+				for (uint32_t r = 0; r < desc.rows; ++ r)
+				{
+					for (uint32_t c = 0; c < desc.columns; ++ c)
 					{
-						desc.type = type;
+						SetStructuredWord(words, base + r * desc.columns + c, element_path + "[" + std::to_string(c) + "]",
+							r, type);
 					}
-					desc.interpolation = SIM_Undefined;
-					desc.is_depth = false;
-					input_registers.push_back(desc);
 				}
+				break;
+
+			case SVC_STRUCT:
+				for (auto const & member : members)
+				{
+					FlattenStructuredWords(member.type_desc, member.members, element_path + "." + member.name,
+						base * 4 + member.type_desc.offset, words);
+				}
+				break;
+
+			default:
+				break;
 			}
 		}
 	}
 
-	for (auto const & reg : input_registers)
+	// GLSL type of a scalar, vector or matrix RDEF type. HLSL floatRxC is matCxR in GLSL.
+	std::string GLSLTypeName(DXBCShaderTypeDesc const & desc)
 	{
-		switch (reg.type)
+		std::string name;
+		switch (desc.var_class)
 		{
-		case SRCT_UINT32:
-			if (glsl_rules_ & GSR_UIntType)
-			{
-				out << "u";
-			}
-			else
+		case SVC_MATRIX_ROWS:
+		case SVC_MATRIX_COLUMNS:
+			name = "mat" + std::to_string(desc.columns);
+			if (desc.rows != desc.columns)
 			{
-				out << "i";
+				name += "x" + std::to_string(desc.rows);
 			}
 			break;
 
-		case SRCT_SINT32:
-			out << "i";
-			break;
-
-		case SRCT_FLOAT32:
-			break;
-
 		default:
-			assert(false);
-			break;
-		}
-
-		out << "vec4 i_REGISTER" << reg.index;
-		if ((ST_GS == shader_type_) || (ST_HS == shader_type_) || (ST_DS == shader_type_))
-		{
-			int n = 0;
-			switch (shader_type_)
 			{
-			case ST_GS:
-				n = PrimitiveNumVertices(program_->gs_input_primitive);
-				break;
-			case ST_HS:
-				n = program_->hs_input_control_point_count;
-				break;
-			case ST_DS:
-			default:
-				n = DomainNumVertices(program_->ds_tessellator_domain);
-				break;
+				std::ostringstream ss;
+				ToImmTypeName(ss, StructuredComponentType(desc.type),
+					(SVC_VECTOR == desc.var_class) ? static_cast<int>(desc.columns) : 1);
+				name = ss.str();
 			}
-			out << '[' << n << ']';
+			break;
 		}
-		out << ";\n";
+		return name;
 	}
-}
 
-void GLSLGen::ToCopyToInterShaderInputRegisters(std::ostream& out) const
-{
-	uint32_t num_vertices = 1;
-	if (ST_GS == shader_type_)
+	// SM4 resource chunks have no type names, so structs are named after where they are used
+	std::string StructTypeName(char const * struct_name, std::string const & fallback)
 	{
-		num_vertices = PrimitiveNumVertices(program_->gs_input_primitive);
+		return struct_name ? std::string(struct_name) : fallback;
 	}
-	if ((ST_HS == shader_type_) || (ST_DS == shader_type_))
+
+	// Register the operand reads or writes as a varying directly, nullptr when it goes through i_REGISTER/o_REGISTER
+	SignatureRegister const * FindDirectRegister(std::vector<SignatureRegister> const & registers, ShaderOperand const & op)
 	{
-		out<< "for (int i = 0; i < gl_PatchVerticesIn; ++ i)\n{\n";
+		if (!op.indices[0].reg && (op.indices[0].disp >= 0) && (op.indices[0].disp < static_cast<int64_t>(registers.size()))
+			&& !registers[static_cast<size_t>(op.indices[0].disp)].varying.empty())
+		{
+			return &registers[static_cast<size_t>(op.indices[0].disp)];
+		}
+		return nullptr;
 	}
-	for (auto const & sig_desc : program_->params_in)
-	{
-		if ((sig_desc.read_write_mask != 0) && (sig_desc.register_index != 0xFFFFFFFF))
-		{
-			for (uint32_t v = 0; v < num_vertices; ++ v)
-			{
-				out << "i_REGISTER" << sig_desc.register_index;
-				if (ST_GS == shader_type_)
-				{
-					out << '[' << v << ']';
-				}
-				if ((ST_HS == shader_type_) || (ST_DS == shader_type_))
-				{
-					out << "[i]";
-				}
-				uint32_t mask = sig_desc.mask;
-				out << '.';
-				this->ToComponentSelector(out, this->ComponentSelectorFromMask(mask, 4));
-
-				out << " = ";
-
-				bool need_comps = true;
-				if (ST_GS == shader_type_)
-				{
-					switch (sig_desc.system_value_type)
-					{
-					case SN_POSITION:
-						if (glsl_rules_ & GSR_CoreGS)
-						{
-							out << "gl_in" << '[' << v << "].gl_Position";
-						}
-						else
-						{
-							out << "gl_PositionIn";
-						}
-						need_comps = true;
-						break;
-
-					case SN_CLIP_DISTANCE:
-						if (glsl_rules_ & GSR_CoreGS)
-						{
-							out << "gl_in" << '[' << v << "].gl_ClipDistance[" << sig_desc.semantic_index << "]";
-						}
-						else
-						{
-							out << "gl_ClipDistanceIn[" << sig_desc.semantic_index << "]";
-						}
-						need_comps = false;
-						break;
-
-					case SN_PRIMITIVE_ID:
-						out << "gl_PrimitiveIDIn";
-						need_comps = false;
-						break;
-
-					case SN_UNDEFINED:
-						out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "In"
-							<< '[' << v << ']';
-						need_comps = true;
-						break;
-
-					default:
-						break;
-					}
-				}
-				else if (ST_HS == shader_type_)
-				{
-					switch (sig_desc.system_value_type)
-					{
-					case SN_POSITION:
-						out << "gl_in[i].gl_Position";
-						need_comps = true;
-						break;
-
-					case SN_CLIP_DISTANCE:
-						out << "gl_in[i].gl_ClipDistance[" << sig_desc.semantic_index << "]";
-						need_comps = false;
-						break;
-
-					case SN_PRIMITIVE_ID:
-						out << "gl_PrimitiveID";
-						need_comps = false;
-						break;
-
-					case SN_UNDEFINED:
-						out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "[i]";
-						need_comps = true;
-						break;
-
-					default:
-						break;
-					}
-				}
-				else if (ST_DS == shader_type_)
-				{
-					switch (sig_desc.system_value_type)
-					{
-					case SN_POSITION:
-						out << "gl_in[i].gl_Position";
-						need_comps = true;
-						break;
-
-					case SN_CLIP_DISTANCE:
-						out << "gl_in[i].gl_ClipDistance[" << sig_desc.semantic_index << "]";
-						need_comps = false;
-						break;
-
-					case SN_PRIMITIVE_ID:
-						out << "gl_PrimitiveID";
-						need_comps = false;
-						break;
-
-					case SN_UNDEFINED:
-						out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "In[i]";
-						need_comps = true;
-						break;
-
-					default:
-						break;
-					}
-				}
-				else
-				{
-					switch (sig_desc.system_value_type)
-					{
-					case SN_POSITION:
-						out << "gl_Position";
-						need_comps = true;
-						break;
 
-					// TODO: Processing SN_CLIP_DISTANCE and SN_CULL_DISTANCE
-
-					case SN_RENDER_TARGET_ARRAY_INDEX:
-						out << "gl_Layer";
-						need_comps = false;
-						break;
-
-					case SN_VIEWPORT_ARRAY_INDEX:
-						out << "gl_ViewportIndex";
-						need_comps = false;
-						break;
-
-					case SN_VERTEX_ID:
-						out << "gl_VertexID";
-						need_comps = false;
-						break;
-
-					case SN_PRIMITIVE_ID:
-						out << "gl_PrimitiveID";
-						need_comps = false;
-						break;
-
-					case SN_INSTANCE_ID:
-						out << "gl_InstanceID";
-						need_comps = false;
-						break;
-
-					case SN_IS_FRONT_FACE:
-						if (glsl_rules_ & GSR_UIntType)
-						{
-							out << "uint";
-						}
-						out << "(gl_FrontFacing ? 1 : 0)";
-						need_comps = false;
-						break;
-
-					case SN_SAMPLE_INDEX:
-						if (glsl_rules_ & GSR_ExplicitMultiSample)
-						{
-							out << "gl_SampleID";
-						}
-						else
-						{
-							out << "0";
-						}
-						need_comps = false;
-						break;
-
-					case SN_UNDEFINED:
-						if (shader_type_ != ST_VS)
-						{
-							out << "v_";
-						}
-						out << sig_desc.semantic_name << sig_desc.semantic_index;
-						need_comps = true;
-						break;
-
-					default:
-						break;
-					}
-				}
-				if (need_comps)
-				{
-					out << ".";
-					this->ToComponentSelector(out, this->ComponentSelectorFromCount(bitcount32(mask)));
-				}
-				out << ";\n";
-			}
-		}
-	}
-	if ((ST_HS == shader_type_) || (ST_DS == shader_type_))
+	bool HasVarying(std::vector<SignatureRegister> const & registers, uint32_t register_index)
 	{
-		out << "}\n";
+		return (register_index < registers.size()) && !registers[register_index].varying.empty();
 	}
 
-	if (!program_->params_in.empty())
+	// gl_Layer and gl_ViewportIndex are ints, whatever type the output signature gives them
+	ShaderRegisterComponentType OutputComponentType(DXBCSignatureParamDesc const & desc)
 	{
-		out << "\n";
+		if ((SN_RENDER_TARGET_ARRAY_INDEX == desc.system_value_type) || (SN_VIEWPORT_ARRAY_INDEX == desc.system_value_type))
+		{
+			return SRCT_SINT32;
+		}
+		return desc.component_type;
 	}
-}
-
-void GLSLGen::ToDeclInterShaderOutputRegisters(std::ostream& out) const
-{
-	std::vector<RegisterDesc> output_dcl_record;
 
-	for (auto const & sig_desc : program_->params_out)
+	void BuildRegisterTable(std::vector<DXBCSignatureParamDesc> const & params, std::vector<SignatureRegister>& registers)
 	{
-		if (sig_desc.read_write_mask != 0xF)
+		SignatureRegister const unused = { nullptr, SSK_User, nullptr, false, SRCT_FLOAT32, SIM_Undefined };
+		registers.clear();
+		for (auto const & param : params)
 		{
-			ShaderRegisterComponentType type = sig_desc.component_type;
-			uint32_t register_index = sig_desc.register_index;
-			bool found = false;
-			for (auto const & dcl : output_dcl_record)
+			uint32_t register_index = param.register_index;
+			if (register_index >= MAX_SIGNATURE_REGISTERS)
 			{
-				if (dcl.index == register_index)
-				{
-					found = true;
-					break;
-				}
+				continue;
 			}
-
-			if (!found)
+			if (register_index >= registers.size())
 			{
-				RegisterDesc desc;
-				desc.index = register_index;
-				desc.type = type;
-				desc.interpolation = SIM_Undefined;
-				desc.is_depth = (0 == strcmp("SV_Depth", sig_desc.semantic_name));
-				output_dcl_record.push_back(desc);
+				registers.resize(register_index + 1, unused);
+			}
+			SignatureRegister& reg = registers[register_index];
+			if (!reg.desc)
+			{
+				reg.desc = &param;
+				reg.kind = ClassifySemantic(param);
+				reg.component_type = param.component_type;
 			}
 		}
 	}
+}
 
-	for (auto const & dcl : output_dcl_record)
+uint64_t GLSLGen::DefaultRules(GLSLVersion version)
+{
+	uint64_t rules = GSR_VersionDecl;
+	if (version < GSV_100_ES)
 	{
-		switch (dcl.type)
+		if (version >= GSV_110)
 		{
-		case SRCT_UINT32:
-			if (glsl_rules_ & GSR_UIntType)
-			{
-				out << "u";
-			}
-			else
-			{
-				out << "i";
-			}
-			break;
-
-		case SRCT_SINT32:
-			out << "i";
-			break;
-
-		case SRCT_FLOAT32:
-			break;
-
-		default:
-			assert(false);
-			break;
+			rules |= GSR_MatrixType;
+			rules |= GSR_DrawBuffers;
 		}
-
-		out << "vec4 o_REGISTER";
-		if (dcl.is_depth)
+		if (version >= GSV_120)
 		{
-			out << "Depth";
+			rules |= GSR_ArrayConstructors;
 		}
-		else
+		if (version >= GSV_130)
+		{
+			rules |= GSR_UIntType;
+			rules |= GSR_GenericTexture;
+			rules |= GSR_PSInterpolation;
+			rules |= GSR_InOutPrefix;
+			rules |= GSR_TextureGrad;
+			rules |= GSR_BitwiseOp;
+			rules |= GSR_BooleanMix;
+		}
+		if (version >= GSV_140)
+		{
+			rules |= GSR_GlobalUniformsInUBO;
+			rules |= GSR_UseUBO;
+		}
+		if (version >= GSV_150)
+		{
+			rules |= GSR_CoreGS;
+		}
+		if (version >= GSV_330)
+		{
+			rules |= GSR_UniformBlockBinding;
+			rules |= GSR_ExplicitPSOutputLayout;
+			rules |= GSR_ExplicitInputLayout;
+		}
+		if (version >= GSV_400)
+		{
+			rules |= GSR_Int64Type;
+			rules |= GSR_MultiStreamGS;
+			rules |= GSR_PreciseQualifier;
+			rules |= GSR_DoubleType;
+			rules |= GSR_HSForkInvocations;
+		}
+		if (version >= GSV_410)
+		{
+			rules |= GSR_ExplicitVaryingLocation;
+		}
+		if (version >= GSV_420)
+		{
+			rules |= GSR_EarlyFragmentTests;
+			rules |= GSR_SamplerBinding;
+		}
+		if (version >= GSV_430)
+		{
+		}
+		if (version >= GSV_440)
+		{
+			rules |= GSR_UniformBlockMemberOffset;
+		}
+		if (version >= GSV_450)
+		{
+			rules |= GSR_ExplicitMultiSample;
+			rules |= GSR_IntegerMix;
+		}
+		if (version >= GSV_460)
 		{
-			out << dcl.index;
 		}
-		out << ";\n";
 	}
-
-	if (!output_dcl_record.empty())
+	else
 	{
-		out << "\n";
+		if (version >= GSV_100_ES)
+		{
+			rules |= GSR_Precision;
+		}
+		if (version >= GSV_300_ES)
+		{
+			rules |= GSR_UIntType;
+			rules |= GSR_GenericTexture;
+			rules |= GSR_PSInterpolation;
+			rules |= GSR_InOutPrefix;
+			rules |= GSR_TextureGrad;
+			rules |= GSR_BitwiseOp;
+			rules |= GSR_GlobalUniformsInUBO;
+			rules |= GSR_UseUBO;
+			rules |= GSR_CoreGS;
+			rules |= GSR_UniformBlockBinding;
+			rules |= GSR_ExplicitPSOutputLayout;
+			rules |= GSR_ExplicitInputLayout;
+			rules |= GSR_MatrixType;
+			rules |= GSR_ArrayConstructors;
+			rules |= GSR_DrawBuffers;
+			rules |= GSR_PrecisionOnSampler;
+			rules |= GSR_BooleanMix;
+		}
+		if (version >= GSV_310_ES)
+		{
+			rules |= GSR_EarlyFragmentTests;
+			rules |= GSR_IntegerMix;
+			rules |= GSR_ExplicitVaryingLocation;
+			rules |= GSR_SamplerBinding;
+		}
+		if (version >= GSV_320_ES)
+		{
+			rules |= GSR_PreciseQualifier;
+			rules |= GSR_HSForkInvocations;
+		}
 	}
+
+	return rules;
 }
 
-void GLSLGen::ToCopyToInterShaderOutputRecords(std::ostream& out) const
+bool GLSLGen::PackVaryings(ShaderProgram const & producer, ShaderProgram const & consumer, VaryingLayout& layout)
 {
-	for (auto const & sig_desc : program_->params_out)
+	layout.varyings.clear();
+	layout.slots.clear();
+	if ((consumer.version.type != ST_PS)
+		|| ((producer.version.type != ST_VS) && (producer.version.type != ST_DS) && (producer.version.type != ST_GS)))
 	{
-		if (sig_desc.read_write_mask != 0xF)
+		return false;
+	}
+
+	struct Element
+	{
+		DXBCSignatureParamDesc const * desc;
+		ShaderInterpolationMode interpolation;
+		uint32_t min_precision;
+		uint32_t first;
+		uint32_t num_comps;
+	};
+	std::vector<Element> elements;
+	for (auto const & param : consumer.params_in)
+	{
+		if ((param.system_value_type != SN_UNDEFINED) || !strcmp("POSITION", param.semantic_name))
 		{
-			uint32_t mask = sig_desc.mask;
-			bool need_comps = true;
-			if (ST_HS == shader_type_)
+			continue;
+		}
+
+		DXBCSignatureParamDesc const * output = nullptr;
+		for (auto const & param_out : producer.params_out)
+		{
+			if ((SN_UNDEFINED == param_out.system_value_type) && (0 == param_out.stream)
+				&& (param_out.semantic_index == param.semantic_index) && !strcmp(param_out.semantic_name, param.semantic_name))
 			{
-				switch (sig_desc.system_value_type)
-				{
-				case SN_POSITION:
-					out << "gl_out[gl_InvocationID].gl_Position";
-					need_comps = true;
-					break;
+				output = &param_out;
+				break;
+			}
+		}
+		if (!output)
+		{
+			continue;
+		}
 
-				case SN_PRIMITIVE_ID:
-					out << "gl_PrimitiveID";
-					need_comps = false;
-					break;
+		Element element;
+		element.desc = &param;
+		element.interpolation = SIM_Linear;
+		for (auto const & dcl : consumer.dcls)
+		{
+			if ((SO_DCL_INPUT_PS == dcl->opcode) && (dcl->op->indices[0].disp == static_cast<int64_t>(param.register_index)))
+			{
+				element.interpolation = dcl->dcl_input_ps.interpolation;
+				break;
+			}
+		}
+		if ((param.component_type != SRCT_FLOAT32) || (SIM_Undefined == element.interpolation))
+		{
+			element.interpolation = (param.component_type != SRCT_FLOAT32) ? SIM_Constant : SIM_Linear;
+		}
+		element.min_precision = MergeMinPrecision(param.min_precision, output->min_precision);
+		uint32_t mask = param.mask | output->mask;
+		element.first = FirstComponent(mask);
+		element.num_comps = LastComponent(mask) - element.first + 1;
+		elements.push_back(element);
+	}
 
-				case SN_UNDEFINED:
-					out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "In[gl_InvocationID]";
-					need_comps = true;
-					break;
+	// Widest first, the narrow ones fill the gaps
+	std::stable_sort(elements.begin(), elements.end(),
+		[](Element const & lhs, Element const & rhs)
+		{
+			return lhs.num_comps > rhs.num_comps;
+		});
 
-				default:
-					break;
-				}
-			}
-			else
+	for (auto const & element : elements)
+	{
+		uint32_t location = 0;
+		for (; location < layout.slots.size(); ++ location)
+		{
+			VaryingSlot const & slot = layout.slots[location];
+			if ((slot.component_type == element.desc->component_type) && (slot.interpolation == element.interpolation)
+				&& (slot.used_comps + element.num_comps <= 4))
 			{
-				switch (sig_desc.system_value_type)
-				{
-				case SN_POSITION:
-					out << "gl_Position";
-					need_comps = true;
-					break;
-
-				case SN_RENDER_TARGET_ARRAY_INDEX:
-					out << "gl_Layer";
-					need_comps = false;
-					break;
+				break;
+			}
+		}
+		if (location == layout.slots.size())
+		{
+			VaryingSlot slot;
+			slot.component_type = element.desc->component_type;
+			slot.interpolation = element.interpolation;
+			slot.min_precision = 0xFF;
+			slot.used_comps = 0;
+			layout.slots.push_back(slot);
+		}
 
-				case SN_PRIMITIVE_ID:
-					out << "gl_PrimitiveID";
-					need_comps = false;
-					break;
+		VaryingSlot& slot = layout.slots[location];
+		PackedVarying varying;
+		varying.semantic_name = element.desc->semantic_name;
+		varying.semantic_index = element.desc->semantic_index;
+		varying.location = location;
+		varying.component = slot.used_comps;
+		varying.register_component = element.first;
+		layout.varyings.push_back(varying);
 
-				case SN_VIEWPORT_ARRAY_INDEX:
-					out << "gl_ViewportIndex";
-					need_comps = false;
-					break;
+		slot.used_comps += element.num_comps;
+		slot.min_precision = MergeMinPrecision(slot.min_precision, element.min_precision);
+	}
 
-				case SN_UNDEFINED:
-					if (0 == strcmp("SV_Depth", sig_desc.semantic_name))
-					{
-						out << "gl_FragDepth";
-						need_comps = false;
-					}
-					else
-					{
-						bool output_var = false;
-						if (glsl_rules_ & GSR_InOutPrefix)
-						{
-							output_var = true;
-						}
-						else
-						{
-							if (shader_type_ != ST_PS)
-							{
-								output_var = true;
-							}
-						}
+	return true;
+}
 
-						bool output_semantic = false;
-						if (output_var)
-						{
-							output_semantic = true;
-						}
-						else
-						{
-							if (0 == strcmp("SV_Target", sig_desc.semantic_name))
-							{
-								uint32_t index = 0;
-								if (glsl_rules_ & GSR_DrawBuffers)
-								{
-									index = sig_desc.semantic_index;
-								}
-								out << "gl_FragData[" << index << ']';
-							}
-							else
-							{
-								output_semantic = true;
-							}
-						}
+void GLSLGen::CBufferSpecializations(std::vector<CBufferSpecialization> const & specializations)
+{
+	specializations_ = specializations;
+}
 
-						if (output_semantic)
-						{
-							out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index;
-							if ((ST_VS == shader_type_) && has_gs_)
-							{
-								out << "In";
-							}
-						}
+void GLSLGen::BindingPolicy(GLSLBindingPolicy const & policy)
+{
+	binding_policy_ = policy;
+}
 
-						need_comps = true;
-					}
-					break;
+void GLSLGen::VaryingLayouts(std::shared_ptr<VaryingLayout const> const & input_layout,
+		std::shared_ptr<VaryingLayout const> const & output_layout)
+{
+	input_layout_ = input_layout;
+	output_layout_ = output_layout;
+}
 
-				default:
-					break;
-				}
-			}
-			if (need_comps)
-			{
-				out << '.';
-				this->ToComponentSelector(out, this->ComponentSelectorFromCount(bitcount32(mask)));
-			}
-			out << " = o_REGISTER";
-			if (0 == strcmp("SV_Depth", sig_desc.semantic_name))
-			{
-				out << "Depth";
-			}
-			else
-			{
-				out << sig_desc.register_index;
-			}
-			out << '.';
-			this->ToComponentSelector(out, this->ComponentSelectorFromMask(mask, 4));
-			out << ";\n";
-		}
-	}
+void GLSLGen::FeedDXBC(std::shared_ptr<ShaderProgram const> const & program,
+		bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive,
+		GLSLVersion version, uint64_t glsl_rules)
+{
+	this->AnalyzeDXBC(program, has_gs, has_ps, ds_partitioning, ds_output_primitive);
+	this->FeedTarget(version, glsl_rules);
 }
 
-void GLSLGen::ToDeclaration(std::ostream& out, ShaderDecl const & dcl)
+void GLSLGen::AnalyzeDXBC(std::shared_ptr<ShaderProgram const> const & program,
+		bool has_gs, bool has_ps, ShaderTessellatorPartitioning ds_partitioning, ShaderTessellatorOutputPrimitive ds_output_primitive)
 {
-	ShaderImmType sit = GetOpInType(dcl.opcode);
-	switch (dcl.opcode)
-	{
-	case SO_DCL_INPUT:
-	case SO_DCL_INPUT_SGV:
-	case SO_DCL_INPUT_SIV:
-	case SO_DCL_OUTPUT:
-	case SO_DCL_OUTPUT_SIV:
-	case SO_DCL_OUTPUT_SGV:
-	case SO_DCL_INPUT_PS_SGV:
-	case SO_DCL_INPUT_PS_SIV:
-		break;
+	program_ = program;
+	shader_type_ = program_->version.type;
+	has_gs_ = has_gs;
+	has_ps_ = has_ps;
+	ds_partitioning_ = ds_partitioning;
+	ds_output_primitive_ = ds_output_primitive;
+	enter_hs_fork_phase_ = false;
+	enter_final_hs_fork_phase_ = false;
+	enter_hs_join_phase_ = false;
+	enter_final_hs_join_phase_ = false;
+	hs_fork_invocations_ = false;
+	labels_found_ = false;
+	result_ = GLSLGenResult();
+	cur_insn_ = nullptr;
 
-	case SO_DCL_CONSTANT_BUFFER:
-		{
-			cb_index_mode_[dcl.op->indices[0].disp] = dcl.dcl_constant_buffer.dynamic;
+	this->FindGlobalFlags();
+	this->ValidateProgram();
+	if (result_.status != GGS_OK)
+	{
+		return;
+	}
+	this->LinkCFInsns();
+	if (result_.status != GGS_OK)
+	{
+		return;
+	}
+	this->FindLabels();
+	this->FindEndOfProgram();
+	if (result_.status != GGS_OK)
+	{
+		return;
+	}
+	this->FindDclIndexRange();
+	this->FindStructuredBuffers();
+	this->FindTempDcls();
+	this->FindHSControlPointPhase();
+	this->FindHSForkPhases();
+	this->FindHSJoinPhases();
+}
 
-			if (glsl_rules_ & GSR_UniformBlockBinding)
-			{
-				out<<"layout(binding="
-					<<dcl.op->indices[0].disp
-					<<") ";
-			}
+void GLSLGen::FeedTarget(GLSLVersion version, uint64_t glsl_rules)
+{
+	glsl_version_ = version;
+	glsl_rules_ = glsl_rules;
 
-			// Find the cb corresponding to bind_point
-			for (auto const & cb : program_->cbuffers)
-			{
-				if ((SCBT_CBUFFER == cb.desc.type) && (cb.bind_point == dcl.op->indices[0].disp))
-				{
-					// If this cb has a member with default value ,then treat all members of this cb as constant
-					// variables with intialization value in glsl.
-					// e.g.
-					/***********************************
-					cbuffer Immutable
-					{
-						int a = 5;
-						float b = 3.0f;
-					}
-					is converted to:
-					const int a = 5;
-					const float b = 3.0f;
-					In this case, uniform block is not used.
-					*************************************/
-						
-					bool has_default_value = false;
-					for (auto const & var : cb.vars)
-					{
-						if (var.var_desc.default_val)
-						{
-							has_default_value = true;
-							break;
-						}
-					}
-					if ((glsl_rules_ & GSR_UseUBO) && ((glsl_rules_ & GSR_GlobalUniformsInUBO) || (cb.desc.name[0] != '$'))
-						&& (!has_default_value))
-					{
-						out << "uniform ";
-						out << cb.desc.name << "\n{\n";
-					}
-					char const * uniform = "";
-					if (!(glsl_rules_ & GSR_GlobalUniformsInUBO))
-					{
-						uniform = "uniform ";
-					}
-						
-					for (auto const & var : cb.vars)
-					{
-						if (var.has_type_desc)
-						{
-							// Array element count, 0 if not a array
-							uint32_t element_count = var.type_desc.elements;
-							if (has_default_value)
-							{
-								out << "const ";
-							}
-							switch (var.type_desc.var_class)
-							{
-							case SVC_SCALAR:
-								out << uniform << var.type_desc.name;
-								out << " " << var.var_desc.name;
-								if (element_count)
-								{
-									out << "[" << element_count << "]";
-								}
-								break;
+	if (!(glsl_rules_ & GSR_UseUBO))
+	{
+		glsl_rules_ &= ~GSR_UniformBlockBinding;
+		glsl_rules_ &= ~GSR_GlobalUniformsInUBO;
+		glsl_rules_ &= ~GSR_D3DCBufferLayout;
+		glsl_rules_ &= ~GSR_DynamicCBufferRegisters;
+	}
+	// GL_ARB_bindless_texture needs GLSL 4.00, and uniform blocks to keep the handles in
+	if ((glsl_version_ < GSV_400) || (glsl_version_ >= GSV_100_ES) || !(glsl_rules_ & GSR_UseUBO))
+	{
+		glsl_rules_ &= ~GSR_BindlessTexture;
+	}
+	// Explicit uniform locations are core in GLSL 4.30 and ESSL 3.10, GL_ARB_explicit_uniform_location needs GL 3.3
+	if ((glsl_version_ >= GSV_100_ES) ? (glsl_version_ < GSV_310_ES) : (glsl_version_ < GSV_330))
+	{
+		glsl_rules_ &= ~GSR_UniformLocations;
+	}
 
-							case SVC_VECTOR:
-								out << uniform;
-								if (1 == var.type_desc.columns)
-								{
-									out << var.type_desc.name;
-								}
-								else
-								{
-									switch (var.type_desc.type)
-									{
-									case SVT_INT:
-										out << "i";
-										break;
-
-									case SVT_FLOAT:
-										break;
-
-									case SVT_UINT:
-										if (glsl_rules_ & GSR_UIntType)
-										{
-											out << "u";
-										}
-										else
-										{
-											out << "i";
-										}
-										break;
-
-									default:
-										assert_msg(false, "unexpected vector type");
-										break;
-									}
-									out << "vec";
-								}
-								out << var.type_desc.columns << " " << var.var_desc.name;
-								if (element_count)
-								{
-									out << "[" << element_count << "]";
-								}
-								break;
+	// Only PS inputs and the outputs feeding a PS are packed
+	if (shader_type_ != ST_PS)
+	{
+		input_layout_.reset();
+	}
+	if (((shader_type_ != ST_VS) && (shader_type_ != ST_DS) && (shader_type_ != ST_GS)) || (has_gs_ && (shader_type_ != ST_GS)))
+	{
+		output_layout_.reset();
+	}
 
-							case SVC_MATRIX_COLUMNS:
-								if (glsl_rules_ & GSR_MatrixType)
-								{
-									// In glsl mat3x2 means 3 columns 2 rows, which is opposite to hlsl
-									out << uniform << "mat" << var.type_desc.columns << 'x'
-										<< var.type_desc.rows << " " << var.var_desc.name;
-									if (element_count)
-									{
-										out << "[" << element_count << "]";
-									}
-								}
-								else
-								{
-									uint32_t array_size = var.type_desc.rows;
-									if (element_count)
-									{
-										array_size *= element_count;
-									}
-									out << uniform << "vec" << var.type_desc.columns << ' '
-										<< var.var_desc.name << "[" << array_size << "]";
-								}
-								break;
+	if (result_.status != GGS_OK)
+	{
+		return;
+	}
+	this->BuildSignatureRegisters();
+	this->FindDirectRegisters();
+	this->FindSamplers();
+	this->FindBindings();
+	this->FindCBufferLayouts();
+	this->FindUniformLocations();
+	this->FindHSForkInvocations();
+	this->FindMinPrecision();
+}
 
-							case SVC_MATRIX_ROWS:
-								if (glsl_rules_ & GSR_MatrixType)
-								{
-									// In glsl mat3x2 means 3 columns 2 rows, which is opposite to hlsl
-									out << "layout(row_major) "
-										<< uniform << "mat" << var.type_desc.columns << 'x'
-										<< var.type_desc.rows << " " << var.var_desc.name;
-									if (element_count)
-									{
-										out << "[" << element_count << "]";
-									}
-								}
-								else
-								{
-									uint32_t array_size = var.type_desc.columns;
-									if (element_count)
-									{
-										array_size *= element_count;
-									}
-									out << uniform << "vec" << var.type_desc.rows << ' '
-										<< var.var_desc.name << "[" << array_size << "]";
-								}
-								break;
+void GLSLGen::ToGLSL(std::ostream& out)
+{
+	if (result_.status != GGS_OK)
+	{
+		return;
+	}
 
-							default:
-								assert_msg(false, "Unhandled type,when converting dcl_constant_buffer");
-								break;
-							}
-							if (has_default_value)
-							{
-								out << " = ";
-								this->ToDefaultValue(out, var);
-							}
-							out << ";\n";
-						}
-					}
-					if ((glsl_rules_ & GSR_UseUBO) && ((glsl_rules_ & GSR_GlobalUniformsInUBO) || (cb.desc.name[0] != '$')))
-					{
-						out << "};\n";
-					}
-					out << "\n";
+	if (glsl_rules_ & GSR_Minify)
+	{
+		std::ostringstream ss;
+		this->ToProgram(ss);
+		out << MinifyGLSL(ss.str());
+	}
+	else
+	{
+		this->ToProgram(out);
+	}
+}
 
-					break;
-				}
-			}
-		}
-		break;
+void GLSLGen::ToProgram(std::ostream& out)
+{
+	if (glsl_rules_ & GSR_VersionDecl)
+	{
+		out << "#version " << GLSLVersionStr[glsl_version_] << "\n";
+	}
+	if ((ST_GS == shader_type_) && !(glsl_rules_ & GSR_CoreGS))
+	{
+		out << "#extension GL_EXT_geometry_shader4 : enable\n";
+	}
+	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTShaderTextureLod))
+	{
+		out << "#extension GL_EXT_shader_texture_lod : enable\n";
+	}
+	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTDrawBuffers))
+	{
+		out << "#extension GL_EXT_draw_buffers : enable\n";
+	}
+	if (glsl_rules_ & GSR_OESStandardDerivatives)
+	{
+		out << "#extension GL_OES_standard_derivatives : enable\n";
+	}
+	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTFragDepth))
+	{
+		out << "#extension GL_EXT_frag_depth : enable\n";
+	}
+	if (((ST_HS == shader_type_) || (ST_DS == shader_type_)) && (glsl_rules_ & GSR_EXTTessellationShader))
+	{
+		out << "#extension GL_EXT_tessellation_shader : enable\n";
+	}
+	if (enable_double_ && !(glsl_rules_ & GSR_DoubleType) && (glsl_version_ >= GSV_150) && (glsl_version_ < GSV_100_ES))
+	{
+		out << "#extension GL_ARB_gpu_shader_fp64 : enable\n";
+	}
+	if ((glsl_rules_ & GSR_BindlessTexture) && !textures_.empty())
+	{
+		out << "#extension GL_ARB_bindless_texture : require\n";
+	}
+	if (!uniform_locations_.empty() && (glsl_version_ < GSV_430))
+	{
+		out << "#extension GL_ARB_explicit_uniform_location : require\n";
+	}
+	out << "\n";
 
-	case SO_DCL_TEMPS:
-	case SO_DCL_INDEXABLE_TEMP:
-		// Moved to GLSLGen::ToTemps();
-		break;
+	if (glsl_rules_ & GSR_Precision)
+	{
+		out << "precision highp float;" << std::endl;
+		out << "precision highp int;" << std::endl << std::endl;
+	}
 
-	case SO_DCL_INPUT_PS:
-		// Moved to GLSLGen::ToInterShaderInputRecords();
-		break;
+	if ((ST_PS == shader_type_) && early_depth_stencil_ && (glsl_rules_ & GSR_EarlyFragmentTests))
+	{
+		out << "layout(early_fragment_tests) in;\n\n";
+	}
 
-	case SO_DCL_RESOURCE:
-		{
-			for (auto const & tex : textures_)
-			{
-				if (tex.tex_index == dcl.op->indices[0].disp)
-				{
-					for (auto const & sampler : tex.samplers)
-					{
-						out << "uniform ";
-						if (glsl_rules_ & GSR_PrecisionOnSampler)
-						{
-							out << "highp ";
-						}
-						switch (dcl.rrt.x)
-						{
-						case SRRT_UNORM:
-						case SRRT_SNORM:
-						case SRRT_FLOAT:
-							break;
+	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTShaderTextureLod))
+	{
+		out << "#ifdef GL_EXT_shader_texture_lod\n";
+		out << "#define texture2DLod texture2DLodEXT\n";
+		out << "#define texture2DProjLod texture2DProjLodEXT\n";
+		out << "#define textureCubeLod textureCubeLodEXT\n";
+		out << "#define texture2DGrad texture2DGradEXT\n";
+		out << "#define texture2DProjGrad texture2DProjGradEXT\n";
+		out << "#define textureCubeGrad textureCubeGradEXT\n";
+		out << "#endif\n";
+	}
 
-						case SRRT_SINT:
-							out << "i";
-							break;
+	if ((ST_PS == shader_type_) && (glsl_rules_ & GSR_EXTFragDepth))
+	{
+		out << "#ifdef GL_EXT_frag_depth\n";
+		out << "#define gl_FragDepth gl_FragDepthEXT\n";
+		out << "#endif\n";
+	}
 
-						case SRRT_UINT:
-							out << "u";
-							break;
+	if ((ST_GS == shader_type_) && (glsl_rules_ & GSR_CoreGS))
+	{
+		out << "layout(";
+		switch (program_->gs_input_primitive)
+		{
+		case SP_Point:
+			out << "points";
+			break;
 
-						default:
-							assert_msg(false, "Unsupported resource return type");
-							break;
-						}
-						out << "sampler";
-						switch (dcl.dcl_resource.target)
-						{
-						case SRD_BUFFER:
-							out << "Buffer";
-							break;
-
-						case SRD_TEXTURE1D:
-							out << "1D";
-							break;
+		case SP_Line:
+			out << "lines";
+			break;
 
-						case SRD_TEXTURE2D:
-							out << "2D";
-							break;
+		case SP_Triangle:
+			out << "triangles";
+			break;
 
-						case SRD_TEXTURE2DMS:
-							out << "2DMS";
-							break;
+		case SP_LineAdj:
+			out << "lines_adjacency";
+			break;
 
-						case SRD_TEXTURE3D:
-							out << "3D";
-							break;
+		case SP_TriangleAdj:
+			out << "triangles_adjacency";
+			break;
 
-						case SRD_TEXTURECUBE:
-							out << "Cube";
-							break;
+		default:
+			assert_msg(false, "Wrong input primitive name.");
+			break;
+		}
+		if (program_->gs_instance_count > 0)
+		{
+			out << ", invocations = " << program_->gs_instance_count;
+		}
+		out << ") in;\n";
 
-						case SRD_TEXTURE1DARRAY:
-							out << "1DArray";
-							break;
+		out << "layout(";
+		switch (program_->gs_output_topology[0])
+		{
+		case SPT_PointList:
+			out << "points";
+			break;
 
-						case SRD_TEXTURE2DARRAY:
-							out << "2DArray";
-							break;
+		case SPT_LineStrip:
+			out << "line_strip";
+			break;
 
-						case SRD_TEXTURE2DMSARRAY:
-							out << "2DMSArray";
-							break;
+		case SPT_TriangleStrip:
+			out << "triangle_strip";
+			break;
 
-						case SRD_TEXTURECUBEARRAY:
-							out << "CubeArray";
-							break;
+		default:
+			assert_msg(false, "Wrong output primitive topology name.");
+			break;
+		}
+		out << ", max_vertices = " << program_->max_gs_output_vertex << ") out;\n\n";
+	}
 
-						default:
-							assert_msg(false, "Unexpected resource target type");
-							break;
-						}
-						if (!tex.samplers.empty() && sampler.shadow)
-						{
-							out << "Shadow ";
-						}
-						else
-						{
-							out << " ";
-						}
-						this->ToOperands(out, *dcl.op, sit, true, false, false, true, true);
-						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(sampler.index));
-						out << "_" << desc.name;
-						out << ";\n";
-					}
-					if (tex.samplers.empty())
-					{
-						out << "uniform ";
-						if (glsl_rules_ & GSR_PrecisionOnSampler)
-						{
-							out << "highp ";
-						}
-						switch (dcl.rrt.x)
-						{
-						case SRRT_UNORM:
-						case SRRT_SNORM:
-						case SRRT_FLOAT:
-							break;
+	if (ST_HS == shader_type_)
+	{
+		out << "layout(vertices = " << program_->hs_output_control_point_count << ") out;\n\n";
+	}
 
-						case SRRT_SINT:
-							out << "i";
-							break;
+	if (ST_DS == shader_type_)
+	{
+		out << "layout(";
+		switch (program_->ds_tessellator_domain)
+		{
+		case SDT_Isoline:
+			out << "isolines";
+			break;
+		case SDT_Triangle:
+			out << "triangles";
+			break;
+		case SDT_Quad:
+			out << "quads";
+			break;
+		default:
+			assert(false);
+			break;
+		}
+		out << ", ";
+		switch (ds_partitioning_)
+		{
+		case STP_Integer:
+		case STP_Pow2:
+			out << "equal_spacing";
+			break;
+		case STP_Fractional_Odd:
+			out << "fractional_odd_spacing";
+			break;
+		case STP_Fractional_Even:
+			out << "fractional_even_spacing";
+			break;
+		default:
+			assert(false);
+			break;
+		}
+		switch (ds_output_primitive_)
+		{
+		case STOP_Point:
+		case STOP_Line:
+			break;
+		case STOP_Triangle_CW:
+			out << ", ccw";
+			break;
+		case STOP_Triangle_CCW:
+			out << ", cw";
+			break;
+		default:
+			assert(false);
+			break;
+		}
+		out << ") in;\n\n";
+	}
 
-						case SRRT_UINT:
-							out << "u";
-							break;
+	if (ST_CS == shader_type_)
+	{
+		out << "layout(local_size_x = " << program_->cs_thread_group_size[0]
+		<<", local_size_y = " << program_->cs_thread_group_size[1]
+		<<", local_size_z = " << program_->cs_thread_group_size[2]
+		<<") in;\n\n";
+	}
 
-						default:
-							assert_msg(false, "Unsupported resource return type");
-							break;
-						}
-						out << "sampler";
-						switch (dcl.dcl_resource.target)
-						{
-						case SRD_BUFFER:
-							out << "Buffer ";
-							break;
+	this->ToDeclarations(out);
 
-						case SRD_TEXTURE1D:
-							out << "1D ";
-							break;
+	out << "\nvoid main()" << "\n" << "{" << "\n";
 
-						case SRD_TEXTURE2D:
-							out << "2D ";
-							break;
+	this->ToDeclInterShaderInputRegisters(out);
+	this->ToCopyToInterShaderInputRegisters(out);
+	this->ToDeclInterShaderOutputRegisters(out);
 
-						case SRD_TEXTURE2DMS:
-							out << "2DMS ";
-							break;
+	for (auto const & dcl : temp_dcls_)
+	{
+		this->ToTemps(out, dcl);
+	}
+	for (auto const & dcl : program_->dcls)
+	{
+		if (SO_IMMEDIATE_CONSTANT_BUFFER == dcl->opcode)
+		{
+			this->ToImmConstBuffer(out, *dcl);
+		}
+	}
+	out << "ivec4 iTempX[2];\n";
+	if (glsl_rules_ & GSR_UIntType)
+	{
+		out << "u";
+	}
+	else
+	{
+		out << "i";
+	}
+	out << "vec4 uTempX[2];\n";
+	out << "\n";
+	if (ST_HS != shader_type_)
+	{
+		for (size_t i = 0; i < program_->insns.size(); ++i)
+		{
+			this->ToInstruction(out, *program_->insns[i]);
+			out << "\n";
+			if (i == end_of_program_)
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		this->ToHSControlPointPhase(out);
+		this->ToHSForkPhases(out);
+		this->ToHSJoinPhases(out);
+		if (hs_fork_invocations_)
+		{
+			// Every invocation writes its own copy of the patch constant records
+			out << "barrier();\n";
+			this->ToCopyToInterShaderPatchConstantRecords(out);
+		}
+	}
+	out << "}" << "\n";
+}
 
-						case SRD_TEXTURE3D:
-							out << "3D ";
-							break;
+void GLSLGen::ToDeclarations(std::ostream& out)
+{
+	declared_structs_.clear();
 
-						case SRD_TEXTURECUBE:
-							out << "Cube ";
-							break;
+	this->ToDclInterShaderInputRecords(out);
+	this->ToDclInterShaderOutputRecords(out);
+	if ((ST_DS == shader_type_) || (ST_HS == shader_type_))
+	{
+		this->ToDclInterShaderPatchConstantRecords(out);
+		if (hs_fork_invocations_)
+		{
+			this->ToDclInterShaderPatchConstantRegisters(out);
+			out << "\n";
+		}
+	}
+	for (auto const & dcl : program_->dcls)
+	{
+		this->ToDeclaration(out, *dcl);
+	}
+	if (glsl_rules_ & GSR_BindlessTexture)
+	{
+		this->ToDclBindlessTextures(out);
+	}
+}
 
-						case SRD_TEXTURE1DARRAY:
-							out << "1DArray ";
-							break;
+void GLSLGen::ToDclInterShaderInputRecords(std::ostream& out)
+{
+	for (size_t i = 0; i < program_->params_in.size(); ++ i)
+	{
+		if (SN_UNDEFINED == program_->params_in[i].system_value_type)
+		{
+			if ((shader_type_ != ST_VS) && (shader_type_ != ST_GS) && (shader_type_ != ST_HS) && (shader_type_ != ST_DS)
+				&& !strcmp("POSITION", program_->params_in[i].semantic_name))
+			{
+				continue;
+			}
+			if (FindPackedVarying(input_layout_, program_->params_in[i]))
+			{
+				continue;
+			}
 
-						case SRD_TEXTURE2DARRAY:
-							out << "2DArray ";
-							break;
+			ShaderRegisterComponentType type = program_->params_in[i].component_type;
+			uint32_t register_index = program_->params_in[i].register_index;
 
-						case SRD_TEXTURE2DMSARRAY:
-							out << "2DMSArray ";
-							break;
+			ShaderInterpolationMode interpolation = SIM_Undefined;
+			if (register_index < input_registers_.size())
+			{
+				interpolation = input_registers_[register_index].interpolation;
+			}
 
-						case SRD_TEXTURECUBEARRAY:
-							out << "CubeArray ";
-							break;
+			if ((glsl_rules_ & GSR_PSInterpolation) && (ST_PS == shader_type_))
+			{
+				ToInterpolationQualifier(out, interpolation);
+			}
 
-						default:
-							assert_msg(false, "Unexpected resource target type");
-							break;
-						}
-						this->ToOperands(out, *dcl.op, sit, true, false, false, true, true);
-						out << ";\n";
-					}
-					break;
+			if (ST_VS == shader_type_)
+			{
+				if (glsl_rules_ & GSR_ExplicitInputLayout)
+				{
+					// layout(location=N)
+					out << "layout(location=" << i << ") ";
 				}
 			}
-		}
-		break;
 
-	case SO_DCL_RESOURCE_STRUCTURED:
-		{
-			out << "layout(std430) buffer ";
-			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_STRUCTURED,
-				static_cast<uint32_t>(dcl.op->indices[0].disp));
-			out << ShaderOperandTypeShortName(dcl.op->type) << dcl.op->indices[0].disp << " {\n";
-			DXBCConstantBuffer const & cbuffer = this->GetConstantBuffer(SCBT_RESOURCE_BIND_INFO, desc.name);
-			assert_msg(cbuffer.vars[0].has_type_desc, "cbuffer vars must have type desc.");
-			switch (cbuffer.vars[0].type_desc.var_class)
+			// No layout qualifier here see dcl_output
+			if (glsl_rules_ & GSR_InOutPrefix)
 			{
-			case SVC_VECTOR:
-				{
-					std::string name;
-					switch (cbuffer.vars[0].type_desc.type)
-					{
-					case SVT_INT:
-						name = "ivec";
-						break;
-
-					case SVT_UINT:
-						name = "uvec";
-						break;
-
-					case SVT_FLOAT:
-						name = "vec";
-						break;
-
-					default:
-						name = cbuffer.vars[0].type_desc.name;
-						break;
-					}
-					out << name << cbuffer.vars[0].type_desc.columns;
-				}
-				break;
-
-			case SVC_SCALAR:
-				out << cbuffer.vars[0].type_desc.name;
-				break;
-
-			default:
-				assert(false);
-				break;
+				out << "in ";
 			}
-			out << " " << desc.name <<"[];\n}\n";
-		}
-		break;
-
-	case SO_DCL_GLOBAL_FLAGS:
-		// TODO: ignore it for now
-		break;
-
-	case SO_DCL_SAMPLER:
-		// TODO: ignore it for now
-		break;
-
-	case SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED:
-		{
-			out << "layout(std430) buffer ";
-			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_UAV_RWSTRUCTURED,
-				static_cast<uint32_t>(dcl.op->indices[0].disp));
-			out << ShaderOperandTypeShortName(dcl.op->type) << dcl.op->indices[0].disp << " {\n";
-			DXBCConstantBuffer const & cbuffer = this->GetConstantBuffer(SCBT_RESOURCE_BIND_INFO, desc.name);
-			assert_msg(cbuffer.vars[0].has_type_desc, "cbuffer vars must have type desc.");
-			switch (cbuffer.vars[0].type_desc.var_class)
+			else
 			{
-			case SVC_VECTOR:
-				out << cbuffer.vars[0].type_desc.name << cbuffer.vars[0].type_desc.columns;
-				break;
-
-			case SVC_SCALAR:
-				out << cbuffer.vars[0].type_desc.name;
-				break;
-
-			default:
-				assert(false);
-				break;
+				if (ST_VS == shader_type_)
+				{
+					out << "attribute ";
+				}
+				else
+				{
+					out << "varying ";
+				}
 			}
-			out << " " <<desc.name <<"[];\n}\n";
-		}
-		break;
-
-	case SO_DCL_UNORDERED_ACCESS_VIEW_TYPED:
-		{
-			out << "layout(binding=" << dcl.op->indices[0].disp << ") uniform ";
-			switch (dcl.rrt.x)
+			this->ToMinPrecision(out, program_->params_in[i].min_precision);
+			switch (type)
 			{
-			case SRRT_UNORM:
-			case SRRT_SNORM:
-			case SRRT_FLOAT:
+			case SRCT_UINT32:
+				if (glsl_rules_ & GSR_UIntType)
+				{
+					out << "u";
+				}
+				else
+				{
+					out << "i";
+				}
 				break;
 
-			case SRRT_SINT:
+			case SRCT_SINT32:
 				out << "i";
 				break;
 
-			case SRRT_UINT:
-				out << "u";
+			case SRCT_FLOAT32:
 				break;
 
 			default:
-				assert_msg(false, "Unsupported resource return type");
+				assert(false);
 				break;
 			}
-			out << "image";
-			switch (dcl.dcl_resource.target)
+			out << "vec4 ";
+			if (shader_type_ != ST_VS)
 			{
-			case SRD_TEXTURE1D:
-				out << "1D";
-				break;
-
-			case SRD_TEXTURE2D:
-				out << "2D";
-				break;
-
-			case SRD_TEXTURE3D:
-				out << "3D";
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				out << "1DArray";
-				break;
-
-			case SRD_TEXTURE2DARRAY:
-				out << "2DArray";
-				break;
-
-			case SRD_BUFFER:
-				out << "Buffer";
-				break;
-
-			default:
-				assert(false);
-				break;
+				out << "v_";
 			}
-			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_UAV_RWTYPED, static_cast<uint32_t>(dcl.op->indices[0].disp));
-			out << " " << desc.name << ";\n";
-		}
-		break;
-
-	case SO_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED:
-		{
-			out << "shared ";
-			assert_msg(dcl.structured.stride <= 16, "thread group shared memory size can't exceed 16 bytes");
-			size_t elem_num=dcl.structured.stride / 4;
-			if (1 == elem_num)
+			out << program_->params_in[i].semantic_name << program_->params_in[i].semantic_index;
+			if (ST_GS == shader_type_)
 			{
-				out << "float";
+				out << "In" << '[' << PrimitiveNumVertices(program_->gs_input_primitive) << ']';
 			}
-			else if (elem_num > 1)
+			else if (ST_HS == shader_type_)
 			{
-				out << "vec" << elem_num;
+				out << "[gl_MaxPatchVertices]";
 			}
-			out << " g" << dcl.op->indices[0].disp;
-			out << "[" << dcl.structured.count << "]" << ";\n";
+			else if (ST_DS == shader_type_)
+			{
+				out << "In[gl_MaxPatchVertices]";
+			}
+			out << ";\n";
 		}
-		break;
+	}
 
-	case SO_DCL_STREAM:
-	case SO_DCL_GS_INPUT_PRIMITIVE:
-	case SO_DCL_GS_OUTPUT_PRIMITIVE_TOPOLOGY:
-	case SO_DCL_MAX_OUTPUT_VERTEX_COUNT:
-	case SO_DCL_GS_INSTANCE_COUNT:
-	case SO_DCL_OUTPUT_CONTROL_POINT_COUNT:
-		break;
+	if (!program_->params_in.empty())
+	{
+		out << "\n";
+	}
 
-	default:
-		//assert_msg(false, "Unhandled declarations");
-		break;
+	if (input_layout_)
+	{
+		this->ToDclVaryingSlots(out, *input_layout_, false);
 	}
 }
 
-void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) const
+void GLSLGen::ToDclInterShaderOutputRecords(std::ostream& out)
 {
-	int selector[4] = { 0 };
-	ShaderImmType oit = GetOpInType(insn.opcode);
-	ShaderImmType oot = GetOpOutType(insn.opcode);
-	uint32_t num_outputs = std::min(insn.num_ops, GetNumOutputs(insn.opcode));
-	int num_comps = 0;
-	switch (insn.opcode)
+	for (size_t i = 0; i < program_->params_out.size(); ++ i)
 	{
-		//-----------------------------------------------------------------------------------------
-		//common single-precision float instructions
-		//-----------------------------------------------------------------------------------------
-	case SO_MOV:
-		if (SOT_OUTPUT == insn.ops[0]->type)
-		{
-			oot = this->OperandAsType(*insn.ops[0], oit);
-			oit = oot;
-		}
-		else
-		{
-			oot = this->OperandAsType(*insn.ops[1], oit);
-			oit = oot;
-		}
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ";
-		switch (oot)
+		if ((SN_UNDEFINED == program_->params_out[i].system_value_type)
+			&& (strcmp("SV_Depth", program_->params_out[i].semantic_name) != 0)
+			&& !FindPackedVarying(output_layout_, program_->params_out[i]))
 		{
-		case SIT_UInt:
-			if (SOT_TEMP == insn.ops[0]->type)
+			if (ST_PS == shader_type_)
 			{
-				out << "i";
+				if (glsl_rules_ & GSR_ExplicitPSOutputLayout)
+				{
+					out << "layout(location=" << i << ") ";
+				}
 			}
-			else
+			
+			bool output_var = false;
+			if (glsl_rules_ & GSR_InOutPrefix)
 			{
-				if (glsl_rules_ & GSR_UIntType)
+				if ((shader_type_ != ST_PS) && (glsl_rules_ & GSR_PSInterpolation))
 				{
-					out << "u";
+					out << "smooth ";
 				}
-				else
+
+				out << "out ";
+				output_var = true;
+			}
+			else
+			{
+				if (shader_type_ != ST_PS)
 				{
-					out << "i";
+					out << "varying ";
+					if (shader_type_ != ST_VS)
+					{
+						out << "out ";
+					}
+					output_var = true;
 				}
 			}
-			break;
-
-		case SIT_Int:
-			out << "i";
-			break;
 
-		case SIT_Double:
-			out << "d";
-			break;
+			if (output_var)
+			{
+				this->ToMinPrecision(out, program_->params_out[i].min_precision);
 
-		case SIT_Float:
-			break;
+				int num_comps = 4;
+				if (((ST_VS == shader_type_) && !has_gs_ && !has_ps_) || ((ST_DS == shader_type_) && !has_gs_ && !has_ps_)
+					|| ((ST_GS == shader_type_) && !has_ps_)
+					|| (ST_PS == shader_type_))
+				{
+					num_comps = bitcount32(program_->params_out[i].mask);
+				}
 
-		default:
-			assert(false);
-			break;
-		}
-		out << "vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+				if (1 == num_comps)
+				{
+					switch (OutputComponentType(program_->params_out[i]))
+					{
+					case SRCT_UINT32:
+						if (glsl_rules_ & GSR_UIntType)
+						{
+							out << "u";
+						}
+						out << "int";
+						break;
 
-	case SO_MUL:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " * ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+					case SRCT_SINT32:
+						out << "int";
+						break;
 
-	case SO_MAD:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " * ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << " + ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+					case SRCT_FLOAT32:
+						out << "float";
+						break;
 
-	case SO_IMAD:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " * ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << " + ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+					default:
+						assert(false);
+						break;
+					}
+				}
+				else
+				{
+					switch (OutputComponentType(program_->params_out[i]))
+					{
+					case SRCT_UINT32:
+						if (glsl_rules_ & GSR_UIntType)
+						{
+							out << "u";
+						}
+						else
+						{
+							out << "i";
+						}
+						break;
 
-	case SO_UMAD:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ";
-		if (glsl_rules_ & GSR_UIntType)
+					case SRCT_SINT32:
+						out << "i";
+						break;
+
+					case SRCT_FLOAT32:
+						break;
+
+					default:
+						assert(false);
+						break;
+					}
+					out << "vec" << num_comps;
+				}
+
+				out << " v_" << program_->params_out[i].semantic_name
+					<< program_->params_out[i].semantic_index;
+				if ((ST_VS == shader_type_) && has_gs_)
+				{
+					out << "In";
+				}
+				if (ST_HS == shader_type_)
+				{
+					out << "In[" << program_->hs_output_control_point_count << "]";
+				}
+				if (ST_DS == shader_type_ && has_gs_)
+				{
+					out << "In";
+				}
+				out << ";\n";
+			}
+		}
+	}
+
+	if (!program_->params_out.empty())
+	{
+		out << "\n";
+	}
+
+	if (output_layout_)
+	{
+		this->ToDclVaryingSlots(out, *output_layout_, true);
+	}
+}
+
+void GLSLGen::ToDclVaryingSlots(std::ostream& out, VaryingLayout const & layout, bool output) const
+{
+	for (uint32_t i = 0; i < layout.slots.size(); ++ i)
+	{
+		VaryingSlot const & slot = layout.slots[i];
+		if (glsl_rules_ & GSR_ExplicitVaryingLocation)
 		{
-			out << "u";
+			out << "layout(location=" << i << ") ";
+		}
+		if (glsl_rules_ & GSR_InOutPrefix)
+		{
+			// Both sides get the consumer's qualifier, pre-4.30 GLSL doesn't link mismatched ones
+			if (glsl_rules_ & GSR_PSInterpolation)
+			{
+				ToInterpolationQualifier(out, slot.interpolation);
+			}
+			out << (output ? "out " : "in ");
 		}
 		else
 		{
-			out << "i";
+			out << "varying ";
 		}
-		out << "vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " * ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << " + ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+		this->ToMinPrecision(out, slot.min_precision);
+		switch (slot.component_type)
+		{
+		case SRCT_UINT32:
+			if (glsl_rules_ & GSR_UIntType)
+			{
+				out << "u";
+			}
+			else
+			{
+				out << "i";
+			}
+			break;
 
-	case SO_DP4:
-		// Notice: dot()only support float vec2/3/4 type. In glsl, ivec and uvec are converted to vec implicitly.
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(dot(vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "), vec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+		case SRCT_SINT32:
+			out << "i";
+			break;
 
-	case SO_DP3:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(dot(vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ").xyz, vec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ").xyz))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+		default:
+			break;
+		}
+		out << "vec4 v_SLOT" << i << ";\n";
+	}
 
-	case SO_DP2:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(dot(vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ").xy, vec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ").xy))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+	if (!layout.slots.empty())
+	{
+		out << "\n";
+	}
+}
 
-	case SO_EXP:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(exp2(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+void GLSLGen::ToDeclInterShaderInputRegisters(std::ostream& out) const
+{
+	std::vector<RegisterDesc> input_registers;
+	for (auto const & sig_desc : program_->params_in)
+	{
+		if (sig_desc.read_write_mask != 0)
+		{
+			uint32_t register_index = sig_desc.register_index;
+			if ((register_index != 0xFFFFFFFF) && !HasVarying(input_registers_, register_index))
+			{
+				ShaderRegisterComponentType type = sig_desc.component_type;
+				bool found = false;
+				for (auto const & reg : input_registers)
+				{
+					if (reg.index == register_index)
+					{
+						found = true;
+						break;
+					}
+				}
 
-	case SO_SQRT:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(sqrt(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+				if (!found)
+				{
+					RegisterDesc desc;
+					desc.index = register_index;
+					if ((SN_VERTEX_ID == sig_desc.system_value_type)
+						|| (SN_PRIMITIVE_ID == sig_desc.system_value_type)
+						|| (SN_INSTANCE_ID == sig_desc.system_value_type))
+					{
+						desc.type = SRCT_SINT32;
+					}
+					else
+					{
+						desc.type = type;
+					}
+					desc.interpolation = SIM_Undefined;
+					desc.is_depth = false;
+					input_registers.push_back(desc);
+				}
+			}
+		}
+	}
 
-	case SO_RSQ:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(inversesqrt(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+	for (auto const & reg : input_registers)
+	{
+		switch (reg.type)
+		{
+		case SRCT_UINT32:
+			if (glsl_rules_ & GSR_UIntType)
+			{
+				out << "u";
+			}
+			else
+			{
+				out << "i";
+			}
+			break;
 
-	case SO_DIV:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " / ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
-
-	case SO_ADD:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " + ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
-
-	case SO_IADD:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << " + ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
-
-	case SO_FRC:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(fract(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
-
-	case SO_LOG:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(log2(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+		case SRCT_SINT32:
+			out << "i";
+			break;
 
-	case SO_EQ:
-		// Need more process to the return value of equal(): true->0xFFFFFFFF, false->0x00000000
-		// e.g.
-		// r0.xy=equal();
-		// r0.x=r0.x?-1:0;
-		// r0.y=r0.y?-1:0;
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (float(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") == float(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
-		}
-		else
-		{
-			out << " = (ivec4(equal(vec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
+		case SRCT_FLOAT32:
+			break;
 
-	case SO_IEQ:
-		// Need more process to the return value of equal(): true->0xFFFFFFFF, false->0x00000000
-		// e.g.
-		// r0.xy=equal();
-		// r0.x=r0.x?-1:0;
-		// r0.y=r0.y?-1:0;
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (int(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") == int(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
+		default:
+			assert(false);
+			break;
 		}
-		else
-		{
-			out << " = (ivec4(equal(ivec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}		
-		break;
 
-	case SO_NE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (float(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") != float(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
-		}
-		else
+		out << "vec4 i_REGISTER" << reg.index;
+		if ((ST_GS == shader_type_) || (ST_HS == shader_type_) || (ST_DS == shader_type_))
 		{
-			out << " = (ivec4(notEqual(vec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			int n = 0;
+			switch (shader_type_)
+			{
+			case ST_GS:
+				n = PrimitiveNumVertices(program_->gs_input_primitive);
+				break;
+			case ST_HS:
+				n = program_->hs_input_control_point_count;
+				break;
+			case ST_DS:
+			default:
+				n = DomainNumVertices(program_->ds_tessellator_domain);
+				break;
+			}
+			out << '[' << n << ']';
 		}
-		break;
+		out << ";\n";
+	}
+}
 
-	case SO_INE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (int(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") != int(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
-		}
-		else
+void GLSLGen::ToCopyToInterShaderInputRegisters(std::ostream& out) const
+{
+	uint32_t num_vertices = 1;
+	if (ST_GS == shader_type_)
+	{
+		num_vertices = PrimitiveNumVertices(program_->gs_input_primitive);
+	}
+	if ((ST_HS == shader_type_) || (ST_DS == shader_type_))
+	{
+		out<< "for (int i = 0; i < gl_PatchVerticesIn; ++ i)\n{\n";
+	}
+	for (auto const & sig_desc : program_->params_in)
+	{
+		if ((sig_desc.read_write_mask != 0) && (sig_desc.register_index != 0xFFFFFFFF)
+			&& !HasVarying(input_registers_, sig_desc.register_index))
 		{
-			out << " = (ivec4(notEqual(ivec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
+			for (uint32_t v = 0; v < num_vertices; ++ v)
+			{
+				out << "i_REGISTER" << sig_desc.register_index;
+				if (ST_GS == shader_type_)
+				{
+					out << '[' << v << ']';
+				}
+				if ((ST_HS == shader_type_) || (ST_DS == shader_type_))
+				{
+					out << "[i]";
+				}
+				uint32_t mask = sig_desc.mask;
+				out << '.';
+				this->ToComponentSelector(out, this->ComponentSelectorFromMask(mask, 4));
 
-	case SO_LT:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (float(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") < float(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
-		}
-		else
-		{
-			out << " = (ivec4(lessThan(vec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
+				out << " = ";
 
-	case SO_ILT:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (int(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") < int(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
-		}
-		else
-		{
-			out << " = (ivec4(lessThan(ivec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
+				bool need_comps = true;
+				if (ST_GS == shader_type_)
+				{
+					switch (sig_desc.system_value_type)
+					{
+					case SN_POSITION:
+						if (glsl_rules_ & GSR_CoreGS)
+						{
+							out << "gl_in" << '[' << v << "].gl_Position";
+						}
+						else
+						{
+							out << "gl_PositionIn";
+						}
+						need_comps = true;
+						break;
 
-	case SO_ULT:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (";
-			if (glsl_rules_ & GSR_UIntType)
+					case SN_CLIP_DISTANCE:
+						if (glsl_rules_ & GSR_CoreGS)
+						{
+							out << "gl_in" << '[' << v << "].gl_ClipDistance[" << sig_desc.semantic_index << "]";
+						}
+						else
+						{
+							out << "gl_ClipDistanceIn[" << sig_desc.semantic_index << "]";
+						}
+						need_comps = false;
+						break;
+
+					case SN_PRIMITIVE_ID:
+						out << "gl_PrimitiveIDIn";
+						need_comps = false;
+						break;
+
+					case SN_UNDEFINED:
+						out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "In"
+							<< '[' << v << ']';
+						need_comps = true;
+						break;
+
+					default:
+						break;
+					}
+				}
+				else if (ST_HS == shader_type_)
+				{
+					switch (sig_desc.system_value_type)
+					{
+					case SN_POSITION:
+						out << "gl_in[i].gl_Position";
+						need_comps = true;
+						break;
+
+					case SN_CLIP_DISTANCE:
+						out << "gl_in[i].gl_ClipDistance[" << sig_desc.semantic_index << "]";
+						need_comps = false;
+						break;
+
+					case SN_PRIMITIVE_ID:
+						out << "gl_PrimitiveID";
+						need_comps = false;
+						break;
+
+					case SN_UNDEFINED:
+						out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "[i]";
+						need_comps = true;
+						break;
+
+					default:
+						break;
+					}
+				}
+				else if (ST_DS == shader_type_)
+				{
+					switch (sig_desc.system_value_type)
+					{
+					case SN_POSITION:
+						out << "gl_in[i].gl_Position";
+						need_comps = true;
+						break;
+
+					case SN_CLIP_DISTANCE:
+						out << "gl_in[i].gl_ClipDistance[" << sig_desc.semantic_index << "]";
+						need_comps = false;
+						break;
+
+					case SN_PRIMITIVE_ID:
+						out << "gl_PrimitiveID";
+						need_comps = false;
+						break;
+
+					case SN_UNDEFINED:
+						out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "In[i]";
+						need_comps = true;
+						break;
+
+					default:
+						break;
+					}
+				}
+				else
+				{
+					switch (sig_desc.system_value_type)
+					{
+					case SN_POSITION:
+						out << "gl_Position";
+						need_comps = true;
+						break;
+
+					// TODO: Processing SN_CLIP_DISTANCE and SN_CULL_DISTANCE
+
+					case SN_RENDER_TARGET_ARRAY_INDEX:
+						out << "gl_Layer";
+						need_comps = false;
+						break;
+
+					case SN_VIEWPORT_ARRAY_INDEX:
+						out << "gl_ViewportIndex";
+						need_comps = false;
+						break;
+
+					case SN_VERTEX_ID:
+						out << "gl_VertexID";
+						need_comps = false;
+						break;
+
+					case SN_PRIMITIVE_ID:
+						out << "gl_PrimitiveID";
+						need_comps = false;
+						break;
+
+					case SN_INSTANCE_ID:
+						out << "gl_InstanceID";
+						need_comps = false;
+						break;
+
+					case SN_IS_FRONT_FACE:
+						if (glsl_rules_ & GSR_UIntType)
+						{
+							out << "uint";
+						}
+						out << "(gl_FrontFacing ? 1 : 0)";
+						need_comps = false;
+						break;
+
+					case SN_SAMPLE_INDEX:
+						if (glsl_rules_ & GSR_ExplicitMultiSample)
+						{
+							out << "gl_SampleID";
+						}
+						else
+						{
+							out << "0";
+						}
+						need_comps = false;
+						break;
+
+					case SN_UNDEFINED:
+						if (PackedVarying const * packed = FindPackedVarying(input_layout_, sig_desc))
+						{
+							out << "v_SLOT" << packed->location << '.';
+							this->ToComponentSelector(out, this->ComponentSelectorFromMask(mask >> packed->register_component, 4),
+								packed->component);
+							need_comps = false;
+							break;
+						}
+						if (shader_type_ != ST_VS)
+						{
+							out << "v_";
+						}
+						out << sig_desc.semantic_name << sig_desc.semantic_index;
+						need_comps = true;
+						break;
+
+					default:
+						break;
+					}
+				}
+				if (need_comps)
+				{
+					out << ".";
+					this->ToComponentSelector(out, this->ComponentSelectorFromCount(bitcount32(mask)));
+				}
+				out << ";\n";
+			}
+		}
+	}
+	if ((ST_HS == shader_type_) || (ST_DS == shader_type_))
+	{
+		out << "}\n";
+	}
+
+	if (!program_->params_in.empty())
+	{
+		out << "\n";
+	}
+}
+
+void GLSLGen::ToDeclInterShaderOutputRegisters(std::ostream& out) const
+{
+	std::vector<RegisterDesc> output_dcl_record;
+
+	for (auto const & sig_desc : program_->params_out)
+	{
+		if ((sig_desc.read_write_mask != 0xF) && !HasVarying(output_registers_, sig_desc.register_index))
+		{
+			ShaderRegisterComponentType type = OutputComponentType(sig_desc);
+			uint32_t register_index = sig_desc.register_index;
+			bool found = false;
+			for (auto const & dcl : output_dcl_record)
 			{
-				out << "uint(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ") < uint(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				if (dcl.index == register_index)
+				{
+					found = true;
+					break;
+				}
 			}
-			else
+
+			if (!found)
 			{
-				out << "int(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ") < int(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				RegisterDesc desc;
+				desc.index = register_index;
+				desc.type = type;
+				desc.interpolation = SIM_Undefined;
+				desc.is_depth = (0 == strcmp("SV_Depth", sig_desc.semantic_name));
+				output_dcl_record.push_back(desc);
 			}
-			out << ")) ? -1 : 0;";
 		}
-		else
+	}
+
+	for (auto const & dcl : output_dcl_record)
+	{
+		switch (dcl.type)
 		{
-			out << " = ivec4(";
+		case SRCT_UINT32:
 			if (glsl_rules_ & GSR_UIntType)
 			{
-				out << "uvec4(lessThan(uvec4(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << "), uvec4(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				out << "u";
 			}
 			else
 			{
-				out << "ivec4(lessThan(ivec4(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << "), ivec4(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				out << "i";
 			}
-			out << "))) * -1)";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			break;
+
+		case SRCT_SINT32:
+			out << "i";
+			break;
+
+		case SRCT_FLOAT32:
+			break;
+
+		default:
+			assert(false);
+			break;
 		}
-		break;
 
-	case SO_GE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+		out << "vec4 o_REGISTER";
+		if (dcl.is_depth)
 		{
-			out << " = (float(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") >= float(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
+			out << "Depth";
 		}
 		else
 		{
-			out << " = (ivec4(greaterThanEqual(vec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			out << dcl.index;
 		}
-		break;
+		out << ";\n";
+	}
 
-	case SO_IGE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
-		{
-			out << " = (int(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") >= int(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")) ? -1 : 0;";
-		}
-		else
-		{
-			out << " = (ivec4(greaterThanEqual(ivec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))) * ivec4(-1))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
+	if (!output_dcl_record.empty())
+	{
+		out << "\n";
+	}
+}
 
-	case SO_UGE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+void GLSLGen::ToCopyToInterShaderOutputRecords(std::ostream& out) const
+{
+	for (auto const & sig_desc : program_->params_out)
+	{
+		if ((sig_desc.read_write_mask != 0xF) && !HasVarying(output_registers_, sig_desc.register_index))
 		{
-			out << " = (";
-			if (glsl_rules_ & GSR_UIntType)
+			uint32_t mask = sig_desc.mask;
+			bool need_comps = true;
+			if (ST_HS == shader_type_)
 			{
-				out << "uint(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ") >= uint(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				switch (sig_desc.system_value_type)
+				{
+				case SN_POSITION:
+					out << "gl_out[gl_InvocationID].gl_Position";
+					need_comps = true;
+					break;
+
+				case SN_PRIMITIVE_ID:
+					out << "gl_PrimitiveID";
+					need_comps = false;
+					break;
+
+				case SN_UNDEFINED:
+					out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index << "In[gl_InvocationID]";
+					need_comps = true;
+					break;
+
+				default:
+					break;
+				}
 			}
 			else
 			{
-				out << "int(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ") >= int(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				switch (sig_desc.system_value_type)
+				{
+				case SN_POSITION:
+					out << "gl_Position";
+					need_comps = true;
+					break;
+
+				case SN_RENDER_TARGET_ARRAY_INDEX:
+					out << "gl_Layer";
+					need_comps = false;
+					break;
+
+				case SN_PRIMITIVE_ID:
+					out << "gl_PrimitiveID";
+					need_comps = false;
+					break;
+
+				case SN_VIEWPORT_ARRAY_INDEX:
+					out << "gl_ViewportIndex";
+					need_comps = false;
+					break;
+
+				case SN_UNDEFINED:
+					if (0 == strcmp("SV_Depth", sig_desc.semantic_name))
+					{
+						out << "gl_FragDepth";
+						need_comps = false;
+					}
+					else
+					{
+						bool output_var = false;
+						if (glsl_rules_ & GSR_InOutPrefix)
+						{
+							output_var = true;
+						}
+						else
+						{
+							if (shader_type_ != ST_PS)
+							{
+								output_var = true;
+							}
+						}
+
+						bool output_semantic = false;
+						if (output_var)
+						{
+							output_semantic = true;
+						}
+						else
+						{
+							if (0 == strcmp("SV_Target", sig_desc.semantic_name))
+							{
+								uint32_t index = 0;
+								if (glsl_rules_ & GSR_DrawBuffers)
+								{
+									index = sig_desc.semantic_index;
+								}
+								out << "gl_FragData[" << index << ']';
+							}
+							else
+							{
+								output_semantic = true;
+							}
+						}
+
+						PackedVarying const * packed = FindPackedVarying(output_layout_, sig_desc);
+						if (packed)
+						{
+							out << "v_SLOT" << packed->location << '.';
+							this->ToComponentSelector(out, this->ComponentSelectorFromMask(mask >> packed->register_component, 4),
+								packed->component);
+						}
+						else if (output_semantic)
+						{
+							out << "v_" << sig_desc.semantic_name << sig_desc.semantic_index;
+							if ((ST_VS == shader_type_) && has_gs_)
+							{
+								out << "In";
+							}
+						}
+
+						need_comps = !packed;
+					}
+					break;
+
+				default:
+					break;
+				}
 			}
-			out << ")) ? -1 : 0;";
-		}
-		else
-		{
-			out << " = uvec4(";
-			if (glsl_rules_ & GSR_UIntType)
+			if (need_comps)
 			{
-				out << "uvec4(greaterThanEqual(uvec4(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << "), uvec4(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				out << '.';
+				this->ToComponentSelector(out, this->ComponentSelectorFromCount(bitcount32(mask)));
+			}
+			out << " = o_REGISTER";
+			if (0 == strcmp("SV_Depth", sig_desc.semantic_name))
+			{
+				out << "Depth";
 			}
 			else
 			{
-				out << "ivec4(greaterThanEqual(ivec4(";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << "), ivec4(";
-				this->ToOperands(out, *insn.ops[2], oit);
+				out << sig_desc.register_index;
 			}
-			out << "))) * -1)";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			out << '.';
+			this->ToComponentSelector(out, this->ComponentSelectorFromMask(mask, 4));
+			out << ";\n";
 		}
+	}
+}
+
+void GLSLGen::ToDeclaration(std::ostream& out, ShaderDecl const & dcl)
+{
+	switch (dcl.opcode)
+	{
+	case SO_DCL_INPUT:
+	case SO_DCL_INPUT_SGV:
+	case SO_DCL_INPUT_SIV:
+	case SO_DCL_OUTPUT:
+	case SO_DCL_OUTPUT_SIV:
+	case SO_DCL_OUTPUT_SGV:
+	case SO_DCL_INPUT_PS_SGV:
+	case SO_DCL_INPUT_PS_SIV:
 		break;
 
-	case SO_AND:
+	case SO_DCL_CONSTANT_BUFFER:
 		{
-			bool op1_is_float = (SIT_Float == this->OperandAsType(*insn.ops[1], oit));
-			bool op2_is_float = (SIT_Float == this->OperandAsType(*insn.ops[2], oit));
-			if (op1_is_float || op2_is_float)
-			{
-				oot = SIT_Float;
-				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-				out << " = vec4(vec4(";
-				if (op1_is_float)
-				{
-					this->ToOperands(out, *insn.ops[1], SIT_Float);
-				}
-				else
-				{
-					out << "bvec4(";
-					this->ToOperands(out, *insn.ops[1], oit);
-					out << ")";
-				}
-				out << ") * vec4(";
-				if (op2_is_float)
-				{
-					this->ToOperands(out, *insn.ops[2], SIT_Float);
-				}
-				else
-				{
-					out << "bvec4(";
-					this->ToOperands(out, *insn.ops[2], oit);
-					out << ")";
-				}
-				out << ")";
-			}
-			else
+			// Find the cb corresponding to bind_point
+			for (auto const & cb : program_->cbuffers)
 			{
-				oot = SIT_Int;
-				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-				out << " = ivec4(";
-				if (glsl_rules_ & GSR_BitwiseOp)
-				{
-					out << "ivec4(";
-					this->ToOperands(out, *insn.ops[1], SIT_Int);
-					out << ") & ivec4(";
-					this->ToOperands(out, *insn.ops[2], SIT_Int);
-					out << ")";
-				}
-				else
+				if ((SCBT_CBUFFER == cb.desc.type) && (cb.bind_point == dcl.op->indices[0].disp))
 				{
-					out << "bool(";
-					this->ToOperands(out, *insn.ops[1], oit);
-					out << ") && bool(";
-					this->ToOperands(out, *insn.ops[2], oit);
-					out << ")";
-				}
-			}
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+					if (this->IsResourcePruned(SOT_CONSTANT_BUFFER, cb.bind_point))
+					{
+						break;
+					}
+
+					bool const has_default_value = HasDefaultValues(cb);
+					bool const block_candidate = (glsl_rules_ & GSR_UseUBO)
+						&& ((glsl_rules_ & GSR_GlobalUniformsInUBO) || (cb.desc.name[0] != '$')) && !has_default_value;
+					bool const register_view = block_candidate && this->IsCBufferRegisterView(cb.bind_point);
+					// Unused members can only go from free standing uniforms and constants. The used flags differ between
+					// stages, and a block keeps every member so all the stages declare it the same way.
+					bool const prune = (glsl_rules_ & GSR_PruneUnused) && !block_candidate;
+					// Members baked into constants are declared after the block, and the block is dropped when nothing
+					// is left in it
+					std::vector<DXBCShaderVariable const *> constants;
+					uint32_t num_members = 0;
+					for (size_t i = 0; i < cb.vars.size(); ++ i)
+					{
+						if (cb.vars[i].has_type_desc && !(prune && !(cb.vars[i].var_desc.flags & DSVF_Used)))
+						{
+							if (this->FindCBufferConstant(cb.bind_point, static_cast<uint32_t>(i)))
+							{
+								constants.push_back(&cb.vars[i]);
+							}
+							else
+							{
+								++ num_members;
+							}
+						}
+					}
+					bool const uniform_block = block_candidate && (num_members > 0);
+					bool const d3d_layout = uniform_block && ((glsl_rules_ & GSR_D3DCBufferLayout) || register_view);
+
+					if (num_members > 0)
+					{
+						if (glsl_rules_ & GSR_UniformBlockBinding)
+						{
+							out << "layout(";
+							if (d3d_layout)
+							{
+								out << "std140, ";
+							}
+							out << "binding=" << dcl.op->indices[0].disp << ") ";
+						}
+						else if (d3d_layout)
+						{
+							out << "layout(std140) ";
+						}
+					}
+
+					// If this cb has a member with default value ,then treat all members of this cb as constant
+					// variables with intialization value in glsl.
+					// e.g.
+					/***********************************
+					cbuffer Immutable
+					{
+						int a = 5;
+						float b = 3.0f;
+					}
+					is converted to:
+					const int a = 5;
+					const float b = 3.0f;
+					In this case, uniform block is not used.
+					*************************************/
+
+					if (uniform_block)
+					{
+						out << "uniform ";
+						out << cb.desc.name;
+						if (register_view)
+						{
+							// Whether cb# is dynamically indexed differs between stages, the member layout of another
+							// stage mustn't meet this block under the same name
+							out << "_registers";
+						}
+						out << "\n{\n";
+					}
+					char const * uniform = "";
+					if (!(glsl_rules_ & GSR_GlobalUniformsInUBO))
+					{
+						uniform = "uniform ";
+					}
+
+					if (register_view)
+					{
+						// The registers themselves, cb operands index them directly
+						out << uniform << "vec4 cb_" << cb.bind_point << "[" << cb.desc.size / 16 << "];\n";
+					}
+					// std140 offset after the last declared member
+					uint32_t std140_offset = 0;
+					for (auto const & var : cb.vars)
+					{
+						if (var.has_type_desc && !register_view && !(prune && !(var.var_desc.flags & DSVF_Used))
+							&& (std::find(constants.begin(), constants.end(), &var) == constants.end()))
+						{
+							int32_t location = -1;
+							if (!uniform_block && !has_default_value && (glsl_rules_ & GSR_UniformLocations))
+							{
+								int32_t const index = this->FindCBufferLayout(cb.bind_point)->uniform_locations[&var - &cb.vars[0]];
+								if (index < 0)
+								{
+									// Unused
+									continue;
+								}
+								location = uniform_locations_[index].location;
+							}
+							if (d3d_layout)
+							{
+								// Already checked by FindCBufferLayouts
+								uint32_t align;
+								uint32_t size;
+								Std140Layout(var.type_desc, (glsl_rules_ & GSR_MatrixType) != 0, align, size);
+
+								if (glsl_rules_ & GSR_UniformBlockMemberOffset)
+								{
+									out << "layout(offset=" << var.var_desc.start_offset << ") ";
+								}
+								else
+								{
+									for (; std140_offset < var.var_desc.start_offset; std140_offset += 4)
+									{
+										out << uniform << "float cb" << cb.bind_point << "_pad" << std140_offset << ";\n";
+									}
+								}
+								std140_offset = var.var_desc.start_offset + size;
+							}
+							if (location >= 0)
+							{
+								out << "layout(location=" << location << ") ";
+							}
+							if (has_default_value)
+							{
+								out << "const ";
+							}
+							this->ToDclCBufferMember(out, var, uniform, uniform_block);
+							if (has_default_value)
+							{
+								out << " = ";
+								this->ToDefaultValue(out, var);
+							}
+							out << ";\n";
+						}
+					}
+					if (uniform_block)
+					{
+						out << "};\n";
+					}
+					for (auto const * var : constants)
+					{
+						DXBCShaderVariable constant = *var;
+						constant.var_desc.default_val = this->FindCBufferConstant(cb.bind_point,
+							static_cast<uint32_t>(var - &cb.vars[0]))->value.data();
+						out << "const ";
+						this->ToDclCBufferMember(out, constant, "", false);
+						out << " = ";
+						this->ToDefaultValue(out, constant);
+						out << ";\n";
+					}
+					out << "\n";
+
+					break;
+				}
+			}
 		}
 		break;
 
-	case SO_OR:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(";
-		if (glsl_rules_ & GSR_BitwiseOp)
-		{
-			out << "ivec4(";
-			this->ToOperands(out, *insn.ops[1], SIT_Int);
-			out << ") | ivec4(";
-			this->ToOperands(out, *insn.ops[2], SIT_Int);
-			out << ")";
-		}
-		else
-		{
-			out << "bool(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ") || bool(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")";
-		}
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	case SO_DCL_TEMPS:
+	case SO_DCL_INDEXABLE_TEMP:
+		// Moved to GLSLGen::ToTemps();
 		break;
 
-	case SO_XOR:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(ivec4(";
-		this->ToOperands(out, *insn.ops[1], SIT_Int);
-		out << ") ^ ivec4(";
-		this->ToOperands(out, *insn.ops[2], SIT_Int);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	case SO_DCL_INPUT_PS:
+		// Moved to GLSLGen::ToInterShaderInputRecords();
 		break;
 
-	case SO_NOT:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(";
-		if (glsl_rules_ & GSR_BitwiseOp)
-		{
-			out << "~i";
-		}
-		else
-		{
-			out << "not(b";
-		}
-		out << "vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		if (!(glsl_rules_ & GSR_BitwiseOp))
+	case SO_DCL_RESOURCE:
+		// Bindless textures are declared by GLSLGen::ToDclBindlessTextures()
+		if (!(glsl_rules_ & GSR_BindlessTexture))
 		{
-			out << ")";
+			this->ToDclSamplers(out, dcl, false);
 		}
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
 		break;
 
-	case SO_MOVC:
-		if (SOT_OUTPUT == insn.ops[0]->type)
-		{
-			oot = this->OperandAsType(*insn.ops[0], oit);
-			oit = oot;
-		}
-		else
-		{
-			oot = std::max(this->OperandAsType(*insn.ops[2], oit), this->OperandAsType(*insn.ops[3], oit));
-			oit = oot;
-		}
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
-		{
-			selector[i] = this->ToSingleComponentSelector(out, *insn.ops[0], i, 0 == i);
-		}
-		out << " = ";
-		if (num_comps > 1)
+	case SO_DCL_RESOURCE_STRUCTURED:
+	case SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED:
+		if (!this->IsResourcePruned(dcl.op->type, dcl.op->indices[0].disp))
 		{
-			out << "vec" << num_comps << "(";
+			this->ToStructuredDeclaration(out, dcl);
 		}
-		for (int i = 0; i < num_comps; ++ i)
-		{
-			if (i != 0)
-			{
-				out << ", ";
-			}
+		break;
 
-			out << "bool(";
-			this->ToOperands(out, *insn.ops[1], this->OperandAsType(*insn.ops[1], oit), false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], selector[i]);
-			out << ")";
-			out << " ? ";
-			this->ToOperands(out, *insn.ops[2], oit, false, false, true);
-			this->ToSingleComponentSelector(out, *insn.ops[2], selector[i]);
-			out << " : ";
-			this->ToOperands(out, *insn.ops[3], oit, false, false, true);
-			this->ToSingleComponentSelector(out, *insn.ops[3], selector[i]);
-		}
-		if (num_comps > 1)
+	case SO_DCL_RESOURCE_RAW:
+		if (!this->IsResourcePruned(dcl.op->type, dcl.op->indices[0].disp))
 		{
-			out << ")";
+			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_BYTEADDRESS,
+				static_cast<uint32_t>(dcl.op->indices[0].disp));
+			out << "layout(std430) readonly buffer ";
+			out << ShaderOperandTypeShortName(dcl.op->type) << dcl.op->indices[0].disp << " {\n";
+			out << "uint " << desc.name << "[];\n};\n";
 		}
-		out << ";";
 		break;
 
-	case SO_MAX:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(max(vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "), vec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	case SO_DCL_GLOBAL_FLAGS:
+		// Handled in GLSLGen::FindGlobalFlags()
 		break;
 
-	case SO_IMAX:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(max(ivec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "), ivec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	case SO_DCL_SAMPLER:
+		// TODO: ignore it for now
 		break;
 
-	case SO_UMAX:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ";
-		if (glsl_rules_ & GSR_UIntType)
-		{
-			out << "uvec4(max(uvec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), uvec4(";
-		}
-		else
+	case SO_DCL_UNORDERED_ACCESS_VIEW_RAW:
+		if (!this->IsResourcePruned(dcl.op->type, dcl.op->indices[0].disp))
 		{
-			out << "ivec4(max(ivec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), ivec4(";
+			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_UAV_RWBYTEADDRESS,
+				static_cast<uint32_t>(dcl.op->indices[0].disp));
+			out << "layout(std430) buffer ";
+			out << ShaderOperandTypeShortName(dcl.op->type) << dcl.op->indices[0].disp << " {\n";
+			out << "uint " << desc.name << "[];\n};\n";
 		}
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
 		break;
 
-	case SO_MIN:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(min(vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "), vec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+	case SO_DCL_UNORDERED_ACCESS_VIEW_TYPED:
+		if (!this->IsResourcePruned(dcl.op->type, dcl.op->indices[0].disp))
+		{
+			out << "layout(binding=" << this->FindBinding(SIT_UAV_RWTYPED, dcl.op->indices[0].disp, -1) << ") uniform ";
+			switch (dcl.rrt.x)
+			{
+			case SRRT_UNORM:
+			case SRRT_SNORM:
+			case SRRT_FLOAT:
+				break;
 
-	case SO_IMIN:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(min(ivec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "), ivec4(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+			case SRRT_SINT:
+				out << "i";
+				break;
 
-	case SO_UMIN:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ";
-		if (glsl_rules_ & GSR_UIntType)
-		{
-			out << "uvec4(min(uvec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), uvec4(";
+			case SRRT_UINT:
+				out << "u";
+				break;
+
+			default:
+				assert_msg(false, "Unsupported resource return type");
+				break;
+			}
+			out << "image";
+			switch (dcl.dcl_resource.target)
+			{
+			case SRD_TEXTURE1D:
+				out << "1D";
+				break;
+
+			case SRD_TEXTURE2D:
+				out << "2D";
+				break;
+
+			case SRD_TEXTURE3D:
+				out << "3D";
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				out << "1DArray";
+				break;
+
+			case SRD_TEXTURE2DARRAY:
+				out << "2DArray";
+				break;
+
+			case SRD_BUFFER:
+				out << "Buffer";
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_UAV_RWTYPED, static_cast<uint32_t>(dcl.op->indices[0].disp));
+			out << " " << desc.name << ";\n";
 		}
-		else
+		break;
+
+	case SO_DCL_THREAD_GROUP_SHARED_MEMORY_RAW:
+		// dcl_tgsm_raw g0, byte_count
+		out << "shared uint g" << dcl.op->indices[0].disp << "[" << dcl.num / 4 << "];\n";
+		break;
+
+	case SO_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED:
 		{
-			out << "ivec4(min(ivec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << "), ivec4(";
+			out << "shared ";
+			assert_msg(dcl.structured.stride <= 16, "thread group shared memory size can't exceed 16 bytes");
+			size_t elem_num=dcl.structured.stride / 4;
+			if (1 == elem_num)
+			{
+				out << "float";
+			}
+			else if (elem_num > 1)
+			{
+				out << "vec" << elem_num;
+			}
+			out << " g" << dcl.op->indices[0].disp;
+			out << "[" << dcl.structured.count << "]" << ";\n";
 		}
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
 		break;
 
-	case SO_FTOI:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	case SO_DCL_STREAM:
+	case SO_DCL_GS_INPUT_PRIMITIVE:
+	case SO_DCL_GS_OUTPUT_PRIMITIVE_TOPOLOGY:
+	case SO_DCL_MAX_OUTPUT_VERTEX_COUNT:
+	case SO_DCL_GS_INSTANCE_COUNT:
+	case SO_DCL_OUTPUT_CONTROL_POINT_COUNT:
 		break;
 
-	case SO_ITOF:
-	case SO_UTOF:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	default:
+		//assert_msg(false, "Unhandled declarations");
 		break;
+	}
+}
 
-	case SO_FTOU:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ";
-		if (glsl_rules_ & GSR_UIntType)
+void GLSLGen::ToDclCBufferMember(std::ostream& out, DXBCShaderVariable const & var, char const * uniform, bool block_member)
+{
+	// Array element count, 0 if not a array
+	uint32_t element_count = var.type_desc.elements;
+	switch (var.type_desc.var_class)
+	{
+	case SVC_SCALAR:
+		out << uniform << var.type_desc.name;
+		out << " " << var.var_desc.name;
+		if (element_count)
 		{
-			out << "u";
+			out << "[" << element_count << "]";
 		}
-		else
+		break;
+
+	case SVC_VECTOR:
+		out << uniform;
+		if (1 == var.type_desc.columns)
 		{
-			out << "i";
+			out << var.type_desc.name;
 		}
-		out << "vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+		else
+		{
+			switch (var.type_desc.type)
+			{
+			case SVT_INT:
+				out << "i";
+				break;
 
-	case SO_ROUND_NI:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(floor(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+			case SVT_FLOAT:
+				break;
 
-	case SO_ROUND_PI:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(ceil(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+			case SVT_UINT:
+				if (glsl_rules_ & GSR_UIntType)
+				{
+					out << "u";
+				}
+				else
+				{
+					out << "i";
+				}
+				break;
 
-	case SO_ROUND_NE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(roundEven(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+			default:
+				assert_msg(false, "unexpected vector type");
+				break;
+			}
+			out << "vec";
+		}
+		out << var.type_desc.columns << " " << var.var_desc.name;
+		if (element_count)
+		{
+			out << "[" << element_count << "]";
+		}
 		break;
 
-	case SO_ROUND_Z:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		num_comps = this->GetOperandComponentNum(*insn.ops[1]);
-		out << " = vec4(";
-		if (1 == num_comps)
+	case SVC_MATRIX_COLUMNS:
+		if (glsl_rules_ & GSR_MatrixType)
 		{
-			out << "int";
+			// In glsl mat3x2 means 3 columns 2 rows, which is opposite to hlsl
+			out << uniform << "mat" << var.type_desc.columns << 'x'
+				<< var.type_desc.rows << " " << var.var_desc.name;
+			if (element_count)
+			{
+				out << "[" << element_count << "]";
+			}
 		}
 		else
 		{
-			out << "ivec" << num_comps;
+			uint32_t array_size = var.type_desc.rows;
+			if (element_count)
+			{
+				array_size *= element_count;
+			}
+			out << uniform << "vec" << var.type_desc.columns << ' '
+				<< var.var_desc.name << "[" << array_size << "]";
 		}
-		out << "(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
 		break;
 
-	case SO_SINCOS:
-		if (insn.ops[0]->type != SOT_NULL)
+	case SVC_MATRIX_ROWS:
+		if (glsl_rules_ & GSR_MatrixType)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = vec4(sin(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			// In glsl mat3x2 means 3 columns 2 rows, which is opposite to hlsl
+			if (block_member)
+			{
+				out << "layout(row_major) ";
+			}
+			out << uniform << "mat" << var.type_desc.columns << 'x'
+				<< var.type_desc.rows << " " << var.var_desc.name;
+			if (element_count)
+			{
+				out << "[" << element_count << "]";
+			}
 		}
-		if (insn.ops[1]->type != SOT_NULL)
+		else
 		{
-			if (insn.ops[0]->type != SOT_NULL)
+			uint32_t array_size = var.type_desc.columns;
+			if (element_count)
 			{
-				out << "\n";
+				array_size *= element_count;
 			}
-			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-			out << " = vec4(cos(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "))";
-			this->ToComponentSelectors(out, *insn.ops[1]);
-			out << ";";
+			out << uniform << "vec" << var.type_desc.rows << ' '
+				<< var.var_desc.name << "[" << array_size << "]";
 		}
 		break;
 
-	case SO_RCP:
-		// TODO: need more test
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(1.0f / ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	default:
+		assert_msg(false, "Unhandled type,when converting dcl_constant_buffer");
 		break;
+	}
+}
 
-	case SO_SWAPC:
-		// swapc 0dest0 1dest1 2src0 3src1 4src2
-		// can be converted to following two instructions:
-		// movc dest0 src0 src2 src1
-		// movc dest1 src0 src1 src2
-
-		// First movc
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
+void GLSLGen::ToDclSamplers(std::ostream& out, ShaderDecl const & dcl, bool block_member) const
+{
+	ShaderImmType sit = GetOpInType(dcl.opcode);
+	for (auto const & tex : textures_)
+	{
+		if (tex.tex_index == dcl.op->indices[0].disp)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			int j = this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = bool(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], j);
-			out << ") ? ";
-			this->ToOperands(out, *insn.ops[4], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[4], j);
-			out << " : ";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[3], j);
-			out << ";";
-			if (i != num_comps - 1)
+			for (auto const & sampler : tex.samplers)
 			{
-				out << "\n";
+				if (!block_member)
+				{
+					if (glsl_rules_ & GSR_SamplerBinding)
+					{
+						out << "layout(binding=" << this->FindBinding(SIT_TEXTURE, tex.tex_index, sampler.index) << ") ";
+					}
+					out << "uniform ";
+				}
+				if (glsl_rules_ & GSR_PrecisionOnSampler)
+				{
+					char const * qualifier = MinPrecisionQualifier(tex.min_precision);
+					out << (qualifier ? qualifier : "highp ");
+				}
+				this->ToSamplerType(out, dcl, sampler.shadow);
+				out << " ";
+				this->ToOperands(out, *dcl.op, sit, true, false, false, true, true);
+				DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(sampler.index));
+				out << "_" << desc.name;
+				out << ";\n";
+			}
+			if (tex.samplers.empty())
+			{
+				if (!block_member)
+				{
+					if (glsl_rules_ & GSR_SamplerBinding)
+					{
+						out << "layout(binding=" << this->FindBinding(SIT_TEXTURE, tex.tex_index, -1) << ") ";
+					}
+					out << "uniform ";
+				}
+				if (glsl_rules_ & GSR_PrecisionOnSampler)
+				{
+					char const * qualifier = MinPrecisionQualifier(tex.min_precision);
+					out << (qualifier ? qualifier : "highp ");
+				}
+				this->ToSamplerType(out, dcl, false);
+				out << " ";
+				this->ToOperands(out, *dcl.op, sit, true, false, false, true, true);
+				out << ";\n";
 			}
+			break;
 		}
-		// Second movc
-		num_comps = this->GetOperandComponentNum(*insn.ops[1]);
-		for (int i = 0; i < num_comps; ++ i)
+	}
+}
+
+void GLSLGen::ToSamplerType(std::ostream& out, ShaderDecl const & dcl, bool shadow) const
+{
+	switch (dcl.rrt.x)
+	{
+	case SRRT_UNORM:
+	case SRRT_SNORM:
+	case SRRT_FLOAT:
+		break;
+
+	case SRRT_SINT:
+		out << "i";
+		break;
+
+	case SRRT_UINT:
+		out << "u";
+		break;
+
+	default:
+		assert_msg(false, "Unsupported resource return type");
+		break;
+	}
+	out << "sampler";
+	switch (dcl.dcl_resource.target)
+	{
+	case SRD_BUFFER:
+		out << "Buffer";
+		break;
+
+	case SRD_TEXTURE1D:
+		out << "1D";
+		break;
+
+	case SRD_TEXTURE2D:
+		out << "2D";
+		break;
+
+	case SRD_TEXTURE2DMS:
+		out << "2DMS";
+		break;
+
+	case SRD_TEXTURE3D:
+		out << "3D";
+		break;
+
+	case SRD_TEXTURECUBE:
+		out << "Cube";
+		break;
+
+	case SRD_TEXTURE1DARRAY:
+		out << "1DArray";
+		break;
+
+	case SRD_TEXTURE2DARRAY:
+		out << "2DArray";
+		break;
+
+	case SRD_TEXTURE2DMSARRAY:
+		out << "2DMSArray";
+		break;
+
+	case SRD_TEXTURECUBEARRAY:
+		out << "CubeArray";
+		break;
+
+	default:
+		assert_msg(false, "Unexpected resource target type");
+		break;
+	}
+	if (shadow)
+	{
+		out << "Shadow";
+	}
+}
+
+void GLSLGen::ToDclBindlessTextures(std::ostream& out) const
+{
+	if (textures_.empty())
+	{
+		return;
+	}
+
+	// Every sampler is a 64-bit handle, 8 bytes apart in std140. GLSLBinding::handle_block and handle_offset say where.
+	// Each stage has a block of its own, so the handles only need to agree within one stage.
+	out << "layout(std140";
+	if (glsl_rules_ & GSR_UniformBlockBinding)
+	{
+		out << ", binding=" << binding_policy_.handle_block_binding + shader_type_;
+	}
+	out << ") uniform " << BindlessBlockName(shader_type_) << "\n{\n";
+	for (auto const & dcl : program_->dcls)
+	{
+		if (SO_DCL_RESOURCE == dcl->opcode)
 		{
-			this->ToOperands(out, *insn.ops[1], oot | (oot << 8), false);
-			int j = this->ToSingleComponentSelector(out, *insn.ops[1], i);
-			out << " = bool(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], j);
-			out << ") ? ";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[3], j);
-			out << " : ";
-			this->ToOperands(out, *insn.ops[4], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[4], j);
-			out << ";";
-			if (i != num_comps - 1)
+			this->ToDclSamplers(out, *dcl, true);
+		}
+	}
+	out << "};\n\n";
+}
+
+void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) const
+{
+	int selector[4] = { 0 };
+	ShaderImmType oit = GetOpInType(insn.opcode);
+	ShaderImmType oot = GetOpOutType(insn.opcode);
+	uint32_t num_outputs = std::min(insn.num_ops, GetNumOutputs(insn.opcode));
+	int num_comps = 0;
+	cur_insn_ = &insn;
+	switch (insn.opcode)
+	{
+		//-----------------------------------------------------------------------------------------
+		//common single-precision float instructions
+		//-----------------------------------------------------------------------------------------
+	case SO_MOV:
+		if (SOT_OUTPUT == insn.ops[0]->type)
+		{
+			oot = this->OperandAsType(*insn.ops[0], oit);
+			oit = oot;
+		}
+		else
+		{
+			oot = this->OperandAsType(*insn.ops[1], oit);
+			oit = oot;
+		}
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ";
+		switch (oot)
+		{
+		case SIT_UInt:
+			if (SOT_TEMP == insn.ops[0]->type)
 			{
-				out << "\n";
+				out << "i";
+			}
+			else
+			{
+				if (glsl_rules_ & GSR_UIntType)
+				{
+					out << "u";
+				}
+				else
+				{
+					out << "i";
+				}
 			}
+			break;
+
+		case SIT_Int:
+			out << "i";
+			break;
+
+		case SIT_Double:
+			out << "d";
+			break;
+
+		case SIT_Float:
+			break;
+
+		default:
+			assert(false);
+			break;
 		}
+		out << "vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-		//-------------------------------------------------------------------------------------
-		//integer instructions
-		//---------------------------------------------------------------------------------------
-
-	case SO_INEG:
-		// TODO: to be tested,is that true?
-		// dest.mask = ivec4(-src0).mask;
+	case SO_MUL:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(-";
+		out << " = vec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
+		out << " * ";
+		this->ToOperands(out, *insn.ops[2], oit);
 		out << ")";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_ISHL:
+	case SO_MAD:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(ivec4(";
+		out << " = vec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
-		out << ") ";
-		if (glsl_rules_ & GSR_BitwiseOp)
-		{
-			out << "<< ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")";
-		}
-		else
-		{
-			out << "* ivec4(pow(vec4(2), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")))";
-		}
+		out << " * ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << " + ";
+		this->ToOperands(out, *insn.ops[3], oit);
 		out << ")";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_ISHR:
+	case SO_IMAD:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(ivec4(";
+		out << " = ivec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
-		out << ") ";
-		if (glsl_rules_ & GSR_BitwiseOp)
+		out << " * ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << " + ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_UMAD:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ";
+		if (glsl_rules_ & GSR_UIntType)
 		{
-			out << ">> ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")";
+			out << "u";
 		}
 		else
 		{
-			out << "/ ivec4(pow(vec4(2), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")))";
+			out << "i";
 		}
+		out << "vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << " * ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << " + ";
+		this->ToOperands(out, *insn.ops[3], oit);
 		out << ")";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_IMUL:
-		//imul destHI[.mask], destLO[.mask], [-]src0[.swizzle], [-]src1[.swizzle]
-		if (((insn.ops[0]->type != SOT_NULL) && (insn.ops[1]->type != SOT_NULL))
-			&& (glsl_rules_ & GSR_Int64Type))
-		{
-			out << "imulExtended(ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << "), ivec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << ")";
-			out << ", ";
-			out << "iTempX[0]";
-			out << ", ";
-			out << "iTempX[1]";
-			out << ");\n";
+	case SO_DP4:
+		// Notice: dot()only support float vec2/3/4 type. In glsl, ivec and uvec are converted to vec implicitly.
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(dot(vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "), vec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
 
-			//destHI.xz=vec4(destHI).xz;
-			if (insn.ops[0]->type != SOT_NULL)
-			{
-				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-				out << " = iTempX[0]";
-				this->ToComponentSelectors(out, *insn.ops[0]);
-				out << ";";
-			}
-			//destLO.xz=vec4(destLO).xz;
-			if (insn.ops[1]->type != SOT_NULL)
-			{
-				if (insn.ops[0]->type != SOT_NULL)
-				{
-					out << "\n";
-				}
-				this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-				out << " = iTempX[1]";
-				this->ToComponentSelectors(out, *insn.ops[1]);
-				out << ";";
-			}
-		}
-		else
-		{
-			assert(((SOT_NULL == insn.ops[0]->type) && (insn.ops[1]->type != SOT_NULL))
-				|| !(glsl_rules_ & GSR_Int64Type));
+	case SO_DP3:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(dot(vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ").xyz, vec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ").xyz))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
 
-			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-			out << " = ivec4(ivec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ") * ivec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << "))";
-			this->ToComponentSelectors(out, *insn.ops[1]);
-			out << ";";
-		}
+	case SO_DP2:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(dot(vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ").xy, vec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ").xy))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-		//--------------------------------------------------------------------------------------
-		// unsigned integer instructions
-		//---------------------------------------------------------------------------------------
+	case SO_EXP:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(exp2(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
 
-	case SO_UADDC:
-		// gl:uaddCarry(x,y,out carry)
-		// uaddc dest0[.mask], dest1[.mask], src0[.swizzle], src1[.swizzle]
-		// dest0.xz=uaddCarry(src0.xxxx,src1.xxxx,dest1).xz;
-		// TODO: to be tested
+	case SO_SQRT:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(uaddCarry(";
+		out << " = vec4(sqrt(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_RSQ:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(inversesqrt(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_DIV:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << " / ";
 		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		if (insn.ops[1]->type != SOT_NULL)
-		{
-			out << ", ";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-		}
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_ADD:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << " + ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_IADD:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << " + ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_FRC:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(fract(";
+		this->ToOperands(out, *insn.ops[1], oit);
 		out << "))";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
-		////dest1.xz=uvec4(dest1).xz;
-		//if (sm_shortfile_names[insn.ops[1]->file] != "null")
-		//{
-		//	out<<"\n";
-		//	this->ToOperands(out,*insn.ops[1],oit);
-		//	out<<" = uvec4(";
-		//	this->ToOperands(out,*insn.ops[1],oit,false);
-		//	out<<")";
-		//	this->ToComponentSelectors(out,*insn.ops[0]);
-		//	out<<";";
-		//}
 		break;
 
-	case SO_UDIV:
-		//dest0.mask= uvec4(src0 / src1).mask;
-		//dest1 = uvec4(src0 % src1).mask;
-		if (insn.ops[0]->type != SOT_NULL)
+	case SO_LOG:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(log2(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_EQ:
+		// Need more process to the return value of equal(): true->0xFFFFFFFF, false->0x00000000
+		// e.g.
+		// r0.xy=equal();
+		// r0.x=r0.x?-1:0;
+		// r0.y=r0.y?-1:0;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ivec4(ivec4(";
+			out << " = (float(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") == float(";
 			this->ToOperands(out, *insn.ops[2], oit);
-			out << ") / ivec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << "))";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			out << ")) ? -1 : 0;";
 		}
-		if (insn.ops[1]->type != SOT_NULL)
+		else
 		{
-			if (insn.ops[0]->type != SOT_NULL)
-			{
-				out << "\n";
-			}
-			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-			out << " = ivec4(ivec4(";
+			out << " = (ivec4(equal(vec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), vec4(";
 			this->ToOperands(out, *insn.ops[2], oit);
-			out << ") % ivec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << "))";
-			this->ToComponentSelectors(out, *insn.ops[1]);
+			out << "))) * ivec4(-1))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
 			out << ";";
 		}
 		break;
 
-	case SO_UMUL:
-		//umul destHI[.mask], destLO[.mask], src0[.swizzle], src1[.swizzle]
-		//umulExtended(src0.xxxx,src1.xxxx,destHI,destLO);
-		// TODO: to be tested
-		if (((insn.ops[0]->type != SOT_NULL) && (insn.ops[1]->type != SOT_NULL))
-			&& (glsl_rules_ & GSR_Int64Type))
+	case SO_IEQ:
+		// Need more process to the return value of equal(): true->0xFFFFFFFF, false->0x00000000
+		// e.g.
+		// r0.xy=equal();
+		// r0.x=r0.x?-1:0;
+		// r0.y=r0.y?-1:0;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
 		{
-			out << "umulExtended(uvec4(";
+			out << " = (int(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") == int(";
 			this->ToOperands(out, *insn.ops[2], oit);
-			out << "), uvec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << ")";
-			out << ", ";
-			out << "uTempX[0]";
-			out << ", ";
-			out << "uTempX[1]";
-			out << ");";
-
-			//destHI.xz=vec4(destHI).xz;
-			if (insn.ops[0]->type != SOT_NULL)
-			{
-				out << "\n";
-				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-				out << " = uTempX[0]";
-				this->ToComponentSelectors(out, *insn.ops[0]);
-				out << ";";
-			}
-			//destLO.xz=vec4(destLO).xz;
-			if (insn.ops[1]->type != SOT_NULL)
-			{
-				if (insn.ops[0]->type != SOT_NULL)
-				{
-					out << "\n";
-				}
-				this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-				out << " = uTempX[1]";
-				this->ToComponentSelectors(out, *insn.ops[1]);
-				out << ";";
-			}
+			out << ")) ? -1 : 0;";
 		}
 		else
 		{
-			assert(((SOT_NULL == insn.ops[0]->type) && (insn.ops[1]->type != SOT_NULL))
-				|| !(glsl_rules_ & GSR_Int64Type));
-
-			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-			out << " = ivec4(";
-			if (glsl_rules_ & GSR_UIntType)
-			{
-				out << "u";
-			}
-			else
-			{
-				out << "i";
-			}
-			out << "vec4(";
+			out << " = (ivec4(equal(ivec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), ivec4(";
 			this->ToOperands(out, *insn.ops[2], oit);
-			out << ") * ";
-			if (glsl_rules_ & GSR_UIntType)
-			{
-				out << "u";
-			}
-			else
-			{
-				out << "i";
-			}
-			out << "vec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << "))";
-			this->ToComponentSelectors(out, *insn.ops[1]);
+			out << "))) * ivec4(-1))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}		
+		break;
+
+	case SO_NE:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+		{
+			out << " = (float(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") != float(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")) ? -1 : 0;";
+		}
+		else
+		{
+			out << " = (ivec4(notEqual(vec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))) * ivec4(-1))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
 			out << ";";
 		}
 		break;
 
-	case SO_USHR:
-		//dest.mask = uvec4(src0 >> src1).mask;
+	case SO_INE:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(";
-		if (glsl_rules_ & GSR_UIntType)
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
 		{
-			out << "u";
+			out << " = (int(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") != int(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")) ? -1 : 0;";
 		}
 		else
 		{
-			out << "i";
+			out << " = (ivec4(notEqual(ivec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))) * ivec4(-1))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
 		}
-		out << "vec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ") ";
-		if (glsl_rules_ & GSR_BitwiseOp)
+		break;
+
+	case SO_LT:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
 		{
-			out << ">> ";
+			out << " = (float(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") < float(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")) ? -1 : 0;";
+		}
+		else
+		{
+			out << " = (ivec4(lessThan(vec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))) * ivec4(-1))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_ILT:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+		{
+			out << " = (int(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") < int(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")) ? -1 : 0;";
+		}
+		else
+		{
+			out << " = (ivec4(lessThan(ivec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))) * ivec4(-1))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_ULT:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+		{
+			out << " = (";
 			if (glsl_rules_ & GSR_UIntType)
 			{
-				out << "u";
+				out << "uint(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ") < uint(";
+				this->ToOperands(out, *insn.ops[2], oit);
 			}
 			else
 			{
-				out << "i";
+				out << "int(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ") < int(";
+				this->ToOperands(out, *insn.ops[2], oit);
 			}
-			out << "vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")";
+			out << ")) ? -1 : 0;";
 		}
 		else
 		{
-			out << "/ ";
+			out << " = ivec4(";
 			if (glsl_rules_ & GSR_UIntType)
 			{
-				out << "u";
+				out << "uvec4(lessThan(uvec4(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << "), uvec4(";
+				this->ToOperands(out, *insn.ops[2], oit);
 			}
 			else
 			{
-				out << "i";
+				out << "ivec4(lessThan(ivec4(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << "), ivec4(";
+				this->ToOperands(out, *insn.ops[2], oit);
 			}
-			out << "vec4(pow(vec4(2), vec4(";
-			this->ToOperands(out, *insn.ops[2], oit);
-			out << ")))";
+			out << "))) * -1)";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
 		}
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
 		break;
 
-	case SO_USUBB:
-		//usubb result borrow src0 src1
-		//result.xz=uvec4(usubBorrow(src0,src1,borrow)).xz;
-		//差为负数时存在问题，见hlsl msdn 
+	case SO_GE:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		if (insn.ops[1]->type != SOT_NULL)
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
 		{
-			out << " = ivec4(usubBorrow(";
+			out << " = (float(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") >= float(";
 			this->ToOperands(out, *insn.ops[2], oit);
-			out << ", ";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << ", ";
-			out << "uTempX[0]";
-			out << "))";
+			out << ")) ? -1 : 0;";
+		}
+		else
+		{
+			out << " = (ivec4(greaterThanEqual(vec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))) * ivec4(-1))";
 			this->ToComponentSelectors(out, *insn.ops[0]);
 			out << ";";
+		}
+		break;
 
-			//borrow.xz=vec4(borrow).xz;
-			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
-			out << " = uTempX[0]";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+	case SO_IGE:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+		{
+			out << " = (int(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") >= int(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")) ? -1 : 0;";
 		}
 		else
 		{
-			out << " = ivec4(uvec4(";
+			out << " = (ivec4(greaterThanEqual(ivec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), ivec4(";
 			this->ToOperands(out, *insn.ops[2], oit);
-			out << ") - uvec4(";
-			this->ToOperands(out, *insn.ops[3], oit);
-			out << "))";
+			out << "))) * ivec4(-1))";
 			this->ToComponentSelectors(out, *insn.ops[0]);
 			out << ";";
 		}
 		break;
 
-		//---------------------------------------------------------------------------
-		//bit instructions
-		//----------------------------------------------------------------------------
-
-	case SO_COUNTBITS:
-		//the number of bits set in src0
-		//dest.mask= uvec4(bitCount(src0)).mask;
+	case SO_UGE:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(bitCount(uvec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+		if (1 == this->GetOperandComponentNum(*insn.ops[1]))
+		{
+			out << " = (";
+			if (glsl_rules_ & GSR_UIntType)
+			{
+				out << "uint(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ") >= uint(";
+				this->ToOperands(out, *insn.ops[2], oit);
+			}
+			else
+			{
+				out << "int(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ") >= int(";
+				this->ToOperands(out, *insn.ops[2], oit);
+			}
+			out << ")) ? -1 : 0;";
+		}
+		else
+		{
+			out << " = uvec4(";
+			if (glsl_rules_ & GSR_UIntType)
+			{
+				out << "uvec4(greaterThanEqual(uvec4(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << "), uvec4(";
+				this->ToOperands(out, *insn.ops[2], oit);
+			}
+			else
+			{
+				out << "ivec4(greaterThanEqual(ivec4(";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << "), ivec4(";
+				this->ToOperands(out, *insn.ops[2], oit);
+			}
+			out << "))) * -1)";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
 		break;
 
-	case SO_BFI:
-		//bfi dest, src0, src1, src2, src3
-		//dest : The address of the results.
-		//src0 : The bitfield width to take from src2.
-		//src1 : The bitfield offset for replacing bits in src3
-		//src2 : The number the bits are taken from.
-		//src3 : The number with bits to be replaced
-		//this instruction is used for packing integers or flags
-		//dest.mask = bitfieldInsert(uvec4(src3),uvec4(src2),int(src1),int(src0)).mask;
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(bitfieldInsert(uvec4(";
-		this->ToOperands(out, *insn.ops[4], oit);
-		out << "), uvec4(";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << "), int(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << "), int(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
+	case SO_AND:
+		{
+			bool op1_is_float = (SIT_Float == this->OperandAsType(*insn.ops[1], oit));
+			bool op2_is_float = (SIT_Float == this->OperandAsType(*insn.ops[2], oit));
+			if (op1_is_float || op2_is_float)
+			{
+				oot = SIT_Float;
+				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+				out << " = vec4(vec4(";
+				if (op1_is_float)
+				{
+					this->ToOperands(out, *insn.ops[1], SIT_Float);
+				}
+				else
+				{
+					out << "bvec4(";
+					this->ToOperands(out, *insn.ops[1], oit);
+					out << ")";
+				}
+				out << ") * vec4(";
+				if (op2_is_float)
+				{
+					this->ToOperands(out, *insn.ops[2], SIT_Float);
+				}
+				else
+				{
+					out << "bvec4(";
+					this->ToOperands(out, *insn.ops[2], oit);
+					out << ")";
+				}
+				out << ")";
+			}
+			else
+			{
+				oot = SIT_Int;
+				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+				out << " = ivec4(";
+				if (glsl_rules_ & GSR_BitwiseOp)
+				{
+					out << "ivec4(";
+					this->ToOperands(out, *insn.ops[1], SIT_Int);
+					out << ") & ivec4(";
+					this->ToOperands(out, *insn.ops[2], SIT_Int);
+					out << ")";
+				}
+				else
+				{
+					out << "bool(";
+					this->ToOperands(out, *insn.ops[1], oit);
+					out << ") && bool(";
+					this->ToOperands(out, *insn.ops[2], oit);
+					out << ")";
+				}
+			}
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
 		break;
 
-	case SO_BFREV:
-		//bfrev dest,src0
-		//reverse bits of src0
-		//dest.mask = bitfieldReverse(src0).mask;
+	case SO_OR:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(bitfieldReverse(uvec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")))";
+		out << " = ivec4(";
+		if (glsl_rules_ & GSR_BitwiseOp)
+		{
+			out << "ivec4(";
+			this->ToOperands(out, *insn.ops[1], SIT_Int);
+			out << ") | ivec4(";
+			this->ToOperands(out, *insn.ops[2], SIT_Int);
+			out << ")";
+		}
+		else
+		{
+			out << "bool(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ") || bool(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")";
+		}
+		out << ")";
 		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << " ;";
+		out << ";";
 		break;
 
-	case SO_UBFE:
-		//ubfe dest,src0,src1,src2
-		//Given a range of bits in a number, shift those bits to the LSB and set remaining bits to 0.
-		//dest : Contains the results of the instruction.
-		//src0 : The LSB 5 bits provide the bitfield width (0-31).
-		//src1 : The LSB 5 bits of src1 provide the bitfield offset (0-31).
-		//src2 : The number to shift.
-		//set all bits of dest to zero
-		//dest.mask = uvec4(0x00000000).mask;
-		//dest.mask = bitfieldExtract(src2,src1,src0).mask;
+	case SO_XOR:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(0x00000000)";
+		out << " = ivec4(ivec4(";
+		this->ToOperands(out, *insn.ops[1], SIT_Int);
+		out << ") ^ ivec4(";
+		this->ToOperands(out, *insn.ops[2], SIT_Int);
+		out << "))";
 		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";\n";
+		out << ";";
+		break;
+
+	case SO_NOT:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(bitfieldExtract(uvec4(";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << "), int(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << "),int(";
+		out << " = ivec4(";
+		if (glsl_rules_ & GSR_BitwiseOp)
+		{
+			out << "~i";
+		}
+		else
+		{
+			out << "not(b";
+		}
+		out << "vec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
-		out << ")))";
+		out << "))";
+		if (!(glsl_rules_ & GSR_BitwiseOp))
+		{
+			out << ")";
+		}
 		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << " ;";
+		out << ";";
 		break;
 
-	case SO_IBFE:
-		//set all bits of dest to zero
-		//dest.mask= uvec4(0x00000000).mask;
-		//dest.mask= bitfieldExtract(src2,src1,src0).mask;
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(0x00000000)";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";\n";
+	case SO_MOVC:
+		if (SOT_OUTPUT == insn.ops[0]->type)
+		{
+			oot = this->OperandAsType(*insn.ops[0], oit);
+			oit = oot;
+		}
+		else
+		{
+			oot = std::max(this->OperandAsType(*insn.ops[2], oit), this->OperandAsType(*insn.ops[3], oit));
+			oit = oot;
+		}
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		if ((num_comps > 1) && (glsl_rules_ & GSR_BooleanMix)
+			&& ((SIT_Float == oot) || ((glsl_rules_ & GSR_IntegerMix) && ((SIT_Int == oot) || (SIT_UInt == oot)))))
+		{
+			// One component-wise select, mix(b, a, bvec4(cond)), instead of a ternary per component
+			char const * vec_type;
+			if (SIT_Float == oot)
+			{
+				vec_type = "vec4";
+			}
+			else if ((SIT_UInt == oot) && (glsl_rules_ & GSR_UIntType))
+			{
+				vec_type = "uvec4";
+			}
+			else
+			{
+				vec_type = "ivec4";
+			}
+
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = " << vec_type << "(mix(" << vec_type << "(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << "), " << vec_type << "(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "), bvec4(";
+			this->ToOperands(out, *insn.ops[1], this->OperandAsType(*insn.ops[1], oit));
+			out << ")))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+			break;
+		}
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			selector[i] = this->ToSingleComponentSelector(out, *insn.ops[0], i, 0 == i);
+		}
+		out << " = ";
+		if (num_comps > 1)
+		{
+			out << "vec" << num_comps << "(";
+		}
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			if (i != 0)
+			{
+				out << ", ";
+			}
+
+			out << "bool(";
+			this->ToOperands(out, *insn.ops[1], this->OperandAsType(*insn.ops[1], oit), false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], selector[i]);
+			out << ")";
+			out << " ? ";
+			this->ToOperands(out, *insn.ops[2], oit, false, false, true);
+			this->ToSingleComponentSelector(out, *insn.ops[2], selector[i]);
+			out << " : ";
+			this->ToOperands(out, *insn.ops[3], oit, false, false, true);
+			this->ToSingleComponentSelector(out, *insn.ops[3], selector[i]);
+		}
+		if (num_comps > 1)
+		{
+			out << ")";
+		}
+		out << ";";
+		break;
+
+	case SO_MAX:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(bitfieldExtract(ivec4(";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << "), int(";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << "), int(";
+		out << " = vec4(max(vec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
+		out << "), vec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
 		out << ")))";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_FIRSTBIT_LO:
-		//dest.mask =findLSB(src0).mask;
+	case SO_IMAX:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(findLSB(uvec4(";
+		out << " = ivec4(max(ivec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
+		out << "), ivec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
 		out << ")))";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_FIRSTBIT_HI:
-		//dest.mask = findMSB(src0).mask;
+	case SO_UMAX:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(findMSB(uvec4(";
-		this->ToOperands(out, *insn.ops[1], oit);
+		out << " = ";
+		if (glsl_rules_ & GSR_UIntType)
+		{
+			out << "uvec4(max(uvec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), uvec4(";
+		}
+		else
+		{
+			out << "ivec4(max(ivec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), ivec4(";
+		}
+		this->ToOperands(out, *insn.ops[2], oit);
 		out << ")))";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_FIRSTBIT_SHI:
-		//dest.mask =findMSB(src0).mask;
+	case SO_MIN:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ivec4(findMSB(ivec4(";
+		out << " = vec4(min(vec4(";
 		this->ToOperands(out, *insn.ops[1], oit);
+		out << "), vec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
 		out << ")))";
 		this->ToComponentSelectors(out, *insn.ops[0]);
 		out << ";";
 		break;
 
-	case SO_F16TOF32:
-		//获取dest mask的个数
-		//for each select component
-		//dest.select_component=unpackHalf2x16(bitfieldExtract(src.select_component,0,16)).x;
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
-		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = unpackHalf2x16(bitfieldExtract(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i);
-			out << ",0,16)).x;";
-			if (i < num_comps - 1)
-			{
-				out << "\n";
-			}
-		}
-		break;
-
-	case SO_F32TOF16:
-		//获取dest mask的个数
-		//for each component
-		//dest.select_component=bitfieldExtract(packHalf2x16(vec2(src.comp)),0,16);
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
-		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = bitfieldExtract(packHalf2x16(vec2(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i);
-			out << ")),0,16);";
-			if (i < num_comps - 1)
-			{
-				out << "\n";
-			}
-		}
+	case SO_IMIN:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(min(ivec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "), ivec4(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-		//----------------------------------------------------------------------------
-		//flow control instructions
-		//------------------------------------------------------------------------------
-
-	case SO_RET:
-		if (ST_HS != shader_type_)
-		{
-			this->ToCopyToInterShaderOutputRecords(out);
-			out << "return;\n";
-		}
-		else if (enter_hs_fork_phase_ || enter_hs_join_phase_)
+	case SO_UMIN:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ";
+		if (glsl_rules_ & GSR_UIntType)
 		{
-			if (enter_final_hs_fork_phase_ || enter_final_hs_join_phase_)
-			{
-				this->ToCopyToInterShaderPatchConstantRecords(out);
-				out << "return;\n";
-			}
+			out << "uvec4(min(uvec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), uvec4(";
 		}
 		else
 		{
-			this->ToCopyToInterShaderOutputRecords(out);
+			out << "ivec4(min(ivec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << "), ivec4(";
 		}
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_NOP:
-		break;
-
-	case SO_LOOP:
-		out << "while(true)\n";
-		out << "{";
-		break;
-
-	case SO_ENDLOOP:
-		out << "}";
-		break;
-
-	case SO_BREAK:
-		out << "break;";
+	case SO_FTOI:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_CONTINUE:
-		out << "continue;";
+	case SO_ITOF:
+	case SO_UTOF:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_SWITCH:
-		out << "switch(";
+	case SO_FTOU:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << ")\n{";
+		out << " = ";
+		if (glsl_rules_ & GSR_UIntType)
+		{
+			out << "u";
+		}
+		else
+		{
+			out << "i";
+		}
+		out << "vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_DEFAULT:
-		out << "default:";
+	case SO_ROUND_NI:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(floor(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_ENDSWITCH:
-		out << "}";
+	case SO_ROUND_PI:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(ceil(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_CASE:
-		out << "case ";
+	case SO_ROUND_NE:
 		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " :";
+		out << " = vec4(roundEven(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_BREAKC:
-		//break if any bit is nonzero
-		if (insn.insn.test_nz)
+	case SO_ROUND_Z:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		num_comps = this->GetOperandComponentNum(*insn.ops[1]);
+		out << " = vec4(";
+		if (1 == num_comps)
 		{
-			out << "if (bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))break;";
+			out << "int";
 		}
-		else//if all bits are zero
+		else
 		{
-			out << "if (!bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))break;";
+			out << "ivec" << num_comps;
 		}
+		out << "(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_IF:
-		//if any bit is nonzero
-		if (insn.insn.test_nz)
+	case SO_SINCOS:
+		if (insn.ops[0]->type != SOT_NULL)
 		{
-			out << "if (bool(";
 			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))\n{";
+			out << " = vec4(sin(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
 		}
-		else//if all bits are zero
+		if (insn.ops[1]->type != SOT_NULL)
 		{
-			out << "if (!bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))\n{";
+			if (insn.ops[0]->type != SOT_NULL)
+			{
+				out << "\n";
+			}
+			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+			out << " = vec4(cos(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[1]);
+			out << ";";
 		}
 		break;
 
-	case SO_ENDIF:
-		out << "}";
+	case SO_RCP:
+		// TODO: need more test
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(1.0f / ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_ELSE:
-		out << "}\nelse\n{";
-		break;
+	case SO_SWAPC:
+		// swapc 0dest0 1dest1 2src0 3src1 4src2
+		// can be converted to following two instructions:
+		// movc dest0 src0 src2 src1
+		// movc dest1 src0 src1 src2
 
-	case SO_CONTINUEC:
-		//continue if any bit is nonzero
-		if (insn.insn.test_nz)
+		// First movc
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
 		{
-			out << "if (bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))continue;";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			int j = this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = bool(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], j);
+			out << ") ? ";
+			this->ToOperands(out, *insn.ops[4], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[4], j);
+			out << " : ";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[3], j);
+			out << ";";
+			if (i != num_comps - 1)
+			{
+				out << "\n";
+			}
 		}
-		else//continue if all bits are zero
+		// Second movc
+		num_comps = this->GetOperandComponentNum(*insn.ops[1]);
+		for (int i = 0; i < num_comps; ++ i)
 		{
-			out << "if (!bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))continue;";
-		}
-		break;
-
-	case SO_RETC:
-		//return if any bit is nonzero
-		if (insn.insn.test_nz)
+			this->ToOperands(out, *insn.ops[1], oot | (oot << 8), false);
+			int j = this->ToSingleComponentSelector(out, *insn.ops[1], i);
+			out << " = bool(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], j);
+			out << ") ? ";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[3], j);
+			out << " : ";
+			this->ToOperands(out, *insn.ops[4], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[4], j);
+			out << ";";
+			if (i != num_comps - 1)
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+		//-------------------------------------------------------------------------------------
+		//integer instructions
+		//---------------------------------------------------------------------------------------
+
+	case SO_INEG:
+		// TODO: to be tested,is that true?
+		// dest.mask = ivec4(-src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(-";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_ISHL:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(ivec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ") ";
+		if (glsl_rules_ & GSR_BitwiseOp)
 		{
-			out << "if (bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))return;";
+			out << "<< ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")";
 		}
-		else//return if all bits are zero
+		else
 		{
-			out << "if (!bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))return;";
+			out << "* ivec4(pow(vec4(2), vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")))";
 		}
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_DISCARD:
-		if (insn.insn.test_nz)
+	case SO_ISHR:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(ivec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ") ";
+		if (glsl_rules_ & GSR_BitwiseOp)
 		{
-			// Discard if any bit is none zero
-			out << "if (bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))discard;";
+			out << ">> ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")";
 		}
 		else
 		{
-			// Discard if all bits are zero
-			out << "if (!bool(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << "))discard;";
+			out << "/ ivec4(pow(vec4(2), vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")))";
 		}
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_CALL:
-	case SO_CALLC:
-		// TODO: l# #=?
-		// to be tested, not sure where to get #
+	case SO_IMUL:
+		//imul destHI[.mask], destLO[.mask], [-]src0[.swizzle], [-]src1[.swizzle]
+		if (((insn.ops[0]->type != SOT_NULL) && (insn.ops[1]->type != SOT_NULL))
+			&& (glsl_rules_ & GSR_Int64Type))
 		{
-			uint32_t label_value;
-			if (SO_CALLC == insn.opcode)
-			{
-				label_value = static_cast<uint32_t>(insn.ops[1]->imm_values[0].u32);
-				if (insn.insn.test_nz)
-				{
-					out << "if (bool(";
-					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-					out << ")){\n";
-				}
-				else// if all bits are zero
-				{
-					out << "if (!bool(";
-					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-					out << ")){\n";
-				}
-			}
-			else
-			{
-				label_value = static_cast<uint32_t>(insn.ops[0]->imm_values[0].u32);
-			}
-			for (uint32_t i = label_to_insn_num_[label_value].start_num; i < label_to_insn_num_[label_value].end_num; ++ i)
+			out << "imulExtended(ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "), ivec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << ")";
+			out << ", ";
+			out << "iTempX[0]";
+			out << ", ";
+			out << "iTempX[1]";
+			out << ");\n";
+
+			//destHI.xz=vec4(destHI).xz;
+			if (insn.ops[0]->type != SOT_NULL)
 			{
-				this->ToInstruction(out, *program_->insns[i]);
+				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+				out << " = iTempX[0]";
+				this->ToComponentSelectors(out, *insn.ops[0]);
+				out << ";";
 			}
-			if (SO_CALLC == insn.opcode)
+			//destLO.xz=vec4(destLO).xz;
+			if (insn.ops[1]->type != SOT_NULL)
 			{
-				out << "\n}";
+				if (insn.ops[0]->type != SOT_NULL)
+				{
+					out << "\n";
+				}
+				this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+				out << " = iTempX[1]";
+				this->ToComponentSelectors(out, *insn.ops[1]);
+				out << ";";
 			}
 		}
-		break;
-
-		//memory barrier and synchronization
-	case SO_SYNC:
-		if(insn.sync.uav_global)
-		{
-			out << "memoryBarrier();\n";
-		}
-		if(insn.sync.uav_group)
-		{
-			out << "groupMemoryBarrier();\n";
-		}
-		if(insn.sync.shared_memory)
-		{
-			out << "memoryBarrierShared();\n";
-		}
-		if(insn.sync.threads_in_group)
+		else
 		{
-			out << "barrier();";
+			assert(((SOT_NULL == insn.ops[0]->type) && (insn.ops[1]->type != SOT_NULL))
+				|| !(glsl_rules_ & GSR_Int64Type));
+
+			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+			out << " = ivec4(ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ") * ivec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[1]);
+			out << ";";
 		}
 		break;
 
-		//----------------------------------------------------------------------------------------
-		//double instructions
-		//----------------------------------------------------------------------------------------
+		//--------------------------------------------------------------------------------------
+		// unsigned integer instructions
+		//---------------------------------------------------------------------------------------
 
-	case SO_FTOD:
-		//ftod dest.mask src0.swwizle swwizle can only be xy or x or y
-		//获取mask的个数，只能为2或4（xy zw xyzw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
-		for (int i = 0; i < num_comps; ++ i)
+	case SO_UADDC:
+		// gl:uaddCarry(x,y,out carry)
+		// uaddc dest0[.mask], dest1[.mask], src0[.swizzle], src1[.swizzle]
+		// dest0.xz=uaddCarry(src0.xxxx,src1.xxxx,dest1).xz;
+		// TODO: to be tested
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(uaddCarry(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		if (insn.ops[1]->type != SOT_NULL)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-			out << "= uintBitsToFloat(unpackDouble2x32(double(";
+			out << ", ";
 			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i);
-			out << ")));";
-			if ((2 == num_comps) && (0 == i))
-			{
-				out << "\n";
-			}
 		}
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		////dest1.xz=uvec4(dest1).xz;
+		//if (sm_shortfile_names[insn.ops[1]->file] != "null")
+		//{
+		//	out<<"\n";
+		//	this->ToOperands(out,*insn.ops[1],oit);
+		//	out<<" = uvec4(";
+		//	this->ToOperands(out,*insn.ops[1],oit,false);
+		//	out<<")";
+		//	this->ToComponentSelectors(out,*insn.ops[0]);
+		//	out<<";";
+		//}
 		break;
 
-	case SO_DTOF:
-		//获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
+	case SO_UDIV:
+		//dest0.mask= uvec4(src0 / src1).mask;
+		//dest1 = uvec4(src0 % src1).mask;
+		if (insn.ops[0]->type != SOT_NULL)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << "= float(packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")));";
-			if ((2 == num_comps) && (0 == i))
-			{
-				out << "\n";
-			}
-		}
-		break;
-
-	case SO_DADD:
-		// TODO: to be tested
-		// dest mask: xy zw xyzw, 2 or 4
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
-		for (int i = 0; i < num_comps; ++ i)
-		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-			out << "= uintBitsToFloat(unpackDouble2x32(packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")) + packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << "))));";
-			if ((2 == num_comps) && (0 == i))
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ivec4(ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ") / ivec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		if (insn.ops[1]->type != SOT_NULL)
+		{
+			if (insn.ops[0]->type != SOT_NULL)
 			{
 				out << "\n";
 			}
+			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+			out << " = ivec4(ivec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ") % ivec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[1]);
+			out << ";";
 		}
 		break;
 
-	case SO_DMOV:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ";";
-		break;
-
-	case SO_DMOVC:
+	case SO_UMUL:
+		//umul destHI[.mask], destLO[.mask], src0[.swizzle], src1[.swizzle]
+		//umulExtended(src0.xxxx,src1.xxxx,destHI,destLO);
 		// TODO: to be tested
-		// 获取dest mask的个数，只能为2或4（xy zw xyzw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
-		for (int i = 0; i < num_comps; ++ i)
+		if (((insn.ops[0]->type != SOT_NULL) && (insn.ops[1]->type != SOT_NULL))
+			&& (glsl_rules_ & GSR_Int64Type))
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-			out << " = ";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i);
-			out << " ? ";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << " : ";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[3], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[3], i * 2 + 1, false);
-			if ((2 == num_comps) && (0 == i))
+			out << "umulExtended(uvec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << "), uvec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << ")";
+			out << ", ";
+			out << "uTempX[0]";
+			out << ", ";
+			out << "uTempX[1]";
+			out << ");";
+
+			//destHI.xz=vec4(destHI).xz;
+			if (insn.ops[0]->type != SOT_NULL)
 			{
 				out << "\n";
+				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+				out << " = uTempX[0]";
+				this->ToComponentSelectors(out, *insn.ops[0]);
+				out << ";";
+			}
+			//destLO.xz=vec4(destLO).xz;
+			if (insn.ops[1]->type != SOT_NULL)
+			{
+				if (insn.ops[0]->type != SOT_NULL)
+				{
+					out << "\n";
+				}
+				this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+				out << " = uTempX[1]";
+				this->ToComponentSelectors(out, *insn.ops[1]);
+				out << ";";
 			}
 		}
-		break;
-
-	case SO_DLT:
-		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
+		else
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")) < ";
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << "));\n";
-			this->ToOperands(out, *insn.ops[0], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = ";
-			this->ToOperands(out, *insn.ops[0], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
-			if ((2 == num_comps) && (0 == i))
+			assert(((SOT_NULL == insn.ops[0]->type) && (insn.ops[1]->type != SOT_NULL))
+				|| !(glsl_rules_ & GSR_Int64Type));
+
+			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+			out << " = ivec4(";
+			if (glsl_rules_ & GSR_UIntType)
 			{
-				out << "\n";
+				out << "u";
+			}
+			else
+			{
+				out << "i";
+			}
+			out << "vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ") * ";
+			if (glsl_rules_ & GSR_UIntType)
+			{
+				out << "u";
+			}
+			else
+			{
+				out << "i";
 			}
+			out << "vec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[1]);
+			out << ";";
 		}
 		break;
 
-	case SO_DGE:
-		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
+	case SO_USHR:
+		//dest.mask = uvec4(src0 >> src1).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(";
+		if (glsl_rules_ & GSR_UIntType)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")) >= ";
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << "));\n";
-			this->ToOperands(out, *insn.ops[0], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = ";
-			this->ToOperands(out, *insn.ops[0], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
-			if ((2 == num_comps) && (0 == i))
+			out << "u";
+		}
+		else
+		{
+			out << "i";
+		}
+		out << "vec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ") ";
+		if (glsl_rules_ & GSR_BitwiseOp)
+		{
+			out << ">> ";
+			if (glsl_rules_ & GSR_UIntType)
 			{
-				out << "\n";
+				out << "u";
 			}
+			else
+			{
+				out << "i";
+			}
+			out << "vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")";
 		}
-		break;
-
-	case SO_DEQ:
-		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
+		else
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")) == ";
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << "));\n";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = ";
-			this->ToOperands(out, *insn.ops[0], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
-			if ((2 == num_comps) && (0 == i))
+			out << "/ ";
+			if (glsl_rules_ & GSR_UIntType)
 			{
-				out << "\n";
+				out << "u";
+			}
+			else
+			{
+				out << "i";
 			}
+			out << "vec4(pow(vec4(2), vec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ")))";
 		}
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
 		break;
 
-	case SO_DNE:
-		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
-		for (int i = 0; i < num_comps; ++ i)
+	case SO_USUBB:
+		//usubb result borrow src0 src1
+		//result.xz=uvec4(usubBorrow(src0,src1,borrow)).xz;
+		//差为负数时存在问题，见hlsl msdn 
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		if (insn.ops[1]->type != SOT_NULL)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")) != ";
-			out << " = packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << "));\n";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " = ";
-			this->ToOperands(out, *insn.ops[0], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i);
-			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
-			if ((2 == num_comps) && (0 == i))
-			{
-				out << "\n";
-			}
+			out << " = ivec4(usubBorrow(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ", ";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << ", ";
+			out << "uTempX[0]";
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+
+			//borrow.xz=vec4(borrow).xz;
+			this->ToOperands(out, *insn.ops[1], oot | (oot << 8));
+			out << " = uTempX[0]";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		else
+		{
+			out << " = ivec4(uvec4(";
+			this->ToOperands(out, *insn.ops[2], oit);
+			out << ") - uvec4(";
+			this->ToOperands(out, *insn.ops[3], oit);
+			out << "))";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
 		}
 		break;
 
-	case SO_DMAX:
-		// 获取dest mask的个数，只能为2或4（xy zw xyzw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		//---------------------------------------------------------------------------
+		//bit instructions
+		//----------------------------------------------------------------------------
+
+	case SO_COUNTBITS:
+		//the number of bits set in src0
+		//dest.mask= uvec4(bitCount(src0)).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(bitCount(uvec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_BFI:
+		//bfi dest, src0, src1, src2, src3
+		//dest : The address of the results.
+		//src0 : The bitfield width to take from src2.
+		//src1 : The bitfield offset for replacing bits in src3
+		//src2 : The number the bits are taken from.
+		//src3 : The number with bits to be replaced
+		//this instruction is used for packing integers or flags
+		//dest.mask = bitfieldInsert(uvec4(src3),uvec4(src2),int(src1),int(src0)).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(bitfieldInsert(uvec4(";
+		this->ToOperands(out, *insn.ops[4], oit);
+		out << "), uvec4(";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << "), int(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << "), int(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_BFREV:
+		//bfrev dest,src0
+		//reverse bits of src0
+		//dest.mask = bitfieldReverse(src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(bitfieldReverse(uvec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << " ;";
+		break;
+
+	case SO_UBFE:
+		//ubfe dest,src0,src1,src2
+		//Given a range of bits in a number, shift those bits to the LSB and set remaining bits to 0.
+		//dest : Contains the results of the instruction.
+		//src0 : The LSB 5 bits provide the bitfield width (0-31).
+		//src1 : The LSB 5 bits of src1 provide the bitfield offset (0-31).
+		//src2 : The number to shift.
+		//set all bits of dest to zero
+		//dest.mask = uvec4(0x00000000).mask;
+		//dest.mask = bitfieldExtract(src2,src1,src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(0x00000000)";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";\n";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(bitfieldExtract(uvec4(";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << "), int(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << "),int(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << " ;";
+		break;
+
+	case SO_IBFE:
+		//set all bits of dest to zero
+		//dest.mask= uvec4(0x00000000).mask;
+		//dest.mask= bitfieldExtract(src2,src1,src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(0x00000000)";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";\n";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(bitfieldExtract(ivec4(";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << "), int(";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << "), int(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_FIRSTBIT_LO:
+		//dest.mask =findLSB(src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(findLSB(uvec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_FIRSTBIT_HI:
+		//dest.mask = findMSB(src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(findMSB(uvec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_FIRSTBIT_SHI:
+		//dest.mask =findMSB(src0).mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ivec4(findMSB(ivec4(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ")))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_F16TOF32:
+		//获取dest mask的个数
+		//for each select component
+		//dest.select_component=unpackHalf2x16(bitfieldExtract(src.select_component,0,16)).x;
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
 		for (int i = 0; i < num_comps; ++ i)
 		{
 			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-			out << " = uintBitsToFloat(unpackDouble2x32(max(packDouble2x32(floatBitsToUint(";
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = unpackHalf2x16(bitfieldExtract(";
 			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")), ";
-			out << "packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << ")))));";
-			if ((2 == num_comps) && (0 == i))
+			this->ToSingleComponentSelector(out, *insn.ops[1], i);
+			out << ",0,16)).x;";
+			if (i < num_comps - 1)
 			{
 				out << "\n";
 			}
 		}
 		break;
 
-	case SO_DMIN:
-		// 获取dest mask的个数，只能为2或4（xy zw xyzw)
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+	case SO_F32TOF16:
+		//获取dest mask的个数
+		//for each component
+		//dest.select_component=bitfieldExtract(packHalf2x16(vec2(src.comp)),0,16);
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
 		for (int i = 0; i < num_comps; ++ i)
 		{
 			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-			out << " = uintBitsToFloat(unpackDouble2x32(min(packDouble2x32(floatBitsToUint(";
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = bitfieldExtract(packHalf2x16(vec2(";
 			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")), ";
-			out << "packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << ")))));";
-			if ((2 == num_comps) && (0 == i))
+			this->ToSingleComponentSelector(out, *insn.ops[1], i);
+			out << ")),0,16);";
+			if (i < num_comps - 1)
 			{
 				out << "\n";
 			}
 		}
 		break;
 
-	case SO_DMUL:
-		// dest mask:xy zw xyzw 个数2或4
-		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
-		for (int i = 0; i < num_comps; ++ i)
+		//----------------------------------------------------------------------------
+		//flow control instructions
+		//------------------------------------------------------------------------------
+
+	case SO_RET:
+		if (ST_HS != shader_type_)
 		{
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-			out << "= uintBitsToFloat(unpackDouble2x32(packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[1], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
-			out << ")) * packDouble2x32(floatBitsToUint(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
-			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
-			out << "))));";
-			if ((2 == num_comps) && (0 == i))
+			this->ToCopyToInterShaderOutputRecords(out);
+			out << "return;\n";
+		}
+		else if (enter_hs_fork_phase_ || enter_hs_join_phase_)
+		{
+			// With hs_fork_invocations_ the records are copied after the last barrier() instead
+			if ((enter_final_hs_fork_phase_ || enter_final_hs_join_phase_) && !hs_fork_invocations_)
 			{
-				out << "\n";
+				this->ToCopyToInterShaderPatchConstantRecords(out);
+				out << "return;\n";
 			}
 		}
+		else
+		{
+			this->ToCopyToInterShaderOutputRecords(out);
+		}
 		break;
 
-		//following three instrucions:dfma ddiv drcp need special conditions(all met):
-		//The system supports DirectX 11.1.
-		//The system includes a WDDM 1.2 driver.
-		//The driver reports support for this instruction via D3D11_FEATURE_DATA_D3D11_OPTIONS.ExtendedDoublesShaderInstructions set to TRUE.
-		//see http://msdn.microsoft.com/en-us/library/hh920927(v=vs.85).aspx
-		//case SO_DRCP:
-		//break;
-
-		//----------------------------------------------------------------------------
-		//PS instructions
-		//----------------------------------------------------------------------------
+	case SO_NOP:
+		break;
 
-	case SO_RESINFO:
-		//resinfo[_uint|_rcpFloat] dest[.mask], srcMipLevel.select_component, srcResource[.swizzle]
-		{
-			//ignore _uint suffix
-			//process _rcpFloat suffix
-			for (auto const & tex : textures_)
-			{
-				if (tex.tex_index == insn.ops[2]->indices[0].disp)
-				{
-					std::string s;
-					if (!tex.samplers.empty())
-					{
-						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
-						s = std::string("_") + desc.name;
-					}
-					switch (insn.resource_target)
-					{
-					case SRD_TEXTURE1D:
-						//dest.x=float(textureSize(src0,src1).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ");";
-						if (this->GetOperandComponentNum(*insn.ops[0]) == 2)
-						{
-							out << "\n";
-							//dest.y=float(textureQueryLevels(src1));
-							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-							this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-							out << " = float(textureQueryLevels(";
-							this->ToOperands(out, *insn.ops[2], oit, false);
-							out << s;
-							out << "));";
-						}
-						break;
+	case SO_LOOP:
+		out << "while(true)\n";
+		out << "{";
+		break;
 
-					case SRD_TEXTURE2D:
-						//dest.x=float(textureSize(src0,src1).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0,src1).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";";
-						if (3 == this->GetOperandComponentNum(*insn.ops[0]))
-						{
-							out << "\n";
-							//dest.z=float(textureQueryLevels(src1));
-							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-							this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-							out << " = float(textureQueryLevels(";
-							this->ToOperands(out, *insn.ops[2], oit, false);
-							out << s;
-							out << "));";
-						}
-						break;
+	case SO_ENDLOOP:
+		out << "}";
+		break;
 
-					case SRD_TEXTURE2DMS:
-						//dest.x=float(textureSize(src0).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";";
-						break;
+	case SO_BREAK:
+		out << "break;";
+		break;
 
-					case SRD_TEXTURE3D:
-						//dest.x=float(textureSize(src0,src1).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0,src1).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.z=float(textureSize(src0,src1).z);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";";
-						if (4 == this->GetOperandComponentNum(*insn.ops[0]))
-						{
-							out << "\n";
-							//dest.w=float(textureQueryLevels(src1));
-							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-							this->ToSingleComponentSelector(out, *insn.ops[0], 3);
-							out << " = float(textureQueryLevels(";
-							this->ToOperands(out, *insn.ops[2], oit, false);
-							out << s;
-							out << "));";
-						}
-						break;
+	case SO_CONTINUE:
+		out << "continue;";
+		break;
 
-					case SRD_TEXTURECUBE:
-						//dest.x=float(textureSize(src0,src1).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0,src1).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
+	case SO_SWITCH:
+		out << "switch(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << ")\n{";
+		break;
+
+	case SO_DEFAULT:
+		out << "default:";
+		break;
+
+	case SO_ENDSWITCH:
+		out << "}";
+		break;
+
+	case SO_CASE:
+		out << "case ";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " :";
+		break;
+
+	case SO_BREAKC:
+		//break if any bit is nonzero
+		if (insn.insn.test_nz)
+		{
+			out << "if (bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))break;";
+		}
+		else//if all bits are zero
+		{
+			out << "if (!bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))break;";
+		}
+		break;
+
+	case SO_IF:
+		//if any bit is nonzero
+		if (insn.insn.test_nz)
+		{
+			out << "if (bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))\n{";
+		}
+		else//if all bits are zero
+		{
+			out << "if (!bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))\n{";
+		}
+		break;
+
+	case SO_ENDIF:
+		out << "}";
+		break;
+
+	case SO_ELSE:
+		out << "}\nelse\n{";
+		break;
+
+	case SO_CONTINUEC:
+		//continue if any bit is nonzero
+		if (insn.insn.test_nz)
+		{
+			out << "if (bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))continue;";
+		}
+		else//continue if all bits are zero
+		{
+			out << "if (!bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))continue;";
+		}
+		break;
+
+	case SO_RETC:
+		//return if any bit is nonzero
+		if (insn.insn.test_nz)
+		{
+			out << "if (bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))return;";
+		}
+		else//return if all bits are zero
+		{
+			out << "if (!bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))return;";
+		}
+		break;
+
+	case SO_DISCARD:
+		if (insn.insn.test_nz)
+		{
+			// Discard if any bit is none zero
+			out << "if (bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))discard;";
+		}
+		else
+		{
+			// Discard if all bits are zero
+			out << "if (!bool(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << "))discard;";
+		}
+		break;
+
+	case SO_CALL:
+	case SO_CALLC:
+		// TODO: l# #=?
+		// to be tested, not sure where to get #
+		{
+			uint32_t label_value;
+			if (SO_CALLC == insn.opcode)
+			{
+				label_value = static_cast<uint32_t>(insn.ops[1]->imm_values[0].u32);
+				if (insn.insn.test_nz)
+				{
+					out << "if (bool(";
+					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+					out << ")){\n";
+				}
+				else// if all bits are zero
+				{
+					out << "if (!bool(";
+					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+					out << ")){\n";
+				}
+			}
+			else
+			{
+				label_value = static_cast<uint32_t>(insn.ops[0]->imm_values[0].u32);
+			}
+			for (uint32_t i = label_to_insn_num_[label_value].start_num; i < label_to_insn_num_[label_value].end_num; ++ i)
+			{
+				this->ToInstruction(out, *program_->insns[i]);
+			}
+			if (SO_CALLC == insn.opcode)
+			{
+				out << "\n}";
+			}
+		}
+		break;
+
+		//memory barrier and synchronization
+	case SO_SYNC:
+		if(insn.sync.uav_global)
+		{
+			out << "memoryBarrier();\n";
+		}
+		if(insn.sync.uav_group)
+		{
+			out << "groupMemoryBarrier();\n";
+		}
+		if(insn.sync.shared_memory)
+		{
+			out << "memoryBarrierShared();\n";
+		}
+		if(insn.sync.threads_in_group)
+		{
+			out << "barrier();";
+		}
+		break;
+
+		//----------------------------------------------------------------------------------------
+		//double instructions
+		//----------------------------------------------------------------------------------------
+
+	case SO_FTOD:
+		//ftod dest.mask src0.swwizle swwizle can only be xy or x or y
+		//获取mask的个数，只能为2或4（xy zw xyzw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+			out << "= uintBitsToFloat(unpackDouble2x32(double(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i);
+			out << ")));";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DTOF:
+		//获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << "= float(packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")));";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DADD:
+		// TODO: to be tested
+		// dest mask: xy zw xyzw, 2 or 4
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+			out << "= uintBitsToFloat(unpackDouble2x32(packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")) + packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << "))));";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DMOV:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ";";
+		break;
+
+	case SO_DMOVC:
+		// TODO: to be tested
+		// 获取dest mask的个数，只能为2或4（xy zw xyzw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+			out << " = ";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i);
+			out << " ? ";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << " : ";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[3], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[3], i * 2 + 1, false);
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DLT:
+		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")) < ";
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << "));\n";
+			this->ToOperands(out, *insn.ops[0], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = ";
+			this->ToOperands(out, *insn.ops[0], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DGE:
+		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")) >= ";
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << "));\n";
+			this->ToOperands(out, *insn.ops[0], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = ";
+			this->ToOperands(out, *insn.ops[0], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DEQ:
+		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")) == ";
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << "));\n";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = ";
+			this->ToOperands(out, *insn.ops[0], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DNE:
+		// 获取mask的个数，只能为1或2（x y z w xy zx xw yz yw zw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")) != ";
+			out << " = packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << "));\n";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " = ";
+			this->ToOperands(out, *insn.ops[0], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i);
+			out << " ? uintBitsToFloat(0xffffffff) : uintBitsToFloat(0x00000000)";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DMAX:
+		// 获取dest mask的个数，只能为2或4（xy zw xyzw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+			out << " = uintBitsToFloat(unpackDouble2x32(max(packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")), ";
+			out << "packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << ")))));";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DMIN:
+		// 获取dest mask的个数，只能为2或4（xy zw xyzw)
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+			out << " = uintBitsToFloat(unpackDouble2x32(min(packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")), ";
+			out << "packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << ")))));";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+	case SO_DMUL:
+		// dest mask:xy zw xyzw 个数2或4
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+			out << "= uintBitsToFloat(unpackDouble2x32(packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[1], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[1], i * 2 + 1, false);
+			out << ")) * packDouble2x32(floatBitsToUint(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i * 2 + 1, false);
+			out << "))));";
+			if ((2 == num_comps) && (0 == i))
+			{
+				out << "\n";
+			}
+		}
+		break;
+
+		//following three instrucions:dfma ddiv drcp need special conditions(all met):
+		//The system supports DirectX 11.1.
+		//The system includes a WDDM 1.2 driver.
+		//The driver reports support for this instruction via D3D11_FEATURE_DATA_D3D11_OPTIONS.ExtendedDoublesShaderInstructions set to TRUE.
+		//see http://msdn.microsoft.com/en-us/library/hh920927(v=vs.85).aspx
+		//case SO_DRCP:
+		//break;
+
+		//----------------------------------------------------------------------------
+		//PS instructions
+		//----------------------------------------------------------------------------
+
+	case SO_RESINFO:
+		//resinfo[_uint|_rcpFloat] dest[.mask], srcMipLevel.select_component, srcResource[.swizzle]
+		{
+			//ignore _uint suffix
+			//process _rcpFloat suffix
+			for (auto const & tex : textures_)
+			{
+				if (tex.tex_index == insn.ops[2]->indices[0].disp)
+				{
+					std::string s;
+					if (!tex.samplers.empty())
+					{
+						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
+						s = std::string("_") + desc.name;
+					}
+					switch (insn.resource_target)
+					{
+					case SRD_TEXTURE1D:
+						//dest.x=float(textureSize(src0,src1).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ");";
+						if (this->GetOperandComponentNum(*insn.ops[0]) == 2)
+						{
+							out << "\n";
+							//dest.y=float(textureQueryLevels(src1));
+							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+							this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+							out << " = float(textureQueryLevels(";
+							this->ToOperands(out, *insn.ops[2], oit, false);
+							out << s;
+							out << "));";
+						}
+						break;
+
+					case SRD_TEXTURE2D:
+						//dest.x=float(textureSize(src0,src1).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0,src1).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";";
+						if (3 == this->GetOperandComponentNum(*insn.ops[0]))
+						{
+							out << "\n";
+							//dest.z=float(textureQueryLevels(src1));
+							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+							this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+							out << " = float(textureQueryLevels(";
+							this->ToOperands(out, *insn.ops[2], oit, false);
+							out << s;
+							out << "));";
+						}
+						break;
+
+					case SRD_TEXTURE2DMS:
+						//dest.x=float(textureSize(src0).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";";
+						break;
+
+					case SRD_TEXTURE3D:
+						//dest.x=float(textureSize(src0,src1).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0,src1).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.z=float(textureSize(src0,src1).z);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";";
+						if (4 == this->GetOperandComponentNum(*insn.ops[0]))
+						{
+							out << "\n";
+							//dest.w=float(textureQueryLevels(src1));
+							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+							this->ToSingleComponentSelector(out, *insn.ops[0], 3);
+							out << " = float(textureQueryLevels(";
+							this->ToOperands(out, *insn.ops[2], oit, false);
+							out << s;
+							out << "));";
+						}
+						break;
+
+					case SRD_TEXTURECUBE:
+						//dest.x=float(textureSize(src0,src1).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0,src1).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";";
+						if (3 == this->GetOperandComponentNum(*insn.ops[0]))
+						{
+							out << "\n";
+							//dest.z=float(textureQueryLevels(src1));
+							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+							this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+							out << " = float(textureQueryLevels(";
+							this->ToOperands(out, *insn.ops[2], oit, false);
+							out << s;
+							out << "));";
+						}
+						break;
+
+					case SRD_TEXTURE1DARRAY:
+						//dest.x=float(textureSize(src0,src1).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0,src1).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << " = textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << ";";
+						if (3 == this->GetOperandComponentNum(*insn.ops[0]))
+						{
+							out << "\n";
+							//dest.z=float(textureQueryLevels(src1));
+							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+							this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+							out << " = float(textureQueryLevels(";
+							this->ToOperands(out, *insn.ops[2], oit, false);
+							out << s;
+							out << "));";
+						}
+						break;
+
+					case SRD_TEXTURE2DARRAY:
+						//dest.x=float(textureSize(src0,src1).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0,src1).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
+						this->ToOperands(out, *insn.ops[1], oit);
+						out << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.z=float(textureSize(src0,src1).z);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+						out << " = textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s;
+						out << ", ";
 						this->ToOperands(out, *insn.ops[1], oit);
 						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
+						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
 						out << ";";
-						if (3 == this->GetOperandComponentNum(*insn.ops[0]))
+						if (4 == this->GetOperandComponentNum(*insn.ops[0]))
 						{
 							out << "\n";
-							//dest.z=float(textureQueryLevels(src1));
+							//dest.w=float(textureQueryLevels(src1));
 							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-							this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+							this->ToSingleComponentSelector(out, *insn.ops[0], 3);
 							out << " = float(textureQueryLevels(";
 							this->ToOperands(out, *insn.ops[2], oit, false);
 							out << s;
@@ -4098,223 +5355,929 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 						}
 						break;
 
+						//-----------------------------------------------------------------------------------------
+						//there seems to be problems with dx sdk reference about texture2dmsarray.getDimesnsions()
+						//the document says 
+						//void GetDimensions(
+						//out  UINT Width,
+						//out  UINT Height,
+						//out  UINT Elements,
+						//out  UINT NumberOfSamples
+						//);
+						//but according to assemble instructions,parameters should be width,height,samples,elements
+						//-------------------------------------------------------------------------------------------
+					case SRD_TEXTURE2DMSARRAY:
+						//dest.x=float(textureSize(src0).x);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.y=float(textureSize(src0).y);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						out << " = ";
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << "1.0 / float(";
+						}
+						out << "textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
+						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
+						{
+							out << ")";
+						}
+						out << ";\n";
+						//dest.z=float(textureSize(src0).z);
+						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+						out << " = textureSize(";
+						this->ToOperands(out, *insn.ops[2], oit, false);
+						out << s << ")";
+						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
+						out << ";";
+						break;
+
+						//SM5 does not support query element count of cube array
+						//case SRD_TEXTURECUBEARRAY:
+						//break;
+					default:
+						assert_msg(false, "Unexpected resource target type");
+						break;
+					}
+
+					break;
+				}
+			}
+		}
+		break;
+
+	case SO_SAMPLE_INFO:
+		//dest.mask=uint(textureSamples(src0));
+		for (auto const & tex : textures_)
+		{
+			if (tex.tex_index == insn.ops[0]->indices[0].disp)
+			{
+				std::string s;
+				if (!tex.samplers.empty())
+				{
+					DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
+					s = std::string("_") + desc.name;
+				}
+				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+				out << " = ";
+				if (glsl_rules_ & GSR_ExplicitMultiSample)
+				{
+					out << "uint(textureSamples(";
+					this->ToOperands(out, *insn.ops[1], oit, false);
+					out << s;
+					out << "))";
+				}
+				else
+				{
+					assert_msg(false, "for sampleinfo, there's no corresponding instruction in glsl 4.5-");
+					out << "1";
+				}
+				out << ";";
+
+				break;
+			}
+		}
+		break;
+
+	case SO_BUFINFO:
+		//dest.mask=uint(textureSize(src0));
+		{
+			for (auto const & tex : textures_)
+			{
+				if (tex.tex_index == insn.ops[0]->indices[0].disp)
+				{
+					std::string s;
+					if (!tex.samplers.empty())
+					{
+						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
+						s = std::string("_") + desc.name;
+					}
+					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+					out << " = uint(textureSize(";
+					this->ToOperands(out, *insn.ops[1], oit, false);
+					out << s;
+					out << "));";
+
+					break;
+				}
+			}
+		}
+		break;
+
+	case SO_SAMPLE:
+		//sample_indexable(0,0,0)(texture2d)(float,float,float,float) dest,src0(coord),src1(t),src2(s)
+		//dest.mask=textureOffset(src1,src0,offset).mask;
+		{
+			//cube and cubearray doesnt support tex-coord offset
+			char const * coord_mask = "";
+			char const * offset_mask = "";
+			char const * texture_type = "";
+			bool offset = true;
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				coord_mask = ".x";
+				offset_mask = ".x";
+				texture_type = "1D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2D:
+				coord_mask = ".xy";
+				offset_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURE3D:
+				coord_mask = ".xyz";
+				offset_mask = ".xyz";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0)
+					|| (insn.sample_offset[2] != 0);
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				coord_mask = ".xy";
+				offset_mask = ".x";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2DARRAY:
+				coord_mask = ".xyz";
+				offset_mask = ".xy";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURECUBE:
+				coord_mask = ".xyz";
+				texture_type = "Cube";
+				offset = false;
+				break;
+
+			case SRD_TEXTURECUBEARRAY:
+				coord_mask = ".xyzw";
+				offset = false;
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			oot = this->FindTextureReturnType(*insn.ops[2]);
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ";
+			switch (oot)
+			{
+			case SIT_UInt:
+			case SIT_Int:
+				out << "i";
+				break;
+
+			default:
+				break;
+			}
+			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
+				<< (offset ? "Offset" : "") << "(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			out << ", vec4(";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ")" << coord_mask;
+			if (offset)
+			{
+				out << ", ivec3(";
+				out << static_cast<int>(insn.sample_offset[0]) << ", "
+					<< static_cast<int>(insn.sample_offset[1]) << ", "
+					<< static_cast<int>(insn.sample_offset[2]) << ")";
+				out << offset_mask;
+			}
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[2]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_SAMPLE_B:
+		//sample_b_indexable(0,0,0)(texture2d)(float,float,float,float) dest,src0(coord),src1(t),src2(s),src3(bias)
+		//dest.mask=textureOffset(src1,src0,offset,src3).mask;
+		{
+			char const * coord_mask = "";
+			char const * offset_mask = "";
+			char const * texture_type = "";
+			bool offset = true;
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				coord_mask = ".x";
+				offset_mask = ".x";
+				texture_type = "1D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2D:
+				coord_mask = ".xy";
+				offset_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURE3D:
+				coord_mask = ".xyz";
+				offset_mask = ".xyz";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0)
+					|| (insn.sample_offset[2] != 0);
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				coord_mask = ".xy";
+				offset_mask = ".x";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2DARRAY:
+				coord_mask = ".xyz";
+				offset_mask = ".xy";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURECUBE:
+				coord_mask = ".xyz";
+				texture_type = "Cube";
+				offset = false;
+				break;
+
+			case SRD_TEXTURECUBEARRAY:
+				coord_mask = ".xyzw";
+				offset = false;
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			oot = this->FindTextureReturnType(*insn.ops[2]);
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ";
+			switch (oot)
+			{
+			case SIT_UInt:
+			case SIT_Int:
+				out << "i";
+				break;
+
+			default:
+				break;
+			}
+			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
+				<< (offset ? "Offset" : "") << "(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			out << ", (";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ")" << coord_mask;
+			if (offset)
+			{
+				out << ", ivec3(";
+				out << static_cast<int>(insn.sample_offset[0]) << ", "
+					<< static_cast<int>(insn.sample_offset[1]) << ", "
+					<< static_cast<int>(insn.sample_offset[2]) << ")";
+				out << offset_mask;
+			}
+			out << ", ";
+			this->ToOperands(out, *insn.ops[4], oit);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[2]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_SAMPLE_C:
+		{
+			char const * offset_mask = "";
+			char const * texture_type = "";
+			bool offset = true;
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				offset_mask = ".x";
+				texture_type = "1D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				offset_mask = ".x";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2D:
+				offset_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURE2DARRAY:
+				offset_mask = ".xy";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURECUBE:
+			case SRD_TEXTURECUBEARRAY:
+				texture_type = "Cube";
+				offset = false;
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			oot = this->FindTextureReturnType(*insn.ops[2]);
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ";
+			switch (oot)
+			{
+			case SIT_UInt:
+			case SIT_Int:
+				out << "i";
+				break;
+
+			default:
+				break;
+			}
+			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
+				<< (offset ? "Offset" : "") << "(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				out << ", vec3((";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ").x,0,";
+				this->ToOperands(out, *insn.ops[4], oit);
+				out << ")";
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+			case SRD_TEXTURE2D:
+				out << ", vec3((";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ").xy,";
+				this->ToOperands(out, *insn.ops[4], oit);
+				out << ")";
+				break;
+
+			case SRD_TEXTURECUBE:
+			case SRD_TEXTURE2DARRAY:
+				out << ", vec4((";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ").xyz, ";
+				this->ToOperands(out, *insn.ops[4], oit);
+				out << ")";
+				break;
+
+			case SRD_TEXTURECUBEARRAY:
+				out << ", (";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ").xyzw, ";
+				this->ToOperands(out, *insn.ops[4], oit);
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			if (offset)
+			{
+				out << ", ivec3(";
+				out << static_cast<int>(insn.sample_offset[0]) << ", "
+					<< static_cast<int>(insn.sample_offset[1]) << ", "
+					<< static_cast<int>(insn.sample_offset[2]) << ")";
+				out << offset_mask;
+			}
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[2]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_SAMPLE_C_LZ:
+		{
+			char const * offset_mask = "";
+			char const * texture_type = "";
+			bool offset = true;
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				offset_mask = ".x";
+				texture_type = "1D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				offset_mask = ".x";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2D:
+				offset_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			oot = this->FindTextureReturnType(*insn.ops[2]);
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ";
+			switch (oot)
+			{
+			case SIT_UInt:
+			case SIT_Int:
+				out << "i";
+				break;
+
+			default:
+				break;
+			}
+			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
+				<< "Lod" << (offset ? "Offset" : "") << "(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				out << ", vec3((";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ").x,0,";
+				this->ToOperands(out, *insn.ops[4], oit);
+				out << ")";
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+			case SRD_TEXTURE2D:
+				out << ", vec3((";
+				this->ToOperands(out, *insn.ops[1], oit);
+				out << ").xy,";
+				this->ToOperands(out, *insn.ops[4], oit);
+				out << ")";
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			out << ", 0";
+			if (offset)
+			{
+				out << ", ivec3(";
+				out << static_cast<int>(insn.sample_offset[0]) << ", "
+					<< static_cast<int>(insn.sample_offset[1]) << ", "
+					<< static_cast<int>(insn.sample_offset[2]) << ")";
+				out << offset_mask;
+			}
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[2]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_SAMPLE_L:
+		{
+			char const * coord_mask = "";
+			char const * offset_mask = "";
+			char const * texture_type = "";
+			bool offset = true;
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				coord_mask = ".x";
+				offset_mask = ".x";
+				texture_type = "1D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2D:
+				coord_mask = ".xy";
+				offset_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURE3D:
+				coord_mask = ".xyz";
+				offset_mask = ".xyz";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0)
+					|| (insn.sample_offset[2] != 0);
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				coord_mask = ".xy";
+				offset_mask = ".x";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2DARRAY:
+				coord_mask = ".xyz";
+				offset_mask = ".xy";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURECUBE:
+				coord_mask = ".xyz";
+				texture_type = "Cube";
+				offset = false;
+				break;
+
+			case SRD_TEXTURECUBEARRAY:
+				coord_mask = ".xyzw";
+				offset = false;
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			oot = this->FindTextureReturnType(*insn.ops[2]);
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ";
+			switch (oot)
+			{
+			case SIT_UInt:
+			case SIT_Int:
+				out << "i";
+				break;
+
+			default:
+				break;
+			}
+			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
+				<< "Lod" << (offset ? "Offset" : "") << "(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			out << ", (";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ")" << coord_mask;
+			out << ", ";
+			this->ToOperands(out, *insn.ops[4], oit);
+			if (offset)
+			{
+				out << ", ivec3(";
+				out << static_cast<int>(insn.sample_offset[0]) << ", "
+					<< static_cast<int>(insn.sample_offset[1]) << ", "
+					<< static_cast<int>(insn.sample_offset[2]) << ")";
+				out << offset_mask;
+			}
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[2]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_SAMPLE_D:
+		{
+			char const * deriv_mask = "";
+			char const * coord_mask = "";
+			char const * offset_mask = "";
+			char const * texture_type = "";
+			bool offset = true;
+			switch (insn.resource_target)
+			{
+			case SRD_TEXTURE1D:
+				coord_mask = ".x";
+				offset_mask = ".x";
+				deriv_mask = ".x";
+				texture_type = "1D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2D:
+				coord_mask = ".xy";
+				offset_mask = ".xy";
+				deriv_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURE3D:
+				coord_mask = ".xyz";
+				offset_mask = ".xyz";
+				deriv_mask = ".xyz";
+				texture_type = "3D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0)
+					|| (insn.sample_offset[2] != 0);
+				break;
+
+			case SRD_TEXTURE1DARRAY:
+				coord_mask = ".xy";
+				offset_mask = ".x";
+				deriv_mask = ".x";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0);
+				break;
+
+			case SRD_TEXTURE2DARRAY:
+				coord_mask = ".xyz";
+				offset_mask = ".xy";
+				deriv_mask = ".xy";
+				texture_type = "2D";
+				offset = (insn.sample_offset[0] != 0)
+					|| (insn.sample_offset[1] != 0);
+				break;
+
+			case SRD_TEXTURECUBE:
+				coord_mask = ".xyz";
+				deriv_mask = ".xyz";
+				texture_type = "Cube";
+				offset = false;
+				break;
+
+			case SRD_TEXTURECUBEARRAY:
+				coord_mask = ".xyzw";
+				deriv_mask = ".xyz";
+				offset = false;
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+			oot = this->FindTextureReturnType(*insn.ops[2]);
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+			out << " = ";
+			switch (oot)
+			{
+			case SIT_UInt:
+			case SIT_Int:
+				out << "i";
+				break;
+
+			default:
+				break;
+			}
+			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
+				<< ((glsl_rules_ & GSR_TextureGrad) ? "Grad"  : "") << (offset ? "Offset" : "") << "(";
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[3], oit, false);
+			out << ", (";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ")" << coord_mask;
+			if (glsl_rules_ & GSR_TextureGrad)
+			{
+				out << ", (";
+				this->ToOperands(out, *insn.ops[4], oit);//ddx
+				out << ")" << deriv_mask;
+				out << ", (";
+				this->ToOperands(out, *insn.ops[5], oit);//ddy
+				out << ")" << deriv_mask;
+			}
+			if (offset)
+			{
+				out << ", ivec3(";
+				out << static_cast<int>(insn.sample_offset[0]) << ", "
+					<< static_cast<int>(insn.sample_offset[1]) << ", "
+					<< static_cast<int>(insn.sample_offset[2]) << ")";
+				out << offset_mask;
+			}
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[2]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_LOD:
+		//lod dest[.mask], srcAddress[.swizzle], srcResource[.swizzle], srcSampler
+		//dest.mask=textureQueryLod(src2,src0).y;
+		{
+			char const * mask = "";
+			for (auto const & tex : textures_)
+			{
+				if (insn.ops[2]->indices[0].disp == tex.tex_index)
+				{
+					switch (tex.type)
+					{
+					case SRD_TEXTURE1D:
+						mask = ".x";
+						break;
+
+					case SRD_TEXTURE2D:
+						mask = ".xy";
+						break;
+
+					case SRD_TEXTURE3D:
+						mask = ".xyz";
+						break;
+
 					case SRD_TEXTURE1DARRAY:
-						//dest.x=float(textureSize(src0,src1).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0,src1).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << " = textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << ";";
-						if (3 == this->GetOperandComponentNum(*insn.ops[0]))
-						{
-							out << "\n";
-							//dest.z=float(textureQueryLevels(src1));
-							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-							this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-							out << " = float(textureQueryLevels(";
-							this->ToOperands(out, *insn.ops[2], oit, false);
-							out << s;
-							out << "));";
-						}
+						mask = ".x";
 						break;
 
 					case SRD_TEXTURE2DARRAY:
-						//dest.x=float(textureSize(src0,src1).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0,src1).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.z=float(textureSize(src0,src1).z);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-						out << " = textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s;
-						out << ", ";
-						this->ToOperands(out, *insn.ops[1], oit);
-						out << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-						out << ";";
-						if (4 == this->GetOperandComponentNum(*insn.ops[0]))
-						{
-							out << "\n";
-							//dest.w=float(textureQueryLevels(src1));
-							this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-							this->ToSingleComponentSelector(out, *insn.ops[0], 3);
-							out << " = float(textureQueryLevels(";
-							this->ToOperands(out, *insn.ops[2], oit, false);
-							out << s;
-							out << "));";
-						}
+						mask = ".xy";
 						break;
 
-						//-----------------------------------------------------------------------------------------
-						//there seems to be problems with dx sdk reference about texture2dmsarray.getDimesnsions()
-						//the document says 
-						//void GetDimensions(
-						//out  UINT Width,
-						//out  UINT Height,
-						//out  UINT Elements,
-						//out  UINT NumberOfSamples
-						//);
-						//but according to assemble instructions,parameters should be width,height,samples,elements
-						//-------------------------------------------------------------------------------------------
-					case SRD_TEXTURE2DMSARRAY:
-						//dest.x=float(textureSize(src0).x);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 0);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.y=float(textureSize(src0).y);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						out << " = ";
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << "1.0 / float(";
-						}
-						out << "textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 1);
-						if (SRIRT_RCPFLOAT == insn.insn.resinfo_return_type)
-						{
-							out << ")";
-						}
-						out << ";\n";
-						//dest.z=float(textureSize(src0).z);
-						this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-						out << " = textureSize(";
-						this->ToOperands(out, *insn.ops[2], oit, false);
-						out << s << ")";
-						this->ToSingleComponentSelector(out, *insn.ops[0], 2);
-						out << ";";
+					case SRD_TEXTURECUBE:
+						mask = ".xyz";
+						break;
+
+					case SRD_TEXTURECUBEARRAY:
+						mask = ".xyz";
+						break;
+
+					default:
+						assert(false);
+						break;
+					}
+					assert(1 == this->GetOperandComponentNum(*insn.ops[0]));
+					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+					out << " = textureQueryLod(";
+					this->ToOperands(out, *insn.ops[2], oit, false);
+					out << "_";
+					this->ToOperands(out, *insn.ops[3], oit, false);
+					out << ", (";
+					this->ToOperands(out, *insn.ops[1], oit);
+					out << ")" << mask;
+					out << ").y;";
+					break;
+				}
+			}
+		}
+		break;
+
+	case SO_LD:
+		{
+			//find a name of texutre:eg.t0_s0 or t0
+			for (auto const & tex : textures_)
+			{
+				if (insn.ops[2]->indices[0].disp == tex.tex_index)
+				{
+					std::string s;
+					if (!tex.samplers.empty())
+					{
+						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
+						s = std::string("_") + desc.name;
+					}
+					char const * mask = "";
+					char const * lod_mask = "";
+					char const * offset_mask = "";
+					bool lod = true;
+					switch (insn.resource_target)
+					{
+					case SRD_TEXTURE1D:
+						mask = ".x";
+						lod_mask = ".y";
+						offset_mask = ".x";
+						break;
+
+					case SRD_TEXTURE2D:
+						mask = ".xy";
+						lod_mask = ".z";
+						offset_mask = ".xy";
+						break;
+
+					case SRD_TEXTURE3D:
+						mask = ".xyz";
+						lod_mask = ".w";
+						offset_mask = ".xyz";
+						break;
+
+					case SRD_TEXTURE1DARRAY:
+						mask = ".xy";
+						lod_mask = ".z";
+						offset_mask = ".x";
+						break;
+
+					case SRD_TEXTURE2DARRAY:
+						mask = ".xyz";
+						lod_mask = ".w";
+						offset_mask = ".xy";
+						break;
+
+					case SRD_BUFFER:
+						mask = ".x";
+						lod = false;
 						break;
 
-						//SM5 does not support query element count of cube array
-						//case SRD_TEXTURECUBEARRAY:
-						//break;
 					default:
-						assert_msg(false, "Unexpected resource target type");
+						assert(false);
 						break;
 					}
+					oot = this->FindTextureReturnType(*insn.ops[2]);
+					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+					out << " = ";
+					switch (oot)
+					{
+					case SIT_UInt:
+					case SIT_Int:
+						out << "i";
+						break;
 
-					break;
-				}
-			}
-		}
-		break;
-
-	case SO_SAMPLE_INFO:
-		//dest.mask=uint(textureSamples(src0));
-		for (auto const & tex : textures_)
-		{
-			if (tex.tex_index == insn.ops[0]->indices[0].disp)
-			{
-				std::string s;
-				if (!tex.samplers.empty())
-				{
-					DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
-					s = std::string("_") + desc.name;
-				}
-				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-				out << " = ";
-				if (glsl_rules_ & GSR_ExplicitMultiSample)
-				{
-					out << "uint(textureSamples(";
-					this->ToOperands(out, *insn.ops[1], oit, false);
+					default:
+						break;
+					}
+					out << "vec4(texelFetch";
+					if (lod)
+					{
+						out << "Offset";
+					}
+					out << "(";
+					this->ToOperands(out, *insn.ops[2], oit, false);
 					out << s;
-					out << "))";
-				}
-				else
-				{
-					assert_msg(false, "for sampleinfo, there's no corresponding instruction in glsl 4.5-");
-					out << "1";
+					out << ", ivec4(";
+					this->ToOperands(out, *insn.ops[1], SIT_Int, false);
+					out << ")" << mask;
+					if (lod)//lod and offset
+					{
+						out << ", ivec4(";
+						this->ToOperands(out, *insn.ops[1], SIT_Int, false);
+						out << ")" << lod_mask;
+						out << ", ivec3(";
+						out << static_cast<int>(insn.sample_offset[0]) << ", "
+							<< static_cast<int>(insn.sample_offset[1]) << ", "
+							<< static_cast<int>(insn.sample_offset[2]) << ")";
+						out << offset_mask;
+					}
+					out << ")";
+					this->ToComponentSelectors(out, *insn.ops[2]);
+					out << ")";
+					this->ToComponentSelectors(out, *insn.ops[0]);
+					out << ";";
+					break;
 				}
-				out << ";";
-
-				break;
 			}
 		}
 		break;
 
-	case SO_BUFINFO:
-		//dest.mask=uint(textureSize(src0));
+	case SO_LD_MS:
 		{
+			//find a name of texutre:eg.t0_s0 or t0
 			for (auto const & tex : textures_)
 			{
-				if (tex.tex_index == insn.ops[0]->indices[0].disp)
+				if (insn.ops[2]->indices[0].disp == tex.tex_index)
 				{
 					std::string s;
 					if (!tex.samplers.empty())
@@ -4322,172 +6285,61 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
 						s = std::string("_") + desc.name;
 					}
+					char const * mask = "";
+					switch (insn.resource_target)
+					{
+					case SRD_TEXTURE2DMS:
+						mask = ".xy";
+						break;
+
+					case SRD_TEXTURE2DMSARRAY:
+						mask = ".xyz";
+						break;
+
+					default:
+						assert(false);
+						break;
+					}
 					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-					out << " = uint(textureSize(";
-					this->ToOperands(out, *insn.ops[1], oit, false);
+					out << " = vec4(texelFetch(";
+					this->ToOperands(out, *insn.ops[2], oit, false);
 					out << s;
-					out << "));";
-
+					out << ", ivec4(";
+					this->ToOperands(out, *insn.ops[1], SIT_Int);
+					out << ")" << mask << ", int(";
+					this->ToOperands(out, *insn.ops[3], SIT_Int);
+					out << ")" << ")";
+					this->ToComponentSelectors(out, *insn.ops[2]);
+					out << ")";
+					this->ToComponentSelectors(out, *insn.ops[0]);
+					out << ";";
 					break;
 				}
 			}
 		}
 		break;
 
-	case SO_SAMPLE:
-		//sample_indexable(0,0,0)(texture2d)(float,float,float,float) dest,src0(coord),src1(t),src2(s)
-		//dest.mask=textureOffset(src1,src0,offset).mask;
-		{
-			//cube and cubearray doesnt support tex-coord offset
-			char const * coord_mask = "";
-			char const * offset_mask = "";
-			char const * texture_type = "";
-			bool offset = true;
-			switch (insn.resource_target)
-			{
-			case SRD_TEXTURE1D:
-				coord_mask = ".x";
-				offset_mask = ".x";
-				texture_type = "1D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
-			case SRD_TEXTURE2D:
-				coord_mask = ".xy";
-				offset_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURE3D:
-				coord_mask = ".xyz";
-				offset_mask = ".xyz";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0)
-					|| (insn.sample_offset[2] != 0);
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				coord_mask = ".xy";
-				offset_mask = ".x";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
-			case SRD_TEXTURE2DARRAY:
-				coord_mask = ".xyz";
-				offset_mask = ".xy";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURECUBE:
-				coord_mask = ".xyz";
-				texture_type = "Cube";
-				offset = false;
-				break;
-
-			case SRD_TEXTURECUBEARRAY:
-				coord_mask = ".xyzw";
-				offset = false;
-				break;
-
-			default:
-				assert(false);
-				break;
-			}
-			oot = this->FindTextureReturnType(*insn.ops[2]);
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ";
-			switch (oot)
-			{
-			case SIT_UInt:
-			case SIT_Int:
-				out << "i";
-				break;
-
-			default:
-				break;
-			}
-			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
-				<< (offset ? "Offset" : "") << "(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			out << "_";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			out << ", vec4(";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask;
-			if (offset)
-			{
-				out << ", ivec3(";
-				out << static_cast<int>(insn.sample_offset[0]) << ", "
-					<< static_cast<int>(insn.sample_offset[1]) << ", "
-					<< static_cast<int>(insn.sample_offset[2]) << ")";
-				out << offset_mask;
-			}
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[2]);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
-
-	case SO_SAMPLE_B:
-		//sample_b_indexable(0,0,0)(texture2d)(float,float,float,float) dest,src0(coord),src1(t),src2(s),src3(bias)
-		//dest.mask=textureOffset(src1,src0,offset,src3).mask;
+	case SO_GATHER4:
+		//gather4_indexable(u,v,w)(texture2d)(float,float,float,float) dest.mask, src0(coord),src1(resource), src2(sampler)
+		//dest.mask=(textureGather[Offset](src1,src0[,offset],src2.comp).src1_mask).dest_mask;
 		{
 			char const * coord_mask = "";
 			char const * offset_mask = "";
-			char const * texture_type = "";
 			bool offset = true;
 			switch (insn.resource_target)
 			{
-			case SRD_TEXTURE1D:
-				coord_mask = ".x";
-				offset_mask = ".x";
-				texture_type = "1D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
 			case SRD_TEXTURE2D:
-				coord_mask = ".xy";
-				offset_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURE3D:
-				coord_mask = ".xyz";
-				offset_mask = ".xyz";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0)
-					|| (insn.sample_offset[2] != 0);
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				coord_mask = ".xy";
-				offset_mask = ".x";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0);
+				coord_mask = ".xy";
+				offset_mask = ".xy";
 				break;
 
 			case SRD_TEXTURE2DARRAY:
 				coord_mask = ".xyz";
 				offset_mask = ".xy";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
 				break;
 
 			case SRD_TEXTURECUBE:
 				coord_mask = ".xyz";
-				texture_type = "Cube";
 				offset = false;
 				break;
 
@@ -4513,24 +6365,26 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 			default:
 				break;
 			}
-			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
-				<< (offset ? "Offset" : "") << "(";
+			out << "vec4(textureGather";
+			if (offset)
+			{
+				out << "Offset(";
+			}
 			this->ToOperands(out, *insn.ops[2], oit, false);
 			out << "_";
 			this->ToOperands(out, *insn.ops[3], oit, false);
 			out << ", (";
 			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask;
+			out << ")" << coord_mask << ", ";
 			if (offset)
 			{
-				out << ", ivec3(";
+				out << "ivec3(";
 				out << static_cast<int>(insn.sample_offset[0]) << ", "
 					<< static_cast<int>(insn.sample_offset[1]) << ", "
 					<< static_cast<int>(insn.sample_offset[2]) << ")";
 				out << offset_mask;
 			}
-			out << ", ";
-			this->ToOperands(out, *insn.ops[4], oit);
+			out << ", " << this->GetComponentSelector(*insn.ops[3], 0);
 			out << ")";
 			this->ToComponentSelectors(out, *insn.ops[2]);
 			out << ")";
@@ -4539,42 +6393,32 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 		}
 		break;
 
-	case SO_SAMPLE_C:
+	case SO_GATHER4_C:
+		//gather4_indexable(u,v,w)(target)(comp_type) dest.mask, src0(coord),src1(resource), src2(sampler),src3 cmp_ref
+		//dest.mask=(textureGather[Offset](src1,src0[,offset],src2.comp).src1_mask).dest_mask;
 		{
+			char const * coord_mask = "";
 			char const * offset_mask = "";
-			char const * texture_type = "";
 			bool offset = true;
 			switch (insn.resource_target)
 			{
-			case SRD_TEXTURE1D:
-				offset_mask = ".x";
-				texture_type = "1D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				offset_mask = ".x";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
 			case SRD_TEXTURE2D:
+				coord_mask = ".xy";
 				offset_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
 				break;
 
 			case SRD_TEXTURE2DARRAY:
+				coord_mask = ".xyz";
 				offset_mask = ".xy";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
 				break;
 
 			case SRD_TEXTURECUBE:
+				coord_mask = ".xyz";
+				offset = false;
+				break;
+
 			case SRD_TEXTURECUBEARRAY:
-				texture_type = "Cube";
+				coord_mask = ".xyzw";
 				offset = false;
 				break;
 
@@ -4595,138 +6439,18 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 			default:
 				break;
 			}
-			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
-				<< (offset ? "Offset" : "") << "(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			out << "_";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			switch (insn.resource_target)
-			{
-			case SRD_TEXTURE1D:
-				out << ", vec3((";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ").x,0,";
-				this->ToOperands(out, *insn.ops[4], oit);
-				out << ")";
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-			case SRD_TEXTURE2D:
-				out << ", vec3((";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ").xy,";
-				this->ToOperands(out, *insn.ops[4], oit);
-				out << ")";
-				break;
-
-			case SRD_TEXTURECUBE:
-			case SRD_TEXTURE2DARRAY:
-				out << ", vec4((";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ").xyz, ";
-				this->ToOperands(out, *insn.ops[4], oit);
-				out << ")";
-				break;
-
-			case SRD_TEXTURECUBEARRAY:
-				out << ", (";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ").xyzw, ";
-				this->ToOperands(out, *insn.ops[4], oit);
-				break;
-
-			default:
-				assert(false);
-				break;
-			}
+			out << "vec4(textureGather";
 			if (offset)
 			{
-				out << ", ivec3(";
-				out << static_cast<int>(insn.sample_offset[0]) << ", "
-					<< static_cast<int>(insn.sample_offset[1]) << ", "
-					<< static_cast<int>(insn.sample_offset[2]) << ")";
-				out << offset_mask;
-			}
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[2]);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
-		}
-		break;
-
-	case SO_SAMPLE_C_LZ:
-		{
-			char const * offset_mask = "";
-			char const * texture_type = "";
-			bool offset = true;
-			switch (insn.resource_target)
-			{
-			case SRD_TEXTURE1D:
-				offset_mask = ".x";
-				texture_type = "1D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				offset_mask = ".x";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
-			case SRD_TEXTURE2D:
-				offset_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			default:
-				assert(false);
-				break;
-			}
-			oot = this->FindTextureReturnType(*insn.ops[2]);
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ";
-			switch (oot)
-			{
-			case SIT_UInt:
-			case SIT_Int:
-				out << "i";
-				break;
-
-			default:
-				break;
+				out << "Offset(";
 			}
-			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
-				<< "Lod" << (offset ? "Offset" : "") << "(";
 			this->ToOperands(out, *insn.ops[2], oit, false);
 			out << "_";
 			this->ToOperands(out, *insn.ops[3], oit, false);
-			switch (insn.resource_target)
-			{
-			case SRD_TEXTURE1D:
-				out << ", vec3((";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ").x,0,";
-				this->ToOperands(out, *insn.ops[4], oit);
-				out << ")";
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-			case SRD_TEXTURE2D:
-				out << ", vec3((";
-				this->ToOperands(out, *insn.ops[1], oit);
-				out << ").xy,";
-				this->ToOperands(out, *insn.ops[4], oit);
-				out << ")";
-				break;
-
-			default:
-				assert(false);
-				break;
-			}
-			out << ", 0";
+			out << ", (";
+			this->ToOperands(out, *insn.ops[1], oit);
+			out << ")" << coord_mask << ", ";
+			this->ToOperands(out, *insn.ops[4], oit);
 			if (offset)
 			{
 				out << ", ivec3(";
@@ -4743,62 +6467,22 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 		}
 		break;
 
-	case SO_SAMPLE_L:
+	case SO_GATHER4_PO:
+		//gather4_po_indexable(target)(comp_type) dest.mask, src0(coord),src1(offset),src2(resource),src3(sampler)
+		//dest.mask=(textureGatherOffset(src2,src0,src1,src3.comp).src2_mask).dest_mask;
 		{
 			char const * coord_mask = "";
 			char const * offset_mask = "";
-			char const * texture_type = "";
-			bool offset = true;
 			switch (insn.resource_target)
 			{
-			case SRD_TEXTURE1D:
-				coord_mask = ".x";
-				offset_mask = ".x";
-				texture_type = "1D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
 			case SRD_TEXTURE2D:
 				coord_mask = ".xy";
 				offset_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURE3D:
-				coord_mask = ".xyz";
-				offset_mask = ".xyz";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0)
-					|| (insn.sample_offset[2] != 0);
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				coord_mask = ".xy";
-				offset_mask = ".x";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0);
 				break;
 
 			case SRD_TEXTURE2DARRAY:
 				coord_mask = ".xyz";
 				offset_mask = ".xy";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURECUBE:
-				coord_mask = ".xyz";
-				texture_type = "Cube";
-				offset = false;
-				break;
-
-			case SRD_TEXTURECUBEARRAY:
-				coord_mask = ".xyzw";
-				offset = false;
 				break;
 
 			default:
@@ -4818,96 +6502,40 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 			default:
 				break;
 			}
-			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
-				<< "Lod" << (offset ? "Offset" : "") << "(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			out << "_";
+			out << "vec4(textureGatherOffset(";
 			this->ToOperands(out, *insn.ops[3], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[4], oit, false);
 			out << ", (";
 			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask;
-			out << ", ";
-			this->ToOperands(out, *insn.ops[4], oit);
-			if (offset)
-			{
-				out << ", ivec3(";
-				out << static_cast<int>(insn.sample_offset[0]) << ", "
-					<< static_cast<int>(insn.sample_offset[1]) << ", "
-					<< static_cast<int>(insn.sample_offset[2]) << ")";
-				out << offset_mask;
-			}
+			out << ")" << coord_mask << ", ";
+			this->ToOperands(out, *insn.ops[2], SIT_Int);
+			out << offset_mask;
+			out << ", " << this->GetComponentSelector(*insn.ops[3], 0);
 			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[2]);
+			this->ToComponentSelectors(out, *insn.ops[3]);
 			out << ")";
 			this->ToComponentSelectors(out, *insn.ops[0]);
 			out << ";";
 		}
 		break;
 
-	case SO_SAMPLE_D:
+	case SO_GATHER4_PO_C:
+		//gather4_po_c_indexable(target)(comp_type) dest.mask, src0(coord),src1(offset),src2(resource),src3(sampler),scr4(cmp_ref)
+		//dest.mask=(textureGatherOffset(src2,src0,src1,src3.comp).src2_mask).dest_mask;
 		{
-			char const * deriv_mask = "";
 			char const * coord_mask = "";
 			char const * offset_mask = "";
-			char const * texture_type = "";
-			bool offset = true;
 			switch (insn.resource_target)
 			{
-			case SRD_TEXTURE1D:
-				coord_mask = ".x";
-				offset_mask = ".x";
-				deriv_mask = ".x";
-				texture_type = "1D";
-				offset = (insn.sample_offset[0] != 0);
-				break;
-
 			case SRD_TEXTURE2D:
 				coord_mask = ".xy";
 				offset_mask = ".xy";
-				deriv_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURE3D:
-				coord_mask = ".xyz";
-				offset_mask = ".xyz";
-				deriv_mask = ".xyz";
-				texture_type = "3D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0)
-					|| (insn.sample_offset[2] != 0);
-				break;
-
-			case SRD_TEXTURE1DARRAY:
-				coord_mask = ".xy";
-				offset_mask = ".x";
-				deriv_mask = ".x";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0);
 				break;
 
 			case SRD_TEXTURE2DARRAY:
 				coord_mask = ".xyz";
 				offset_mask = ".xy";
-				deriv_mask = ".xy";
-				texture_type = "2D";
-				offset = (insn.sample_offset[0] != 0)
-					|| (insn.sample_offset[1] != 0);
-				break;
-
-			case SRD_TEXTURECUBE:
-				coord_mask = ".xyz";
-				deriv_mask = ".xyz";
-				texture_type = "Cube";
-				offset = false;
-				break;
-
-			case SRD_TEXTURECUBEARRAY:
-				coord_mask = ".xyzw";
-				deriv_mask = ".xyz";
-				offset = false;
 				break;
 
 			default:
@@ -4927,1324 +6555,2162 @@ void GLSLGen::ToInstruction(std::ostream& out, ShaderInstruction const & insn) c
 			default:
 				break;
 			}
-			out << "vec4(texture" << ((glsl_rules_ & GSR_GenericTexture) ? "" : texture_type)
-				<< ((glsl_rules_ & GSR_TextureGrad) ? "Grad"  : "") << (offset ? "Offset" : "") << "(";
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			out << "_";
+			out << "vec4(textureGatherOffset(";
 			this->ToOperands(out, *insn.ops[3], oit, false);
+			out << "_";
+			this->ToOperands(out, *insn.ops[4], oit, false);
 			out << ", (";
 			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask;
-			if (glsl_rules_ & GSR_TextureGrad)
+			out << ")" << coord_mask << ", ";
+			this->ToOperands(out, *insn.ops[2], SIT_Int);
+			out << offset_mask << ", " << this->GetComponentSelector(*insn.ops[4], 0) << ")";
+			this->ToComponentSelectors(out, *insn.ops[3]);
+			out << ")";
+			this->ToComponentSelectors(out, *insn.ops[0]);
+			out << ";";
+		}
+		break;
+
+	case SO_DERIV_RTX:
+	case SO_DERIV_RTX_COARSE:
+	case SO_DERIV_RTX_FINE:
+		//deriv_rtx_coarse[_sat] dest[.mask], [-]src0[_abs][.swizzle]
+		//dest.mask=ddx(src0).mask
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(dFdx(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_DERIV_RTY:
+	case SO_DERIV_RTY_COARSE:
+	case SO_DERIV_RTY_FINE:
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = vec4(dFdy(";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << "))";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_LD_UAV_TYPED:
+		//ld_uav_typed dst0[.mask], srcAddress[.swizzle], srcUAV[.swizzle]
+		//dst0.mask=(imageLoad(srcUAV,srcAddress).srcUAV_mask).dst_mask;
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << " = vec4(imageLoad(";
+		this->ToOperands(out, *insn.ops[2], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], SIT_UInt);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[2]);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_STORE_UAV_TYPED:
+		{
+			//store_uav_typed dstUAV.xyzw, dstAddress[.swizzle](uint), src0[.swizzle]
+			//imageStore(dstUAV,dstAddress,src0);
+
+			//get component type of UAV
+			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_UAV_RWTYPED, static_cast<uint32_t>(insn.ops[0]->indices[0].disp));
+			ShaderImmType data_sit;
+			switch (desc.return_type)
 			{
-				out << ", (";
-				this->ToOperands(out, *insn.ops[4], oit);//ddx
-				out << ")" << deriv_mask;
-				out << ", (";
-				this->ToOperands(out, *insn.ops[5], oit);//ddy
-				out << ")" << deriv_mask;
+			case SRRT_UNORM:
+			case SRRT_SNORM:
+			case SRRT_FLOAT:
+				data_sit = SIT_Float;
+				break;
+
+			case SRRT_SINT:
+				data_sit = SIT_Int;
+				break;
+
+			case SRRT_UINT:
+				data_sit = SIT_UInt;
+				break;
+
+			default:
+				assert_msg(false, "Unsupported resource return type");
+				data_sit = SIT_Float;
+				break;
 			}
-			if (offset)
+			out << "imageStore(";
+			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+			out << ", ";
+			this->ToOperands(out, *insn.ops[1], SIT_UInt);
+			out << ", ";
+			this->ToOperands(out, *insn.ops[2], data_sit);
+			out << ");";
+		}
+		break;
+
+	case SO_LD_STRUCTURED:
+		// ld_structured dst0[.mask], srcAddress[.select_component], srcByteOffset[.select_component], src0[.swizzle]
+		// dst0[.mask]=src0[srcAddress[.select_component]][.swizzle].dst0_mask;
+		if (insn.ops[3]->type != SOT_THREAD_GROUP_SHARED_MEMORY)
+		{
+			this->ToStructuredLoad(out, insn, oot);
+			break;
+		}
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), true);
+		out << " = vec4(";
+		ShaderInputType sit;
+		switch(insn.ops[3]->type)
+		{
+		case SOT_RESOURCE:
+			sit = SIT_STRUCTURED;
+			break;
+
+		case SOT_UNORDERED_ACCESS_VIEW:
+		case SOT_THREAD_GROUP_SHARED_MEMORY:
+			sit = SIT_UAV_RWSTRUCTURED;
+			break;
+
+		default:
+			assert(false);
+			break;
+		}
+		this->ToOperands(out, *insn.ops[3], oit, false, false, false, false, false,sit);
+		out << "[";
+		this->ToOperands(out, *insn.ops[1], SIT_UInt);
+		out << "]";
+		this->ToComponentSelectors(out, *insn.ops[3], true, static_cast<uint32_t>(insn.ops[2]->imm_values[0].u32) / 4);
+		out << ")";
+		this->ToComponentSelectors(out, *insn.ops[0]);
+		out << ";";
+		break;
+
+	case SO_LD_RAW:
+		// ld_raw dst0[.mask], srcByteOffset[.select_component], src0[.swizzle]
+		// dst0[.mask] = src0[srcByteOffset / 4 + swizzle], one word per destination component
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = ";
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		ToImmTypeName(out, ((SOT_TEMP == insn.ops[0]->type) || !(glsl_rules_ & GSR_UIntType)) ? SIT_Int : SIT_UInt, num_comps);
+		out << "(";
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			if (i != 0)
 			{
-				out << ", ivec3(";
-				out << static_cast<int>(insn.sample_offset[0]) << ", "
-					<< static_cast<int>(insn.sample_offset[1]) << ", "
-					<< static_cast<int>(insn.sample_offset[2]) << ")";
-				out << offset_mask;
+				out << ", ";
 			}
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[2]);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
+			this->ToBufferWord(out, *insn.ops[2], nullptr, 0, *insn.ops[1],
+				this->GetComponentSelector(*insn.ops[2], this->GetComponentSelector(*insn.ops[0], i)));
+		}
+		out << ");";
+		break;
+
+	case SO_STORE_RAW:
+		// store_raw dst0[.write_mask], dstByteOffset[.select_component], src0[.swizzle]
+		// Consecutive words from dstByteOffset / 4, one per write mask component
+		num_comps = this->GetOperandComponentNum(*insn.ops[0]);
+		for (int i = 0; i < num_comps; ++ i)
+		{
+			if (i != 0)
+			{
+				out << "\n";
+			}
+			this->ToBufferWord(out, *insn.ops[0], nullptr, 0, *insn.ops[1], i);
+			if (SIT_Float == this->OperandAsType(*insn.ops[2], oit))
+			{
+				out << " = floatBitsToUint(";
+			}
+			else
+			{
+				out << " = uint(";
+			}
+			this->ToOperands(out, *insn.ops[2], oit, false);
+			this->ToSingleComponentSelector(out, *insn.ops[2], i);
+			out << ");";
+		}
+		break;
+
+	case SO_STORE_STRUCTURED:
+		//store_structured dst0[.write_mask], dstAddress[.select_component], dstByteOffset[.select_component], src0[.swizzle]
+		//dst0[dstAddress[.select_component]][.write_mask]=src0[.swizzle]
+		if (insn.ops[0]->type != SOT_THREAD_GROUP_SHARED_MEMORY)
+		{
+			this->ToStructuredStore(out, insn);
+			break;
 		}
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false, false, false, false, false, SIT_UAV_RWSTRUCTURED);
+		out << "[";
+		this->ToOperands(out, *insn.ops[1], SIT_UInt);
+		out << "]";
+		this->ToComponentSelectors(out, *insn.ops[0], true, static_cast<uint32_t>(insn.ops[2]->imm_values[0].u32) / 4);
+		out << " = vec4(";
+		this->ToOperands(out, *insn.ops[3], oit, true);
+		out <<")";
+		this->ToComponentSelectors(out,*insn.ops[0]);
+		out << ";";
+		break;
+
+		//------------------------------------------------------------------
+		//atomic operations
+		//-------------------------------------------------------------------
+
+	case SO_ATOMIC_AND:
+		//atomic_and dst, dstAddress[.swizzle], src0[.select_component]
+		//imageAtomicAnd(dst,dstAddress[.swizzle],src0);
+		out << "imageAtomicAnd(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ");";
 		break;
 
-	case SO_LOD:
-		//lod dest[.mask], srcAddress[.swizzle], srcResource[.swizzle], srcSampler
-		//dest.mask=textureQueryLod(src2,src0).y;
-		{
-			char const * mask = "";
-			for (auto const & tex : textures_)
-			{
-				if (insn.ops[2]->indices[0].disp == tex.tex_index)
-				{
-					switch (tex.type)
-					{
-					case SRD_TEXTURE1D:
-						mask = ".x";
-						break;
+	case SO_ATOMIC_OR:
+		//atomic_or dst, dstAddress[.swizzle], src0[.select_component]
+		//imageAtomicOr(dst,dstAddress[.swizzle],src0);
+		out << "imageAtomicOr(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE2D:
-						mask = ".xy";
-						break;
+	case SO_ATOMIC_XOR:
+		//atomic_xor dst, dstAddress[.swizzle], src0[.select_component]
+		//imageAtomicXor(dst,dstAddress[.swizzle],src0);
+		out << "imageAtomicXor(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE3D:
-						mask = ".xyz";
-						break;
+	case SO_ATOMIC_CMP_STORE:
+		//atomic_cmp_store dst, dstAddress[.swizzle], src0[.select_component], src1[.select_component]
+		//imageAtomicCompSwap(dst,dstAddress[.swizzle],src0[.select_component], src1[.select_component]);
+		out << "imageAtomicCompSwap(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE1DARRAY:
-						mask = ".x";
-						break;
+	case SO_ATOMIC_IADD:
+		//atomic_iadd dst, dstAddress[.swizzle], src0[.select_component]
+		//imageAtomicAdd(dst,dstAddress[.swizzle],src0);
+		out << "imageAtomicAdd(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE2DARRAY:
-						mask = ".xy";
-						break;
+	case SO_ATOMIC_IMAX:
+	case SO_ATOMIC_UMAX:
+		//atomic_imax dst, dstAddress[.swizzle], src0[.select_component]
+		//imageAtomicMax(dst,dstAddress[.swizzle],src0);
+		out << "imageAtomicMax(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURECUBE:
-						mask = ".xyz";
-						break;
+	case SO_ATOMIC_IMIN:
+	case SO_ATOMIC_UMIN:
+		//atomic_imin dst, dstAddress[.swizzle], src0[.select_component]
+		//imageAtomicMin(dst,dstAddress[.swizzle],src0);
+		out << "imageAtomicMin(";
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[1], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURECUBEARRAY:
-						mask = ".xyz";
-						break;
+	case SO_IMM_ATOMIC_IADD:
+		//imm_atomic_iadd dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicAdd(dst1,dstAddress[.swizzle],src0);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = imageAtomicAdd(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					default:
-						assert(false);
-						break;
-					}
-					assert(1 == this->GetOperandComponentNum(*insn.ops[0]));
-					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-					out << " = textureQueryLod(";
-					this->ToOperands(out, *insn.ops[2], oit, false);
-					out << "_";
-					this->ToOperands(out, *insn.ops[3], oit, false);
-					out << ", (";
-					this->ToOperands(out, *insn.ops[1], oit);
-					out << ")" << mask;
-					out << ").y;";
-					break;
-				}
-			}
-		}
+	case SO_IMM_ATOMIC_AND:
+		//imm_atomic_and dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicAnd(dst1,dstAddress[.swizzle],src0);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = imageAtomicAnd(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
 		break;
 
-	case SO_LD:
-		{
-			//find a name of texutre:eg.t0_s0 or t0
-			for (auto const & tex : textures_)
-			{
-				if (insn.ops[2]->indices[0].disp == tex.tex_index)
-				{
-					std::string s;
-					if (!tex.samplers.empty())
-					{
-						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
-						s = std::string("_") + desc.name;
-					}
-					char const * mask = "";
-					char const * lod_mask = "";
-					char const * offset_mask = "";
-					bool lod = true;
-					switch (insn.resource_target)
-					{
-					case SRD_TEXTURE1D:
-						mask = ".x";
-						lod_mask = ".y";
-						offset_mask = ".x";
-						break;
+	case SO_IMM_ATOMIC_OR:
+		//imm_atomic_or dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicOr(dst1,dstAddress[.swizzle],src0);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = imageAtomicOr(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE2D:
-						mask = ".xy";
-						lod_mask = ".z";
-						offset_mask = ".xy";
-						break;
+	case SO_IMM_ATOMIC_XOR:
+		//imm_atomic_xor dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicXor(dst1,dstAddress[.swizzle],src0);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = imageAtomicXor(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE3D:
-						mask = ".xyz";
-						lod_mask = ".w";
-						offset_mask = ".xyz";
-						break;
+	case SO_IMM_ATOMIC_IMAX:
+	case SO_IMM_ATOMIC_UMAX:
+		//imm_atomic_imax dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicMax(dst1,dstAddress[.swizzle],src0);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = imageAtomicMax(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE1DARRAY:
-						mask = ".xy";
-						lod_mask = ".z";
-						offset_mask = ".x";
-						break;
+	case SO_IMM_ATOMIC_IMIN:
+	case SO_IMM_ATOMIC_UMIN:
+		//imm_atomic_umin dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicMin(dst1,dstAddress[.swizzle],src0);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << " = imageAtomicMin(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					case SRD_TEXTURE2DARRAY:
-						mask = ".xyz";
-						lod_mask = ".w";
-						offset_mask = ".xy";
-						break;
+	case SO_IMM_ATOMIC_CMP_EXCH:
+		//imm_atomic_cmp_exch dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component], src1[.select_component]
+		//imageAtomicCompSwap(dst,dstAddress[.swizzle],src0[.select_component], src1[.select_component]);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << "= imageAtomicCompSwap(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[4], oit);
+		out << ");";
+		break;
+
+	case SO_IMM_ATOMIC_EXCH:
+		//imm_atomic_exch dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
+		//dst0[.single_component_mask]=imageAtomicExchange(dst1,dstAddress[.swizzle], src0[.select_component]);
+		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+		out << "= imageAtomicExchange(";
+		this->ToOperands(out, *insn.ops[1], oit, false);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[2], oit);
+		out << ", ";
+		this->ToOperands(out, *insn.ops[3], oit);
+		out << ");";
+		break;
 
-					case SRD_BUFFER:
-						mask = ".x";
-						lod = false;
-						break;
+		//------------------------------------------------------------------
+		// Geometry shader operations
+		//-------------------------------------------------------------------
+	case SO_EMIT:
+		this->ToCopyToInterShaderOutputRecords(out);
+		out << "EmitVertex();";
+		break;
 
-					default:
-						assert(false);
-						break;
-					}
-					oot = this->FindTextureReturnType(*insn.ops[2]);
-					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-					out << " = ";
-					switch (oot)
-					{
-					case SIT_UInt:
-					case SIT_Int:
-						out << "i";
-						break;
+	case SO_EMITTHENCUT:
+		out << "EndPrimitive();";
+		break;
 
-					default:
-						break;
-					}
-					out << "vec4(texelFetch";
-					if (lod)
-					{
-						out << "Offset";
-					}
-					out << "(";
-					this->ToOperands(out, *insn.ops[2], oit, false);
-					out << s;
-					out << ", ivec4(";
-					this->ToOperands(out, *insn.ops[1], SIT_Int, false);
-					out << ")" << mask;
-					if (lod)//lod and offset
-					{
-						out << ", ivec4(";
-						this->ToOperands(out, *insn.ops[1], SIT_Int, false);
-						out << ")" << lod_mask;
-						out << ", ivec3(";
-						out << static_cast<int>(insn.sample_offset[0]) << ", "
-							<< static_cast<int>(insn.sample_offset[1]) << ", "
-							<< static_cast<int>(insn.sample_offset[2]) << ")";
-						out << offset_mask;
-					}
-					out << ")";
-					this->ToComponentSelectors(out, *insn.ops[2]);
-					out << ")";
-					this->ToComponentSelectors(out, *insn.ops[0]);
-					out << ";";
-					break;
-				}
-			}
+	case SO_EMIT_STREAM:
+		this->ToCopyToInterShaderOutputRecords(out);
+		if ((glsl_rules_ & GSR_MultiStreamGS)
+			&& (SPT_PointList == program_->gs_output_topology[static_cast<uint32_t>(insn.ops[0]->indices[0].disp)]))
+		{
+			out << "EmitStreamVertex(" << insn.ops[0]->indices[0].disp << ");";
+		}
+		else
+		{
+			out << "EmitVertex();";
 		}
 		break;
 
-	case SO_LD_MS:
+	case SO_EMITTHENCUT_STREAM:
+		this->ToCopyToInterShaderOutputRecords(out);
+		if ((glsl_rules_ & GSR_MultiStreamGS)
+			&& (SPT_PointList == program_->gs_output_topology[static_cast<uint32_t>(insn.ops[0]->indices[0].disp)]))
 		{
-			//find a name of texutre:eg.t0_s0 or t0
-			for (auto const & tex : textures_)
-			{
-				if (insn.ops[2]->indices[0].disp == tex.tex_index)
-				{
-					std::string s;
-					if (!tex.samplers.empty())
-					{
-						DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(tex.samplers[0].index));
-						s = std::string("_") + desc.name;
-					}
-					char const * mask = "";
-					switch (insn.resource_target)
-					{
-					case SRD_TEXTURE2DMS:
-						mask = ".xy";
-						break;
-
-					case SRD_TEXTURE2DMSARRAY:
-						mask = ".xyz";
-						break;
-
-					default:
-						assert(false);
-						break;
-					}
-					this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-					out << " = vec4(texelFetch(";
-					this->ToOperands(out, *insn.ops[2], oit, false);
-					out << s;
-					out << ", ivec4(";
-					this->ToOperands(out, *insn.ops[1], SIT_Int);
-					out << ")" << mask << ", int(";
-					this->ToOperands(out, *insn.ops[3], SIT_Int);
-					out << ")" << ")";
-					this->ToComponentSelectors(out, *insn.ops[2]);
-					out << ")";
-					this->ToComponentSelectors(out, *insn.ops[0]);
-					out << ";";
-					break;
-				}
-			}
+			out << "EmitStreamVertex(" << insn.ops[0]->indices[0].disp << ");\n";
+			out << "EndStreamPrimitive(" << insn.ops[0]->indices[0].disp << ");";
+		}
+		else
+		{
+			out << "EmitVertex();\n";
+			out << "EndPrimitive();";
 		}
 		break;
 
-	case SO_GATHER4:
-		//gather4_indexable(u,v,w)(texture2d)(float,float,float,float) dest.mask, src0(coord),src1(resource), src2(sampler)
-		//dest.mask=(textureGather[Offset](src1,src0[,offset],src2.comp).src1_mask).dest_mask;
+	case SO_CUT:
+		out << "EndPrimitive();";
+		break;
+
+	case SO_CUT_STREAM:
+		if ((glsl_rules_ & GSR_MultiStreamGS)
+			&& (SPT_PointList == program_->gs_output_topology[static_cast<uint32_t>(insn.ops[0]->indices[0].disp)]))
 		{
-			char const * coord_mask = "";
-			char const * offset_mask = "";
-			bool offset = true;
-			switch (insn.resource_target)
-			{
-			case SRD_TEXTURE2D:
-				coord_mask = ".xy";
-				offset_mask = ".xy";
-				break;
+			out << "EndStreamPrimitive(" << insn.ops[0]->indices[0].disp << ");";
+		}
+		else
+		{
+			out << "EndPrimitive();";
+		}
+		break;
 
-			case SRD_TEXTURE2DARRAY:
-				coord_mask = ".xyz";
-				offset_mask = ".xy";
-				break;
+	case SO_LABEL:
+	case SO_HS_DECLS:
+	case SO_HS_CONTROL_POINT_PHASE:
+	case SO_HS_FORK_PHASE:
+	case SO_HS_JOIN_PHASE:
+		break;
 
-			case SRD_TEXTURECUBE:
-				coord_mask = ".xyz";
-				offset = false;
-				break;
+	default:
+		this->ReportError(GGS_Unsupported, "Unhandled instruction", &insn);
+		break;
+	}
 
-			case SRD_TEXTURECUBEARRAY:
-				coord_mask = ".xyzw";
-				offset = false;
-				break;
+	if (insn.insn.sat && (num_outputs > 0))
+	{
+		// process _sat instruction modifier
 
-			default:
-				assert(false);
-				break;
-			}
-			oot = this->FindTextureReturnType(*insn.ops[2]);
+		if (SIT_Float == oit)
+		{
+			out << "\n";
 			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ";
-			switch (oot)
+			out << " = clamp(";
+			this->ToOperands(out, *insn.ops[0], oit);
+			out << ", 0.0f, 1.0f);";
+		}
+		else if (SIT_Double == oit)
+		{
+			switch (insn.opcode)
 			{
-			case SIT_UInt:
-			case SIT_Int:
-				out << "i";
+			case SO_DLT:
+			case SO_DNE:
+			case SO_DGE:
+			case SO_DEQ:
+				// TODO: to be tested
+				// 这四个指令dest mask 为1个或2个
+				out << "\n";
+				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
+				out << " = clamp(";
+				this->ToOperands(out, *insn.ops[0], oit);
+				out << ", 0.0f, 1.0f);";
 				break;
 
 			default:
+				//其余指令dest mask为2个或4个
+				//dest.xy=uintBitsToFloat(unpackDouble2x32(clamp(packDouble2x32(floatBitsToUint(dest.xy)))));
+				//获取dest mask的个数，只能为2或4（xy zw xyzw)
+				num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
+				for (int i = 0; i < num_comps; ++ i)
+				{
+					this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
+					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+					out << " = uintBitsToFloat(unpackDouble2x32(clamp(packDouble2x32(floatBitsToUint(";
+					this->ToOperands(out, *insn.ops[0], oit, false);
+					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
+					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
+					out << ")))));";
+					if ((2 == num_comps) && (0 == i))
+					{
+						out << "\n";
+					}
+				}
 				break;
 			}
-			out << "vec4(textureGather";
-			if (offset)
-			{
-				out << "Offset(";
-			}
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			out << "_";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			out << ", (";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask << ", ";
-			if (offset)
-			{
-				out << "ivec3(";
-				out << static_cast<int>(insn.sample_offset[0]) << ", "
-					<< static_cast<int>(insn.sample_offset[1]) << ", "
-					<< static_cast<int>(insn.sample_offset[2]) << ")";
-				out << offset_mask;
-			}
-			out << ", " << this->GetComponentSelector(*insn.ops[3], 0);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[2]);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
 		}
-		break;
+	}
+
+	// A mov passes the raw bits on
+	bool const raw = (SO_LD_RAW == insn.opcode)
+		|| ((SO_MOV == insn.opcode) && (SOT_TEMP == insn.ops[1]->type) && this->IsRawTemp(*insn.ops[1]));
+	for (uint32_t i = 0; i < num_outputs; ++ i)
+	{
+		if (SOT_TEMP == insn.ops[i]->type)
+		{
+			num_comps = this->GetOperandComponentNum(*insn.ops[i]);
+			for (int j = 0; j < num_comps; ++ j)
+			{
+				size_t const comp = static_cast<size_t>(insn.ops[i]->indices[0].disp) * 4
+					+ this->GetComponentSelector(*insn.ops[i], j);
+				temp_as_type_[comp] = static_cast<uint8_t>(oot);
+				temp_raw_[comp] = raw;
+			}
+		}
+	}
+}
 
-	case SO_GATHER4_C:
-		//gather4_indexable(u,v,w)(target)(comp_type) dest.mask, src0(coord),src1(resource), src2(sampler),src3 cmp_ref
-		//dest.mask=(textureGather[Offset](src1,src0[,offset],src2.comp).src1_mask).dest_mask;
+void GLSLGen::ToOperands(std::ostream& out, ShaderOperand const & op, uint32_t imm_as_type,
+		bool mask, bool dcl_array, bool no_swizzle, bool no_idx, bool no_cast, ShaderInputType const & sit) const
+{
+	ShaderImmType imm_type = static_cast<ShaderImmType>(imm_as_type & 0xFF);
+	ShaderImmType as_type = static_cast<ShaderImmType>(imm_as_type >> 8);
+
+	if (op.neg)
+	{
+		out << '-';
+	}
+	if (op.abs)
+	{
+		out << "abs(";
+	}
+	// 3.0 3 3U, etc
+	if (SOT_IMMEDIATE32 == op.type)
+	{
+		if (1 == op.comps)
 		{
-			char const * coord_mask = "";
-			char const * offset_mask = "";
-			bool offset = true;
-			switch (insn.resource_target)
+			switch (imm_type)
 			{
-			case SRD_TEXTURE2D:
-				coord_mask = ".xy";
-				offset_mask = ".xy";
-				break;
-
-			case SRD_TEXTURE2DARRAY:
-				coord_mask = ".xyz";
-				offset_mask = ".xy";
+			case SIT_Float:
+				// Normalized float test
+				if (ValidFloat(op.imm_values[0].f32))
+				{
+					out << FloatToString(op.imm_values[0].f32);
+				}
+				else
+				{
+					out << op.imm_values[0].i32;
+				}
 				break;
 
-			case SRD_TEXTURECUBE:
-				coord_mask = ".xyz";
-				offset = false;
+			case SIT_Int:
+				out << op.imm_values[0].i32;
 				break;
 
-			case SRD_TEXTURECUBEARRAY:
-				coord_mask = ".xyzw";
-				offset = false;
+			case SIT_UInt:
+				if ((0xC0490FDB == op.imm_values[0].u32) || (0x3F800000 == op.imm_values[0].u32))
+				{
+					// Hack for predefined magic value
+					out << FloatToString(op.imm_values[0].f32);
+				}
+				else
+				{
+					out << op.imm_values[0].u32;
+				}
 				break;
 
 			default:
 				assert(false);
 				break;
 			}
-			oot = this->FindTextureReturnType(*insn.ops[2]);
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ";
-			switch (oot)
+		}
+		else
+		{
+			if (SIT_Int == imm_type)
 			{
-			case SIT_UInt:
-			case SIT_Int:
 				out << "i";
-				break;
-
-			default:
-				break;
 			}
-			out << "vec4(textureGather";
-			if (offset)
+			else if (SIT_UInt == imm_type)
 			{
-				out << "Offset(";
+				if (glsl_rules_ & GSR_UIntType)
+				{
+					out << "u";
+				}
+				else
+				{
+					out << "i";
+				}
 			}
-			this->ToOperands(out, *insn.ops[2], oit, false);
-			out << "_";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			out << ", (";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask << ", ";
-			this->ToOperands(out, *insn.ops[4], oit);
-			if (offset)
+			out << "vec" << static_cast<int>(op.comps) << "(";
+			for (uint32_t i = 0; i < op.comps; ++ i)
 			{
-				out << ", ivec3(";
-				out << static_cast<int>(insn.sample_offset[0]) << ", "
-					<< static_cast<int>(insn.sample_offset[1]) << ", "
-					<< static_cast<int>(insn.sample_offset[2]) << ")";
-				out << offset_mask;
+				if (i != 0)
+				{
+					out << ", ";
+				}
+				switch (imm_type)
+				{
+				case SIT_Float:
+					// Normalized float test
+					if (ValidFloat(op.imm_values[i].f32))
+					{
+						out << FloatToString(op.imm_values[i].f32);
+					}
+					else
+					{
+						out << op.imm_values[i].i32;
+					}
+					break;
+
+				case SIT_Int:
+					out << op.imm_values[i].i32;
+					break;
+
+				case SIT_UInt:
+					out << op.imm_values[i].u32;
+					break;
+
+				case SIT_Double:
+				default:
+					assert(false);
+					break;
+				}
 			}
 			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[2]);
+		}
+	}
+	else if (SOT_IMMEDIATE64 == op.type)
+	{
+		// Only 4.3+ support double type
+
+		if (1 == op.comps)
+		{
+			out << DoubleToString(op.imm_values[0].f64) << "lf";
+		}
+		else
+		{
+			out << "dvec" << static_cast<int>(op.comps) << "(";
+			for (uint32_t i = 0; i < op.comps; ++ i)
+			{
+				if (i != 0)
+				{
+					out << ", ";
+				}
+				out << DoubleToString(op.imm_values[i].f64) << "lf";
+			}
 			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
 		}
-		break;
+	}
+	else
+	{
+		// 应该是类似v1 v2[2] o0 cb0[1]的这种变量名形式
 
-	case SO_GATHER4_PO:
-		//gather4_po_indexable(target)(comp_type) dest.mask, src0(coord),src1(offset),src2(resource),src3(sampler)
-		//dest.mask=(textureGatherOffset(src2,src0,src1,src3.comp).src2_mask).dest_mask;
+		int flag = 0;
+		int64_t start = 0;
+		int64_t index = 0;
+		int num = 0;
+		bool whether_output_comps = true;//for matrixs,do not output comps
+		bool whether_output_idx = true;//for cb member and vs input,no index
+		for (auto const & iri : idx_range_info_)
 		{
-			char const * coord_mask = "";
-			char const * offset_mask = "";
-			switch (insn.resource_target)
+			if (iri.op_type == op.type)
+			{
+				if (iri.start == op.indices[0].disp)
+				{
+					flag = 1;
+					start = iri.start;
+					num = iri.num;
+					break;
+				}
+				else if ((op.indices[0].disp > iri.start) && (op.indices[0].disp < iri.start + iri.num))
+				{
+					flag = 2;
+					index = op.indices[0].disp - iri.start;
+					start = iri.start;
+					break;
+				}
+			}
+		}
+
+		bool naked = false;
+		//ajudge whether it is naked
+		//naked为true表示有常数后缀如cb0[数字或表达式]
+		//naked为false表示没有常数后缀如v[数字或表达式],用于array input variable
+		switch (op.type)
+		{
+		case SOT_TEMP:
+		case SOT_INPUT:
+		case SOT_OUTPUT:
+		case SOT_CONSTANT_BUFFER:
+		case SOT_INDEXABLE_TEMP:
+		case SOT_RESOURCE:
+		case SOT_SAMPLER:
+		case SOT_UNORDERED_ACCESS_VIEW:
+		case SOT_THREAD_GROUP_SHARED_MEMORY:
+			naked = true;
+			break;
+
+		default:
+			naked = false;
+			break;
+		}
+		if (op.indices[0].reg)
+		{
+			naked = false;
+		}
+
+		bool cast = false;
+		ShaderImmType op_as_type;
+		if ((SOT_CONSTANT_BUFFER == op.type) && this->IsCBufferRegisterView(static_cast<uint32_t>(op.indices[0].disp)))
+		{
+			// vec4 cb_#[] holds the bits of int and uint members too
+			op_as_type = SIT_Float;
+		}
+		else if (imm_type != SIT_Unknown)
+		{
+			op_as_type = imm_type;
+		}
+		else
+		{
+			op_as_type = this->OperandAsType(op, imm_as_type);
+		}
+		if (!no_cast)
+		{
+			if ((SOT_TEMP == op.type) && (SIT_Unknown == as_type) && (SIT_Float == imm_type) && this->IsRawTemp(op))
+			{
+				out << "intBitsToFloat(";
+				cast = true;
+			}
+			else if (((SIT_Int == op_as_type) || (SIT_UInt == op_as_type))
+				&& ((SIT_Float == imm_type) || (SIT_Double == imm_type)))
+			{
+				if (SIT_UInt == op_as_type)
+				{
+					out << "uintBitsToFloat";
+				}
+				else
+				{
+					out << "intBitsToFloat";
+				}
+				out << "(";
+				cast = true;
+			}
+			else if (((SIT_Float == op_as_type) || (SIT_Double == op_as_type))
+				&& ((SIT_Int == imm_type) || (SIT_UInt == imm_type)))
 			{
-			case SRD_TEXTURE2D:
-				coord_mask = ".xy";
-				offset_mask = ".xy";
-				break;
+				if (SIT_UInt == imm_type)
+				{
+					out << "floatBitsToUint";
+				}
+				else
+				{
+					out << "floatBitsToInt";
+				}
+				out << "(";
+				cast = true;
+			}
+		}
 
-			case SRD_TEXTURE2DARRAY:
-				coord_mask = ".xyz";
-				offset_mask = ".xy";
-				break;
+		// output operand name 
+		this->ToOperandName(out, op, as_type, &whether_output_idx, &whether_output_comps, no_swizzle, no_idx, sit);
 
-			default:
-				assert(false);
-				break;
-			}
-			oot = this->FindTextureReturnType(*insn.ops[2]);
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ";
-			switch (oot)
+		// output index
+		// constant buffer is mapped to variable name,does not need index.
+		// vs input is mapped to semantic,does not need index.
+		if (whether_output_idx)
+		{
+			for (uint32_t i = 0; i < op.num_indices; ++ i)
 			{
-			case SIT_UInt:
-			case SIT_Int:
-				out << "i";
-				break;
-
-			default:
-				break;
+				//第一层索引不需要[]，如cb0[22]中0为第一层,naked==false需要[]
+				if (!naked || (i != 0))
+				{
+					out << '[';
+				}
+				if (op.indices[i].reg)
+				{
+					out << "int(";
+					this->ToOperands(out, *op.indices[i].reg, imm_type, true, false, false, false, true);
+					if (op.indices[i].disp)
+					{
+						out << "+" << op.indices[i].disp;
+					}
+					out << ")";
+				}
+				else
+				{
+					if (0 == i)
+					{
+						if (dcl_array)
+						{
+							// Declare an array
+							out << op.indices[i].disp;
+							if (1 == flag)
+							{
+								out << "[" << num << "]";
+							}
+						}
+						else
+						{
+							// Use an array
+							if (0 == flag)
+							{
+								out << op.indices[i].disp;
+							}
+							else
+							{
+								out << start << "[" << index << "]";
+							}
+						}
+					}
+					else
+					{
+						out << op.indices[i].disp;
+					}
+				}
+				if (!naked || (i != 0))
+				{
+					out << ']';
+				}
 			}
-			out << "vec4(textureGatherOffset(";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			out << "_";
-			this->ToOperands(out, *insn.ops[4], oit, false);
-			out << ", (";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask << ", ";
-			this->ToOperands(out, *insn.ops[2], SIT_Int);
-			out << offset_mask;
-			out << ", " << this->GetComponentSelector(*insn.ops[3], 0);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[3]);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
 		}
-		break;
-
-	case SO_GATHER4_PO_C:
-		//gather4_po_c_indexable(target)(comp_type) dest.mask, src0(coord),src1(offset),src2(resource),src3(sampler),scr4(cmp_ref)
-		//dest.mask=(textureGatherOffset(src2,src0,src1,src3.comp).src2_mask).dest_mask;
+		//output component selectors
+		//matrix has been converted to mat[2][3]-like form,do not need ouput comps
+		if (whether_output_comps)
 		{
-			char const * coord_mask = "";
-			char const * offset_mask = "";
-			switch (insn.resource_target)
+			if (op.comps && mask)
 			{
-			case SRD_TEXTURE2D:
-				coord_mask = ".xy";
-				offset_mask = ".xy";
-				break;
+				switch (op.mode)
+				{
+				case SOSM_MASK:
+					out << '.';
+					this->ToComponentSelector(out, this->ComponentSelectorFromMask(op.mask, op.comps));
+					break;
 
-			case SRD_TEXTURE2DARRAY:
-				coord_mask = ".xyz";
-				offset_mask = ".xy";
-				break;
+				case SOSM_SWIZZLE:
+					out << '.';
+					this->ToComponentSelector(out, this->ComponentSelectorFromSwizzle(op.swizzle, op.comps));
+					break;
 
-			default:
-				assert(false);
-				break;
-			}
-			oot = this->FindTextureReturnType(*insn.ops[2]);
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = ";
-			switch (oot)
-			{
-			case SIT_UInt:
-			case SIT_Int:
-				out << "i";
-				break;
+				case SOSM_SCALAR:
+					out << '.';
+					this->ToComponentSelector(out, this->ComponentSelectorFromScalar(op.swizzle[0]));
+					break;
 
-			default:
-				break;
+				default:
+					assert(false);
+					break;
+				}
 			}
-			out << "vec4(textureGatherOffset(";
-			this->ToOperands(out, *insn.ops[3], oit, false);
-			out << "_";
-			this->ToOperands(out, *insn.ops[4], oit, false);
-			out << ", (";
-			this->ToOperands(out, *insn.ops[1], oit);
-			out << ")" << coord_mask << ", ";
-			this->ToOperands(out, *insn.ops[2], SIT_Int);
-			out << offset_mask << ", " << this->GetComponentSelector(*insn.ops[4], 0) << ")";
-			this->ToComponentSelectors(out, *insn.ops[3]);
-			out << ")";
-			this->ToComponentSelectors(out, *insn.ops[0]);
-			out << ";";
 		}
-		break;
-
-	case SO_DERIV_RTX_COARSE:
-	case SO_DERIV_RTX_FINE:
-		//deriv_rtx_coarse[_sat] dest[.mask], [-]src0[_abs][.swizzle]
-		//dest.mask=ddx(src0).mask
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(dFdx(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
 
-	case SO_DERIV_RTY_COARSE:
-	case SO_DERIV_RTY_FINE:
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = vec4(dFdy(";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << "))";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+		if (cast)
+		{
+			out << ")";
+		}
+	}
 
-	case SO_LD_UAV_TYPED:
-		//ld_uav_typed dst0[.mask], srcAddress[.swizzle], srcUAV[.swizzle]
-		//dst0.mask=(imageLoad(srcUAV,srcAddress).srcUAV_mask).dst_mask;
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << " = vec4(imageLoad(";
-		this->ToOperands(out, *insn.ops[2], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], SIT_UInt);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[2]);
+	if (op.abs)
+	{
 		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
+	}
+}
 
-	case SO_STORE_UAV_TYPED:
-		{
-			//store_uav_typed dstUAV.xyzw, dstAddress[.swizzle](uint), src0[.swizzle]
-			//imageStore(dstUAV,dstAddress,src0);
+ShaderImmType GLSLGen::OperandAsType(ShaderOperand const & op, uint32_t imm_as_type) const
+{
+	ShaderImmType imm_type = static_cast<ShaderImmType>(imm_as_type & 0xFF);
+	ShaderImmType as_type = static_cast<ShaderImmType>(imm_as_type >> 8);
 
-			//get component type of UAV
-			DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_UAV_RWTYPED, static_cast<uint32_t>(insn.ops[0]->indices[0].disp));
-			ShaderImmType data_sit;
-			switch (desc.return_type)
+	if (SOT_IMMEDIATE32 == op.type)
+	{
+		as_type = SIT_Unknown;
+		for (uint32_t i = 0; i < op.comps; ++ i)
+		{
+			switch (imm_type)
 			{
-			case SRRT_UNORM:
-			case SRRT_SNORM:
-			case SRRT_FLOAT:
-				data_sit = SIT_Float;
+			case SIT_Float:
+				// Normalized float test
+				if (ValidFloat(op.imm_values[i].f32))
+				{
+					as_type = std::max(as_type, SIT_Float);
+				}
+				else
+				{
+					as_type = std::max(as_type, SIT_Int);
+				}
 				break;
 
-			case SRRT_SINT:
-				data_sit = SIT_Int;
+			case SIT_Int:
+				as_type = std::max(as_type, SIT_Int);
 				break;
 
-			case SRRT_UINT:
-				data_sit = SIT_UInt;
+			case SIT_UInt:
+				if ((0xC0490FDB == op.imm_values[0].u32) || (0x3F800000 == op.imm_values[0].u32))
+				{
+					// Hack for predefined magic value
+					as_type = std::max(as_type, SIT_Float);
+				}
+				else
+				{
+					as_type = std::max(as_type, SIT_UInt);
+				}
 				break;
 
 			default:
-				assert_msg(false, "Unsupported resource return type");
-				data_sit = SIT_Float;
+				assert(false);
 				break;
 			}
-			out << "imageStore(";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-			out << ", ";
-			this->ToOperands(out, *insn.ops[1], SIT_UInt);
-			out << ", ";
-			this->ToOperands(out, *insn.ops[2], data_sit);
-			out << ");";
 		}
-		break;
-
-	case SO_LD_STRUCTURED:
-		// ld_structured dst0[.mask], srcAddress[.select_component], srcByteOffset[.select_component], src0[.swizzle]
-		// dst0[.mask]=src0[srcAddress[.select_component]][.swizzle].dst0_mask;
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), true);
-		out << " = vec4(";
-		ShaderInputType sit;
-		switch(insn.ops[3]->type)
+	}
+	else if (SOT_IMMEDIATE64 == op.type)
+	{
+		as_type = SIT_Double;
+	}
+	else
+	{
+		if (SIT_Unknown == as_type)
 		{
-		case SOT_RESOURCE:
-			sit = SIT_STRUCTURED;
-			break;
-
-		case SOT_UNORDERED_ACCESS_VIEW:
-		case SOT_THREAD_GROUP_SHARED_MEMORY:
-			sit = SIT_UAV_RWSTRUCTURED;
-			break;
-
-		default:
-			assert(false);
-			break;
-		}
-		this->ToOperands(out, *insn.ops[3], oit, false, false, false, false, false,sit);
-		out << "[";
-		this->ToOperands(out, *insn.ops[1], SIT_UInt);
-		out << "]";
-		this->ToComponentSelectors(out, *insn.ops[3], true, static_cast<uint32_t>(insn.ops[2]->imm_values[0].u32) / 4);
-		out << ")";
-		this->ToComponentSelectors(out, *insn.ops[0]);
-		out << ";";
-		break;
-
-	case SO_STORE_STRUCTURED:
-		//store_structured dst0[.write_mask], dstAddress[.select_component], dstByteOffset[.select_component], src0[.swizzle]
-		//dst0[dstAddress[.select_component]][.write_mask]=src0[.swizzle]
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false, false, false, false, false, SIT_UAV_RWSTRUCTURED);
-		out << "[";
-		this->ToOperands(out, *insn.ops[1], SIT_UInt);
-		out << "]";
-		this->ToComponentSelectors(out, *insn.ops[0], true, static_cast<uint32_t>(insn.ops[2]->imm_values[0].u32) / 4);
-		out << " = vec4(";
-		this->ToOperands(out, *insn.ops[3], oit, true);
-		out <<")";
-		this->ToComponentSelectors(out,*insn.ops[0]);
-		out << ";";
-		break;
-
-		//------------------------------------------------------------------
-		//atomic operations
-		//-------------------------------------------------------------------
+			if (SOT_TEMP == op.type)
+			{
+				as_type = SIT_Unknown;
+				for (int i = 0; i < this->GetOperandComponentNum(op); ++ i)
+				{
+					as_type = std::max(as_type, static_cast<ShaderImmType>(temp_as_type_[
+						static_cast<size_t>(op.indices[0].disp) * 4 + this->GetComponentSelector(op, i)]));
+				}
+			}
+			else if (SOT_INPUT == op.type)
+			{
+				switch (this->GetInputParamDesc(op, (ST_GS == shader_type_) ? 1 : 0).component_type)
+				{
+				case SRCT_UINT32:
+					as_type = SIT_UInt;
+					break;
 
-	case SO_ATOMIC_AND:
-		//atomic_and dst, dstAddress[.swizzle], src0[.select_component]
-		//imageAtomicAnd(dst,dstAddress[.swizzle],src0);
-		out << "imageAtomicAnd(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ");";
-		break;
+				case SRCT_SINT32:
+					as_type = SIT_Int;
+					break;
 
-	case SO_ATOMIC_OR:
-		//atomic_or dst, dstAddress[.swizzle], src0[.select_component]
-		//imageAtomicOr(dst,dstAddress[.swizzle],src0);
-		out << "imageAtomicOr(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ");";
-		break;
+				case SRCT_FLOAT32:
+					as_type = SIT_Float;
+					break;
 
-	case SO_ATOMIC_XOR:
-		//atomic_xor dst, dstAddress[.swizzle], src0[.select_component]
-		//imageAtomicXor(dst,dstAddress[.swizzle],src0);
-		out << "imageAtomicXor(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ");";
-		break;
+				default:
+					assert(false);
+					break;
+				}
+			}
+			else if (SOT_OUTPUT == op.type)
+			{
+				switch (this->GetOutputParamType(op))
+				{
+				case SRCT_UINT32:
+					as_type = SIT_UInt;
+					break;
 
-	case SO_ATOMIC_CMP_STORE:
-		//atomic_cmp_store dst, dstAddress[.swizzle], src0[.select_component], src1[.select_component]
-		//imageAtomicCompSwap(dst,dstAddress[.swizzle],src0[.select_component], src1[.select_component]);
-		out << "imageAtomicCompSwap(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+				case SRCT_SINT32:
+					as_type = SIT_Int;
+					break;
 
-	case SO_ATOMIC_IADD:
-		//atomic_iadd dst, dstAddress[.swizzle], src0[.select_component]
-		//imageAtomicAdd(dst,dstAddress[.swizzle],src0);
-		out << "imageAtomicAdd(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ");";
-		break;
+				case SRCT_FLOAT32:
+					as_type = SIT_Float;
+					break;
 
-	case SO_ATOMIC_IMAX:
-	case SO_ATOMIC_UMAX:
-		//atomic_imax dst, dstAddress[.swizzle], src0[.select_component]
-		//imageAtomicMax(dst,dstAddress[.swizzle],src0);
-		out << "imageAtomicMax(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ");";
-		break;
+				default:
+					assert(false);
+					break;
+				}
+			}
+			else if ((SOT_CONSTANT_BUFFER == op.type) && this->IsCBufferRegisterView(static_cast<uint32_t>(op.indices[0].disp)))
+			{
+				as_type = SIT_Float;
+			}
+			else if (SOT_CONSTANT_BUFFER == op.type)
+			{
+				uint32_t bind_point = static_cast<uint32_t>(op.indices[0].disp);
+				uint32_t register_index = static_cast<uint32_t>(op.indices[1].disp);
+				uint32_t min_selector = this->GetMinComponentSelector(op);
+				uint32_t offset = 16 * register_index + min_selector * 4;
 
-	case SO_ATOMIC_IMIN:
-	case SO_ATOMIC_UMIN:
-		//atomic_imin dst, dstAddress[.swizzle], src0[.select_component]
-		//imageAtomicMin(dst,dstAddress[.swizzle],src0);
-		out << "imageAtomicMin(";
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[1], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ");";
-		break;
+				// find which cb member current cb# array index is located in
+				DXBCShaderVariable const * var = this->FindCBufferMember(bind_point, offset);
+				if (var)
+				{
+					switch (var->type_desc.type)
+					{
+					case SVT_INT:
+						as_type = SIT_Int;
+						break;
 
-	case SO_IMM_ATOMIC_IADD:
-		//imm_atomic_iadd dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicAdd(dst1,dstAddress[.swizzle],src0);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = imageAtomicAdd(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+					case SVT_UINT:
+						as_type = SIT_UInt;
+						break;
 
-	case SO_IMM_ATOMIC_AND:
-		//imm_atomic_and dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicAnd(dst1,dstAddress[.swizzle],src0);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = imageAtomicAnd(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+					case SVT_FLOAT:
+						as_type = SIT_Float;
+						break;
 
-	case SO_IMM_ATOMIC_OR:
-		//imm_atomic_or dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicOr(dst1,dstAddress[.swizzle],src0);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = imageAtomicOr(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+					default:
+						assert(false);
+						break;
+					}
+				}
+			}
+			else
+			{
+				as_type = imm_type;
+			}
+		}
+	}
 
-	case SO_IMM_ATOMIC_XOR:
-		//imm_atomic_xor dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicXor(dst1,dstAddress[.swizzle],src0);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = imageAtomicXor(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+	return as_type;
+}
 
-	case SO_IMM_ATOMIC_IMAX:
-	case SO_IMM_ATOMIC_UMAX:
-		//imm_atomic_imax dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicMax(dst1,dstAddress[.swizzle],src0);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = imageAtomicMax(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+void GLSLGen::ToOperandName(std::ostream& out, ShaderOperand const & op, ShaderImmType as_type,
+		bool* need_idx, bool* need_comps, bool no_swizzle, bool no_idx, ShaderInputType const & sit) const
+{
+	*need_comps = true;
+	*need_idx = true;
+	if ((ST_PS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type)))
+	{
+		if (SOT_INPUT == op.type)
+		{
+			SignatureRegister const & reg = this->GetInputRegister(op);
+			if (reg.builtin)
+			{
+				*need_comps = !reg.builtin_scalar;
+				*need_idx = false;
+				out << reg.builtin;
+			}
+			else if (!reg.varying.empty() && !op.indices[0].reg)
+			{
+				*need_idx = false;
+				out << reg.varying;
+			}
+			else
+			{
+				out << "i_REGISTER";
+			}
+		}
+		else
+		{
+			assert(SOT_OUTPUT == op.type);
 
-	case SO_IMM_ATOMIC_IMIN:
-	case SO_IMM_ATOMIC_UMIN:
-		//imm_atomic_umin dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicMin(dst1,dstAddress[.swizzle],src0);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << " = imageAtomicMin(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+			SignatureRegister const * reg = FindDirectRegister(output_registers_, op);
+			if (reg)
+			{
+				*need_idx = false;
+				out << reg->varying;
+			}
+			else
+			{
+				out << "o_REGISTER";
+			}
+		}
+	}
+	else if ((ST_VS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type)))
+	{
+		if (SOT_INPUT == op.type)
+		{
+			SignatureRegister const & reg = this->GetInputRegister(op);
+			if (reg.builtin)
+			{
+				*need_comps = !reg.builtin_scalar;
+				*need_idx = false;
+				out << reg.builtin;
+			}
+			else if (!reg.varying.empty() && !op.indices[0].reg)
+			{
+				*need_idx = false;
+				out << reg.varying;
+			}
+			else
+			{
+				*need_idx = true;
+				out << "i_REGISTER";
+			}
+		}
+		else
+		{
+			assert(SOT_OUTPUT == op.type);
 
-	case SO_IMM_ATOMIC_CMP_EXCH:
-		//imm_atomic_cmp_exch dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component], src1[.select_component]
-		//imageAtomicCompSwap(dst,dstAddress[.swizzle],src0[.select_component], src1[.select_component]);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << "= imageAtomicCompSwap(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[4], oit);
-		out << ");";
-		break;
+			SignatureRegister const & reg = this->GetOutputRegister(op);
+			if (reg.builtin)
+			{
+				*need_idx = false;
+				out << reg.builtin << '[' << reg.desc->semantic_index << ']';
+			}
+			else if (!reg.varying.empty() && !op.indices[0].reg)
+			{
+				*need_idx = false;
+				out << reg.varying;
+			}
+			else
+			{
+				*need_idx = true;
+				out << "o_REGISTER";
+			}
+		}
+	}
+	else if ((ST_GS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type)))
+	{
+		if (SOT_INPUT == op.type)
+		{
+			*need_idx = false;
+			out << "i_REGISTER" << op.indices[1].disp;
+			if (!no_idx)
+			{
+				out << '[' << op.indices[0].disp << ']';
+			}
+		}
+		else
+		{
+			assert(SOT_OUTPUT == op.type);
 
-	case SO_IMM_ATOMIC_EXCH:
-		//imm_atomic_exch dst0[.single_component_mask], dst1, dstAddress[.swizzle], src0[.select_component]
-		//dst0[.single_component_mask]=imageAtomicExchange(dst1,dstAddress[.swizzle], src0[.select_component]);
-		this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-		out << "= imageAtomicExchange(";
-		this->ToOperands(out, *insn.ops[1], oit, false);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[2], oit);
-		out << ", ";
-		this->ToOperands(out, *insn.ops[3], oit);
-		out << ");";
-		break;
+			*need_idx = true;
+			out << "o_REGISTER";
+		}
+	}
+	else if ((ST_HS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type) || (SOT_INPUT_CONTROL_POINT == op.type)))
+	{
+		if (SOT_INPUT == op.type || SOT_INPUT_CONTROL_POINT == op.type)
+		{
+			*need_idx = false;
+			out << "i_REGISTER" << op.indices[1].disp;
+			//why need this?
+			/*if (!no_idx)
+			{
+				out << '[' << op.indices[0].disp << ']';
+			}*/
+			//I use this,so that it can support representations index.
+			if (op.indices[0].reg)
+			{
+				out << "[int(";
+				this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
+				if (op.indices[0].disp)
+				{
+					out << "+" << op.indices[0].disp;
+				}
+				out << ")]";
+			}
+			else
+			{
+				out << '[' << op.indices[0].disp << ']';
+			}
 
-		//------------------------------------------------------------------
-		// Geometry shader operations
-		//-------------------------------------------------------------------
-	case SO_EMIT:
-		this->ToCopyToInterShaderOutputRecords(out);
-		out << "EmitVertex();";
-		break;
+		}
+		else
+		{
+			assert(SOT_OUTPUT == op.type);
 
-	case SO_EMITTHENCUT:
-		out << "EndPrimitive();";
-		break;
+			*need_idx = false;
+			if (enter_hs_fork_phase_ || enter_hs_join_phase_)
+			{
+				out << "p_REGISTER";
+			}
+			else
+			{
+				out << "o_REGISTER";
+			}
+			if (enter_hs_fork_phase_ || enter_hs_join_phase_)
+			{
+				if (op.indices[0].reg)
+				{
+					out << "[int(";
+					this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
+					if (op.indices[0].disp)
+					{
+						out << "+" << op.indices[0].disp;
+					}
+					out << ")]";
+				}
+				else
+				{
+					out << '[' << op.indices[0].disp << ']';
+				}
+			}
+			else
+			{
+				out << op.indices[0].disp;
+			}
+		}
+	}
+	else if ((ST_DS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type) || (SOT_INPUT_CONTROL_POINT == op.type)
+		|| (SOT_INPUT_DOMAIN_POINT == op.type) || (SOT_INPUT_PATCH_CONSTANT == op.type)))
+	{
+		if ((SOT_INPUT == op.type) || (SOT_INPUT_CONTROL_POINT == op.type))
+		{
+			*need_idx = false;
+			out << "i_REGISTER" << op.indices[1].disp;
+			//why need this?
+			/*if (!no_idx)
+			{
+				out << '[' << op.indices[0].disp << ']';
+			}*/
+			//I use this,so that it can support representations index.
+			if (op.indices[0].reg)
+			{
+				out << "[int(";
+				this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
+				if (op.indices[0].disp)
+				{
+					out << "+" << op.indices[0].disp;
+				}
+				out << ")]";
+			}
+			else
+			{
+				out << '[' << op.indices[0].disp << ']';
+			}
 
-	case SO_EMIT_STREAM:
-		this->ToCopyToInterShaderOutputRecords(out);
-		if ((glsl_rules_ & GSR_MultiStreamGS)
-			&& (SPT_PointList == program_->gs_output_topology[static_cast<uint32_t>(insn.ops[0]->indices[0].disp)]))
-		{
-			out << "EmitStreamVertex(" << insn.ops[0]->indices[0].disp << ");";
 		}
-		else
+		else if (SOT_INPUT_DOMAIN_POINT == op.type)
 		{
-			out << "EmitVertex();";
+			out << "gl_TessCoord";
+			*need_idx = false;
+			*need_comps = true;
 		}
-		break;
-
-	case SO_EMITTHENCUT_STREAM:
-		this->ToCopyToInterShaderOutputRecords(out);
-		if ((glsl_rules_ & GSR_MultiStreamGS)
-			&& (SPT_PointList == program_->gs_output_topology[static_cast<uint32_t>(insn.ops[0]->indices[0].disp)]))
+		else if (SOT_INPUT_PATCH_CONSTANT == op.type)
 		{
-			out << "EmitStreamVertex(" << insn.ops[0]->indices[0].disp << ");\n";
-			out << "EndStreamPrimitive(" << insn.ops[0]->indices[0].disp << ");";
+			out << "p_REGISTER";
+			if (op.indices[0].reg)
+			{
+				out << "[int(";
+				this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
+				if (op.indices[0].disp)
+				{
+					out << "+" << op.indices[0].disp;
+				}
+				out << ")]";
+			}
+			else
+			{
+				out << '[' << op.indices[0].disp << ']';
+			}
+			*need_idx = false;
 		}
 		else
 		{
-			out << "EmitVertex();\n";
-			out << "EndPrimitive();";
+			assert(SOT_OUTPUT == op.type);
+			*need_idx = false;
+			out << "o_REGISTER";
+			out << op.indices[0].disp;
+		}
+	}
+	else if (SOT_OUTPUT_DEPTH == op.type)
+	{
+		out << "o_REGISTERDepth";
+		*need_comps = true;
+		*need_idx = false;
+	}
+	else if (SOT_TEMP == op.type)
+	{
+		if (SIT_Unknown == as_type)
+		{
+			as_type = static_cast<ShaderImmType>(temp_as_type_[static_cast<size_t>(op.indices[0].disp) * 4
+				+ this->GetComponentSelector(op, 0)]);
 		}
-		break;
 
-	case SO_CUT_STREAM:
-		if ((glsl_rules_ & GSR_MultiStreamGS)
-			&& (SPT_PointList == program_->gs_output_topology[static_cast<uint32_t>(insn.ops[0]->indices[0].disp)]))
+		out << 't';
+		switch (as_type)
 		{
-			out << "EndStreamPrimitive(" << insn.ops[0]->indices[0].disp << ");";
+		case SIT_Float:
+		case SIT_Double:
+			out << 'f';
+			break;
+
+		case SIT_Int:
+		case SIT_UInt:
+			out << 'i';
+			break;
+
+		default:
+			assert(false);
+			break;
 		}
-		else
+	}
+	else if (SOT_SAMPLER == op.type)
+	{
+		DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(op.indices[0].disp));
+		out << desc.name;
+		*need_comps = false;
+		*need_idx = false;
+	}
+	else if (SOT_RESOURCE == op.type)
+	{
+		ShaderInputType type = SIT_TEXTURE;
+		if (SIT_UNDEFINED != sit)
 		{
-			out << "EndPrimitive();";
+			type = sit;
 		}
-		break;
-
-	default:
-		//assert_msg(false, "Unhandled instructions");
-		break;
+		DXBCInputBindDesc const & desc = this->GetResourceDesc(type, static_cast<uint32_t>(op.indices[0].disp));
+		out << desc.name;
+		*need_comps = false;
+		*need_idx = false;
 	}
-
-	if (insn.insn.sat)
+	else if (SOT_UNORDERED_ACCESS_VIEW == op.type)
 	{
-		// process _sat instruction modifier
-
-		if (SIT_Float == oit)
+		ShaderInputType type = SIT_UAV_RWTYPED;
+		if(SIT_UNDEFINED != sit)
 		{
-			out << "\n";
-			this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-			out << " = clamp(";
-			this->ToOperands(out, *insn.ops[0], oit);
-			out << ", 0.0f, 1.0f);";
+			type = sit;
 		}
-		else if (SIT_Double == oit)
+		DXBCInputBindDesc const & desc = this->GetResourceDesc(type, static_cast<uint32_t>(op.indices[0].disp));
+		out << desc.name;
+		*need_comps = false;
+		*need_idx = false;
+	}
+	else if (SOT_INDEXABLE_TEMP == op.type)
+	{
+		out << "IndexableTemp";
+	}
+	else if ((SOT_INPUT == op.type) && (ST_VS == shader_type_))
+	{
+		*need_idx = false;
+
+		DXBCSignatureParamDesc const & param_desc = this->GetInputParamDesc(op);
+		*need_comps = (param_desc.mask > 1);
+		out << param_desc.semantic_name << param_desc.semantic_index;
+	}
+	else if ((SOT_CONSTANT_BUFFER == op.type) && this->IsCBufferRegisterView(static_cast<uint32_t>(op.indices[0].disp)))
+	{
+		// cb_#[i] as it is, the block itself may be named cb#
+		out << "cb_";
+	}
+	else if (SOT_CONSTANT_BUFFER == op.type)
+	{
+		*need_idx = false;
+
+		// map cb array element to cb member names(with array index if it's a array)
+
+		// map cb#[i] to a cb member name
+		uint32_t bind_point = static_cast<uint32_t>(op.indices[0].disp);
+		CBufferLayout const * layout = this->FindCBufferLayout(bind_point);
+		bool dynamic_indexed = layout && layout->dynamic_indexed;
+		uint32_t register_index = static_cast<uint32_t>(op.indices[1].disp);
+		uint32_t min_selector = this->GetMinComponentSelector(op);
+		uint32_t offset = 16 * register_index + min_selector * 4;
+		uint32_t num_selectors = this->GetOperandComponentNum(op);
+
+		// find which cb member current cb# array index is located in
+		DXBCShaderVariable const * member = this->FindCBufferMember(bind_point, offset);
+		if (member)
 		{
-			switch (insn.opcode)
+			DXBCShaderVariable const & var = *member;
+
+			// indicate if a register contains more than one variables because of register packing
+			bool contain_multi_var = false;
+			uint32_t max_selector = this->GetMaxComponentSelector(op);
+			if ((offset + (max_selector - min_selector + 1) * 4) > (var.var_desc.start_offset + var.var_desc.size))
 			{
-			case SO_DLT:
-			case SO_DNE:
-			case SO_DGE:
-			case SO_DEQ:
-				// TODO: to be tested
-				// 这四个指令dest mask 为1个或2个
-				out << "\n";
-				this->ToOperands(out, *insn.ops[0], oot | (oot << 8));
-				out << " = clamp(";
-				this->ToOperands(out, *insn.ops[0], oit);
-				out << ", 0.0f, 1.0f);";
+				contain_multi_var = true;
+			}
+			assert_msg(var.has_type_desc, "Constant buffer should have type desc");
+
+			// if cb member is a array,this is element count, 0 if not a array
+			uint32_t element_count = var.type_desc.elements;
+			// find corresponding cb member array element index if it's a array
+			uint32_t element_index = 0;
+
+			switch (var.type_desc.var_class)
+			{
+			case SVC_VECTOR:
+			case SVC_SCALAR:
+				if (contain_multi_var)
+				{
+
+					//if a current register references more than one variable,things become more
+					//complex:
+					//e.g.
+					//|a[3].x|a[3].y|b   |c   |->this is a register,a b c are variables,a is an array
+					//|.x    |.y    |.z  |.w  |->this is register component
+					//current register reference is .yzw
+					//so we should convert it to :
+					//[i|u]vec{2,3,4}(a[3].y,b.x,c.x)
+					*need_comps = false;
+					switch (var.type_desc.type)
+					{
+					case SVT_INT:
+						out << "i";
+						break;
+
+					case SVT_UINT:
+						if (glsl_rules_ & GSR_UIntType)
+						{
+							out << "u";
+						}
+						else
+						{
+							out << "i";
+						}
+						break;
+
+					case SVT_FLOAT:
+						break;
+
+					default:
+						assert(false);
+						break;
+					}
+					out << "vec" << num_selectors;
+					out << "(";
+					for (uint32_t i = 0; i < num_selectors; ++ i)
+					{
+						if (i != 0)
+						{
+							out << ", ";
+						}
+
+						uint32_t register_selector = this->GetComponentSelector(op, i);
+						// find the cb member this register selector correspond to
+						uint32_t offset2 = 16 * register_index + register_selector * 4;
+						DXBCShaderVariable const * var2 = this->FindCBufferMember(bind_point, offset2);
+						if (var2)
+						{
+							out << var2->var_desc.name;
+							uint32_t element_count2 = var2->type_desc.elements;
+							// ajudge which cb member array element it's located in
+							if (element_count2)
+							{
+								element_index = (16 * register_index - var2->var_desc.start_offset) / 16;
+								out << "[" << element_index << "]";
+							}
+
+							if ((SVC_VECTOR == var2->type_desc.var_class) && !no_swizzle)
+							{
+								// remap register selector to the right cb member variable component
+								out << ".";
+								// for array,doesn't need to remap because array element is always at the start of a register,since
+								// array is not packed.
+								if (element_count2)
+								{
+									out << "xyzw"[register_selector];
+								}
+								else
+								{
+									// remap
+									uint32_t variable_offset = var2->var_desc.start_offset;
+									uint32_t register_component_offset = 16 * register_index + 4 * this->GetComponentSelector(op, i);
+									uint32_t remapped_component = (register_component_offset - variable_offset) / 4;
+									out << "xyzw"[remapped_component];
+								}
+							}
+						}
+					}
+					out << ")";
+				}
+				else
+				{
+					out << var.var_desc.name;
+					if (element_count != 0)
+					{
+						out << "[";
+						if (dynamic_indexed && op.indices[1].reg)
+						{
+							this->ToOperands(out, *op.indices[1].reg, SIT_Int);
+						}
+						else
+						{
+							element_index = (16 * register_index - var.var_desc.start_offset) / 16;
+							out << element_index;
+						}
+						out << "]";
+					}
+					else
+					{
+						// array is not packed, so doesn't need remap component_selector
+						// if not, because of register packing, we need to remap it.
+						// see: http://msdn.microsoft.com/zh-cn/library/windows/desktop/bb509632
+
+						*need_comps = false;
+						if ((SVC_VECTOR == var.type_desc.var_class) && !no_swizzle)
+						{
+							// remap register component to the right cb member variable component
+							// example case:
+							// |a  |b  |c.x|c.y|->this is a register,a b c is three variables
+							// |.x |.y |.z |.w |->this is register component
+							// so we need to remap .zw to .xy
+							for (uint32_t i = 0; i < num_selectors; ++ i)
+							{
+								if (i == 0)
+								{
+									out << ".";
+								}
+								uint32_t variable_offset = var.var_desc.start_offset;
+								uint32_t register_component_offset = 16 * register_index + 4 * this->GetComponentSelector(op, i);
+								uint32_t remapped_component = (register_component_offset - variable_offset) / 4;
+								out << "xyzw"[remapped_component];
+							}
+						}
+					}
+
+					if (SVC_SCALAR == var.type_desc.var_class)
+					{
+						*need_comps = false;
+					}
+				}
+				break;
+
+			case SVC_MATRIX_ROWS:
+			case SVC_MATRIX_COLUMNS:
+				{
+					//hlsl matrix subscript is opposite to glsl
+					//e.g.in hlsl mat[2][3] <=>in glsl mat[3][2]
+					//so mat[2].xyzw in hlsl<=>vec4(mat[0][2],mat[1][2],mat[2][2],mat[3][2]) in glsl
+
+					assert_msg(!contain_multi_var, "Matrix will not be packed?");
+
+					//indicate how many registers a matrix array element occupies
+					uint32_t register_stride;
+					if (SVC_MATRIX_ROWS == var.type_desc.var_class)
+					{
+						register_stride = var.type_desc.rows;
+					}
+					else
+					{
+						register_stride = var.type_desc.columns;
+					}
+					if (element_count != 0)
+					{
+						//identify which matrix array element it's loacated in
+						element_index = (16 * register_index - var.var_desc.start_offset) / 16 / register_stride;
+					}
+					uint32_t row = (16 * register_index - var.var_desc.start_offset) / 16 - element_index * register_stride;
+					uint32_t count = this->GetOperandComponentNum(op);
+					if (count == 1)
+					{
+						out << "float";
+					}
+					else
+					{
+						out << "vec" << count;//glsl only support float or double matrix 
+					}
+					out << "(";
+					for (uint32_t i = 0; i < count; ++ i)
+					{
+						if (i > 0)
+						{
+							out << ", ";
+						}
+						//convert component selector to column number
+						//x y z w--> 0 1 2 3
+						uint32_t column = this->GetComponentSelector(op, i);
+						out << var.var_desc.name;
+						if (glsl_rules_ & GSR_MatrixType)
+						{
+							if (element_count)
+							{
+								out << "[";
+								if (dynamic_indexed && op.indices[1].reg)
+								{
+									this->ToOperands(out, *op.indices[1].reg, SIT_Int);
+								}
+								else
+								{
+									out << element_index;
+								}
+								// The index is in float4. So for 4x4 matrix, divide by register_stride
+								out << " / " << register_stride;
+								out << "]";
+							}
+							if (SVC_MATRIX_ROWS == var.type_desc.var_class)
+							{
+								out << "[" << column << "]" << "[" << row << "]";
+							}
+							else
+							{
+								out << "[" << row << "]" << "[" << column << "]";
+							}
+						}
+						else
+						{
+							out << "[";
+							if (element_count)
+							{
+								if (dynamic_indexed && op.indices[1].reg)
+								{
+									this->ToOperands(out, *op.indices[1].reg, SIT_Int);
+								}
+								else
+								{
+									out << element_index;
+								}
+								out << " + ";
+							}
+							if (SVC_MATRIX_ROWS == var.type_desc.var_class)
+							{
+								out << column;
+							}
+							else
+							{
+								out << row;
+							}
+							out << "][";
+							if (SVC_MATRIX_ROWS == var.type_desc.var_class)
+							{
+								out << row;
+							}
+							else
+							{
+								out << column;
+							}
+							out << "]";
+						}
+					}
+					out << ")";
+					*need_comps = false;
+					}
 				break;
 
 			default:
-				//其余指令dest mask为2个或4个
-				//dest.xy=uintBitsToFloat(unpackDouble2x32(clamp(packDouble2x32(floatBitsToUint(dest.xy)))));
-				//获取dest mask的个数，只能为2或4（xy zw xyzw)
-				num_comps = this->GetOperandComponentNum(*insn.ops[0]) / 2;
-				for (int i = 0; i < num_comps; ++ i)
-				{
-					this->ToOperands(out, *insn.ops[0], oot | (oot << 8), false);
-					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-					out << " = uintBitsToFloat(unpackDouble2x32(clamp(packDouble2x32(floatBitsToUint(";
-					this->ToOperands(out, *insn.ops[0], oit, false);
-					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2);
-					this->ToSingleComponentSelector(out, *insn.ops[0], i * 2 + 1, false);
-					out << ")))));";
-					if ((2 == num_comps) && (0 == i))
-					{
-						out << "\n";
-					}
-				}
+				assert_msg(false, "Unhandled type");
 				break;
 			}
 		}
 	}
-
-	for (uint32_t i = 0; i < num_outputs; ++ i)
+	else if (SOT_INPUT_PRIMITIVEID == op.type)
 	{
-		if (SOT_TEMP == insn.ops[i]->type)
+		out << "gl_PrimitiveID";
+		if (ST_GS == shader_type_)
 		{
-			num_comps = this->GetOperandComponentNum(*insn.ops[i]);
-			for (int j = 0; j < num_comps; ++ j)
-			{
-				temp_as_type_[static_cast<size_t>(insn.ops[i]->indices[0].disp) * 4
-					+ this->GetComponentSelector(*insn.ops[i], j)] = static_cast<uint8_t>(oot);
-			}
+			out << "In";
 		}
+		*need_comps = false;
+		*need_idx = false;
 	}
-}
-
-void GLSLGen::ToOperands(std::ostream& out, ShaderOperand const & op, uint32_t imm_as_type,
-		bool mask, bool dcl_array, bool no_swizzle, bool no_idx, bool no_cast, ShaderInputType const & sit) const
-{
-	ShaderImmType imm_type = static_cast<ShaderImmType>(imm_as_type & 0xFF);
-	ShaderImmType as_type = static_cast<ShaderImmType>(imm_as_type >> 8);
-
-	if (op.neg)
+	else if (SOT_INPUT_GS_INSTANCE_ID == op.type)
 	{
-		out << '-';
+		out << "gl_InvocationID";
+		*need_comps = false;
+		*need_idx = false;
 	}
-	if (op.abs)
+	else if (SOT_OUTPUT_CONTROL_POINT_ID == op.type)
 	{
-		out << "abs(";
+		out << "gl_InvocationID";
+		*need_comps = false;
+		*need_idx = false;
 	}
-	// 3.0 3 3U, etc
-	if (SOT_IMMEDIATE32 == op.type)
+	else if (SOT_INPUT_THREAD_ID == op.type)
 	{
-		if (1 == op.comps)
+		out << "gl_GlobalInvocationID";
+		*need_idx = false;
+	}
+	else if (SOT_INPUT_THREAD_GROUP_ID == op.type)
+	{
+		out << "gl_WorkGroupID";
+		*need_idx = false;
+	}
+	else if (SOT_INPUT_THREAD_ID_IN_GROUP == op.type)
+	{
+		out << "gl_LocalInvocationID";
+		*need_idx = false;
+	}
+	else if (SOT_INPUT_THREAD_ID_IN_GROUP_FLATTENED == op.type)
+	{
+		out << "gl_LocalInvocationIndex";
+		*need_idx = false;
+	}
+	else
+	{
+		out << ShaderOperandTypeShortName(op.type);
+	}
+}
+
+int GLSLGen::ToSingleComponentSelector(std::ostream& out, ShaderOperand const & op, int i, bool dot) const
+{
+	if ((SOT_IMMEDIATE32 == op.type) || (SOT_IMMEDIATE64 == op.type))
+	{
+		if ((op.comps > 1) && (i < op.comps))
 		{
-			switch (imm_type)
+			if (dot)
 			{
-			case SIT_Float:
-				// Normalized float test
-				if (ValidFloat(op.imm_values[0].f32))
-				{
-					out.setf(std::ios::showpoint);
-					out << op.imm_values[0].f32;
-				}
-				else
-				{
-					out << op.imm_values[0].i32;
-				}
-				break;
-
-			case SIT_Int:
-				out << op.imm_values[0].i32;
-				break;
-
-			case SIT_UInt:
-				if ((0xC0490FDB == op.imm_values[0].u32) || (0x3F800000 == op.imm_values[0].u32))
-				{
-					// Hack for predefined magic value
-					out.setf(std::ios::showpoint);
-					out << op.imm_values[0].f32;
-				}
-				else
-				{
-					out << op.imm_values[0].u32;
-				}
-				break;
-
-			default:
-				assert(false);
-				break;
+				out << ".";
 			}
+			out << "xyzw"[i];
 		}
-		else
+	}
+	else
+	{
+		if (dot)
 		{
-			if (SIT_Int == imm_type)
-			{
-				out << "i";
-			}
-			else if (SIT_UInt == imm_type)
-			{
-				if (glsl_rules_ & GSR_UIntType)
-				{
-					out << "u";
-				}
-				else
-				{
-					out << "i";
-				}
-			}
-			out << "vec" << static_cast<int>(op.comps) << "(";
-			for (uint32_t i = 0; i < op.comps; ++ i)
-			{
-				if (i != 0)
-				{
-					out << ", ";
-				}
-				switch (imm_type)
-				{
-				case SIT_Float:
-					// Normalized float test
-					if (ValidFloat(op.imm_values[i].f32))
-					{
-						out.setf(std::ios::showpoint);
-						out << op.imm_values[i].f32;
-					}
-					else
-					{
-						out << op.imm_values[i].i32;
-					}
-					break;
+			out << '.';
+		}
+		uint32_t comp = this->GetComponentSelector(op, i);
+		out << "xyzw"[comp];
+		return comp;
+	}
 
-				case SIT_Int:
-					out << op.imm_values[i].i32;
-					break;
+	return 0;
+}
 
-				case SIT_UInt:
-					out << op.imm_values[i].u32;
-					break;
+//param i:the component selector to get
+//return:the idx of selector:0 1 2 3 stand for x y z w
+//for .xw i=0 return 0 i=1 return 3
+int GLSLGen::GetComponentSelector(ShaderOperand const & op, int i) const
+{
+	uint32_t comps_index;
+	switch (op.mode)
+	{
+	case SOSM_MASK:
+		comps_index = this->ComponentSelectorFromMask(op.mask, op.comps);
+		break;
 
-				case SIT_Double:
-				default:
-					assert(false);
-					break;
-				}
-			}
-			out << ")";
+	case SOSM_SWIZZLE:
+		comps_index = this->ComponentSelectorFromSwizzle(op.swizzle, op.comps);
+		break;
+
+	case SOSM_SCALAR:
+		comps_index = this->ComponentSelectorFromScalar(op.swizzle[0]);
+		i = 0;
+		break;
+
+	default:
+		assert(false);
+		comps_index = 0;
+		break;
+	}
+
+	uint32_t comp = (comps_index >> (i * 8)) & 0xFF;
+	assert(comp != 0xFF);
+	return comp;
+}
+
+bool GLSLGen::IsRawTemp(ShaderOperand const & op) const
+{
+	assert(SOT_TEMP == op.type);
+	for (int i = 0; i < this->GetOperandComponentNum(op); ++ i)
+	{
+		size_t const comp = static_cast<size_t>(op.indices[0].disp) * 4 + this->GetComponentSelector(op, i);
+		if ((comp >= temp_raw_.size()) || !temp_raw_[comp])
+		{
+			return false;
 		}
 	}
-	else if (SOT_IMMEDIATE64 == op.type)
+	return true;
+}
+
+uint32_t GLSLGen::ImmediateComponent(ShaderOperand const & op) const
+{
+	assert(SOT_IMMEDIATE32 == op.type);
+	return op.imm_values[(op.comps > 1) ? this->GetComponentSelector(op, 0) : 0].u32;
+}
+
+void GLSLGen::ToBufferName(std::ostream& out, ShaderOperand const & buffer, bool structured) const
+{
+	ShaderInputType sit = SIT_UNDEFINED;
+	if (SOT_RESOURCE == buffer.type)
+	{
+		sit = structured ? SIT_STRUCTURED : SIT_BYTEADDRESS;
+	}
+	else if (SOT_UNORDERED_ACCESS_VIEW == buffer.type)
 	{
-		// Only 4.3+ support double type
+		sit = structured ? SIT_UAV_RWSTRUCTURED : SIT_UAV_RWBYTEADDRESS;
+	}
+	this->ToOperands(out, buffer, SIT_UInt, false, false, true, false, true, sit);
+}
 
-		if (1 == op.comps)
+// Raw buffers, raw thread group shared memory and untyped structured buffers are declared as uint arrays.
+// element is the structure index of structured buffers, nullptr for raw ones.
+void GLSLGen::ToBufferWord(std::ostream& out, ShaderOperand const & buffer, ShaderOperand const * element, uint32_t stride,
+		ShaderOperand const & byte_offset, uint32_t word) const
+{
+	this->ToBufferName(out, buffer, element != nullptr);
+	out << "[";
+	bool sum = false;
+	if (element)
+	{
+		if (SOT_IMMEDIATE32 == element->type)
 		{
-			out << op.imm_values[0].f64;
+			uint32_t const element_word = this->ImmediateComponent(*element) * (stride / 4);
+			if (element_word != 0)
+			{
+				out << element_word << "U";
+				sum = true;
+			}
 		}
 		else
 		{
-			out << "dvec" << static_cast<int>(op.comps) << "(";
-			for (uint32_t i = 0; i < op.comps; ++ i)
+			out << "uint(";
+			this->ToOperands(out, *element, SIT_UInt);
+			out << ") * " << stride / 4 << "U";
+			sum = true;
+		}
+	}
+	if (SOT_IMMEDIATE32 == byte_offset.type)
+	{
+		uint32_t const offset_word = this->ImmediateComponent(byte_offset) / 4 + word;
+		if ((offset_word != 0) || !sum)
+		{
+			if (sum)
 			{
-				if (i != 0)
-				{
-					out << ", ";
-				}
-				out << op.imm_values[i].f64;
+				out << " + ";
 			}
-			out << ")";
+			out << offset_word << "U";
 		}
 	}
 	else
 	{
-		// 应该是类似v1 v2[2] o0 cb0[1]的这种变量名形式
+		if (sum)
+		{
+			out << " + ";
+		}
+		out << "(uint(";
+		this->ToOperands(out, byte_offset, SIT_UInt);
+		out << ") >> 2U)";
+		if (word != 0)
+		{
+			out << " + " << word << "U";
+		}
+	}
+	out << "]";
+}
 
-		int flag = 0;
-		int64_t start = 0;
-		int64_t index = 0;
-		int num = 0;
-		bool whether_output_comps = true;//for matrixs,do not output comps
-		bool whether_output_idx = true;//for cb member and vs input,no index
-		for (auto const & iri : idx_range_info_)
+void GLSLGen::ToStructuredLoad(std::ostream& out, ShaderInstruction const & insn, ShaderImmType& oot) const
+{
+	// ld_structured dst0[.mask], srcAddress[.select_component], srcByteOffset[.select_component], src0[.swizzle]
+	ShaderOperand const & dst = *insn.ops[0];
+	ShaderOperand const & element = *insn.ops[1];
+	ShaderOperand const & byte_offset = *insn.ops[2];
+	ShaderOperand const & buffer = *insn.ops[3];
+	StructuredLayout const * layout = this->FindStructuredLayout(buffer);
+	if (!layout)
+	{
+		this->ReportError(GGS_InvalidProgram, "Structured buffer isn't declared", cur_insn_);
+		return;
+	}
+
+	int const num_comps = this->GetOperandComponentNum(dst);
+	uint32_t words[4];
+	for (int i = 0; i < num_comps; ++ i)
+	{
+		words[i] = this->GetComponentSelector(buffer, this->GetComponentSelector(dst, i));
+	}
+
+	if (!layout->typed)
+	{
+		oot = SIT_UInt;
+		this->ToOperands(out, dst, oot | (oot << 8));
+		out << " = ";
+		ToImmTypeName(out, (SOT_TEMP == dst.type) ? SIT_Int : SIT_UInt, num_comps);
+		out << "(";
+		for (int i = 0; i < num_comps; ++ i)
 		{
-			if (iri.op_type == op.type)
+			if (i != 0)
 			{
-				if (iri.start == op.indices[0].disp)
-				{
-					flag = 1;
-					start = iri.start;
-					num = iri.num;
-					break;
-				}
-				else if ((op.indices[0].disp > iri.start) && (op.indices[0].disp < iri.start + iri.num))
-				{
-					flag = 2;
-					index = op.indices[0].disp - iri.start;
-					start = iri.start;
-					break;
-				}
+				out << ", ";
 			}
+			this->ToBufferWord(out, buffer, &element, layout->stride, byte_offset, words[i]);
 		}
+		out << ");";
+		return;
+	}
 
-		bool naked = false;
-		//ajudge whether it is naked
-		//naked为true表示有常数后缀如cb0[数字或表达式]
-		//naked为false表示没有常数后缀如v[数字或表达式],用于array input variable
-		switch (op.type)
+	// Every word maps to a member, so the load reads members directly, a vector's worth at a time
+	StructuredWord const * word_descs[4];
+	uint32_t const base = this->ImmediateComponent(byte_offset) / 4;
+	for (int i = 0; i < num_comps; ++ i)
+	{
+		uint32_t const w = base + words[i];
+		word_descs[i] = ((w < layout->words.size()) && (layout->words[w].comp != -2)) ? &layout->words[w] : nullptr;
+		ShaderImmType const type = word_descs[i] ? word_descs[i]->type : SIT_UInt;
+		oot = ((0 == i) || (oot == type)) ? type : SIT_UInt;
+	}
+
+	this->ToOperands(out, dst, oot | (oot << 8));
+	out << " = ";
+	ToImmTypeName(out, ((SIT_UInt == oot) && (SOT_TEMP == dst.type)) ? SIT_Int : oot, num_comps);
+	out << "(";
+	for (int i = 0; i < num_comps;)
+	{
+		if (i != 0)
 		{
-		case SOT_TEMP:
-		case SOT_INPUT:
-		case SOT_OUTPUT:
-		case SOT_CONSTANT_BUFFER:
-		case SOT_INDEXABLE_TEMP:
-		case SOT_RESOURCE:
-		case SOT_SAMPLER:
-		case SOT_UNORDERED_ACCESS_VIEW:
-		case SOT_THREAD_GROUP_SHARED_MEMORY:
-			naked = true;
-			break;
+			out << ", ";
+		}
 
-		default:
-			naked = false;
-			break;
+		StructuredWord const * word = word_descs[i];
+		if (!word)
+		{
+			out << "0U";
+			++ i;
+			continue;
 		}
-		if (op.indices[0].reg)
+
+		int j = i + 1;
+		if (word->comp >= 0)
 		{
-			naked = false;
+			while ((j < num_comps) && word_descs[j] && (word_descs[j]->comp >= 0) && (word_descs[j]->leaf == word->leaf))
+			{
+				++ j;
+			}
 		}
 
-		bool cast = false;
-		ShaderImmType op_as_type;
-		if (imm_type != SIT_Unknown)
+		bool const cast = ToBitCast(out, word->type, oot, j - i);
+		this->ToBufferName(out, buffer, true);
+		out << "[";
+		this->ToOperands(out, element, SIT_UInt);
+		out << "]" << word->leaf;
+		if (word->comp >= 0)
 		{
-			op_as_type = imm_type;
+			out << ".";
+			for (int k = i; k < j; ++ k)
+			{
+				out << "xyzw"[word_descs[k]->comp];
+			}
 		}
-		else
+		if (cast)
 		{
-			op_as_type = this->OperandAsType(op, imm_as_type);
+			out << ")";
 		}
-		if (!no_cast)
+		i = j;
+	}
+	out << ");";
+}
+
+void GLSLGen::ToStructuredStore(std::ostream& out, ShaderInstruction const & insn) const
+{
+	// store_structured dst0[.write_mask], dstAddress[.select_component], dstByteOffset[.select_component], src0[.swizzle]
+	ShaderOperand const & buffer = *insn.ops[0];
+	ShaderOperand const & element = *insn.ops[1];
+	ShaderOperand const & byte_offset = *insn.ops[2];
+	ShaderOperand const & src = *insn.ops[3];
+	StructuredLayout const * layout = this->FindStructuredLayout(buffer);
+	if (!layout)
+	{
+		this->ReportError(GGS_InvalidProgram, "Structured buffer isn't declared", cur_insn_);
+		return;
+	}
+
+	int const num_comps = this->GetOperandComponentNum(buffer);
+	uint32_t comps[4];
+	for (int i = 0; i < num_comps; ++ i)
+	{
+		comps[i] = this->GetComponentSelector(buffer, i);
+	}
+
+	if (!layout->typed)
+	{
+		for (int i = 0; i < num_comps; ++ i)
 		{
-			if (((SIT_Int == op_as_type) || (SIT_UInt == op_as_type))
-				&& ((SIT_Float == imm_type) || (SIT_Double == imm_type)))
+			if (i != 0)
 			{
-				if (SIT_UInt == op_as_type)
-				{
-					out << "uintBitsToFloat";
-				}
-				else
-				{
-					out << "intBitsToFloat";
-				}
-				out << "(";
-				cast = true;
+				out << "\n";
 			}
-			else if (((SIT_Float == op_as_type) || (SIT_Double == op_as_type))
-				&& ((SIT_Int == imm_type) || (SIT_UInt == imm_type)))
+			this->ToBufferWord(out, buffer, &element, layout->stride, byte_offset, comps[i]);
+			if (SIT_Float == this->OperandAsType(src, SIT_UInt))
 			{
-				if (SIT_UInt == imm_type)
-				{
-					out << "floatBitsToUint";
-				}
-				else
-				{
-					out << "floatBitsToInt";
-				}
-				out << "(";
-				cast = true;
+				out << " = floatBitsToUint(";
+			}
+			else
+			{
+				out << " = uint(";
 			}
+			this->ToOperands(out, src, SIT_UInt, false);
+			this->ToSingleComponentSelector(out, src, comps[i]);
+			out << ");";
 		}
+		return;
+	}
 
-		// output operand name 
-		this->ToOperandName(out, op, as_type, &whether_output_idx, &whether_output_comps, no_swizzle, no_idx, sit);
+	StructuredWord const * word_descs[4];
+	uint32_t const base = this->ImmediateComponent(byte_offset) / 4;
+	for (int i = 0; i < num_comps; ++ i)
+	{
+		uint32_t const w = base + comps[i];
+		word_descs[i] = ((w < layout->words.size()) && (layout->words[w].comp != -2)) ? &layout->words[w] : nullptr;
+	}
 
-		// output index
-		// constant buffer is mapped to variable name,does not need index.
-		// vs input is mapped to semantic,does not need index.
-		if (whether_output_idx)
+	bool first = true;
+	for (int i = 0; i < num_comps;)
+	{
+		StructuredWord const * word = word_descs[i];
+		if (!word)
 		{
-			for (uint32_t i = 0; i < op.num_indices; ++ i)
-			{
-				//第一层索引不需要[]，如cb0[22]中0为第一层,naked==false需要[]
-				if (!naked || (i != 0))
-				{
-					out << '[';
-				}
-				if (op.indices[i].reg)
-				{
-					out << "int(";
-					this->ToOperands(out, *op.indices[i].reg, imm_type, true, false, false, false, true);
-					if (op.indices[i].disp)
-					{
-						out << "+" << op.indices[i].disp;
-					}
-					out << ")";
-				}
-				else
-				{
-					if (0 == i)
-					{
-						if (dcl_array)
-						{
-							// Declare an array
-							out << op.indices[i].disp;
-							if (1 == flag)
-							{
-								out << "[" << num << "]";
-							}
-						}
-						else
-						{
-							// Use an array
-							if (0 == flag)
-							{
-								out << op.indices[i].disp;
-							}
-							else
-							{
-								out << start << "[" << index << "]";
-							}
-						}
-					}
-					else
-					{
-						out << op.indices[i].disp;
-					}
-				}
-				if (!naked || (i != 0))
-				{
-					out << ']';
-				}
-			}
+			++ i;
+			continue;
 		}
-		//output component selectors
-		//matrix has been converted to mat[2][3]-like form,do not need ouput comps
-		if (whether_output_comps)
+
+		int j = i + 1;
+		if (word->comp >= 0)
 		{
-			if (op.comps && mask)
+			while ((j < num_comps) && word_descs[j] && (word_descs[j]->comp >= 0) && (word_descs[j]->leaf == word->leaf))
 			{
-				switch (op.mode)
-				{
-				case SOSM_MASK:
-					out << '.';
-					this->ToComponentSelector(out, this->ComponentSelectorFromMask(op.mask, op.comps));
-					break;
-
-				case SOSM_SWIZZLE:
-					out << '.';
-					this->ToComponentSelector(out, this->ComponentSelectorFromSwizzle(op.swizzle, op.comps));
-					break;
+				++ j;
+			}
+		}
 
-				case SOSM_SCALAR:
-					out << '.';
-					this->ToComponentSelector(out, this->ComponentSelectorFromScalar(op.swizzle[0]));
-					break;
+		if (!first)
+		{
+			out << "\n";
+		}
+		first = false;
 
-				default:
-					assert(false);
-					break;
-				}
+		this->ToBufferName(out, buffer, true);
+		out << "[";
+		this->ToOperands(out, element, SIT_UInt);
+		out << "]" << word->leaf;
+		if (word->comp >= 0)
+		{
+			out << ".";
+			for (int k = i; k < j; ++ k)
+			{
+				out << "xyzw"[word_descs[k]->comp];
 			}
 		}
-
+		out << " = ";
+
+		ShaderImmType src_type = this->OperandAsType(src, word->type);
+		if ((SOT_TEMP == src.type) && (SIT_UInt == src_type))
+		{
+			// uint values live in the int temps
+			src_type = SIT_Int;
+		}
+		else if ((SOT_IMMEDIATE32 == src.type) && (1 == src.comps) && (SIT_UInt == src_type))
+		{
+			// A bare literal is an int, and GLSL ES doesn't convert it to uint implicitly
+			src_type = SIT_Int;
+		}
+		bool const cast = ToBitCast(out, src_type, word->type, j - i);
+		if (j - i > 1)
+		{
+			ToImmTypeName(out, src_type, j - i);
+			out << "(";
+		}
+		this->ToOperands(out, src, word->type, false);
+		for (int k = i; k < j; ++ k)
+		{
+			this->ToSingleComponentSelector(out, src, comps[k], k == i);
+		}
+		if (j - i > 1)
+		{
+			out << ")";
+		}
 		if (cast)
 		{
 			out << ")";
 		}
+		out << ";";
+		i = j;
 	}
+}
 
-	if (op.abs)
+void GLSLGen::ToStructDeclaration(std::ostream& out, std::string const & name, std::vector<DXBCShaderTypeMember> const & members)
+{
+	if (std::find(declared_structs_.begin(), declared_structs_.end(), name) != declared_structs_.end())
 	{
-		out << ")";
+		return;
+	}
+
+	for (auto const & member : members)
+	{
+		if (SVC_STRUCT == member.type_desc.var_class)
+		{
+			this->ToStructDeclaration(out, StructTypeName(member.struct_name, name + "_" + member.name), member.members);
+		}
 	}
+
+	out << "struct " << name << "\n{\n";
+	for (auto const & member : members)
+	{
+		if (SVC_STRUCT == member.type_desc.var_class)
+		{
+			out << StructTypeName(member.struct_name, name + "_" + member.name);
+		}
+		else
+		{
+			out << GLSLTypeName(member.type_desc);
+		}
+		out << " " << member.name;
+		if (member.type_desc.elements > 0)
+		{
+			out << "[" << member.type_desc.elements << "]";
+		}
+		out << ";\n";
+	}
+	out << "};\n";
+	declared_structs_.push_back(name);
 }
 
-ShaderImmType GLSLGen::OperandAsType(ShaderOperand const & op, uint32_t imm_as_type) const
+void GLSLGen::ToStructuredDeclaration(std::ostream& out, ShaderDecl const & dcl)
 {
-	ShaderImmType imm_type = static_cast<ShaderImmType>(imm_as_type & 0xFF);
-	ShaderImmType as_type = static_cast<ShaderImmType>(imm_as_type >> 8);
+	bool const srv = (SOT_RESOURCE == dcl.op->type);
+	DXBCInputBindDesc const & desc = this->GetResourceDesc(srv ? SIT_STRUCTURED : SIT_UAV_RWSTRUCTURED,
+		static_cast<uint32_t>(dcl.op->indices[0].disp));
+	StructuredLayout const * layout = this->FindStructuredLayout(*dcl.op);
+	if (!layout)
+	{
+		return;
+	}
 
-	if (SOT_IMMEDIATE32 == op.type)
+	if (layout->typed && (SVC_STRUCT == layout->element->type_desc.var_class))
 	{
-		as_type = SIT_Unknown;
-		for (uint32_t i = 0; i < op.comps; ++ i)
+		this->ToStructDeclaration(out, layout->element_type, layout->element->members);
+	}
+
+	out << "layout(std430) ";
+	if (srv)
+	{
+		out << "readonly ";
+	}
+	out << "buffer " << ShaderOperandTypeShortName(dcl.op->type) << dcl.op->indices[0].disp << " {\n";
+	if (layout->typed)
+	{
+		if (layout->row_major)
 		{
-			switch (imm_type)
+			out << "layout(row_major) ";
+		}
+		out << layout->element_type;
+	}
+	else
+	{
+		out << "uint";
+	}
+	out << " " << desc.name << "[];\n};\n";
+}
+
+void GLSLGen::ToComponentSelectors(std::ostream& out, ShaderOperand const & op, bool dot, uint32_t offset) const
+{
+	if ((op.type != SOT_IMMEDIATE32) && (op.type != SOT_IMMEDIATE64))
+	{
+		if (op.comps)
+		{
+			switch (op.mode)
 			{
-			case SIT_Float:
-				// Normalized float test
-				if (ValidFloat(op.imm_values[i].f32))
-				{
-					as_type = std::max(as_type, SIT_Float);
-				}
-				else
+			case SOSM_MASK:
+				if (dot)
 				{
-					as_type = std::max(as_type, SIT_Int);
+					out << '.';
 				}
+				this->ToComponentSelector(out, this->ComponentSelectorFromMask(op.mask, op.comps), offset);
 				break;
 
-			case SIT_Int:
-				as_type = std::max(as_type, SIT_Int);
+			case SOSM_SWIZZLE:
+				out << '.';
+				this->ToComponentSelector(out, this->ComponentSelectorFromSwizzle(op.swizzle, op.comps), offset);
 				break;
 
-			case SIT_UInt:
-				if ((0xC0490FDB == op.imm_values[0].u32) || (0x3F800000 == op.imm_values[0].u32))
-				{
-					// Hack for predefined magic value
-					as_type = std::max(as_type, SIT_Float);
-				}
-				else
-				{
-					as_type = std::max(as_type, SIT_UInt);
-				}
+			case SOSM_SCALAR:
+				out << '.';
+				this->ToComponentSelector(out, this->ComponentSelectorFromScalar(op.swizzle[0]), offset);
 				break;
 
 			default:
@@ -6253,1065 +8719,1181 @@ ShaderImmType GLSLGen::OperandAsType(ShaderOperand const & op, uint32_t imm_as_t
 			}
 		}
 	}
-	else if (SOT_IMMEDIATE64 == op.type)
-	{
-		as_type = SIT_Double;
-	}
-	else
+}
+
+bool GLSLGen::IsImmediateNumber(ShaderOperand const & op) const
+{
+	return ((SOT_IMMEDIATE32 == op.type) || (SOT_IMMEDIATE64 == op.type));
+}
+
+int GLSLGen::GetOperandComponentNum(ShaderOperand const & op) const
+{
+	int num_comps = 0;
+	if (op.comps)
 	{
-		if (SIT_Unknown == as_type)
+		switch (op.mode)
 		{
-			if (SOT_TEMP == op.type)
+		case SOSM_MASK:
+			for (uint32_t i = 0; i < op.comps; ++ i)
 			{
-				as_type = SIT_Unknown;
-				for (uint32_t i = 0; i < op.comps; ++ i)
+				if (op.mask & (1 << i))
 				{
-					as_type = std::max(as_type, static_cast<ShaderImmType>(temp_as_type_[
-						static_cast<size_t>(op.indices[0].disp) * 4 + this->GetComponentSelector(op, i)]));
+					++ num_comps;
 				}
 			}
-			else if (SOT_INPUT == op.type)
-			{
-				switch (this->GetInputParamDesc(op, (ST_GS == shader_type_) ? 1 : 0).component_type)
-				{
-				case SRCT_UINT32:
-					as_type = SIT_UInt;
-					break;
+			break;
 
-				case SRCT_SINT32:
-					as_type = SIT_Int;
-					break;
+		case SOSM_SWIZZLE:
+			num_comps = op.comps;
+			break;
 
-				case SRCT_FLOAT32:
-					as_type = SIT_Float;
-					break;
+		case SOSM_SCALAR:
+			num_comps = 1;
+			break;
 
-				default:
-					assert(false);
-					break;
-				}
+		default:
+			assert(false);
+			break;
+		}
+	}
+	return num_comps;
+}
+
+ShaderRegisterComponentType GLSLGen::GetOutputParamType(ShaderOperand const & op) const
+{
+	if (SOT_OUTPUT == op.type)
+	{
+		if ((op.indices[0].disp >= 0) && (op.indices[0].disp < static_cast<int64_t>(output_registers_.size())))
+		{
+			SignatureRegister const & reg = output_registers_[static_cast<size_t>(op.indices[0].disp)];
+			if (reg.desc)
+			{
+				return reg.component_type;
 			}
-			else if (SOT_OUTPUT == op.type)
+		}
+		//I met a false error here when debugging,remove it for convenience.
+		//the insn  is:
+		//dcl_out_siv o4.x, finalQuadUInsideTessFactor
+		//there is only 3 output params.
+		//assert(false);
+		return SRCT_FLOAT32;
+	}
+	else if (SOT_OUTPUT_DEPTH == op.type)
+	{
+		for (auto const & po : program_->params_out)
+		{
+			if (0 == strcmp("SV_Depth", po.semantic_name))
 			{
-				switch (this->GetOutputParamType(op))
-				{
-				case SRCT_UINT32:
-					as_type = SIT_UInt;
-					break;
+				return OutputComponentType(po);
+			}
+		}
+		assert(false);
+		return SRCT_FLOAT32;
+	}
+	else if ((SOT_TEMP == op.type) || (SOT_INDEXABLE_TEMP == op.type))
+	{
+		return SRCT_FLOAT32;
+	}
+	else
+	{
+		assert(false);
+		return SRCT_FLOAT32;
+	}
+}
 
-				case SRCT_SINT32:
-					as_type = SIT_Int;
-					break;
+DXBCSignatureParamDesc const & GLSLGen::GetOutputParamDesc(ShaderOperand const & op, uint32_t index) const
+{
+	SignatureRegister const & reg = this->GetOutputRegister(op, index);
+	if (reg.desc)
+	{
+		return *reg.desc;
+	}
 
-				case SRCT_FLOAT32:
-					as_type = SIT_Float;
-					break;
+	static DXBCSignatureParamDesc const invalid = { "" };
+	return invalid;
+}
 
-				default:
-					assert(false);
-					break;
-				}
-			}
-			else if (SOT_CONSTANT_BUFFER == op.type)
+DXBCSignatureParamDesc const & GLSLGen::GetInputParamDesc(ShaderOperand const & op, uint32_t index) const
+{
+	assert(SOT_INPUT == op.type);
+	SignatureRegister const & reg = this->GetInputRegister(op, index);
+	if (reg.desc)
+	{
+		return *reg.desc;
+	}
+
+	static DXBCSignatureParamDesc const invalid = { "" };
+	return invalid;
+}
+
+SignatureRegister const & GLSLGen::GetInputRegister(ShaderOperand const & op, uint32_t index) const
+{
+	int64_t register_index = op.indices[index].disp;
+	if ((register_index >= 0) && (register_index < static_cast<int64_t>(input_registers_.size()))
+		&& input_registers_[static_cast<size_t>(register_index)].desc)
+	{
+		return input_registers_[static_cast<size_t>(register_index)];
+	}
+
+	this->ReportError(GGS_InvalidProgram, "Register isn't in the signature", cur_insn_);
+	static SignatureRegister const invalid = { nullptr, SSK_User, nullptr, false, SRCT_FLOAT32, SIM_Undefined };
+	return invalid;
+}
+
+SignatureRegister const & GLSLGen::GetOutputRegister(ShaderOperand const & op, uint32_t index) const
+{
+	int64_t register_index = op.indices[index].disp;
+	if ((register_index >= 0) && (register_index < static_cast<int64_t>(output_registers_.size()))
+		&& output_registers_[static_cast<size_t>(register_index)].desc)
+	{
+		return output_registers_[static_cast<size_t>(register_index)];
+	}
+
+	this->ReportError(GGS_InvalidProgram, "Register isn't in the signature", cur_insn_);
+	static SignatureRegister const invalid = { nullptr, SSK_User, nullptr, false, SRCT_FLOAT32, SIM_Undefined };
+	return invalid;
+}
+
+void GLSLGen::BuildSignatureRegisters()
+{
+	BuildRegisterTable(program_->params_in, input_registers_);
+	BuildRegisterTable(program_->params_out, output_registers_);
+	for (auto& reg : output_registers_)
+	{
+		if (reg.desc)
+		{
+			reg.component_type = OutputComponentType(*reg.desc);
+		}
+	}
+
+	for (auto& reg : input_registers_)
+	{
+		if (!reg.desc)
+		{
+			continue;
+		}
+
+		if (ST_PS == shader_type_)
+		{
+			switch (reg.kind)
 			{
-				uint32_t bind_point = static_cast<uint32_t>(op.indices[0].disp);
-				uint32_t register_index = static_cast<uint32_t>(op.indices[1].disp);
-				uint32_t min_selector = this->GetMinComponentSelector(op);
-				uint32_t offset = 16 * register_index + min_selector * 4;
+			case SSK_Position:
+				reg.builtin = "gl_FragCoord";
+				break;
 
-				for (auto const & cb : program_->cbuffers)
-				{
-					if ((SCBT_CBUFFER == cb.desc.type) && (cb.bind_point == bind_point))
-					{
-						// find which cb member current cb# array index is located in
-						for (auto const & var : cb.vars)
-						{
-							if ((offset >= var.var_desc.start_offset)
-								&& (var.var_desc.start_offset + var.var_desc.size > offset))
-							{
-								switch (var.type_desc.type)
-								{
-								case SVT_INT:
-									as_type = SIT_Int;
-									break;
+			case SSK_SampleIndex:
+				reg.builtin = (glsl_rules_ & GSR_ExplicitMultiSample) ? "gl_SampleID" : "0";
+				reg.builtin_scalar = true;
+				break;
 
-								case SVT_UINT:
-									as_type = SIT_UInt;
-									break;
+			case SSK_PrimitiveID:
+				reg.builtin = "gl_PrimitiveID";
+				reg.builtin_scalar = true;
+				break;
 
-								case SVT_FLOAT:
-									as_type = SIT_Float;
-									break;
+			default:
+				break;
+			}
+		}
+		else if (ST_VS == shader_type_)
+		{
+			if (SSK_VertexID == reg.kind)
+			{
+				reg.builtin = "gl_VertexID";
+				reg.builtin_scalar = true;
+			}
+			else if (SSK_InstanceID == reg.kind)
+			{
+				reg.builtin = "gl_InstanceID";
+				reg.builtin_scalar = true;
+			}
+		}
+	}
 
-								default:
-									assert(false);
-									break;
-								}
-							}
-						}
-					}
+	if (ST_PS == shader_type_)
+	{
+		for (auto const & dcl : program_->dcls)
+		{
+			if ((SO_DCL_INPUT_PS == dcl->opcode) && (dcl->op->indices[0].disp >= 0)
+				&& (dcl->op->indices[0].disp < static_cast<int64_t>(input_registers_.size())))
+			{
+				SignatureRegister& reg = input_registers_[static_cast<size_t>(dcl->op->indices[0].disp)];
+				if (SIM_Undefined == reg.interpolation)
+				{
+					reg.interpolation = dcl->dcl_input_ps.interpolation;
 				}
 			}
-			else
+		}
+	}
+
+	if (ST_VS == shader_type_)
+	{
+		for (auto& reg : output_registers_)
+		{
+			if (SSK_ClipDistance == reg.kind)
 			{
-				as_type = imm_type;
+				reg.builtin = "gl_ClipDistance";
 			}
 		}
 	}
-
-	return as_type;
 }
 
-void GLSLGen::ToOperandName(std::ostream& out, ShaderOperand const & op, ShaderImmType as_type,
-		bool* need_idx, bool* need_comps, bool no_swizzle, bool no_idx, ShaderInputType const & sit) const
+void GLSLGen::ValidateProgram()
 {
-	*need_comps = true;
-	*need_idx = true;
-	if ((ST_PS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type)))
+	uint32_t num_temps = 0;
+	bool has_control_point_phase = false;
+	for (auto const & dcl : program_->dcls)
 	{
-		if (SOT_INPUT == op.type)
+		ShaderOperandType const declared = DeclaredOperandType(dcl->opcode);
+		if ((declared != SOT_COUNT) && (!dcl->op || (dcl->op->type != declared)))
 		{
-			DXBCSignatureParamDesc const & param_desc = this->GetInputParamDesc(op);
-			if (0 == strcmp(param_desc.semantic_name, "SV_Position"))
-			{
-				*need_idx = false;
-				out << "gl_FragCoord";
-			}
-			else if (0 == strcmp(param_desc.semantic_name, "SV_SampleIndex"))
+			this->ReportError(GGS_InvalidProgram, "Declaration of the wrong register type", nullptr);
+			return;
+		}
+		switch (dcl->opcode)
+		{
+		case SO_HS_CONTROL_POINT_PHASE:
+			has_control_point_phase = true;
+			break;
+
+		case SO_DCL_TEMPS:
+			if (dcl->num > MAX_TEMP_REGISTERS)
 			{
-				*need_comps = false;
-				*need_idx = false;
-				if (glsl_rules_ & GSR_ExplicitMultiSample)
-				{
-					out << "gl_SampleID";
-				}
-				else
-				{
-					out << "0";
-				}
+				this->ReportError(GGS_InvalidProgram, "Too many temp registers", nullptr);
+				return;
 			}
-			else if (0 == strcmp(param_desc.semantic_name, "SV_PrimitiveID"))
+			num_temps = std::max(num_temps, dcl->num);
+			break;
+
+		case SO_DCL_INDEXABLE_TEMP:
+			if ((dcl->indexable_temp.num > MAX_TEMP_REGISTERS) || (dcl->indexable_temp.comps < 1) || (dcl->indexable_temp.comps > 4))
 			{
-				*need_comps = false;
-				*need_idx = false;
-				out << "gl_PrimitiveID";
+				this->ReportError(GGS_InvalidProgram, "Indexable temp is out of range", nullptr);
+				return;
 			}
-			else
+			break;
+
+		case SO_DCL_RESOURCE_STRUCTURED:
+		case SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED:
+			if (dcl->structured.stride > MAX_STRUCTURE_STRIDE)
 			{
-				out << "i_REGISTER";
+				this->ReportError(GGS_InvalidProgram, "Structure stride is out of range", nullptr);
+				return;
 			}
-		}
-		else
-		{
-			assert(SOT_OUTPUT == op.type);
+			break;
 
-			out << "o_REGISTER";
+		default:
+			break;
 		}
 	}
-	else if ((ST_VS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type)))
+	for (auto const & cb : program_->cbuffers)
 	{
-		if (SOT_INPUT == op.type)
+		if (SCBT_CBUFFER == cb.desc.type)
 		{
-			DXBCSignatureParamDesc const & param_desc = this->GetInputParamDesc(op);
-			if (SN_VERTEX_ID == param_desc.system_value_type)
+			if (cb.desc.size > MAX_CBUFFER_SIZE)
 			{
-				*need_comps = false;
-				*need_idx = false;
-				out << "gl_VertexID";
+				this->ReportError(GGS_InvalidProgram, "Constant buffer is too large", nullptr);
+				return;
 			}
-			else if (SN_INSTANCE_ID == param_desc.system_value_type)
+			for (auto const & var : cb.vars)
 			{
-				*need_comps = false;
-				*need_idx = false;
-				out << "gl_InstanceID";
+				if (var.has_type_desc && !MemberFitsCBuffer(var, cb.desc.size))
+				{
+					this->ReportError(GGS_InvalidProgram, "Constant buffer member doesn't fit its type", nullptr);
+					return;
+				}
 			}
-			else
+		}
+	}
+	for (auto const * params : { &program_->params_in, &program_->params_out, &program_->params_patch })
+	{
+		for (auto const & param : *params)
+		{
+			if ((param.mask | param.read_write_mask) & ~0xF)
 			{
-				*need_idx = true;
-				out << "i_REGISTER";
+				this->ReportError(GGS_InvalidProgram, "Signature element has more than 4 components", nullptr);
+				return;
 			}
 		}
-		else
-		{
-			assert(SOT_OUTPUT == op.type);
+	}
+
+	if ((ST_GS == shader_type_) && program_->gs_output_topology.empty())
+	{
+		this->ReportError(GGS_InvalidProgram, "Geometry shader without an output topology", nullptr);
+		return;
+	}
+	if ((ST_HS == shader_type_) && !has_control_point_phase
+		&& (program_->params_in.size() < program_->params_out.size()))
+	{
+		// The pass-through control point phase copies each output from the input at the same position
+		this->ReportError(GGS_InvalidProgram, "Pass-through control points have outputs without inputs", nullptr);
+		return;
+	}
 
-			DXBCSignatureParamDesc const & param_desc = this->GetOutputParamDesc(op);
-			if (0 == strcmp(param_desc.semantic_name, "SV_ClipDistance"))
+	// Everything after this indexes the register tables by the operands without looking
+	bool patch_phase = false;
+	for (auto const & insn : program_->insns)
+	{
+		if (SO_HS_CONTROL_POINT_PHASE == insn->opcode)
+		{
+			patch_phase = false;
+		}
+		else if ((SO_HS_FORK_PHASE == insn->opcode) || (SO_HS_JOIN_PHASE == insn->opcode))
+		{
+			patch_phase = true;
+		}
+		if (((SO_EMIT_STREAM == insn->opcode) || (SO_CUT_STREAM == insn->opcode) || (SO_EMITTHENCUT_STREAM == insn->opcode))
+			&& ((insn->num_ops < 1) || (insn->ops[0]->type != SOT_STREAM)))
+		{
+			this->ReportError(GGS_InvalidProgram, "Stream instruction without a stream", insn.get());
+			return;
+		}
+		if (((SO_DTOF == insn->opcode) || (SO_DLT == insn->opcode) || (SO_DGE == insn->opcode)
+				|| (SO_DEQ == insn->opcode) || (SO_DNE == insn->opcode))
+			&& (insn->num_ops > 0) && (this->GetOperandComponentNum(*insn->ops[0]) > 2))
+		{
+			// Each result reads a pair of components holding one double
+			this->ReportError(GGS_InvalidProgram, "Double instruction writes more than 2 components", insn.get());
+			return;
+		}
+		uint32_t const num_outputs = std::min(insn->num_ops, GetNumOutputs(insn->opcode));
+		for (uint32_t i = 0; i < insn->num_ops; ++ i)
+		{
+			char const * message = this->ValidateOperand(*insn->ops[i], num_temps, patch_phase);
+			if (!message && (i >= num_outputs) && IsVectorRegister(insn->ops[i]->type)
+				&& (SOSM_MASK == insn->ops[i]->mode))
 			{
-				*need_idx = false;
-				out << "gl_ClipDistance[" << param_desc.semantic_index << "]";
+				// Sources are read by swizzle position, a mask runs out before the instruction does
+				message = "Source operand has a write mask";
 			}
-			else
+			if (message)
 			{
-				*need_idx = true;
-				out << "o_REGISTER";
+				this->ReportError(GGS_InvalidProgram, message, insn.get());
+				return;
 			}
 		}
 	}
-	else if ((ST_GS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type)))
+}
+
+char const * GLSLGen::ValidateOperand(ShaderOperand const & op, uint32_t num_temps, bool patch_phase) const
+{
+	uint32_t const num_indices = std::min<uint32_t>(op.num_indices, 3);
+	for (uint32_t i = 0; i < num_indices; ++ i)
 	{
-		if (SOT_INPUT == op.type)
+		if (op.indices[i].reg)
 		{
-			*need_idx = false;
-			out << "i_REGISTER" << op.indices[1].disp;
-			if (!no_idx)
+			char const * message = this->ValidateOperand(*op.indices[i].reg, num_temps, patch_phase);
+			if (message)
 			{
-				out << '[' << op.indices[0].disp << ']';
+				return message;
 			}
 		}
-		else
-		{
-			assert(SOT_OUTPUT == op.type);
+	}
 
-			*need_idx = true;
-			out << "o_REGISTER";
-		}
+	// v# and o# are indexed by vertex or control point first, the register is the last index
+	int64_t const index = op.indices[0].disp;
+	uint32_t const last = (num_indices > 0) ? num_indices - 1 : 0;
+	bool const static_register = !op.indices[last].reg;
+	int64_t const register_index = op.indices[last].disp;
+	if ((4 == op.comps) && (SOSM_MASK == op.mode) && !(op.mask & 0xF))
+	{
+		return "Operand selects no components";
 	}
-	else if ((ST_HS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type) || (SOT_INPUT_CONTROL_POINT == op.type)))
+	if (IsVectorRegister(op.type) && (op.comps != 4))
 	{
-		if (SOT_INPUT == op.type || SOT_INPUT_CONTROL_POINT == op.type)
+		return "Operand of a vector register isn't 4-component";
+	}
+	switch (op.type)
+	{
+	case SOT_TEMP:
+		if ((index < 0) || (index >= num_temps))
 		{
-			*need_idx = false;
-			out << "i_REGISTER" << op.indices[1].disp;
-			//why need this?
-			/*if (!no_idx)
-			{
-				out << '[' << op.indices[0].disp << ']';
-			}*/
-			//I use this,so that it can support representations index.
-			if (op.indices[0].reg)
+			return "Temp register isn't declared";
+		}
+		break;
+
+	case SOT_INDEXABLE_TEMP:
+		{
+			bool declared = false;
+			uint32_t num = 0;
+			for (auto const & dcl : program_->dcls)
 			{
-				out << "[int(";
-				this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
-				if (op.indices[0].disp)
+				if ((SO_DCL_INDEXABLE_TEMP == dcl->opcode) && (dcl->op->indices[0].disp == index))
 				{
-					out << "+" << op.indices[0].disp;
+					declared = true;
+					num = std::max(num, dcl->indexable_temp.num);
 				}
-				out << ")]";
 			}
-			else
+			if (!declared)
 			{
-				out << '[' << op.indices[0].disp << ']';
+				return "Indexable temp isn't declared";
+			}
+			if (!op.indices[1].reg && ((op.indices[1].disp < 0) || (op.indices[1].disp >= num)))
+			{
+				return "Indexable temp element is out of range";
 			}
+		}
+		break;
 
+	case SOT_CONSTANT_BUFFER:
+	case SOT_RESOURCE:
+	case SOT_UNORDERED_ACCESS_VIEW:
+	case SOT_SAMPLER:
+	case SOT_THREAD_GROUP_SHARED_MEMORY:
+		{
+			bool declared = false;
+			for (auto const & dcl : program_->dcls)
+			{
+				if ((DeclaredOperandType(dcl->opcode) == op.type) && (dcl->op->indices[0].disp == index))
+				{
+					declared = true;
+					break;
+				}
+			}
+			if (!declared)
+			{
+				return "Register isn't declared";
+			}
 		}
-		else
+		if (SOT_CONSTANT_BUFFER == op.type)
 		{
-			assert(SOT_OUTPUT == op.type);
-
-			*need_idx = false;
-			if (enter_hs_fork_phase_ || enter_hs_join_phase_)
+			DXBCConstantBuffer const * found = nullptr;
+			for (auto const & cb : program_->cbuffers)
 			{
-				out << "p_REGISTER";
+				if ((SCBT_CBUFFER == cb.desc.type) && (cb.bind_point == index))
+				{
+					found = &cb;
+					break;
+				}
 			}
-			else
+			if (!found)
 			{
-				out << "o_REGISTER";
+				return "Constant buffer isn't in the resource chunk";
 			}
-			if (enter_hs_fork_phase_ || enter_hs_join_phase_)
+			if (!op.indices[1].reg && ((op.indices[1].disp < 0) || (op.indices[1].disp >= (found->desc.size + 15) / 16)))
 			{
-				if (op.indices[0].reg)
+				return "Constant buffer register is out of range";
+			}
+		}
+		break;
+
+	case SOT_STREAM:
+		if ((index < 0) || (index >= static_cast<int64_t>(program_->gs_output_topology.size())))
+		{
+			return "Stream isn't declared";
+		}
+		break;
+
+	case SOT_INPUT:
+	case SOT_INPUT_CONTROL_POINT:
+		if (static_register && !InSignature(program_->params_in, register_index))
+		{
+			return "Register isn't in the signature";
+		}
+		break;
+
+	case SOT_OUTPUT_CONTROL_POINT:
+		if (static_register && !InSignature(program_->params_out, register_index))
+		{
+			return "Register isn't in the signature";
+		}
+		break;
+
+	case SOT_INPUT_PATCH_CONSTANT:
+		if (static_register && !InSignature(program_->params_patch, register_index))
+		{
+			return "Register isn't in the signature";
+		}
+		break;
+
+	case SOT_OUTPUT:
+		if (static_register && !InSignature(patch_phase ? program_->params_patch : program_->params_out, register_index))
+		{
+			return "Register isn't in the signature";
+		}
+		break;
+
+	default:
+		break;
+	}
+	return nullptr;
+}
+
+void GLSLGen::FindGlobalFlags()
+{
+	allow_refactoring_ = false;
+	early_depth_stencil_ = false;
+	enable_double_ = false;
+	enable_minimum_precision_ = false;
+	for (auto const & dcl : program_->dcls)
+	{
+		if (SO_DCL_GLOBAL_FLAGS == dcl->opcode)
+		{
+			allow_refactoring_ = dcl->dcl_global_flags.allow_refactoring ? true : false;
+			early_depth_stencil_ = dcl->dcl_global_flags.early_depth_stencil ? true : false;
+			enable_double_ = (dcl->dcl_global_flags.fp64 || dcl->dcl_global_flags.enable_double_extensions) ? true : false;
+			enable_minimum_precision_ = dcl->dcl_global_flags.enable_minimum_precision ? true : false;
+			break;
+		}
+	}
+}
+
+void GLSLGen::FindMinPrecision()
+{
+	temp_min_precision_.clear();
+	if (!(glsl_rules_ & GSR_Precision) || !enable_minimum_precision_)
+	{
+		return;
+	}
+
+	for (auto const & insn : program_->insns)
+	{
+		uint32_t num_outputs = std::min(insn->num_ops, GetNumOutputs(insn->opcode));
+		for (uint32_t i = 0; i < num_outputs; ++ i)
+		{
+			ShaderOperand const & op = *insn->ops[i];
+			if ((SOT_TEMP == op.type) && op.IsIndexSimple(0))
+			{
+				uint32_t index = static_cast<uint32_t>(op.indices[0].disp);
+				if (index >= temp_min_precision_.size())
 				{
-					out << "[int(";
-					this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
-					if (op.indices[0].disp)
-					{
-						out << "+" << op.indices[0].disp;
-					}
-					out << ")]";
+					temp_min_precision_.resize(index + 1, 0xFF);
 				}
-				else
+				// Integer min precision lives in ti#, tf# only goes below highp for float writes
+				uint32_t min_precision = op.min_precision;
+				if ((SMP_SInt16 == min_precision) || (SMP_UInt16 == min_precision))
 				{
-					out << '[' << op.indices[0].disp << ']';
+					min_precision = SMP_Default;
 				}
+				temp_min_precision_[index] = static_cast<uint8_t>(MergeMinPrecision(temp_min_precision_[index], min_precision));
+			}
+		}
+	}
+
+	for (auto& tex : textures_)
+	{
+		uint32_t min_precision = 0xFF;
+		for (auto const & insn : program_->insns)
+		{
+			uint32_t i_tex;
+			if (ShaderOpcodeDescription(insn->opcode).flags & SOF_Sample)
+			{
+				i_tex = ((SO_GATHER4_PO == insn->opcode) || (SO_GATHER4_PO_C == insn->opcode)) ? 3 : 2;
+			}
+			else if ((SO_LD == insn->opcode) || (SO_LD_MS == insn->opcode))
+			{
+				i_tex = 2;
 			}
 			else
 			{
-				out << op.indices[0].disp;
+				continue;
+			}
+			if (tex.tex_index == insn->ops[i_tex]->indices[0].disp)
+			{
+				min_precision = MergeMinPrecision(min_precision, insn->ops[0]->min_precision);
 			}
 		}
+		tex.min_precision = (0xFF == min_precision) ? SMP_Default : min_precision;
+	}
+}
+
+void GLSLGen::ToMinPrecision(std::ostream& out, uint32_t min_precision) const
+{
+	if (glsl_rules_ & GSR_Precision)
+	{
+		char const * qualifier = MinPrecisionQualifier(min_precision);
+		if (qualifier)
+		{
+			out << qualifier;
+		}
+	}
+}
+
+void GLSLGen::FindDclIndexRange()
+{
+	for (auto const & dcl : program_->dcls)
+	{
+		if (SO_DCL_INDEX_RANGE == dcl->opcode)
+		{
+			DclIndexRangeInfo mInfo;
+			mInfo.op_type = dcl->op->type;
+			mInfo.start = dcl->op->indices[0].disp;
+			mInfo.num = dcl->num;
+			idx_range_info_.push_back(mInfo);
+		}
 	}
-	else if ((ST_DS == shader_type_) && ((SOT_INPUT == op.type) || (SOT_OUTPUT == op.type) || (SOT_INPUT_CONTROL_POINT == op.type)
-		|| (SOT_INPUT_DOMAIN_POINT == op.type) || (SOT_INPUT_PATCH_CONSTANT == op.type)))
+}
+
+void GLSLGen::FindDirectRegisters()
+{
+	if ((shader_type_ != ST_VS) && (shader_type_ != ST_PS))
 	{
-		if ((SOT_INPUT == op.type) || (SOT_INPUT_CONTROL_POINT == op.type))
+		return;
+	}
+
+	for (uint32_t i = 0; i < input_registers_.size(); ++ i)
+	{
+		SignatureRegister& reg = input_registers_[i];
+		if (reg.desc && !reg.builtin && (SN_UNDEFINED == reg.desc->system_value_type)
+			&& this->IsDirectRegister(SOT_INPUT, program_->params_in, i))
 		{
-			*need_idx = false;
-			out << "i_REGISTER" << op.indices[1].disp;
-			//why need this?
-			/*if (!no_idx)
+			// PS doesn't declare POSITION inputs, see ToDclInterShaderInputRecords
+			if ((ST_PS == shader_type_) && !strcmp("POSITION", reg.desc->semantic_name))
 			{
-				out << '[' << op.indices[0].disp << ']';
-			}*/
-			//I use this,so that it can support representations index.
-			if (op.indices[0].reg)
+				continue;
+			}
+
+			// The register components have to line up with the varying's
+			if (PackedVarying const * packed = FindPackedVarying(input_layout_, *reg.desc))
 			{
-				out << "[int(";
-				this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
-				if (op.indices[0].disp)
+				if (packed->component == packed->register_component)
 				{
-					out << "+" << op.indices[0].disp;
+					reg.varying = "v_SLOT" + std::to_string(packed->location);
 				}
-				out << ")]";
+				continue;
 			}
-			else
+			if (reg.desc->mask & (reg.desc->mask + 1))
 			{
-				out << '[' << op.indices[0].disp << ']';
+				continue;
+			}
+
+			if (shader_type_ != ST_VS)
+			{
+				reg.varying = "v_";
 			}
+			reg.varying += reg.desc->semantic_name + std::to_string(reg.desc->semantic_index);
+		}
+	}
 
+	for (uint32_t i = 0; i < output_registers_.size(); ++ i)
+	{
+		SignatureRegister& reg = output_registers_[i];
+		if (!reg.desc || reg.builtin || !this->IsDirectRegister(SOT_OUTPUT, program_->params_out, i))
+		{
+			continue;
 		}
-		else if (SOT_INPUT_DOMAIN_POINT == op.type)
+
+		if (PackedVarying const * packed = FindPackedVarying(output_layout_, *reg.desc))
 		{
-			out << "gl_TessCoord";
-			*need_idx = false;
-			*need_comps = true;
+			if ((ST_VS == shader_type_) && (packed->component == packed->register_component))
+			{
+				reg.varying = "v_SLOT" + std::to_string(packed->location);
+			}
+			continue;
 		}
-		else if (SOT_INPUT_PATCH_CONSTANT == op.type)
+		if (reg.desc->mask & (reg.desc->mask + 1))
 		{
-			out << "p_REGISTER";
-			if (op.indices[0].reg)
+			continue;
+		}
+
+		if (ST_VS == shader_type_)
+		{
+			if (SN_POSITION == reg.desc->system_value_type)
 			{
-				out << "[int(";
-				this->ToOperands(out, *op.indices[0].reg,SIT_Float, true, false, false, false, true);
-				if (op.indices[0].disp)
+				reg.varying = "gl_Position";
+			}
+			else if ((SN_UNDEFINED == reg.desc->system_value_type)
+				&& ((0xF == reg.desc->mask) || has_gs_ || has_ps_))
+			{
+				reg.varying = "v_";
+				reg.varying += reg.desc->semantic_name + std::to_string(reg.desc->semantic_index);
+				if (has_gs_)
 				{
-					out << "+" << op.indices[0].disp;
+					reg.varying += "In";
 				}
-				out << ")]";
 			}
-			else
+		}
+		else if ((SN_UNDEFINED == reg.desc->system_value_type) && (reg.kind != SSK_Depth) && (0xF == reg.desc->mask))
+		{
+			if (glsl_rules_ & GSR_InOutPrefix)
 			{
-				out << '[' << op.indices[0].disp << ']';
+				reg.varying = "v_";
+				reg.varying += reg.desc->semantic_name + std::to_string(reg.desc->semantic_index);
+			}
+			else if (SSK_Target == reg.kind)
+			{
+				reg.varying = "gl_FragData[" + std::to_string((glsl_rules_ & GSR_DrawBuffers) ? reg.desc->semantic_index : 0) + "]";
 			}
-			*need_idx = false;
 		}
-		else
+	}
+}
+
+// A register can be accessed as its varying when no index range covers it, and it holds a single signature element
+bool GLSLGen::IsDirectRegister(ShaderOperandType type, std::vector<DXBCSignatureParamDesc> const & params, uint32_t register_index) const
+{
+	for (auto const & iri : idx_range_info_)
+	{
+		if ((iri.op_type == type) && (static_cast<int64_t>(register_index) >= iri.start)
+			&& (static_cast<int64_t>(register_index) < iri.start + iri.num))
 		{
-			assert(SOT_OUTPUT == op.type);
-			*need_idx = false;
-			out << "o_REGISTER";
-			out << op.indices[0].disp;
+			return false;
 		}
 	}
-	else if (SOT_OUTPUT_DEPTH == op.type)
+
+	uint32_t num_elements = 0;
+	for (auto const & param : params)
 	{
-		out << "o_REGISTERDepth";
-		*need_comps = true;
-		*need_idx = false;
+		if (param.register_index == register_index)
+		{
+			++ num_elements;
+		}
 	}
-	else if (SOT_TEMP == op.type)
+	return (1 == num_elements);
+}
+
+void GLSLGen::FindStructuredBuffers()
+{
+	structured_layouts_.clear();
+	for (auto const & dcl : program_->dcls)
 	{
-		if (SIT_Unknown == as_type)
+		ShaderInputType sit;
+		if (SO_DCL_RESOURCE_STRUCTURED == dcl->opcode)
 		{
-			as_type = static_cast<ShaderImmType>(temp_as_type_[static_cast<size_t>(op.indices[0].disp) * 4
-				+ this->GetComponentSelector(op, 0)]);
+			sit = SIT_STRUCTURED;
 		}
-
-		out << 't';
-		switch (as_type)
+		else if (SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED == dcl->opcode)
 		{
-		case SIT_Float:
-		case SIT_Double:
-			out << 'f';
-			break;
+			sit = SIT_UAV_RWSTRUCTURED;
+		}
+		else
+		{
+			continue;
+		}
 
-		case SIT_Int:
-		case SIT_UInt:
-			out << 'i';
-			break;
+		StructuredLayout layout;
+		layout.op_type = dcl->op->type;
+		layout.index = static_cast<uint32_t>(dcl->op->indices[0].disp);
+		layout.stride = dcl->structured.stride;
+		layout.typed = false;
+		layout.row_major = false;
+		layout.element = nullptr;
+		layout.words.resize(layout.stride / 4);
+		for (auto& word : layout.words)
+		{
+			word.comp = -2;
+			word.type = SIT_UInt;
+		}
 
-		default:
-			assert(false);
-			break;
+		DXBCInputBindDesc const & desc = this->GetResourceDesc(sit, layout.index);
+		for (auto const & cb : program_->cbuffers)
+		{
+			if ((SCBT_RESOURCE_BIND_INFO == cb.desc.type) && desc.name && !strcmp(cb.desc.name, desc.name))
+			{
+				if (!cb.vars.empty() && cb.vars[0].has_type_desc && (0 == cb.vars[0].type_desc.elements))
+				{
+					DXBCShaderVariable const & var = cb.vars[0];
+					uint32_t align;
+					uint32_t size;
+					uint32_t majors = 0;
+					if (Std430Layout(var.type_desc, var.members, align, size, majors) && (size == layout.stride) && (majors != 3))
+					{
+						layout.typed = true;
+						layout.row_major = (2 == majors);
+						layout.element = &var;
+						if (SVC_STRUCT == var.type_desc.var_class)
+						{
+							layout.element_type = StructTypeName(var.struct_name, std::string(desc.name) + "_Element");
+						}
+						else
+						{
+							layout.element_type = GLSLTypeName(var.type_desc);
+						}
+						FlattenStructuredWords(var.type_desc, var.members, "", 0, layout.words);
+					}
+				}
+				break;
+			}
 		}
+
+		structured_layouts_.push_back(layout);
 	}
-	else if (SOT_SAMPLER == op.type)
-	{
-		DXBCInputBindDesc const & desc = this->GetResourceDesc(SIT_SAMPLER, static_cast<uint32_t>(op.indices[0].disp));
-		out << desc.name;
-		*need_comps = false;
-		*need_idx = false;
-	}
-	else if (SOT_RESOURCE == op.type)
+
+	// Member access needs to know the member at compile time, so runtime byte offsets go through the words
+	for (auto const & insn : program_->insns)
 	{
-		ShaderInputType type = SIT_TEXTURE;
-		if (SIT_UNDEFINED != sit)
+		ShaderOperand const * buffer = nullptr;
+		if (SO_LD_STRUCTURED == insn->opcode)
 		{
-			type = sit;
+			buffer = insn->ops[3].get();
 		}
-		DXBCInputBindDesc const & desc = this->GetResourceDesc(type, static_cast<uint32_t>(op.indices[0].disp));
-		out << desc.name;
-		*need_comps = false;
-		*need_idx = false;
-	}
-	else if (SOT_UNORDERED_ACCESS_VIEW == op.type)
-	{
-		ShaderInputType type = SIT_UAV_RWTYPED;
-		if(SIT_UNDEFINED != sit)
+		else if (SO_STORE_STRUCTURED == insn->opcode)
 		{
-			type = sit;
+			buffer = insn->ops[0].get();
+		}
+		if (buffer && (insn->ops[2]->type != SOT_IMMEDIATE32))
+		{
+			for (auto& layout : structured_layouts_)
+			{
+				if ((layout.op_type == buffer->type) && (layout.index == buffer->indices[0].disp))
+				{
+					layout.typed = false;
+				}
+			}
 		}
-		DXBCInputBindDesc const & desc = this->GetResourceDesc(type, static_cast<uint32_t>(op.indices[0].disp));
-		out << desc.name;
-		*need_comps = false;
-		*need_idx = false;
 	}
-	else if (SOT_INDEXABLE_TEMP == op.type)
+}
+
+StructuredLayout const * GLSLGen::FindStructuredLayout(ShaderOperand const & op) const
+{
+	for (auto const & layout : structured_layouts_)
 	{
-		out << "IndexableTemp";
+		if ((layout.op_type == op.type) && (layout.index == op.indices[0].disp))
+		{
+			return &layout;
+		}
 	}
-	else if ((SOT_INPUT == op.type) && (ST_VS == shader_type_))
-	{
-		*need_idx = false;
+	return nullptr;
+}
 
-		DXBCSignatureParamDesc const & param_desc = this->GetInputParamDesc(op);
-		*need_comps = (param_desc.mask > 1);
-		out << param_desc.semantic_name << param_desc.semantic_index;
-	}
-	else if (SOT_CONSTANT_BUFFER == op.type)
+void GLSLGen::FindSamplers()
+{
+	for (auto const & dcl : program_->dcls)
 	{
-		*need_idx = false;
-		bool dynamic_indexed = cb_index_mode_.find(op.indices[0].disp)->second;
-
-		// map cb array element to cb member names(with array index if it's a array)
-
-		// map cb#[i] to a cb member name
-		uint32_t bind_point = static_cast<uint32_t>(op.indices[0].disp);
-		uint32_t register_index = static_cast<uint32_t>(op.indices[1].disp);
-		uint32_t min_selector = this->GetMinComponentSelector(op);
-		uint32_t offset = 16 * register_index + min_selector * 4;
-		uint32_t num_selectors = this->GetOperandComponentNum(op);
-
-		// find cb corresponding to bind_point
-		for (auto const & cb : program_->cbuffers)
+		// Samplers come from the sample instructions, so the unused ones are never declared
+		if ((SO_DCL_RESOURCE == dcl->opcode) && !this->IsResourcePruned(dcl->op->type, dcl->op->indices[0].disp))
 		{
-			if ((SCBT_CBUFFER == cb.desc.type) && (cb.bind_point == bind_point))
+			TextureSamplerInfo tex;
+			tex.type = dcl->dcl_resource.target;
+			tex.min_precision = SMP_Default;
+			tex.tex_index = dcl->op->indices[0].disp;
+			for (auto const & insn : program_->insns)
 			{
-				// find which cb member current cb# array index is located in
-				for (auto const & var : cb.vars)
+				if (ShaderOpcodeDescription(insn->opcode).flags & SOF_Sample)
 				{
-					if ((offset >= var.var_desc.start_offset)
-						&& (var.var_desc.start_offset + var.var_desc.size > offset))
+					// 3:sampler, 2:resource
+					int i_tex = 2;
+					int i_sam = 3;
+					if ((SO_GATHER4_PO == insn->opcode)
+						|| (SO_GATHER4_PO_C == insn->opcode))
 					{
-						// indicate if a register contains more than one variables because of register packing
-						bool contain_multi_var = false;
-						uint32_t max_selector = this->GetMaxComponentSelector(op);
-						if ((offset + (max_selector - min_selector + 1) * 4) > (var.var_desc.start_offset + var.var_desc.size))
-						{
-							contain_multi_var = true;
-						}
-						assert_msg(var.has_type_desc, "Constant buffer should have type desc");
-
-						// if cb member is a array,this is element count, 0 if not a array
-						uint32_t element_count = var.type_desc.elements;
-						// find corresponding cb member array element index if it's a array
-						uint32_t element_index = 0;
-
-						switch (var.type_desc.var_class)
+						i_tex = 3;
+						i_sam = 4;
+					}
+					if (tex.tex_index == insn->ops[i_tex]->indices[0].disp)
+					{
+						SamplerInfo sam;
+						sam.index = insn->ops[i_sam]->indices[0].disp;
+						bool found = false;
+						for (std::vector<SamplerInfo>::const_iterator iter = tex.samplers.begin();
+							iter != tex.samplers.end(); ++ iter)
 						{
-						case SVC_VECTOR:
-						case SVC_SCALAR:
-							if (contain_multi_var)
-							{
-
-								//if a current register references more than one variable,things become more
-								//complex:
-								//e.g.
-								//|a[3].x|a[3].y|b   |c   |->this is a register,a b c are variables,a is an array
-								//|.x    |.y    |.z  |.w  |->this is register component
-								//current register reference is .yzw
-								//so we should convert it to :
-								//[i|u]vec{2,3,4}(a[3].y,b.x,c.x)
-								*need_comps = false;
-								switch (var.type_desc.type)
-								{
-								case SVT_INT:
-									out << "i";
-									break;
-
-								case SVT_UINT:
-									if (glsl_rules_ & GSR_UIntType)
-									{
-										out << "u";
-									}
-									else
-									{
-										out << "i";
-									}
-									break;
-
-								case SVT_FLOAT:
-									break;
-
-								default:
-									assert(false);
-									break;
-								}
-								out << "vec" << num_selectors;
-								out << "(";
-								for (uint32_t i = 0; i < num_selectors; ++ i)
-								{
-									if (i != 0)
-									{
-										out << ", ";
-									}
-
-									uint32_t register_selector = this->GetComponentSelector(op, i);
-									// find the cb member this register selector correspond to
-									// TODO: Check the O(N^2) here
-									uint32_t offset2 = 16 * register_index + register_selector * 4;
-									for (auto const & var2 : cb.vars)
-									{
-										if ((offset2 >= var2.var_desc.start_offset)
-											&& (var2.var_desc.start_offset + var2.var_desc.size > offset2))
-										{
-											out << var2.var_desc.name;
-											uint32_t element_count2 = var2.type_desc.elements;
-											// ajudge which cb member array element it's located in
-											if (element_count2)
-											{
-												element_index = (16 * register_index - var2.var_desc.start_offset) / 16;
-												out << "[" << element_index << "]";
-											}
-
-											if ((SVC_VECTOR == var2.type_desc.var_class) && !no_swizzle)
-											{
-												// remap register selector to the right cb member variable component
-												out << ".";
-												// for array,doesn't need to remap because array element is always at the start of a register,since
-												// array is not packed.
-												if (element_count2)
-												{
-													out << "xyzw"[register_selector];
-												}
-												else
-												{
-													// remap
-													uint32_t variable_offset = var2.var_desc.start_offset;
-													uint32_t register_component_offset = 16 * register_index + 4 * this->GetComponentSelector(op, i);
-													uint32_t remapped_component = (register_component_offset - variable_offset) / 4;
-													out << "xyzw"[remapped_component];
-												}
-											}
-
-											break;
-										}
-									}
-								}
-								out << ")";
-							}
-							else
+							if (iter->index == sam.index)
 							{
-								out << var.var_desc.name;
-								if (element_count != 0)
-								{
-									out << "[";
-									if (dynamic_indexed && op.indices[1].reg)
-									{
-										this->ToOperands(out, *op.indices[1].reg, SIT_Int);
-									}
-									else
-									{
-										element_index = (16 * register_index - var.var_desc.start_offset) / 16;
-										out << element_index;
-									}
-									out << "]";
-								}
-								else
-								{
-									// array is not packed, so doesn't need remap component_selector
-									// if not, because of register packing, we need to remap it.
-									// see: http://msdn.microsoft.com/zh-cn/library/windows/desktop/bb509632
-
-									*need_comps = false;
-									if ((SVC_VECTOR == var.type_desc.var_class) && !no_swizzle)
-									{
-										// remap register component to the right cb member variable component
-										// example case:
-										// |a  |b  |c.x|c.y|->this is a register,a b c is three variables
-										// |.x |.y |.z |.w |->this is register component
-										// so we need to remap .zw to .xy
-										for (uint32_t i = 0; i < num_selectors; ++ i)
-										{
-											if (i == 0)
-											{
-												out << ".";
-											}
-											uint32_t variable_offset = var.var_desc.start_offset;
-											uint32_t register_component_offset = 16 * register_index + 4 * this->GetComponentSelector(op, i);
-											uint32_t remapped_component = (register_component_offset - variable_offset) / 4;
-											out << "xyzw"[remapped_component];
-										}
-									}
-								}
-
-								if (SVC_SCALAR == var.type_desc.var_class)
-								{
-									*need_comps = false;
-								}
+								found = true;
+								break;
 							}
-							break;
-
-						case SVC_MATRIX_ROWS:
-						case SVC_MATRIX_COLUMNS:
+						}
+						if (!found)
+						{
+							// search sampler dcls
+							for (auto const & dcl2 : program_->dcls)
 							{
-								//hlsl matrix subscript is opposite to glsl
-								//e.g.in hlsl mat[2][3] <=>in glsl mat[3][2]
-								//so mat[2].xyzw in hlsl<=>vec4(mat[0][2],mat[1][2],mat[2][2],mat[3][2]) in glsl
-
-								assert_msg(!contain_multi_var, "Matrix will not be packed?");
-
-								//indicate how many registers a matrix array element occupies
-								uint32_t register_stride;
-								if (SVC_MATRIX_ROWS == var.type_desc.var_class)
-								{
-									register_stride = var.type_desc.rows;
-								}
-								else
-								{
-									register_stride = var.type_desc.columns;
-								}
-								if (element_count != 0)
-								{
-									//identify which matrix array element it's loacated in
-									element_index = (16 * register_index - var.var_desc.start_offset) / 16 / register_stride;
-								}
-								uint32_t row = (16 * register_index - var.var_desc.start_offset) / 16 - element_index * register_stride;
-								uint32_t count = this->GetOperandComponentNum(op);
-								if (count == 1)
-								{
-									out << "float";
-								}
-								else
-								{
-									out << "vec" << count;//glsl only support float or double matrix 
-								}
-								out << "(";
-								for (uint32_t i = 0; i < count; ++ i)
+								if ((SO_DCL_SAMPLER == dcl2->opcode)
+									&& (sam.index == dcl2->op->indices[0].disp))
 								{
-									if (i > 0)
-									{
-										out << ", ";
-									}
-									//convert component selector to column number
-									//x y z w--> 0 1 2 3
-									uint32_t column = this->GetComponentSelector(op, i);
-									out << var.var_desc.name;
-									if (glsl_rules_ & GSR_MatrixType)
+									if (dcl2->dcl_sampler.shadow)
 									{
-										if (element_count)
-										{
-											out << "[";
-											if (dynamic_indexed && op.indices[1].reg)
-											{
-												this->ToOperands(out, *op.indices[1].reg, SIT_Int);
-											}
-											else
-											{
-												out << element_index;
-											}
-											// The index is in float4. So for 4x4 matrix, divide by register_stride
-											out << " / " << register_stride;
-											out << "]";
-										}
-										if (SVC_MATRIX_ROWS == var.type_desc.var_class)
-										{
-											out << "[" << column << "]" << "[" << row << "]";
-										}
-										else
-										{
-											out << "[" << row << "]" << "[" << column << "]";
-										}
+										sam.shadow = true;
 									}
 									else
 									{
-										out << "[";
-										if (element_count)
-										{
-											if (dynamic_indexed && op.indices[1].reg)
-											{
-												this->ToOperands(out, *op.indices[1].reg, SIT_Int);
-											}
-											else
-											{
-												out << element_index;
-											}
-											out << " + ";
-										}
-										if (SVC_MATRIX_ROWS == var.type_desc.var_class)
-										{
-											out << column;
-										}
-										else
-										{
-											out << row;
-										}
-										out << "][";
-										if (SVC_MATRIX_ROWS == var.type_desc.var_class)
-										{
-											out << row;
-										}
-										else
-										{
-											out << column;
-										}
-										out << "]";
+										sam.shadow = false;
 									}
 								}
-								out << ")";
-								*need_comps = false;
-								}
-							break;
-
-						default:
-							assert_msg(false, "Unhandled type");
-							break;
+							}
+							tex.samplers.push_back(sam);
 						}
-
-						break;
 					}
 				}
-
-				break;
 			}
+			textures_.push_back(tex);
 		}
 	}
-	else if (SOT_INPUT_PRIMITIVEID == op.type)
-	{
-		out << "gl_PrimitiveID";
-		if (ST_GS == shader_type_)
-		{
-			out << "In";
-		}
-		*need_comps = false;
-		*need_idx = false;
-	}
-	else if (SOT_INPUT_GS_INSTANCE_ID == op.type)
-	{
-		out << "gl_InvocationID";
-		*need_comps = false;
-		*need_idx = false;
-	}
-	else if (SOT_OUTPUT_CONTROL_POINT_ID == op.type)
-	{
-		out << "gl_InvocationID";
-		*need_comps = false;
-		*need_idx = false;
-	}
-	else if (SOT_INPUT_THREAD_ID == op.type)
-	{
-		out << "gl_GlobalInvocationID";
-		*need_idx = false;
-	}
-	else if (SOT_INPUT_THREAD_GROUP_ID == op.type)
-	{
-		out << "gl_WorkGroupID";
-		*need_idx = false;
-	}
-	else if (SOT_INPUT_THREAD_ID_IN_GROUP == op.type)
-	{
-		out << "gl_LocalInvocationID";
-		*need_idx = false;
-	}
-	else if (SOT_INPUT_THREAD_ID_IN_GROUP_FLATTENED == op.type)
-	{
-		out << "gl_LocalInvocationIndex";
-		*need_idx = false;
-	}
-	else
-	{
-		out << ShaderOperandTypeShortName(op.type);
-	}
 }
 
-int GLSLGen::ToSingleComponentSelector(std::ostream& out, ShaderOperand const & op, int i, bool dot) const
+void GLSLGen::FindBindings()
 {
-	if ((SOT_IMMEDIATE32 == op.type) || (SOT_IMMEDIATE64 == op.type))
+	bindings_.clear();
+
+	int64_t num_textures = 0;
+	for (auto const & tex : textures_)
 	{
-		if ((op.comps > 1) && (i < op.comps))
+		num_textures = std::max(num_textures, tex.tex_index + 1);
+	}
+
+	uint32_t next_sampler = 0;
+	uint32_t next_extra_sampler = 0;
+	for (auto const & tex : textures_)
+	{
+		GLSLBinding binding;
+		binding.type = SIT_TEXTURE;
+		binding.bind_point = static_cast<uint32_t>(tex.tex_index);
+		char const * tex_name = this->GetResourceDesc(SIT_TEXTURE, binding.bind_point).name;
+		for (size_t i = 0; i < std::max<size_t>(tex.samplers.size(), 1); ++ i)
 		{
-			if (dot)
+			binding.name = tex_name;
+			binding.sampler_bind_point = -1;
+			if (i < tex.samplers.size())
 			{
-				out << ".";
+				binding.sampler_bind_point = static_cast<int32_t>(tex.samplers[i].index);
+				binding.name += "_";
+				binding.name += this->GetResourceDesc(SIT_SAMPLER, binding.sampler_bind_point).name;
 			}
-			out << "xyzw"[i];
+
+			binding.binding = binding_policy_.sampler_base;
+			if (binding_policy_.sequential)
+			{
+				binding.binding += next_sampler;
+			}
+			else if (0 == i)
+			{
+				binding.binding += binding.bind_point;
+			}
+			else
+			{
+				binding.binding += static_cast<uint32_t>(num_textures) + next_extra_sampler;
+				++ next_extra_sampler;
+			}
+			binding.handle_block = BindlessBlockName(shader_type_);
+			binding.handle_block_binding = binding_policy_.handle_block_binding + shader_type_;
+			binding.handle_offset = next_sampler * 8;
+			++ next_sampler;
+
+			bindings_.push_back(binding);
 		}
 	}
-	else
+
+	uint32_t next_image = 0;
+	for (auto const & dcl : program_->dcls)
 	{
-		if (dot)
+		if ((SO_DCL_UNORDERED_ACCESS_VIEW_TYPED == dcl->opcode) && !this->IsResourcePruned(dcl->op->type, dcl->op->indices[0].disp))
 		{
-			out << '.';
+			GLSLBinding binding;
+			binding.type = SIT_UAV_RWTYPED;
+			binding.bind_point = static_cast<uint32_t>(dcl->op->indices[0].disp);
+			binding.sampler_bind_point = -1;
+			binding.handle_block_binding = static_cast<uint32_t>(-1);
+			binding.handle_offset = static_cast<uint32_t>(-1);
+			binding.name = this->GetResourceDesc(SIT_UAV_RWTYPED, binding.bind_point).name;
+			binding.binding = binding_policy_.image_base + (binding_policy_.sequential ? next_image : binding.bind_point);
+			++ next_image;
+
+			bindings_.push_back(binding);
 		}
-		uint32_t comp = this->GetComponentSelector(op, i);
-		out << "xyzw"[comp];
-		return comp;
 	}
-
-	return 0;
 }
 
-//param i:the component selector to get
-//return:the idx of selector:0 1 2 3 stand for x y z w
-//for .xw i=0 return 0 i=1 return 3
-int GLSLGen::GetComponentSelector(ShaderOperand const & op, int i) const
+uint32_t GLSLGen::FindBinding(ShaderInputType type, int64_t bind_point, int64_t sampler_bind_point) const
 {
-	uint32_t comps_index;
-	switch (op.mode)
+	for (auto const & binding : bindings_)
 	{
-	case SOSM_MASK:
-		comps_index = this->ComponentSelectorFromMask(op.mask, op.comps);
-		break;
-
-	case SOSM_SWIZZLE:
-		comps_index = this->ComponentSelectorFromSwizzle(op.swizzle, op.comps);
-		break;
-
-	case SOSM_SCALAR:
-		comps_index = this->ComponentSelectorFromScalar(op.swizzle[0]);
-		i = 0;
-		break;
-
-	default:
-		assert(false);
-		comps_index = 0;
-		break;
+		if ((binding.type == type) && (binding.bind_point == bind_point) && (binding.sampler_bind_point == sampler_bind_point))
+		{
+			return binding.binding;
+		}
 	}
 
-	uint32_t comp = (comps_index >> (i * 8)) & 0xFF;
-	assert(comp != 0xFF);
-	return comp;
+	assert_msg(false, "Sampler or image without binding");
+	return 0;
 }
 
-void GLSLGen::ToComponentSelectors(std::ostream& out, ShaderOperand const & op, bool dot, uint32_t offset) const
+void GLSLGen::FindCBufferLayouts()
 {
-	if ((op.type != SOT_IMMEDIATE32) && (op.type != SOT_IMMEDIATE64))
+	cb_layouts_.clear();
+	for (auto const & cb : program_->cbuffers)
 	{
-		if (op.comps)
-		{
-			switch (op.mode)
-			{
-			case SOSM_MASK:
-				if (dot)
+		if (SCBT_CBUFFER == cb.desc.type)
+		{
+			CBufferLayout layout;
+			layout.bind_point = cb.bind_point;
+			layout.cb = &cb;
+			layout.dynamic_indexed = false;
+			layout.register_view = false;
+			layout.constants.assign(cb.vars.size(), nullptr);
+			layout.members.assign(cb.desc.size / 4, -1);
+			for (size_t i = 0; i < cb.vars.size(); ++ i)
+			{
+				uint32_t const first = cb.vars[i].var_desc.start_offset / 4;
+				uint32_t const last = std::min((cb.vars[i].var_desc.start_offset + cb.vars[i].var_desc.size + 3) / 4,
+					static_cast<uint32_t>(layout.members.size()));
+				for (uint32_t j = first; j < last; ++ j)
 				{
-					out << '.';
+					if (layout.members[j] < 0)
+					{
+						layout.members[j] = static_cast<int32_t>(i);
+					}
 				}
-				this->ToComponentSelector(out, this->ComponentSelectorFromMask(op.mask, op.comps), offset);
-				break;
-
-			case SOSM_SWIZZLE:
-				out << '.';
-				this->ToComponentSelector(out, this->ComponentSelectorFromSwizzle(op.swizzle, op.comps), offset);
-				break;
-
-			case SOSM_SCALAR:
-				out << '.';
-				this->ToComponentSelector(out, this->ComponentSelectorFromScalar(op.swizzle[0]), offset);
-				break;
-
-			default:
-				assert(false);
-				break;
 			}
+			cb_layouts_.push_back(layout);
 		}
 	}
-}
-
-bool GLSLGen::IsImmediateNumber(ShaderOperand const & op) const
-{
-	return ((SOT_IMMEDIATE32 == op.type) || (SOT_IMMEDIATE64 == op.type));
-}
 
-int GLSLGen::GetOperandComponentNum(ShaderOperand const & op) const
-{
-	int num_comps = 0;
-	if (op.comps)
+	for (auto const & dcl : program_->dcls)
 	{
-		switch (op.mode)
+		if (SO_DCL_CONSTANT_BUFFER == dcl->opcode)
 		{
-		case SOSM_MASK:
-			for (uint32_t i = 0; i < op.comps; ++ i)
+			for (auto& layout : cb_layouts_)
 			{
-				if (op.mask & (1 << i))
+				if (layout.bind_point == dcl->op->indices[0].disp)
 				{
-					++ num_comps;
+					layout.dynamic_indexed = dcl->dcl_constant_buffer.dynamic;
 				}
 			}
-			break;
-
-		case SOSM_SWIZZLE:
-			num_comps = op.comps;
-			break;
-
-		case SOSM_SCALAR:
-			num_comps = 1;
-			break;
-
-		default:
-			assert(false);
-			break;
 		}
 	}
-	return num_comps;
-}
 
-ShaderRegisterComponentType GLSLGen::GetOutputParamType(ShaderOperand const & op) const
-{
-	if (SOT_OUTPUT == op.type)
+	for (auto& layout : cb_layouts_)
 	{
-		for (auto const & po : program_->params_out)
+		DXBCConstantBuffer const & cb = *layout.cb;
+		if (((glsl_rules_ & GSR_GlobalUniformsInUBO) || (cb.desc.name[0] != '$')) && !HasDefaultValues(cb))
 		{
-			if (po.register_index == op.indices[0].disp)
+			if ((glsl_rules_ & GSR_DynamicCBufferRegisters) && layout.dynamic_indexed)
 			{
-				return po.component_type;
+				layout.register_view = true;
+			}
+			else if (glsl_rules_ & GSR_D3DCBufferLayout)
+			{
+				layout.register_view = !Std140MatchesD3D(cb, (glsl_rules_ & GSR_MatrixType) != 0);
 			}
 		}
-		//I met a false error here when debugging,remove it for convenience.
-		//the insn  is:
-		//dcl_out_siv o4.x, finalQuadUInsideTessFactor
-		//there is only 3 output params.
-		//assert(false);
-		return SRCT_FLOAT32;
-	}
-	else if (SOT_OUTPUT_DEPTH == op.type)
-	{
-		for (auto const & po : program_->params_out)
+
+		// A register view reads every member from the buffer, and cbuffers with default values are constants already
+		if (!layout.register_view && !HasDefaultValues(cb))
 		{
-			if (0 == strcmp("SV_Depth", po.semantic_name))
+			for (auto const & specialization : specializations_)
 			{
-				return po.component_type;
+				if (specialization.cbuffer_name == cb.desc.name)
+				{
+					for (size_t i = 0; i < cb.vars.size(); ++ i)
+					{
+						DXBCShaderVariable const & var = cb.vars[i];
+						if (var.has_type_desc && (specialization.member_name == var.var_desc.name)
+							&& HasConstantInitializer(var.type_desc) && (specialization.value.size() >= var.var_desc.size))
+						{
+							layout.constants[i] = &specialization;
+						}
+					}
+				}
 			}
 		}
-		assert(false);
-		return SRCT_FLOAT32;
-	}
-	else if ((SOT_TEMP == op.type) || (SOT_INDEXABLE_TEMP == op.type))
-	{
-		return SRCT_FLOAT32;
-	}
-	else
-	{
-		assert(false);
-		return SRCT_FLOAT32;
 	}
 }
 
-DXBCSignatureParamDesc const & GLSLGen::GetOutputParamDesc(ShaderOperand const & op, uint32_t index) const
+CBufferLayout const * GLSLGen::FindCBufferLayout(uint32_t bind_point) const
 {
-	for (auto const & po : program_->params_out)
+	// A handful of cbuffers at most
+	for (auto const & layout : cb_layouts_)
 	{
-		if (po.register_index == op.indices[index].disp)
+		if (layout.bind_point == bind_point)
 		{
-			return po;
+			return &layout;
 		}
 	}
-
-	assert(false);
-	static DXBCSignatureParamDesc invalid;
-	return invalid;
+	return nullptr;
 }
 
-DXBCSignatureParamDesc const & GLSLGen::GetInputParamDesc(ShaderOperand const & op, uint32_t index) const
+DXBCShaderVariable const * GLSLGen::FindCBufferMember(uint32_t bind_point, uint32_t offset) const
 {
-	assert(SOT_INPUT == op.type);
-	for (auto const & pi : program_->params_in)
+	CBufferLayout const * layout = this->FindCBufferLayout(bind_point);
+	if (layout && (offset / 4 < layout->members.size()) && (layout->members[offset / 4] >= 0))
 	{
-		if (pi.register_index == op.indices[index].disp)
-		{
-			return pi;
-		}
+		return &layout->cb->vars[layout->members[offset / 4]];
 	}
+	return nullptr;
+}
 
-	assert(false);
-	static DXBCSignatureParamDesc invalid;
-	return invalid;
+CBufferSpecialization const * GLSLGen::FindCBufferConstant(uint32_t bind_point, uint32_t var_index) const
+{
+	CBufferLayout const * layout = this->FindCBufferLayout(bind_point);
+	return layout ? layout->constants[var_index] : nullptr;
+}
+
+bool GLSLGen::IsCBufferRegisterView(uint32_t bind_point) const
+{
+	CBufferLayout const * layout = this->FindCBufferLayout(bind_point);
+	return layout && layout->register_view;
 }
 
-void GLSLGen::FindDclIndexRange()
-{
-	for (auto const & dcl : program_->dcls)
+bool GLSLGen::IsResourcePruned(ShaderOperandType type, int64_t bind_point) const
+{
+	if (!(glsl_rules_ & GSR_PruneUnused))
+	{
+		return false;
+	}
+
+	// Covers DSIF_Unused too, the compiler only flags resources no instruction refers to
+	for (auto const & insn : program_->insns)
 	{
-		if (SO_DCL_INDEX_RANGE == dcl->opcode)
+		for (uint32_t i = 0; i < insn->num_ops; ++ i)
 		{
-			DclIndexRangeInfo mInfo;
-			mInfo.op_type = dcl->op->type;
-			mInfo.start = dcl->op->indices[0].disp;
-			mInfo.num = dcl->num;
-			idx_range_info_.push_back(mInfo);
+			if ((insn->ops[i]->type == type) && (insn->ops[i]->indices[0].disp == bind_point))
+			{
+				return false;
+			}
 		}
 	}
+	return true;
 }
 
-void GLSLGen::FindSamplers()
+void GLSLGen::FindUniformLocations()
 {
+	uniform_locations_.clear();
+	for (auto& layout : cb_layouts_)
+	{
+		layout.uniform_locations.assign(layout.cb->vars.size(), -1);
+	}
+	if (!(glsl_rules_ & GSR_UniformLocations))
+	{
+		return;
+	}
+
 	for (auto const & dcl : program_->dcls)
 	{
-		if (SO_DCL_RESOURCE == dcl->opcode)
+		if (SO_DCL_CONSTANT_BUFFER == dcl->opcode)
 		{
-			TextureSamplerInfo tex;
-			tex.type = dcl->dcl_resource.target;
-			tex.tex_index = dcl->op->indices[0].disp;
-			for (auto const & insn : program_->insns)
+			CBufferLayout* layout = nullptr;
+			for (auto& cb_layout : cb_layouts_)
 			{
-				if ((SO_SAMPLE == insn->opcode)
-					|| (SO_SAMPLE_C == insn->opcode)
-					|| (SO_SAMPLE_C_LZ == insn->opcode)
-					|| (SO_SAMPLE_L == insn->opcode)
-					|| (SO_SAMPLE_D == insn->opcode)
-					|| (SO_SAMPLE_B == insn->opcode)
-					|| (SO_LOD == insn->opcode)
-					|| (SO_GATHER4 == insn->opcode)
-					|| (SO_GATHER4_C == insn->opcode)
-					|| (SO_GATHER4_PO == insn->opcode)
-					|| (SO_GATHER4_PO_C == insn->opcode))
+				if (cb_layout.bind_point == dcl->op->indices[0].disp)
 				{
-					// 3:sampler, 2:resource
-					int i_tex = 2;
-					int i_sam = 3;
-					if ((SO_GATHER4_PO == insn->opcode)
-						|| (SO_GATHER4_PO_C == insn->opcode))
-					{
-						i_tex = 3;
-						i_sam = 4;
-					}
-					if (tex.tex_index == insn->ops[i_tex]->indices[0].disp)
+					layout = &cb_layout;
+				}
+			}
+			if (!layout)
+			{
+				continue;
+			}
+
+			// Same conditions as the free standing uniforms of ToDeclaration
+			DXBCConstantBuffer const & cb = *layout->cb;
+			if (((glsl_rules_ & GSR_UseUBO) && ((glsl_rules_ & GSR_GlobalUniformsInUBO) || (cb.desc.name[0] != '$')))
+				|| HasDefaultValues(cb))
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < cb.vars.size(); ++ i)
+			{
+				DXBCShaderVariable const & var = cb.vars[i];
+				if (var.has_type_desc && (var.var_desc.flags & DSVF_Used) && !layout->constants[i])
+				{
+					GLSLUniformLocation location;
+					location.name = var.var_desc.name;
+					location.cb_bind_point = cb.bind_point;
+					location.var_index = static_cast<uint32_t>(i);
+					location.offset = var.var_desc.start_offset;
+					location.num_locations = UniformLocationCount(var.type_desc, (glsl_rules_ & GSR_MatrixType) != 0);
+					location.location = -1;
+					if (location.offset / 4 + location.num_locations <= binding_policy_.uniform_location_stride)
 					{
-						SamplerInfo sam;
-						sam.index = insn->ops[i_sam]->indices[0].disp;
-						bool found = false;
-						for (std::vector<SamplerInfo>::const_iterator iter = tex.samplers.begin();
-							iter != tex.samplers.end(); ++ iter)
-						{
-							if (iter->index == sam.index)
-							{
-								found = true;
-								break;
-							}
-						}
-						if (!found)
-						{
-							// search sampler dcls
-							for (auto const & dcl2 : program_->dcls)
-							{
-								if ((SO_DCL_SAMPLER == dcl2->opcode)
-									&& (sam.index == dcl2->op->indices[0].disp))
-								{
-									if (dcl2->dcl_sampler.shadow)
-									{
-										sam.shadow = true;
-									}
-									else
-									{
-										sam.shadow = false;
-									}
-								}
-							}
-							tex.samplers.push_back(sam);
-						}
+						location.location = static_cast<int32_t>(binding_policy_.uniform_location_base
+							+ cb.bind_point * binding_policy_.uniform_location_stride + location.offset / 4);
 					}
+
+					layout->uniform_locations[i] = static_cast<int32_t>(uniform_locations_.size());
+					uniform_locations_.push_back(location);
 				}
 			}
-			textures_.push_back(tex);
 		}
 	}
 }
@@ -7327,6 +9909,11 @@ void GLSLGen::LinkCFInsns()
 	std::vector<uint32_t> cf_stack;
 	for (uint32_t insn_num = 0; insn_num < program_->insns.size(); ++ insn_num)
 	{
+		if (!(ShaderOpcodeDescription(program_->insns[insn_num]->opcode).flags & SOF_ControlFlow))
+		{
+			continue;
+		}
+
 		uint32_t v;
 		switch (program_->insns[insn_num]->opcode)
 		{
@@ -7335,9 +9922,12 @@ void GLSLGen::LinkCFInsns()
 			break;
 
 		case SO_ENDLOOP:
-			assert(!cf_stack.empty());
+			if (cf_stack.empty() || (program_->insns[cf_stack.back()]->opcode != SO_LOOP))
+			{
+				this->ReportError(GGS_InvalidProgram, "endloop without matching loop", program_->insns[insn_num].get());
+				return;
+			}
 			v = cf_stack.back();
-			assert(SO_LOOP == program_->insns[v]->opcode);
 			kcf_insn_linked[v] = insn_num;
 			kcf_insn_linked[insn_num] = v;
 			cf_stack.pop_back();
@@ -7351,15 +9941,27 @@ void GLSLGen::LinkCFInsns()
 
 		case SO_ELSE:
 		case SO_CASE:
-			assert(!cf_stack.empty());
+			if (cf_stack.empty())
+			{
+				this->ReportError(GGS_InvalidProgram, "else or case outside of if or switch", program_->insns[insn_num].get());
+				return;
+			}
 			v = cf_stack.back();
 			if (SO_ELSE == program_->insns[insn_num]->opcode)
 			{
-				assert(SO_IF == program_->insns[v]->opcode);
+				if (program_->insns[v]->opcode != SO_IF)
+				{
+					this->ReportError(GGS_InvalidProgram, "else without matching if", program_->insns[insn_num].get());
+					return;
+				}
 			}
 			else
 			{
-				assert((SO_SWITCH == program_->insns[v]->opcode) || (SO_CASE == program_->insns[v]->opcode));
+				if ((program_->insns[v]->opcode != SO_SWITCH) && (program_->insns[v]->opcode != SO_CASE))
+				{
+					this->ReportError(GGS_InvalidProgram, "case without matching switch", program_->insns[insn_num].get());
+					return;
+				}
 			}
 			kcf_insn_linked[insn_num] = kcf_insn_linked[v]; // later changed
 			kcf_insn_linked[v] = insn_num;
@@ -7368,15 +9970,27 @@ void GLSLGen::LinkCFInsns()
 
 		case SO_ENDSWITCH:
 		case SO_ENDIF:
-			assert(!cf_stack.empty());
+			if (cf_stack.empty())
+			{
+				this->ReportError(GGS_InvalidProgram, "endif or endswitch outside of if or switch", program_->insns[insn_num].get());
+				return;
+			}
 			v = cf_stack.back();
 			if (SO_ENDIF == program_->insns[insn_num]->opcode)
 			{
-				assert((SO_IF == program_->insns[v]->opcode) || (SO_ELSE == program_->insns[v]->opcode));
+				if ((program_->insns[v]->opcode != SO_IF) && (program_->insns[v]->opcode != SO_ELSE))
+				{
+					this->ReportError(GGS_InvalidProgram, "endif without matching if", program_->insns[insn_num].get());
+					return;
+				}
 			}
 			else
 			{
-				assert((SO_SWITCH == program_->insns[v]->opcode) || (SO_CASE == program_->insns[v]->opcode));
+				if ((program_->insns[v]->opcode != SO_SWITCH) && (program_->insns[v]->opcode != SO_CASE))
+				{
+					this->ReportError(GGS_InvalidProgram, "endswitch without matching switch", program_->insns[insn_num].get());
+					return;
+				}
 			}
 			kcf_insn_linked[insn_num] = kcf_insn_linked[v];
 			kcf_insn_linked[v] = insn_num;
@@ -7387,7 +10001,11 @@ void GLSLGen::LinkCFInsns()
 			break;
 		}
 	}
-	assert(cf_stack.empty());
+	if (!cf_stack.empty())
+	{
+		this->ReportError(GGS_InvalidProgram, "Unterminated flow control block", program_->insns[cf_stack.back()].get());
+		return;
+	}
 	cf_insn_linked_.swap(kcf_insn_linked);
 	return;
 }
@@ -7407,16 +10025,22 @@ void GLSLGen::FindLabels()
 		case SO_LABEL:
 			if (insn->num_ops > 0)
 			{
-				ShaderOperand& op = *insn->ops[0];
+				ShaderOperand const & op = *insn->ops[0];
 				LabelInfo info;
 				if ((SOT_LABEL == op.type) && op.HasSimpleIndex())
 				{
 					uint32_t idx = static_cast<uint32_t>(op.indices[0].disp);
 					info.start_num = idx + 1;
+					info.end_num = info.start_num;
 					// find the last insn in the label code.
 					uint32_t threshold = idx;
 					for (uint32_t i = info.start_num; ; ++ i)
 					{
+						if (i >= program_->insns.size())
+						{
+							this->ReportError(GGS_InvalidProgram, "Label without ret", insn.get());
+							break;
+						}
 						if ((SO_RET == program_->insns[i]->opcode) && (i > threshold))
 						{
 							info.end_num = i;
@@ -7449,6 +10073,19 @@ void GLSLGen::FindLabels()
 		}
 	}
 
+	for (auto const & insn : program_->insns)
+	{
+		if ((SO_CALL == insn->opcode) || (SO_CALLC == insn->opcode))
+		{
+			// Read the same way as ToInstruction does
+			uint32_t const label_op = (SO_CALLC == insn->opcode) ? 1 : 0;
+			if ((label_op >= insn->num_ops) || (static_cast<uint32_t>(insn->ops[label_op]->imm_values[0].u32) >= labels.size()))
+			{
+				this->ReportError(GGS_InvalidProgram, "call to a label that isn't defined", insn.get());
+			}
+		}
+	}
+
 	label_to_insn_num_.swap(labels);
 	labels_found_ = true;
 }
@@ -7468,7 +10105,8 @@ void GLSLGen::FindEndOfProgram()
 		}
 	}
 	uint32_t current_fork_phase_count = 0;*/
-	for (uint32_t i = 0; ; ++ i)
+	end_of_program_ = static_cast<uint32_t>(-1);
+	for (uint32_t i = 0; i < program_->insns.size(); ++ i)
 	{
 		
 		if (program_->insns[i]->opcode == SO_RET&&i >= threshold)
@@ -7495,6 +10133,11 @@ void GLSLGen::FindEndOfProgram()
 			//++current_fork_phase_count;
 		//}
 	}
+
+	if (static_cast<uint32_t>(-1) == end_of_program_)
+	{
+		this->ReportError(GGS_InvalidProgram, "Missing ret at the end of the program", nullptr);
+	}
 }
 
 DXBCInputBindDesc const & GLSLGen::GetResourceDesc(ShaderInputType type, uint32_t bind_point) const
@@ -7507,8 +10150,8 @@ DXBCInputBindDesc const & GLSLGen::GetResourceDesc(ShaderInputType type, uint32_
 		}
 	}
 
-	assert(false);
-	static DXBCInputBindDesc ret;
+	this->ReportError(GGS_InvalidProgram, "Resource isn't in the resource bindings", cur_insn_);
+	static DXBCInputBindDesc const ret = { "" };
 	return ret;
 }
 
@@ -7522,8 +10165,8 @@ DXBCConstantBuffer const & GLSLGen::GetConstantBuffer(ShaderCBufferType type, ch
 		}
 	}
 
-	assert(false);
-	static DXBCConstantBuffer ret;
+	this->ReportError(GGS_InvalidProgram, "Constant buffer isn't in the resource chunk", cur_insn_);
+	static DXBCConstantBuffer const ret = { { "" } };
 	return ret;
 }
 
@@ -7592,11 +10235,21 @@ void GLSLGen::ToTemps(std::ostream& out, ShaderDecl const & dcl)
 		{
 			for (uint32_t i = 0; i < dcl.num; ++ i)
 			{
+				// Without refactoringAllowed D3D keeps the float math in program order
+				if (!allow_refactoring_ && (glsl_rules_ & GSR_PreciseQualifier))
+				{
+					out << "precise ";
+				}
+				if (i < temp_min_precision_.size())
+				{
+					this->ToMinPrecision(out, temp_min_precision_[i]);
+				}
 				out << "vec4 " << "tf" << i << ";\n";
 				out << "ivec4 " << "ti" << i << ";\n";
 			}
 
 			temp_as_type_.assign(dcl.num * 4, SIT_Float);
+			temp_raw_.assign(dcl.num * 4, 0);
 		}
 		break;
 
@@ -7626,8 +10279,7 @@ void GLSLGen::ToImmConstBuffer(std::ostream& out, ShaderDecl const & dcl)
 			// Normalized float test
 			if (ValidFloat(data[i * 4 + j]))
 			{
-				out.setf(std::ios::showpoint);
-				out << data[i * 4 + j];
+				out << FloatToString(data[i * 4 + j]);
 			}
 			else
 			{
@@ -7704,14 +10356,16 @@ void GLSLGen::ToDefaultValue(std::ostream& out, DXBCShaderVariable const & var,
 				{
 					out << ",";
 				}
+				// Matches the operand mapping, mat[register][component] for column major and the other way around
+				// for row major
 				char const * p = p_base;
 				if (SVC_MATRIX_COLUMNS == var.type_desc.var_class)
 				{
-					p += row * 16 + column * 4;
+					p += column * 16 + row * 4;
 				}
 				else
 				{
-					p += column * 16 + row * 4;
+					p += row * 16 + column * 4;
 				}
 				this->ToDefaultValue(out, p, var.type_desc.type);
 			}
@@ -7790,8 +10444,17 @@ void GLSLGen::ToDefaultValue(std::ostream& out, char const * value, ShaderVariab
 
 	case SVT_FLOAT:
 		{
+			// GLSL ES has no implicit int to float conversion
 			float const * p = reinterpret_cast<float const *>(value);
-			out << *p;
+			if (std::isfinite(*p))
+			{
+				out << FloatToString(*p);
+			}
+			else
+			{
+				// No literal for them
+				out << *p;
+			}
 		}
 		break;
 
@@ -7803,45 +10466,65 @@ void GLSLGen::ToDefaultValue(std::ostream& out, char const * value, ShaderVariab
 
 void GLSLGen::ToDefaultValue(std::ostream& out, DXBCShaderVariable const & var)
 {
+	// A member without initializer is 0, and one shorter than its type reads 0 past the end. Every element takes at
+	// most 4 registers. Values are read a word at a time, so an unaligned one is copied too.
+	uint32_t const footprint = std::max(var.type_desc.elements, 1U) * 64;
+	if (!var.var_desc.default_val || (var.var_desc.size < footprint)
+		|| (reinterpret_cast<uintptr_t>(var.var_desc.default_val) & 3))
+	{
+		std::vector<char> value(std::max(footprint, var.var_desc.size), 0);
+		if (var.var_desc.default_val)
+		{
+			memcpy(&value[0], var.var_desc.default_val, var.var_desc.size);
+		}
+		DXBCShaderVariable padded = var;
+		padded.var_desc.default_val = &value[0];
+		padded.var_desc.size = static_cast<uint32_t>(value.size());
+		this->ToDefaultValue(out, padded);
+		return;
+	}
+
 	if (0 == var.type_desc.elements)
 	{
 		this->ToDefaultValue(out, var, 0);
 	}
 	else
 	{
+		// Every array element starts a new register
 		uint32_t stride = 0;
-		switch (var.type_desc.type)
-		{
-		case SVT_INT:
-			out << "i";
-			break;
-
-		case SVT_UINT:
-			if (glsl_rules_ & GSR_UIntType)
-			{
-				out << "u";
-			}
-			else
-			{
-				out << "i";
-			}
-			break;
-
-		case SVT_FLOAT:
-			break;
-
-		default:
-			assert_msg(false, "Unhandled type.");
-			break;
-		}
 		switch (var.type_desc.var_class)
 		{
 		case SVC_SCALAR:
-			stride = 4;
+			stride = 16;
+			out << var.type_desc.name << "[]";
 			break;
 					
 		case SVC_VECTOR:
 			stride = 16;
+			switch (var.type_desc.type)
+			{
+			case SVT_INT:
+				out << "i";
+				break;
+
+			case SVT_UINT:
+				if (glsl_rules_ & GSR_UIntType)
+				{
+					out << "u";
+				}
+				else
+				{
+					out << "i";
+				}
+				break;
+
+			case SVT_FLOAT:
+				break;
+
+			default:
+				assert_msg(false, "Unhandled type.");
+				break;
+			}
 			out << "vec" << var.type_desc.columns << "[]";
 			break;
 
@@ -8085,11 +10768,57 @@ void GLSLGen::FindHSControlPointPhase()
 	}
 }
 
+void GLSLGen::FindHSForkInvocations()
+{
+	if ((ST_HS != shader_type_) || !(glsl_rules_ & GSR_HSForkInvocations)
+		|| (hs_fork_phases_.empty() && hs_join_phases_.empty())
+		|| (0 == program_->hs_output_control_point_count))
+	{
+		return;
+	}
+
+	// barrier() can't follow a return, so a conditional return keeps every phase in every invocation
+	for (auto const & insn : program_->insns)
+	{
+		if (SO_RETC == insn->opcode)
+		{
+			return;
+		}
+	}
+
+	// The shared p_REGISTER is the only per patch output, on top of the per vertex ones. If it doesn't fit,
+	// keep it local to each invocation as before.
+	uint32_t const patch_comps = this->GetNumPatchConstantSignatureRegisters(program_->params_patch) * 4;
+	uint32_t vertex_comps = 0;
+	for (auto const & desc : program_->params_out)
+	{
+		vertex_comps += bitcount32(desc.mask);
+	}
+	for (auto const & desc : program_->params_patch)
+	{
+		if ((desc.read_write_mask != 0xF) && (SN_UNDEFINED == desc.system_value_type))
+		{
+			vertex_comps += bitcount32(desc.mask);
+		}
+	}
+	if ((patch_comps > MAX_TESS_PATCH_COMPONENTS)
+		|| (vertex_comps * program_->hs_output_control_point_count + patch_comps > MAX_TESS_CONTROL_TOTAL_OUTPUT_COMPONENTS))
+	{
+		return;
+	}
+
+	hs_fork_invocations_ = true;
+}
+
 void GLSLGen::ToDclInterShaderPatchConstantRegisters(std::ostream& out)
 {
 	uint32_t num_registers = GetNumPatchConstantSignatureRegisters(program_->params_patch);
 	if (num_registers > 0)
 	{
+		if (hs_fork_invocations_)
+		{
+			out << "patch out ";
+		}
 		out << "vec4 p_REGISTER[" << num_registers << "];\n";
 	}
 }
@@ -8099,7 +10828,15 @@ void GLSLGen::ToHSForkPhases(std::ostream& out)
 	// set enter_hs_fork_phase to true;
 	if (!hs_fork_phases_.empty())
 	{
-		this->ToDclInterShaderPatchConstantRegisters(out);
+		if (hs_fork_invocations_)
+		{
+			// Control point outputs have to be visible to the fork phases of other invocations
+			out << "barrier();\n";
+		}
+		else
+		{
+			this->ToDclInterShaderPatchConstantRegisters(out);
+		}
 		enter_hs_fork_phase_ = true;
 	}
 	// convert instructions of all the hs fork phase
@@ -8112,8 +10849,22 @@ void GLSLGen::ToHSForkPhases(std::ostream& out)
 		// add a for(){} to iterate each hs_fork_phase instance
 		if (iter->fork_instance_count > 0)
 		{
-			out << "\nfor (int vForkInstanceID = 0; vForkInstanceID < " << iter->fork_instance_count
-				<<"; ++ vForkInstanceID)\n{\n";
+			if (hs_fork_invocations_)
+			{
+				out << "\nfor (int vForkInstanceID = gl_InvocationID; vForkInstanceID < " << iter->fork_instance_count
+					<< "; vForkInstanceID += " << program_->hs_output_control_point_count << ")\n{\n";
+			}
+			else
+			{
+				out << "\nfor (int vForkInstanceID = 0; vForkInstanceID < " << iter->fork_instance_count
+					<<"; ++ vForkInstanceID)\n{\n";
+			}
+		}
+		else if (hs_fork_invocations_)
+		{
+			// Single instance phases are dealt out round-robin
+			out << "\nif (gl_InvocationID == " << (iter - hs_fork_phases_.begin()) % program_->hs_output_control_point_count
+				<< ")\n{\n";
 		}
 		
 		for (uint32_t i = 0; i < iter->insns.size(); ++ i)
@@ -8126,7 +10877,7 @@ void GLSLGen::ToHSForkPhases(std::ostream& out)
 		}
 
 		// end of for(){}
-		if (iter->fork_instance_count > 0)
+		if ((iter->fork_instance_count > 0) || hs_fork_invocations_)
 		{
 			out << "}\n";
 		}
@@ -8144,7 +10895,15 @@ void GLSLGen::ToHSJoinPhases(std::ostream& out)
 	// set enter_hs_fork_phase to true;
 	if (!hs_join_phases_.empty())
 	{
-		this->ToDclInterShaderPatchConstantRegisters(out);
+		if (hs_fork_invocations_)
+		{
+			// Join phases read the patch constants written by the fork phases
+			out << "barrier();\n";
+		}
+		else
+		{
+			this->ToDclInterShaderPatchConstantRegisters(out);
+		}
 		enter_hs_join_phase_ = true;
 	}
 	// convert instructions of all the hs fork phase	
@@ -8157,8 +10916,21 @@ void GLSLGen::ToHSJoinPhases(std::ostream& out)
 		// add a for(){} to iterate each hs_fork_phase instance
 		if (iter->join_instance_count > 0)
 		{
-			out << "\nfor (int vJoinInstanceID = 0; vJoinInstanceID < " << iter->join_instance_count
-				<< "; ++ vJoinInstanceID)\n{\n";
+			if (hs_fork_invocations_)
+			{
+				out << "\nfor (int vJoinInstanceID = gl_InvocationID; vJoinInstanceID < " << iter->join_instance_count
+					<< "; vJoinInstanceID += " << program_->hs_output_control_point_count << ")\n{\n";
+			}
+			else
+			{
+				out << "\nfor (int vJoinInstanceID = 0; vJoinInstanceID < " << iter->join_instance_count
+					<< "; ++ vJoinInstanceID)\n{\n";
+			}
+		}
+		else if (hs_fork_invocations_)
+		{
+			out << "\nif (gl_InvocationID == " << (iter - hs_join_phases_.begin()) % program_->hs_output_control_point_count
+				<< ")\n{\n";
 		}
 
 		for (uint32_t i = 0; i < iter->insns.size(); ++ i)
@@ -8171,7 +10943,7 @@ void GLSLGen::ToHSJoinPhases(std::ostream& out)
 		}
 
 		// end of for(){}
-		if (iter->join_instance_count > 0)
+		if ((iter->join_instance_count > 0) || hs_fork_invocations_)
 		{
 			out << "}\n";
 		}
@@ -8305,7 +11077,7 @@ void GLSLGen::ToDclInterShaderPatchConstantRecords(std::ostream& out)
 
 			if (1 == num_comps)
 			{
-				switch (program_->params_out[i].component_type)
+				switch (program_->params_patch[i].component_type)
 				{
 				case SRCT_UINT32:
 					if (glsl_rules_ & GSR_UIntType)
@@ -8457,3 +11229,44 @@ ShaderImmType GLSLGen::FindTextureReturnType(ShaderOperand const & op) const
 	}
 	return ret;
 }
+
+GLSLGenResult const & GLSLGen::Result() const
+{
+	return result_;
+}
+
+std::vector<GLSLBinding> const & GLSLGen::Bindings() const
+{
+	return bindings_;
+}
+
+std::vector<GLSLUniformLocation> const & GLSLGen::UniformLocations() const
+{
+	return uniform_locations_;
+}
+
+void GLSLGen::ReportError(GLSLGenStatus status, char const * message, ShaderInstruction const * insn) const
+{
+	// Keep the first error, the later ones are usually fallout from it
+	if (result_.status != GGS_OK)
+	{
+		return;
+	}
+
+	result_.status = status;
+	result_.message = message;
+	result_.insn_index = static_cast<uint32_t>(-1);
+	result_.opcode = 0;
+	if (insn)
+	{
+		result_.opcode = insn->opcode;
+		for (size_t i = 0; i < program_->insns.size(); ++ i)
+		{
+			if (program_->insns[i].get() == insn)
+			{
+				result_.insn_index = static_cast<uint32_t>(i);
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,629 @@
+/**
+ * @file GLSLMinify.cpp
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <DXBC2GLSL/GLSLMinify.hpp>
+#include <DXBC2GLSL/Utils.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace
+{
+	enum GLSLTokenType
+	{
+		GTT_Identifier,
+		GTT_Number,
+		GTT_Punctuator,
+		GTT_Preprocessor	// A whole directive line
+	};
+
+	struct GLSLToken
+	{
+		GLSLTokenType type;
+		std::string text;
+		bool in_function;	// Inside the body of a function
+	};
+
+	char const * const multi_char_punctuators[] =
+	{
+		"<<=", ">>=",
+		"++", "--", "+=", "-=", "*=", "/=", "%=", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "^^", "&=", "|=", "^="
+	};
+
+	// Short names a local can't take even when the shader doesn't use them
+	char const * const reserved_short_names[] =
+	{
+		"do", "if", "in", "asm", "for", "int", "out",
+		"abs", "all", "any", "cos", "dot", "exp", "fma", "log", "max", "min", "mix", "mod", "not", "pow", "sin", "tan"
+	};
+
+	bool IsIdentifierStart(char c)
+	{
+		return std::isalpha(static_cast<unsigned char>(c)) || ('_' == c);
+	}
+
+	bool IsIdentifierChar(char c)
+	{
+		return std::isalnum(static_cast<unsigned char>(c)) || ('_' == c);
+	}
+
+	bool IsTypeName(std::string const & name, std::set<std::string> const & structs)
+	{
+		if ((name == "bool") || (name == "int") || (name == "uint") || (name == "float") || (name == "double")
+			|| (structs.find(name) != structs.end()))
+		{
+			return true;
+		}
+
+		size_t prefix = 0;
+		bool matrix = false;
+		if ((0 == name.compare(0, 3, "vec")) || (0 == name.compare(0, 3, "mat")))
+		{
+			prefix = 3;
+			matrix = ('m' == name[0]);
+		}
+		else if ((0 == name.compare(0, 4, "ivec")) || (0 == name.compare(0, 4, "uvec")) || (0 == name.compare(0, 4, "bvec"))
+			|| (0 == name.compare(0, 4, "dvec")) || (0 == name.compare(0, 4, "dmat")))
+		{
+			prefix = 4;
+			matrix = ('m' == name[1]);
+		}
+		else
+		{
+			return false;
+		}
+
+		if ((name.size() == prefix + 1) && (name[prefix] >= '2') && (name[prefix] <= '4'))
+		{
+			return true;
+		}
+		return matrix && (name.size() == prefix + 3) && (name[prefix] >= '2') && (name[prefix] <= '4')
+			&& ('x' == name[prefix + 1]) && (name[prefix + 2] >= '2') && (name[prefix + 2] <= '4');
+	}
+
+	std::vector<GLSLToken> Tokenize(std::string const & glsl)
+	{
+		std::vector<GLSLToken> tokens;
+		bool line_start = true;
+		size_t i = 0;
+		while (i < glsl.size())
+		{
+			char const c = glsl[i];
+			if ('\n' == c)
+			{
+				line_start = true;
+				++ i;
+			}
+			else if (std::isspace(static_cast<unsigned char>(c)))
+			{
+				++ i;
+			}
+			else if (('#' == c) && line_start)
+			{
+				// GLSLGen doesn't continue directives over several lines
+				size_t end = glsl.find('\n', i);
+				if (std::string::npos == end)
+				{
+					end = glsl.size();
+				}
+				size_t last = end;
+				while ((last > i) && std::isspace(static_cast<unsigned char>(glsl[last - 1])))
+				{
+					-- last;
+				}
+				GLSLToken token = { GTT_Preprocessor, glsl.substr(i, last - i), false };
+				tokens.push_back(token);
+				i = end;
+			}
+			else if (('/' == c) && (i + 1 < glsl.size()) && ('/' == glsl[i + 1]))
+			{
+				i = glsl.find('\n', i);
+				if (std::string::npos == i)
+				{
+					i = glsl.size();
+				}
+			}
+			else if (('/' == c) && (i + 1 < glsl.size()) && ('*' == glsl[i + 1]))
+			{
+				size_t const end = glsl.find("*/", i + 2);
+				i = (std::string::npos == end) ? glsl.size() : end + 2;
+			}
+			else
+			{
+				line_start = false;
+
+				size_t const begin = i;
+				GLSLTokenType type;
+				if (IsIdentifierStart(c))
+				{
+					type = GTT_Identifier;
+					while ((i < glsl.size()) && IsIdentifierChar(glsl[i]))
+					{
+						++ i;
+					}
+				}
+				else if (std::isdigit(static_cast<unsigned char>(c))
+					|| (('.' == c) && (i + 1 < glsl.size()) && std::isdigit(static_cast<unsigned char>(glsl[i + 1]))))
+				{
+					type = GTT_Number;
+					bool const hex = ('0' == c) && (i + 1 < glsl.size()) && (('x' == glsl[i + 1]) || ('X' == glsl[i + 1]));
+					while (i < glsl.size())
+					{
+						char const n = glsl[i];
+						if (IsIdentifierChar(n) || ('.' == n)
+							|| (!hex && (('+' == n) || ('-' == n)) && (('e' == glsl[i - 1]) || ('E' == glsl[i - 1]))))
+						{
+							++ i;
+						}
+						else
+						{
+							break;
+						}
+					}
+				}
+				else
+				{
+					type = GTT_Punctuator;
+					++ i;
+					for (auto const * punctuator : multi_char_punctuators)
+					{
+						size_t const len = std::strlen(punctuator);
+						if (0 == glsl.compare(begin, len, punctuator))
+						{
+							i = begin + len;
+							break;
+						}
+					}
+				}
+
+				GLSLToken token = { type, glsl.substr(begin, i - begin), false };
+				tokens.push_back(token);
+			}
+		}
+
+		// A { right after ) opens a function body, the other global ones are blocks and structs
+		int depth = 0;
+		bool in_function = false;
+		for (size_t i = 0; i < tokens.size(); ++ i)
+		{
+			if ("{" == tokens[i].text)
+			{
+				if ((0 == depth) && (i > 0) && (")" == tokens[i - 1].text))
+				{
+					in_function = true;
+				}
+				++ depth;
+			}
+			tokens[i].in_function = in_function;
+			if ("}" == tokens[i].text)
+			{
+				-- depth;
+				if (0 == depth)
+				{
+					in_function = false;
+				}
+			}
+		}
+
+		return tokens;
+	}
+
+	// Index of the matching bracket of every ( and [, and the other way round
+	std::vector<size_t> MatchBrackets(std::vector<GLSLToken> const & tokens)
+	{
+		std::vector<size_t> match(tokens.size(), tokens.size());
+		std::vector<size_t> open;
+		for (size_t i = 0; i < tokens.size(); ++ i)
+		{
+			std::string const & text = tokens[i].text;
+			if (GTT_Punctuator == tokens[i].type)
+			{
+				if (("(" == text) || ("[" == text))
+				{
+					open.push_back(i);
+				}
+				else if (((")" == text) || ("]" == text)) && !open.empty())
+				{
+					match[open.back()] = i;
+					match[i] = open.back();
+					open.pop_back();
+				}
+			}
+		}
+		return match;
+	}
+
+	// Name, number, call or parenthesized expression followed by any number of .field and [index], which binds
+	// tighter than every operator around it
+	bool IsPostfixExpression(std::vector<GLSLToken> const & tokens, std::vector<size_t> const & match, size_t begin, size_t end)
+	{
+		size_t i = begin;
+		if (i >= end)
+		{
+			return false;
+		}
+		if (GTT_Identifier == tokens[i].type)
+		{
+			++ i;
+			if ((i < end) && ("(" == tokens[i].text))
+			{
+				i = match[i] + 1;
+			}
+		}
+		else if (GTT_Number == tokens[i].type)
+		{
+			++ i;
+		}
+		else if ("(" == tokens[i].text)
+		{
+			i = match[i] + 1;
+		}
+		else
+		{
+			return false;
+		}
+
+		while (i < end)
+		{
+			if (("." == tokens[i].text) && (i + 1 < end) && (GTT_Identifier == tokens[i + 1].type))
+			{
+				i += 2;
+			}
+			else if ("[" == tokens[i].text)
+			{
+				i = match[i] + 1;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return i == end;
+	}
+
+	bool HasTopLevelComma(std::vector<GLSLToken> const & tokens, std::vector<size_t> const & match, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++ i)
+		{
+			if (("(" == tokens[i].text) || ("[" == tokens[i].text))
+			{
+				i = match[i];
+			}
+			else if ("," == tokens[i].text)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// One pass over the parentheses, false when there was nothing left to remove
+	bool RemoveRedundantParentheses(std::vector<GLSLToken>& tokens, std::set<std::string> const & structs)
+	{
+		std::vector<size_t> const match = MatchBrackets(tokens);
+		std::vector<bool> removed(tokens.size(), false);
+		bool changed = false;
+		for (size_t i = 0; i < tokens.size(); ++ i)
+		{
+			if (("(" != tokens[i].text) || removed[i] || (match[i] == tokens.size()))
+			{
+				continue;
+			}
+			size_t const j = match[i];
+			if (((i > 0) && removed[i - 1]) || ((j + 1 < tokens.size()) && removed[j + 1]))
+			{
+				// Its surroundings changed, left to the next pass
+				continue;
+			}
+
+			bool const call = (i > 0) && (((GTT_Identifier == tokens[i - 1].type) && ("return" != tokens[i - 1].text))
+				|| (GTT_Number == tokens[i - 1].type) || (")" == tokens[i - 1].text) || ("]" == tokens[i - 1].text));
+			if (call && (i > 0) && (i + 3 < j) && IsTypeName(tokens[i - 1].text, structs) && (tokens[i + 1].text == tokens[i - 1].text)
+				&& ("(" == tokens[i + 2].text) && (match[i + 2] == j - 1))
+			{
+				// T(T(x)) -> T(x)
+				removed[i - 1] = true;
+				removed[i] = true;
+				removed[j] = true;
+				changed = true;
+			}
+			else if (!call && IsPostfixExpression(tokens, match, i + 1, j))
+			{
+				// (a.x) -> a.x
+				removed[i] = true;
+				removed[j] = true;
+				changed = true;
+			}
+			else if (!call && (i > 0) && (j + 1 < tokens.size()) && !HasTopLevelComma(tokens, match, i + 1, j)
+				&& (((("[" == tokens[i - 1].text) || ("(" == tokens[i - 1].text) || ("," == tokens[i - 1].text))
+						&& (("]" == tokens[j + 1].text) || (")" == tokens[j + 1].text) || ("," == tokens[j + 1].text)))
+					|| ((("=" == tokens[i - 1].text) || ("return" == tokens[i - 1].text)) && (";" == tokens[j + 1].text))))
+			{
+				// a[(b + c)] -> a[b + c], the whole index, argument or right hand side
+				removed[i] = true;
+				removed[j] = true;
+				changed = true;
+			}
+			else if ((i + 1 < j) && ("(" == tokens[i + 1].text) && (match[i + 1] == j - 1)
+				&& !HasTopLevelComma(tokens, match, i + 2, j - 1))
+			{
+				// ((a + b)) -> (a + b)
+				removed[i + 1] = true;
+				removed[j - 1] = true;
+				changed = true;
+			}
+		}
+
+		if (changed)
+		{
+			size_t k = 0;
+			for (size_t i = 0; i < tokens.size(); ++ i)
+			{
+				if (!removed[i])
+				{
+					tokens[k] = tokens[i];
+					++ k;
+				}
+			}
+			tokens.resize(k);
+		}
+		return changed;
+	}
+
+	// 2.500000 -> 2.5, 0.500000 -> .5, 1.000000 -> 1.
+	void TrimFloatLiteral(std::string& number)
+	{
+		size_t const dot = number.find('.');
+		if ((std::string::npos == dot) || (number.find_first_not_of("0123456789.") != std::string::npos))
+		{
+			return;
+		}
+
+		size_t last = number.size();
+		while ((last > dot + 1) && ('0' == number[last - 1]))
+		{
+			-- last;
+		}
+		number.resize(last);
+		if ((1 == dot) && ('0' == number[0]) && (number.size() > 2))
+		{
+			number.erase(0, 1);
+		}
+	}
+
+	std::string ShortName(uint32_t index)
+	{
+		static char const first_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		static char const other_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+		uint32_t const num_first_chars = sizeof(first_chars) - 1;
+		uint32_t const num_other_chars = sizeof(other_chars) - 1;
+
+		std::string name(1, first_chars[index % num_first_chars]);
+		index /= num_first_chars;
+		while (index > 0)
+		{
+			-- index;
+			name += other_chars[index % num_other_chars];
+			index /= num_other_chars;
+		}
+		return name;
+	}
+
+	bool NeedsSpace(GLSLToken const & prev, GLSLToken const & next)
+	{
+		char const last = prev.text.back();
+		char const first = next.text.front();
+		// Names and numbers running together, 1 .x and return .5
+		if ((IsIdentifierChar(last) && IsIdentifierChar(first))
+			|| ((GTT_Number == prev.type) && ('.' == first))
+			|| (IsIdentifierChar(last) && (GTT_Number == next.type)))
+		{
+			return true;
+		}
+
+		char const pair[] = { last, first, '\0' };
+		if ((0 == std::strcmp(pair, "//")) || (0 == std::strcmp(pair, "/*")))
+		{
+			return true;
+		}
+		for (auto const * punctuator : multi_char_punctuators)
+		{
+			if (0 == std::strncmp(punctuator, pair, 2))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+std::string MinifyGLSL(std::string const & glsl)
+{
+	std::vector<GLSLToken> tokens = Tokenize(glsl);
+
+	std::set<std::string> structs;
+	for (size_t i = 0; i + 1 < tokens.size(); ++ i)
+	{
+		if ("struct" == tokens[i].text)
+		{
+			structs.insert(tokens[i + 1].text);
+		}
+	}
+
+	// Every name in the shader, and the ones outside functions that have to stay
+	std::set<std::string> used_names;
+	std::set<std::string> global_names;
+	for (auto const & token : tokens)
+	{
+		if (GTT_Identifier == token.type)
+		{
+			used_names.insert(token.text);
+			if (!token.in_function)
+			{
+				global_names.insert(token.text);
+			}
+		}
+		else if (GTT_Preprocessor == token.type)
+		{
+			// Macros would replace a local named like them
+			for (size_t i = 0; i < token.text.size(); )
+			{
+				if (IsIdentifierStart(token.text[i]))
+				{
+					size_t const begin = i;
+					while ((i < token.text.size()) && IsIdentifierChar(token.text[i]))
+					{
+						++ i;
+					}
+					used_names.insert(token.text.substr(begin, i - begin));
+				}
+				else
+				{
+					++ i;
+				}
+			}
+		}
+	}
+	for (auto const * name : reserved_short_names)
+	{
+		used_names.insert(name);
+	}
+
+	// Locals are the "type name" declarations inside functions, the more often one is used the shorter its new name
+	std::map<std::string, uint32_t> local_uses;
+	for (size_t i = 0; i + 2 < tokens.size(); ++ i)
+	{
+		if (tokens[i].in_function && (GTT_Identifier == tokens[i].type) && IsTypeName(tokens[i].text, structs)
+			&& (GTT_Identifier == tokens[i + 1].type) && (global_names.find(tokens[i + 1].text) == global_names.end())
+			&& (0 != tokens[i + 1].text.compare(0, 3, "gl_")))
+		{
+			std::string const & next = tokens[i + 2].text;
+			if ((";" == next) || ("[" == next) || ("=" == next) || ("," == next))
+			{
+				local_uses[tokens[i + 1].text] = 0;
+			}
+		}
+	}
+	for (size_t i = 0; i < tokens.size(); ++ i)
+	{
+		if (tokens[i].in_function && (GTT_Identifier == tokens[i].type) && ((0 == i) || ("." != tokens[i - 1].text)))
+		{
+			auto iter = local_uses.find(tokens[i].text);
+			if (iter != local_uses.end())
+			{
+				++ iter->second;
+			}
+		}
+	}
+
+	std::vector<std::pair<uint32_t, std::string>> by_uses;
+	for (auto const & local : local_uses)
+	{
+		by_uses.push_back(std::make_pair(local.second, local.first));
+	}
+	std::stable_sort(by_uses.begin(), by_uses.end(),
+		[](std::pair<uint32_t, std::string> const & lhs, std::pair<uint32_t, std::string> const & rhs)
+		{
+			return lhs.first > rhs.first;
+		});
+
+	std::map<std::string, std::string> renames;
+	uint32_t next_name = 0;
+	for (auto const & local : by_uses)
+	{
+		while (used_names.find(ShortName(next_name)) != used_names.end())
+		{
+			++ next_name;
+		}
+
+		// Already as short, e.g. a loop counter i
+		std::string const name = ShortName(next_name);
+		if (name.size() < local.second.size())
+		{
+			renames[local.second] = name;
+			++ next_name;
+		}
+	}
+
+	for (size_t i = 0; i < tokens.size(); ++ i)
+	{
+		GLSLToken& token = tokens[i];
+		if (token.in_function && (GTT_Identifier == token.type) && ((0 == i) || ("." != tokens[i - 1].text)))
+		{
+			auto iter = renames.find(token.text);
+			if (iter != renames.end())
+			{
+				token.text = iter->second;
+			}
+		}
+		else if (GTT_Number == token.type)
+		{
+			TrimFloatLiteral(token.text);
+		}
+	}
+
+	while (RemoveRedundantParentheses(tokens, structs))
+	{
+	}
+
+	std::string minified;
+	minified.reserve(glsl.size() / 2);
+	GLSLToken const * prev = nullptr;
+	for (auto const & token : tokens)
+	{
+		if (GTT_Preprocessor == token.type)
+		{
+			if (!minified.empty() && (minified.back() != '\n'))
+			{
+				minified += '\n';
+			}
+			minified += token.text;
+			minified += '\n';
+			prev = nullptr;
+		}
+		else
+		{
+			if (prev && NeedsSpace(*prev, token))
+			{
+				minified += ' ';
+			}
+			minified += token.text;
+			prev = &token;
+		}
+	}
+	if (!minified.empty() && (minified.back() != '\n'))
+	{
+		minified += '\n';
+	}
+
+	return minified;
+}
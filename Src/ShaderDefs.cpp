@@ -135,217 +135,226 @@ namespace
 		"linear noperspective sample",
 	};
 
-	char const * shader_opcode_names[] =
+	// Indexed by ShaderOpcode
+	constexpr ShaderOpcodeDesc shader_opcode_descs[] =
 	{
-		"add",
-		"and",
-		"break",
-		"breakc",
-		"call",
-		"callc",
-		"case",
-		"continue",
-		"continuec",
-		"cut",
-		"default",
-		"deriv_rtx",
-		"deriv_rty",
-		"discard",
-		"div",
-		"dp2",
-		"dp3",
-		"dp4",
-		"else",
-		"emit",
-		"emitthencut",
-		"endif",
-		"endloop",
-		"endswitch",
-		"eq",
-		"exp",
-		"frc",
-		"ftoi",
-		"ftou",
-		"ge",
-		"iadd",
-		"if",
-		"ieq",
-		"ige",
-		"ilt",
-		"imad",
-		"imax",
-		"imin",
-		"imul",
-		"ine",
-		"ineg",
-		"ishl",
-		"ishr",
-		"itof",
-		"label",
-		"ld_indexable",
-		"ld_ms_indexable",
-		"log",
-		"loop",
-		"lt",
-		"mad",
-		"min",
-		"max",
-		"dcl_immediateConstantBuffer",
-		"mov",
-		"movc",
-		"mul",
-		"ne",
-		"nop",
-		"not",
-		"or",
-		"resinfo_indexable",
-		"ret",
-		"retc",
-		"round_ne",
-		"round_ni",
-		"round_pi",
-		"round_z",
-		"rsq",
-		"sample_indexable",
-		"sample_c_indexable",
-		"sample_c_lz_indexable",
-		"sample_l_indexable",
-		"sample_d_indexable",
-		"sample_b_indexable",
-		"sqrt",
-		"switch",
-		"sincos",
-		"udiv",
-		"ult",
-		"uge",
-		"umul",
-		"umad",
-		"umax",
-		"umin",
-		"ushr",
-		"utof",
-		"xor",
-		"dcl_resource",
-		"dcl_constantbuffer",
-		"dcl_sampler",
-		"dcl_index_range",
-		"dcl_outputtopology",
-		"dcl_inputprimitive",
-		"dcl_maxout",
-		"dcl_input",
-		"dcl_input_sgv",
-		"dcl_input_siv",
-		"dcl_input_ps",
-		"dcl_input_ps_sgv",
-		"dcl_input_ps_siv",
-		"dcl_output",
-		"dcl_output_sgv",
-		"dcl_output_siv",
-		"dcl_temps",
-		"dcl_indexableTemp",
-		"dcl_globalFlags",
-		"d3d10_count",
-		"lod",
-		"gather4_indexable",
-		"sample_pos",
-		"sampleinfo",
-		"d3d10_1_count",
-		"hs_decls",
-		"hs_control_point_phase",
-		"hs_fork_phase",
-		"hs_join_phase",
-		"emit_stream",
-		"cut_stream",
-		"emitthencut_stream",
-		"interface_call",
-		"bufinfo_indexable",
-		"deriv_rtx_coarse",
-		"deriv_rtx_fine",
-		"deriv_rty_coarse",
-		"deriv_rty_fine",
-		"gather4_c_indexable",
-		"gather4_po_indexable",
-		"gather4_po_c_indexable",
-		"rcp",
-		"f32tof16",
-		"f16tof32",
-		"uaddc",
-		"usubb",
-		"countbits",
-		"firstbit_hi",
-		"firstbit_lo",
-		"firstbit_shi",
-		"ubfe",
-		"ibfe",
-		"bfi",
-		"bfrev",
-		"swapc",
-		"dcl_stream",
-		"dcl_function_body",
-		"dcl_function_table",
-		"dcl_interface",
-		"dcl_input_control_point_count",
-		"dcl_output_control_point_count",
-		"dcl_tessellator_domain",
-		"dcl_tessellator_partitioning",
-		"dcl_tessellator_output_primitive",
-		"dcl_hs_max_tessfactor",
-		"dcl_hs_fork_phase_instance_count",
-		"dcl_hs_join_phase_instance_count",
-		"dcl_thread_group",
-		"dcl_uav_typed",
-		"dcl_unordered_access_view_raw",
-		"dcl_unordered_access_view_structured",
-		"dcl_thread_group_shared_memory_raw",
-		"dcl_thread_group_shared_memory_structured",
-		"dcl_resource_raw",
-		"dcl_resource_structured",
-		"ld_uav_typed",
-		"store_uav_typed",
-		"ld_raw",
-		"store_raw",
-		"ld_structured",
-		"store_structured",
-		"atomic_and",
-		"atomic_or",
-		"atomic_xor",
-		"atomic_cmp_store",
-		"atomic_iadd",
-		"atomic_imax",
-		"atomic_imin",
-		"atomic_umax",
-		"atomic_umin",
-		"imm_atomic_alloc",
-		"imm_atomic_consume",
-		"imm_atomic_iadd",
-		"imm_atomic_and",
-		"imm_atomic_or",
-		"imm_atomic_xor",
-		"imm_atomic_exch",
-		"imm_atomic_cmp_exch",
-		"imm_atomic_imax",
-		"imm_atomic_imin",
-		"imm_atomic_umax",
-		"imm_atomic_umin",
-		"sync",
-		"dadd",
-		"dmax",
-		"dmin",
-		"dmul",
-		"deq",
-		"dge",
-		"dlt",
-		"dne",
-		"dmov",
-		"dmovc",
-		"dtof",
-		"ftod",
-		"eval_snapped",
-		"eval_sample_index",
-		"eval_centroid",
-		"dcl_gsinstances",
+		{ SO_ADD, "add", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_AND, "and", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_BREAK, "break", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_BREAKC, "breakc", SIT_Int, SIT_Int, 1, 1, SOF_ControlFlow },
+		{ SO_CALL, "call", SIT_Int, SIT_Int, 1, 1, SOF_ControlFlow },
+		{ SO_CALLC, "callc", SIT_Int, SIT_Int, 1, 2, SOF_ControlFlow },
+		{ SO_CASE, "case", SIT_Int, SIT_Int, 1, 1, SOF_ControlFlow },
+		{ SO_CONTINUE, "continue", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_CONTINUEC, "continuec", SIT_Int, SIT_Int, 1, 1, SOF_ControlFlow },
+		{ SO_CUT, "cut", SIT_Float, SIT_Float, 1, 0, 0 },
+		{ SO_DEFAULT, "default", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_DERIV_RTX, "deriv_rtx", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DERIV_RTY, "deriv_rty", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DISCARD, "discard", SIT_Int, SIT_Int, 1, 1, 0 },
+		{ SO_DIV, "div", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_DP2, "dp2", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_DP3, "dp3", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_DP4, "dp4", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_ELSE, "else", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_EMIT, "emit", SIT_Float, SIT_Float, 0, 0, 0 },
+		{ SO_EMITTHENCUT, "emitthencut", SIT_Float, SIT_Float, 0, 0, 0 },
+		{ SO_ENDIF, "endif", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_ENDLOOP, "endloop", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_ENDSWITCH, "endswitch", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_EQ, "eq", SIT_Float, SIT_Int, 1, 3, 0 },
+		{ SO_EXP, "exp", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_FRC, "frc", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_FTOI, "ftoi", SIT_Float, SIT_Int, 1, 2, 0 },
+		{ SO_FTOU, "ftou", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_GE, "ge", SIT_Float, SIT_Int, 1, 3, 0 },
+		{ SO_IADD, "iadd", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_IF, "if", SIT_Int, SIT_Int, 1, 1, SOF_ControlFlow },
+		{ SO_IEQ, "ieq", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_IGE, "ige", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_ILT, "ilt", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_IMAD, "imad", SIT_Int, SIT_Int, 1, 4, 0 },
+		{ SO_IMAX, "imax", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_IMIN, "imin", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_IMUL, "imul", SIT_Int, SIT_Int, 2, 4, 0 },
+		{ SO_INE, "ine", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_INEG, "ineg", SIT_Int, SIT_Int, 1, 2, 0 },
+		{ SO_ISHL, "ishl", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_ISHR, "ishr", SIT_Int, SIT_Int, 1, 3, 0 },
+		{ SO_ITOF, "itof", SIT_Int, SIT_Float, 1, 2, 0 },
+		{ SO_LABEL, "label", SIT_Float, SIT_Float, 1, 1, SOF_ControlFlow },
+		{ SO_LD, "ld_indexable", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_LD_MS, "ld_ms_indexable", SIT_Float, SIT_Float, 1, 4, 0 },
+		{ SO_LOG, "log", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_LOOP, "loop", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_LT, "lt", SIT_Float, SIT_Int, 1, 3, 0 },
+		{ SO_MAD, "mad", SIT_Float, SIT_Float, 1, 4, 0 },
+		{ SO_MIN, "min", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_MAX, "max", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_IMMEDIATE_CONSTANT_BUFFER, "dcl_immediateConstantBuffer", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_MOV, "mov", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_MOVC, "movc", SIT_Float, SIT_Float, 1, 4, 0 },
+		{ SO_MUL, "mul", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_NE, "ne", SIT_Float, SIT_Int, 1, 3, 0 },
+		{ SO_NOP, "nop", SIT_Float, SIT_Float, 0, 0, 0 },
+		{ SO_NOT, "not", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_OR, "or", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_RESINFO, "resinfo_indexable", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_RET, "ret", SIT_Float, SIT_Float, 0, 0, SOF_ControlFlow },
+		{ SO_RETC, "retc", SIT_Int, SIT_Int, 1, 1, SOF_ControlFlow },
+		{ SO_ROUND_NE, "round_ne", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_ROUND_NI, "round_ni", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_ROUND_PI, "round_pi", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_ROUND_Z, "round_z", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_RSQ, "rsq", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_SAMPLE, "sample_indexable", SIT_Float, SIT_Float, 1, 4, SOF_Sample },
+		{ SO_SAMPLE_C, "sample_c_indexable", SIT_Float, SIT_Float, 1, 5, SOF_Sample },
+		{ SO_SAMPLE_C_LZ, "sample_c_lz_indexable", SIT_Float, SIT_Float, 1, 5, SOF_Sample },
+		{ SO_SAMPLE_L, "sample_l_indexable", SIT_Float, SIT_Float, 1, 5, SOF_Sample },
+		{ SO_SAMPLE_D, "sample_d_indexable", SIT_Float, SIT_Float, 1, 6, SOF_Sample },
+		{ SO_SAMPLE_B, "sample_b_indexable", SIT_Float, SIT_Float, 1, 5, SOF_Sample },
+		{ SO_SQRT, "sqrt", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_SWITCH, "switch", SIT_Float, SIT_Float, 1, 1, SOF_ControlFlow },
+		{ SO_SINCOS, "sincos", SIT_Float, SIT_Float, 2, 3, 0 },
+		{ SO_UDIV, "udiv", SIT_UInt, SIT_UInt, 2, 4, 0 },
+		{ SO_ULT, "ult", SIT_UInt, SIT_Int, 1, 3, 0 },
+		{ SO_UGE, "uge", SIT_UInt, SIT_Int, 1, 3, 0 },
+		{ SO_UMUL, "umul", SIT_UInt, SIT_UInt, 2, 4, 0 },
+		{ SO_UMAD, "umad", SIT_UInt, SIT_UInt, 1, 4, 0 },
+		{ SO_UMAX, "umax", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_UMIN, "umin", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_USHR, "ushr", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_UTOF, "utof", SIT_UInt, SIT_Float, 1, 2, 0 },
+		{ SO_XOR, "xor", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_DCL_RESOURCE, "dcl_resource", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_CONSTANT_BUFFER, "dcl_constantbuffer", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_SAMPLER, "dcl_sampler", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INDEX_RANGE, "dcl_index_range", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_GS_OUTPUT_PRIMITIVE_TOPOLOGY, "dcl_outputtopology", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_GS_INPUT_PRIMITIVE, "dcl_inputprimitive", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_MAX_OUTPUT_VERTEX_COUNT, "dcl_maxout", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT, "dcl_input", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT_SGV, "dcl_input_sgv", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT_SIV, "dcl_input_siv", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT_PS, "dcl_input_ps", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT_PS_SGV, "dcl_input_ps_sgv", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT_PS_SIV, "dcl_input_ps_siv", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_OUTPUT, "dcl_output", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_OUTPUT_SGV, "dcl_output_sgv", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_OUTPUT_SIV, "dcl_output_siv", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_TEMPS, "dcl_temps", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INDEXABLE_TEMP, "dcl_indexableTemp", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_GLOBAL_FLAGS, "dcl_globalFlags", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_SM10_COUNT, "d3d10_count", SIT_Float, SIT_Float, 1, 0, 0 },
+		{ SO_LOD, "lod", SIT_Float, SIT_Float, 1, 4, SOF_Sample },
+		{ SO_GATHER4, "gather4_indexable", SIT_Float, SIT_Float, 1, 4, SOF_Sample },
+		{ SO_SAMPLE_POS, "sample_pos", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_SAMPLE_INFO, "sampleinfo", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_SM10_1_COUNT, "d3d10_1_count", SIT_Float, SIT_Float, 1, 0, 0 },
+		{ SO_HS_DECLS, "hs_decls", SIT_Float, SIT_Float, 1, 0, SOF_HSPhase },
+		{ SO_HS_CONTROL_POINT_PHASE, "hs_control_point_phase", SIT_Float, SIT_Float, 1, 0, SOF_HSPhase },
+		{ SO_HS_FORK_PHASE, "hs_fork_phase", SIT_Float, SIT_Float, 1, 0, SOF_HSPhase },
+		{ SO_HS_JOIN_PHASE, "hs_join_phase", SIT_Float, SIT_Float, 1, 0, SOF_HSPhase },
+		{ SO_EMIT_STREAM, "emit_stream", SIT_Float, SIT_Float, 1, 1, 0 },
+		{ SO_CUT_STREAM, "cut_stream", SIT_Float, SIT_Float, 1, 1, 0 },
+		{ SO_EMITTHENCUT_STREAM, "emitthencut_stream", SIT_Float, SIT_Float, 1, 1, 0 },
+		{ SO_INTERFACE_CALL, "interface_call", SIT_Float, SIT_Float, 1, 1, SOF_ControlFlow },
+		{ SO_BUFINFO, "bufinfo_indexable", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DERIV_RTX_COARSE, "deriv_rtx_coarse", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DERIV_RTX_FINE, "deriv_rtx_fine", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DERIV_RTY_COARSE, "deriv_rty_coarse", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DERIV_RTY_FINE, "deriv_rty_fine", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_GATHER4_C, "gather4_c_indexable", SIT_Float, SIT_Float, 1, 5, SOF_Sample },
+		{ SO_GATHER4_PO, "gather4_po_indexable", SIT_Float, SIT_Float, 1, 5, SOF_Sample },
+		{ SO_GATHER4_PO_C, "gather4_po_c_indexable", SIT_Float, SIT_Float, 1, 6, SOF_Sample },
+		{ SO_RCP, "rcp", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_F32TOF16, "f32tof16", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_F16TOF32, "f16tof32", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_UADDC, "uaddc", SIT_UInt, SIT_UInt, 2, 4, 0 },
+		{ SO_USUBB, "usubb", SIT_UInt, SIT_UInt, 2, 4, 0 },
+		{ SO_COUNTBITS, "countbits", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_FIRSTBIT_HI, "firstbit_hi", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_FIRSTBIT_LO, "firstbit_lo", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_FIRSTBIT_SHI, "firstbit_shi", SIT_Int, SIT_Int, 1, 2, 0 },
+		{ SO_UBFE, "ubfe", SIT_UInt, SIT_UInt, 1, 4, 0 },
+		{ SO_IBFE, "ibfe", SIT_Int, SIT_Int, 1, 4, 0 },
+		{ SO_BFI, "bfi", SIT_UInt, SIT_UInt, 1, 5, 0 },
+		{ SO_BFREV, "bfrev", SIT_UInt, SIT_UInt, 1, 2, 0 },
+		{ SO_SWAPC, "swapc", SIT_Float, SIT_Float, 2, 5, 0 },
+		{ SO_DCL_STREAM, "dcl_stream", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_FUNCTION_BODY, "dcl_function_body", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_FUNCTION_TABLE, "dcl_function_table", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INTERFACE, "dcl_interface", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_INPUT_CONTROL_POINT_COUNT, "dcl_input_control_point_count", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_OUTPUT_CONTROL_POINT_COUNT, "dcl_output_control_point_count", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_TESS_DOMAIN, "dcl_tessellator_domain", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_TESS_PARTITIONING, "dcl_tessellator_partitioning", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_TESS_OUTPUT_PRIMITIVE, "dcl_tessellator_output_primitive", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_HS_MAX_TESSFACTOR, "dcl_hs_max_tessfactor", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_HS_FORK_PHASE_INSTANCE_COUNT, "dcl_hs_fork_phase_instance_count", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_HS_JOIN_PHASE_INSTANCE_COUNT, "dcl_hs_join_phase_instance_count", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_THREAD_GROUP, "dcl_thread_group", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_UNORDERED_ACCESS_VIEW_TYPED, "dcl_uav_typed", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_UNORDERED_ACCESS_VIEW_RAW, "dcl_unordered_access_view_raw", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED, "dcl_unordered_access_view_structured", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_THREAD_GROUP_SHARED_MEMORY_RAW, "dcl_thread_group_shared_memory_raw", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED, "dcl_thread_group_shared_memory_structured", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_RESOURCE_RAW, "dcl_resource_raw", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_DCL_RESOURCE_STRUCTURED, "dcl_resource_structured", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
+		{ SO_LD_UAV_TYPED, "ld_uav_typed", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_STORE_UAV_TYPED, "store_uav_typed", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_LD_RAW, "ld_raw", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_STORE_RAW, "store_raw", SIT_UInt, SIT_UInt, 1, 3, 0 },
+		{ SO_LD_STRUCTURED, "ld_structured", SIT_Float, SIT_Float, 1, 4, 0 },
+		{ SO_STORE_STRUCTURED, "store_structured", SIT_Float, SIT_Float, 1, 4, 0 },
+		{ SO_ATOMIC_AND, "atomic_and", SIT_UInt, SIT_UInt, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_OR, "atomic_or", SIT_UInt, SIT_UInt, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_XOR, "atomic_xor", SIT_UInt, SIT_UInt, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_CMP_STORE, "atomic_cmp_store", SIT_Float, SIT_Float, 1, 4, SOF_Atomic },
+		{ SO_ATOMIC_IADD, "atomic_iadd", SIT_Int, SIT_Int, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_IMAX, "atomic_imax", SIT_Int, SIT_Int, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_IMIN, "atomic_imin", SIT_Int, SIT_Int, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_UMAX, "atomic_umax", SIT_UInt, SIT_UInt, 1, 3, SOF_Atomic },
+		{ SO_ATOMIC_UMIN, "atomic_umin", SIT_UInt, SIT_UInt, 1, 3, SOF_Atomic },
+		{ SO_IMM_ATOMIC_ALLOC, "imm_atomic_alloc", SIT_Float, SIT_Float, 1, 2, SOF_Atomic },
+		{ SO_IMM_ATOMIC_CONSUME, "imm_atomic_consume", SIT_Float, SIT_Float, 1, 2, SOF_Atomic },
+		{ SO_IMM_ATOMIC_IADD, "imm_atomic_iadd", SIT_Int, SIT_Int, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_AND, "imm_atomic_and", SIT_UInt, SIT_UInt, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_OR, "imm_atomic_or", SIT_UInt, SIT_UInt, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_XOR, "imm_atomic_xor", SIT_UInt, SIT_UInt, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_EXCH, "imm_atomic_exch", SIT_Float, SIT_Float, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_CMP_EXCH, "imm_atomic_cmp_exch", SIT_Float, SIT_Float, 1, 5, SOF_Atomic },
+		{ SO_IMM_ATOMIC_IMAX, "imm_atomic_imax", SIT_Int, SIT_Int, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_IMIN, "imm_atomic_imin", SIT_Int, SIT_Int, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_UMAX, "imm_atomic_umax", SIT_UInt, SIT_UInt, 1, 4, SOF_Atomic },
+		{ SO_IMM_ATOMIC_UMIN, "imm_atomic_umin", SIT_UInt, SIT_UInt, 1, 4, SOF_Atomic },
+		{ SO_SYNC, "sync", SIT_Float, SIT_Float, 1, 0, 0 },
+		{ SO_DADD, "dadd", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DMAX, "dmax", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DMIN, "dmin", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DMUL, "dmul", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DEQ, "deq", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DGE, "dge", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DLT, "dlt", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DNE, "dne", SIT_Double, SIT_Double, 1, 3, 0 },
+		{ SO_DMOV, "dmov", SIT_Double, SIT_Double, 1, 2, 0 },
+		{ SO_DMOVC, "dmovc", SIT_Double, SIT_Double, 1, 4, 0 },
+		{ SO_DTOF, "dtof", SIT_Double, SIT_Float, 1, 2, 0 },
+		{ SO_FTOD, "ftod", SIT_Float, SIT_Double, 1, 2, 0 },
+		{ SO_EVAL_SNAPPED, "eval_snapped", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_EVAL_SAMPLE_INDEX, "eval_sample_index", SIT_Float, SIT_Float, 1, 3, 0 },
+		{ SO_EVAL_CENTROID, "eval_centroid", SIT_Float, SIT_Float, 1, 2, 0 },
+		{ SO_DCL_GS_INSTANCE_COUNT, "dcl_gsinstances", SIT_Float, SIT_Float, 1, 0, SOF_Declaration },
 	};
 
+	constexpr bool ShaderOpcodeDescsInOrder(uint32_t i)
+	{
+		return (i >= SO_COUNT) || ((shader_opcode_descs[i].opcode == i) && ShaderOpcodeDescsInOrder(i + 1));
+	}
+
+	static_assert(sizeof(shader_opcode_descs) / sizeof(shader_opcode_descs[0]) == SO_COUNT, "Every opcode needs an entry in shader_opcode_descs");
+	static_assert(ShaderOpcodeDescsInOrder(0), "shader_opcode_descs isn't in ShaderOpcode order");
+
 	char const * shader_system_value_names[] =
 	{
 		"undefined",
@@ -596,9 +605,15 @@ char const * ShaderInterpolationModeName(ShaderInterpolationMode v)
 	return shader_interpolation_mode_names[v];
 }
 
+ShaderOpcodeDesc const & ShaderOpcodeDescription(uint32_t opcode)
+{
+	assert(opcode < SO_COUNT);
+	return shader_opcode_descs[opcode];
+}
+
 char const * ShaderOpcodeName(ShaderOpcode v)
 {
-	return shader_opcode_names[v];
+	return shader_opcode_descs[v].name;
 }
 
 char const * ShaderSystemValueName(ShaderSystemValue v)
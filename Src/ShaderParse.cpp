@@ -83,61 +83,159 @@ namespace
 	{
 		return lh.var_desc.start_offset < rh.var_desc.start_offset;
 	}
+
+	// Forward reader over a run of little-endian tokens. The reads don't check bounds themselves: callers
+	// reserve what they are about to consume with Require(), once per instruction or operand.
+	class TokenCursor
+	{
+	public:
+		TokenCursor()
+			: cur_(nullptr), end_(nullptr)
+		{
+		}
+		TokenCursor(uint32_t const * begin, uint32_t const * end)
+			: cur_(begin), end_(end)
+		{
+		}
+
+		bool Require(uint64_t num_tokens) const
+		{
+			return static_cast<uint64_t>(end_ - cur_) >= num_tokens;
+		}
+
+		bool AtEnd() const
+		{
+			return cur_ == end_;
+		}
+
+		uint32_t const * Position() const
+		{
+			return cur_;
+		}
+
+		uint32_t Read32()
+		{
+			assert(cur_ < end_);
+			uint32_t cur_token = le2native(*cur_);
+			++ cur_;
+			return cur_token;
+		}
+
+		template <typename T>
+		void ReadToken(T* tok)
+		{
+			*reinterpret_cast<uint32_t*>(tok) = this->Read32();
+		}
+
+		uint64_t Read64()
+		{
+			uint32_t a = this->Read32();
+			uint32_t b = this->Read32();
+			return static_cast<uint64_t>(a) | (static_cast<uint64_t>(b) << 32);
+		}
+
+		void Skip(uint32_t toskip)
+		{
+			assert(this->Require(toskip));
+			cur_ += toskip;
+		}
+
+	private:
+		uint32_t const * cur_;
+		uint32_t const * end_;
+	};
+
+	// Pointer to size bytes at offset in the chunk body, or nullptr if they don't fit in the chunk
+	void const * ChunkData(DXBCChunkHeader const * chunk, uint32_t offset, uint64_t size)
+	{
+		uint32_t chunk_size = le2native(chunk->size);
+		if ((offset > chunk_size) || (size > chunk_size - offset))
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<char const *>(chunk + 1) + offset;
+	}
+
+	bool IsDeclaration(ShaderOpcode opcode)
+	{
+		return (ShaderOpcodeDescription(opcode).flags & SOF_Declaration) && (opcode != SO_IMMEDIATE_CONSTANT_BUFFER);
+	}
+
+	bool IsHSPhase(ShaderOpcode opcode)
+	{
+		return (ShaderOpcodeDescription(opcode).flags & SOF_HSPhase) != 0;
+	}
+
+	// Whether a full parse puts the opcode in ShaderProgram::insns. HS phase markers go in both lists.
+	bool IsInstruction(ShaderOpcode opcode)
+	{
+		return !IsDeclaration(opcode) && (opcode != SO_HS_DECLS) && (opcode != SO_IMMEDIATE_CONSTANT_BUFFER);
+	}
+
+	bool ChunkTokens(DXBCChunkHeader const * chunk, uint32_t offset, uint64_t num_tokens, TokenCursor& cursor)
+	{
+		if (offset & 3)
+		{
+			return false;
+		}
+		uint32_t const * tokens = static_cast<uint32_t const *>(ChunkData(chunk, offset, num_tokens * sizeof(uint32_t)));
+		if (!tokens)
+		{
+			return false;
+		}
+		cursor = TokenCursor(tokens, tokens + num_tokens);
+		return true;
+	}
+
+	// nullptr unless the string is terminated inside the chunk
+	char const * ChunkString(DXBCChunkHeader const * chunk, uint32_t offset)
+	{
+		uint32_t chunk_size = le2native(chunk->size);
+		if (offset >= chunk_size)
+		{
+			return nullptr;
+		}
+		char const * str = reinterpret_cast<char const *>(chunk + 1) + offset;
+		return memchr(str, '\0', chunk_size - offset) ? str : nullptr;
+	}
 }
 
 struct ShaderParser
 {
-	uint32_t const * tokens;//shader tokens
-	uint32_t const * tokens_end;
+	TokenCursor code;//shader tokens
 	DXBCChunkHeader const * resource_chunk;//resource definition and constant buffer chunk
 	DXBCChunkSignatureHeader const * input_signature;
 	DXBCChunkSignatureHeader const * output_signature;
 	DXBCChunkSignatureHeader const * patch_constant_signature;
 	std::shared_ptr<ShaderProgram> program;
+	ShaderParseMode mode;
+	ShaderParseResult& result;
 
-	ShaderParser(const DXBCContainer& dxbc, std::shared_ptr<ShaderProgram> const & program)
-		: program(program)
+	ShaderParser(const DXBCContainer& dxbc, std::shared_ptr<ShaderProgram> const & program, ShaderParseMode mode, ShaderParseResult& result)
+		: program(program), mode(mode), result(result)
 	{
 		resource_chunk = dxbc.resource_chunk;
 		input_signature = reinterpret_cast<DXBCChunkSignatureHeader const *>(dxbc.input_signature);
 		output_signature = reinterpret_cast<DXBCChunkSignatureHeader const *>(dxbc.output_signature);
 		patch_constant_signature = reinterpret_cast<DXBCChunkSignatureHeader const *>(dxbc.patch_constant_signature);
 		uint32_t size = le2native(dxbc.shader_chunk->size);
-		tokens = reinterpret_cast<uint32_t const *>(dxbc.shader_chunk + 1);
-		tokens_end = reinterpret_cast<uint32_t const *>(reinterpret_cast<char const *>(tokens) + size);
-	}
-
-	uint32_t Read32()
-	{
-		assert(tokens < tokens_end);
-		uint32_t cur_token = le2native(*tokens);
-		++ tokens; 
-		return cur_token;
-	}
-
-	template <typename T>
-	void ReadToken(T* tok)
-	{
-		*reinterpret_cast<uint32_t*>(tok) = this->Read32();
-	}
-
-	uint64_t Read64()
-	{
-		uint32_t a = this->Read32();
-		uint32_t b = this->Read32();
-		return static_cast<uint64_t>(a) | (static_cast<uint64_t>(b) << 32);
+		uint32_t const * tokens = reinterpret_cast<uint32_t const *>(dxbc.shader_chunk + 1);
+		code = TokenCursor(tokens, tokens + size / sizeof(uint32_t));
 	}
 
-	void Skip(uint32_t toskip)
+	static ShaderParseStatus ReadOp(TokenCursor& insn, ShaderOperand& op)
 	{
-		tokens += toskip;
-	}
+		if (!insn.Require(1))
+		{
+			return SPS_TruncatedInstruction;
+		}
 
-	void ReadOp(ShaderOperand& op)
-	{
 		TokenizedShaderOperand optok;
-		this->ReadToken(&optok);
-		assert(optok.op_type < SOT_COUNT);
+		insn.ReadToken(&optok);
+		if (optok.op_type >= SOT_COUNT)
+		{
+			return SPS_InvalidOperand;
+		}
 		op.swizzle[0] = 0;
 		op.swizzle[1] = 1;
 		op.swizzle[2] = 2;
@@ -175,22 +273,59 @@ struct ShaderParser
 				break;
 
 			default:
-				assert(false);
-				break;
+				return SPS_InvalidOperand;
 			}
 			break;
 
 		default:
-			assert_msg(false, "Unhandled operand component type");
-			break;
+			return SPS_InvalidOperand;
 		}
 		op.type = static_cast<ShaderOperandType>(optok.op_type);
 		op.num_indices = optok.num_indices;
 
+		uint32_t const reprs[] = { optok.index0_repr, optok.index1_repr, optok.index2_repr };
+
+		// Everything this operand needs except relative index operands, which check their own tokens
+		uint32_t num_tokens = optok.extended;
+		for (uint32_t i = 0; i < op.num_indices; ++ i)
+		{
+			switch (reprs[i])
+			{
+			case SOIP_IMM32:
+			case SOIP_IMM32_PLUS_RELATIVE:
+				num_tokens += 1;
+				break;
+
+			case SOIP_IMM64:
+			case SOIP_IMM64_PLUS_RELATIVE:
+				num_tokens += 2;
+				break;
+
+			case SOIP_RELATIVE:
+				break;
+
+			default:
+				return SPS_InvalidOperand;
+			}
+		}
+		if (SOT_IMMEDIATE32 == op.type)
+		{
+			num_tokens += op.comps;
+		}
+		else if (SOT_IMMEDIATE64 == op.type)
+		{
+			num_tokens += op.comps * 2;
+		}
+		if (!insn.Require(num_tokens))
+		{
+			return SPS_TruncatedInstruction;
+		}
+
 		if (optok.extended)
 		{
+			-- num_tokens;
 			TokenizedShaderOperandExtended optokext;
-			this->ReadToken(&optokext);
+			insn.ReadToken(&optokext);
 			if (0 == optokext.type)
 			{
 			}
@@ -198,412 +333,582 @@ struct ShaderParser
 			{
 				op.neg = optokext.neg;
 				op.abs = optokext.abs;
+				op.min_precision = static_cast<uint8_t>(optokext.min_precision);
 			}
 			else
 			{
-				assert_msg(false, "Unhandled extended operand token type");
+				return SPS_InvalidOperand;
 			}
 		}
 
 		for (uint32_t i = 0; i < op.num_indices; ++ i)
 		{
-			uint32_t repr;
-			if (0 == i)
-			{
-				repr = optok.index0_repr;
-			}
-			else if (1 == i)
-			{
-				repr = optok.index1_repr;
-			}
-			else if (2 == i)
-			{
-				repr = optok.index2_repr;
-			}
-			else
-			{
-				assert_msg(false, "Unhandled operand index representation");
-				repr = 0;
-			}
 			op.indices[i].disp = 0;
 			// TODO: is disp supposed to be signed here??
-			switch (repr)
+			switch (reprs[i])
 			{
 			case SOIP_IMM32:
-				op.indices[i].disp = static_cast<int32_t>(this->Read32());
+				op.indices[i].disp = static_cast<int32_t>(insn.Read32());
+				num_tokens -= 1;
 				break;
 
 			case SOIP_IMM64:
-				op.indices[i].disp = this->Read64();
+				op.indices[i].disp = insn.Read64();
+				num_tokens -= 2;
 				break;
 
 			case SOIP_RELATIVE:
 				op.indices[i].reg = std::make_shared<ShaderOperand>();
-				this->ReadOp(*op.indices[i].reg);
 				break;
 
 			case SOIP_IMM32_PLUS_RELATIVE:
-				op.indices[i].disp = static_cast<int32_t>(this->Read32());
+				op.indices[i].disp = static_cast<int32_t>(insn.Read32());
+				num_tokens -= 1;
 				op.indices[i].reg = std::make_shared<ShaderOperand>();
-				this->ReadOp(*op.indices[i].reg);
 				break;
 
 			case SOIP_IMM64_PLUS_RELATIVE:
-				op.indices[i].disp = this->Read64();
+				op.indices[i].disp = insn.Read64();
+				num_tokens -= 2;
 				op.indices[i].reg = std::make_shared<ShaderOperand>();
-				this->ReadOp(*op.indices[i].reg);
 				break;
 			}
+
+			if (op.indices[i].reg)
+			{
+				ShaderParseStatus status = ReadOp(insn, *op.indices[i].reg);
+				if (status != SPS_OK)
+				{
+					return status;
+				}
+				// The relative operand may have eaten into what was reserved above
+				if (!insn.Require(num_tokens))
+				{
+					return SPS_TruncatedInstruction;
+				}
+			}
 		}
 
 		if (SOT_IMMEDIATE32 == op.type)
 		{
 			for (uint32_t i = 0; i < op.comps; ++ i)
 			{
-				op.imm_values[i].i32 = this->Read32();
+				op.imm_values[i].i32 = insn.Read32();
 			}
 		}
 		else if (SOT_IMMEDIATE64 == op.type)
 		{
 			for (uint32_t i = 0; i < op.comps; ++ i)
 			{
-				op.imm_values[i].i64 = this->Read64();
+				op.imm_values[i].i64 = insn.Read64();
 			}
 		}
+
+		return SPS_OK;
 	}
 
-	void ParseShader()
+	ShaderParseStatus ParseShader()
 	{
-		this->ReadToken(&program->version);
+		if (!code.Require(2))
+		{
+			return this->Fail(SPS_InvalidLength);
+		}
 
-		uint32_t lentok = this->Read32();
-		tokens_end = tokens - 2 + lentok;
+		code.ReadToken(&program->version);
+
+		// The length includes the version and length tokens
+		uint32_t lentok = code.Read32();
+		if ((lentok < 2) || !code.Require(lentok - 2))
+		{
+			return this->Fail(SPS_InvalidLength);
+		}
+		code = TokenCursor(code.Position(), code.Position() + lentok - 2);
+		program->code = code.Position();
+		program->code_size = lentok - 2;
+
+		// Declarations precede the instructions except in hull shaders, where every phase has its own
+		ShaderParseMode skip_mode = mode;
+		if ((SPM_DeclarationsOnly == skip_mode) && (ST_HS == program->version.type))
+		{
+			skip_mode = SPM_Reflection;
+		}
 
 		uint32_t cur_gs_stream = 0;
 
-		while (tokens != tokens_end)
+		uint32_t insn_index = 0;
+		while (!code.AtEnd())
 		{
+			uint32_t const * insn_begin = code.Position();
 			TokenizedShaderInstruction insntok;
-			this->ReadToken(&insntok);
-			uint32_t const * insn_end = tokens - 1 + insntok.length;
+			code.ReadToken(&insntok);
 			ShaderOpcode opcode = insntok.opcode;
-			assert(opcode < SO_COUNT);
 
-			if (SO_IMMEDIATE_CONSTANT_BUFFER == opcode)
+			ShaderParseStatus status;
+			if (opcode >= SO_COUNT)
+			{
+				status = SPS_InvalidOpcode;
+			}
+			else if (SO_IMMEDIATE_CONSTANT_BUFFER == opcode)
+			{
+				status = this->ParseImmConstantBuffer();
+			}
+			else if ((0 == insntok.length) || !code.Require(insntok.length - 1))
+			{
+				status = SPS_InvalidLength;
+			}
+			else
+			{
+				// Every instruction and declaration is checked against the chunk once here, so decoding
+				// it only has to stay inside its own length.
+				TokenCursor insn(code.Position(), insn_begin + insntok.length);
+				code.Skip(insntok.length - 1);
+				if ((skip_mode != SPM_Full) && !IsDeclaration(opcode) && !IsHSPhase(opcode))
+				{
+					if (SPM_DeclarationsOnly == skip_mode)
+					{
+						break;
+					}
+					if (SPM_InstructionOffsets == skip_mode)
+					{
+						program->insn_offsets.push_back(static_cast<uint32_t>(insn_begin - program->code));
+					}
+					status = SPS_OK;
+				}
+				else
+				{
+					status = this->ParseInstruction(insntok, insn, insn_begin, cur_gs_stream);
+				}
+			}
+
+			bool const is_insn = (opcode < SO_COUNT) && IsInstruction(opcode);
+			if (status != SPS_OK)
+			{
+				result.status = status;
+				result.insn_index = is_insn ? insn_index : static_cast<uint32_t>(-1);
+				result.opcode = opcode;
+				return status;
+			}
+			if (is_insn)
 			{
-				// immediate constant buffer data
-				uint32_t customlen = this->Read32() - 2;
+				++ insn_index;
+			}
+		}
 
-				std::shared_ptr<ShaderDecl> dcl = std::make_shared<ShaderDecl>();
-				program->dcls.push_back(dcl);
+		return SPS_OK;
+	}
 
-				dcl->opcode = SO_IMMEDIATE_CONSTANT_BUFFER;
-				dcl->num = customlen;
-				dcl->data.resize(customlen * sizeof(tokens[0]));
+	ShaderParseStatus ParseImmConstantBuffer()
+	{
+		// immediate constant buffer data, the length includes the opcode and length tokens
+		if (!code.Require(1))
+		{
+			return SPS_InvalidLength;
+		}
+		uint32_t customlen = code.Read32();
+		if ((customlen < 2) || !code.Require(customlen - 2))
+		{
+			return SPS_InvalidLength;
+		}
+		customlen -= 2;
 
-				memcpy(&dcl->data[0], &tokens[0], customlen * sizeof(tokens[0]));
+		std::shared_ptr<ShaderDecl> dcl = std::make_shared<ShaderDecl>();
+		program->dcls.push_back(dcl);
 
-				this->Skip(customlen);
-				continue;
-			}
+		dcl->opcode = SO_IMMEDIATE_CONSTANT_BUFFER;
+		dcl->num = customlen;
+		dcl->data.resize(customlen * sizeof(uint32_t));
 
-			if ((SO_HS_FORK_PHASE == opcode) || (SO_HS_JOIN_PHASE == opcode) || (SO_HS_CONTROL_POINT_PHASE == opcode) || (SO_HS_DECLS == opcode ))
+		if (customlen > 0)
+		{
+			memcpy(&dcl->data[0], code.Position(), customlen * sizeof(uint32_t));
+		}
+
+		code.Skip(customlen);
+		return SPS_OK;
+	}
+
+	ShaderParseStatus ParseInstruction(TokenizedShaderInstruction const & insntok, TokenCursor& insn, uint32_t const * insn_begin,
+		uint32_t& cur_gs_stream)
+	{
+		ShaderOpcode opcode = insntok.opcode;
+		ShaderParseStatus status = SPS_OK;
+
+		if (IsHSPhase(opcode))
+		{
+			// need to interleave these with the declarations or we cannot
+			// assign fork/join phase instance counts to phases
+			std::shared_ptr<ShaderDecl> dcl = std::make_shared<ShaderDecl>();
+			program->dcls.push_back(dcl);
+			dcl->opcode = opcode;
+		}
+
+		if (IsDeclaration(opcode))
+		{
+			std::shared_ptr<ShaderDecl> dcl = std::make_shared<ShaderDecl>();
+			program->dcls.push_back(dcl);
+			reinterpret_cast<TokenizedShaderInstruction&>(*dcl) = insntok;
+
+			TokenizedShaderInstructionExtended exttok;
+			memcpy(&exttok, &insntok, sizeof(exttok));
+			while (exttok.extended)
 			{
-				// need to interleave these with the declarations or we cannot
-				// assign fork/join phase instance counts to phases
-				std::shared_ptr<ShaderDecl> dcl = std::make_shared<ShaderDecl>();
-				program->dcls.push_back(dcl);
-				dcl->opcode = opcode;
+				if (!insn.Require(1))
+				{
+					return SPS_TruncatedInstruction;
+				}
+				insn.ReadToken(&exttok);
 			}
 
-			if (((opcode >= SO_DCL_RESOURCE) && (opcode <= SO_DCL_GLOBAL_FLAGS))
-				|| ((opcode >= SO_DCL_STREAM) && (opcode <= SO_DCL_RESOURCE_STRUCTURED))
-				|| (SO_DCL_GS_INSTANCE_COUNT == opcode))
+#define READ_OP_ANY dcl->op = std::make_shared<ShaderOperand>(); status = this->ReadOp(insn, *dcl->op); if (status != SPS_OK) { return status; }
+#define READ_OP(FILE) READ_OP_ANY
+			//check(dcl->op->file == SOT_##FILE);
+#define REQUIRE_TOKENS(n) if (!insn.Require(n)) { return SPS_TruncatedInstruction; }
+
+			switch (opcode)
 			{
-				std::shared_ptr<ShaderDecl> dcl = std::make_shared<ShaderDecl>();
-				program->dcls.push_back(dcl);
-				reinterpret_cast<TokenizedShaderInstruction&>(*dcl) = insntok;
+			case SO_DCL_GLOBAL_FLAGS:
+				break;
+
+			case SO_DCL_RESOURCE:
+				READ_OP(RESOURCE);
+				REQUIRE_TOKENS(1);
+				insn.ReadToken(&dcl->rrt);
+				break;
+
+			case SO_DCL_SAMPLER:
+				READ_OP(SAMPLER);
+				break;
+
+			case SO_DCL_INPUT:
+			case SO_DCL_INPUT_PS:
+				READ_OP(INPUT);
+				break;
+
+			case SO_DCL_INPUT_SIV:
+			case SO_DCL_INPUT_SGV:
+			case SO_DCL_INPUT_PS_SIV:
+			case SO_DCL_INPUT_PS_SGV:
+				READ_OP(INPUT);
+				REQUIRE_TOKENS(1);
+				dcl->sv = static_cast<ShaderSystemValue>(static_cast<uint16_t>(insn.Read32()));
+				break;
+
+			case SO_DCL_OUTPUT:
+				READ_OP(OUTPUT);
+				break;
 
-				TokenizedShaderInstructionExtended exttok;
-				memcpy(&exttok, &insntok, sizeof(exttok));
-				while(exttok.extended)
+			case SO_DCL_OUTPUT_SIV:
+			case SO_DCL_OUTPUT_SGV:
+				READ_OP(OUTPUT);
+				REQUIRE_TOKENS(1);
+				dcl->sv = static_cast<ShaderSystemValue>(static_cast<uint16_t>(insn.Read32()));
+				break;
+
+			case SO_DCL_INDEX_RANGE:
+				READ_OP_ANY;
+				if ((dcl->op->type != SOT_INPUT) && (dcl->op->type != SOT_OUTPUT))
 				{
-					this->ReadToken(&exttok);
+					return SPS_InvalidOperand;
 				}
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				break;
 
-#define READ_OP_ANY dcl->op = std::make_shared<ShaderOperand>(); this->ReadOp(*dcl->op);
-#define READ_OP(FILE) READ_OP_ANY
-				//check(dcl->op->file == SOT_##FILE);
+			case SO_DCL_TEMPS:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				break;
 
-				switch (opcode)
-				{
-				case SO_DCL_GLOBAL_FLAGS:
-					break;
-
-				case SO_DCL_RESOURCE:
-					READ_OP(RESOURCE);
-					this->ReadToken(&dcl->rrt);
-					break;
-
-				case SO_DCL_SAMPLER:
-					READ_OP(SAMPLER);
-					break;
-
-				case SO_DCL_INPUT:
-				case SO_DCL_INPUT_PS:
-					READ_OP(INPUT);
-					break;
-
-				case SO_DCL_INPUT_SIV:
-				case SO_DCL_INPUT_SGV:
-				case SO_DCL_INPUT_PS_SIV:
-				case SO_DCL_INPUT_PS_SGV:
-					READ_OP(INPUT);
-					dcl->sv = static_cast<ShaderSystemValue>(static_cast<uint16_t>(this->Read32()));
-					break;
-
-				case SO_DCL_OUTPUT:
-					READ_OP(OUTPUT);
-					break;
-
-				case SO_DCL_OUTPUT_SIV:
-				case SO_DCL_OUTPUT_SGV:
-					READ_OP(OUTPUT);
-					dcl->sv = static_cast<ShaderSystemValue>(static_cast<uint16_t>(this->Read32()));
-					break;
-
-				case SO_DCL_INDEX_RANGE:
-					READ_OP_ANY;
-					assert((SOT_INPUT == dcl->op->type) || (SOT_OUTPUT == dcl->op->type));
-					dcl->num = this->Read32();
-					break;
-
-				case SO_DCL_TEMPS:
-					dcl->num = this->Read32();
-					break;
-
-				case SO_DCL_INDEXABLE_TEMP:
-					dcl->op = std::make_shared<ShaderOperand>();
-					dcl->op->indices[0].disp = this->Read32();
-					dcl->indexable_temp.num = this->Read32();
-					dcl->indexable_temp.comps = this->Read32();
-					break;
-
-				case SO_DCL_CONSTANT_BUFFER:
-					READ_OP(CONSTANT_BUFFER);
-					break;
-
-				case SO_DCL_GS_INPUT_PRIMITIVE:
-					program->gs_input_primitive = dcl->dcl_gs_input_primitive.primitive;
-					break;
-
-				case SO_DCL_GS_OUTPUT_PRIMITIVE_TOPOLOGY:
-					program->gs_output_topology[cur_gs_stream]
-						= dcl->dcl_gs_output_primitive_topology.primitive_topology;
-					break;
-
-				case SO_DCL_MAX_OUTPUT_VERTEX_COUNT:
-					dcl->num = this->Read32();
-					program->max_gs_output_vertex = dcl->num;
-					break;
-
-				case SO_DCL_GS_INSTANCE_COUNT:
-					dcl->num = this->Read32();
-					program->gs_instance_count = dcl->num;
-					break;
-				
-				case SO_DCL_TESS_OUTPUT_PRIMITIVE:
-					program->ds_tessellator_output_primitive
-						= static_cast<ShaderTessellatorOutputPrimitive>(dcl->dcl_tess_output_primitive.primitive & 0x7);
-					break;
-
-				case SO_DCL_TESS_PARTITIONING:
-					program->ds_tessellator_partitioning
-						= static_cast<ShaderTessellatorPartitioning>(dcl->dcl_tess_partitioning.partitioning & 0x7);
-					break;
-
-				case SO_DCL_TESS_DOMAIN:
-					program->ds_tessellator_domain = static_cast<ShaderTessellatorDomain>(dcl->dcl_tess_domain.domain & 0x7);
-					break;
-
-				case SO_DCL_OUTPUT_CONTROL_POINT_COUNT:
-					program->hs_output_control_point_count = dcl->dcl_output_control_point_count.control_points;
-					break;
-
-				case SO_DCL_INPUT_CONTROL_POINT_COUNT:
-					program->hs_input_control_point_count = dcl->dcl_input_control_point_count.control_points;
-					break;
-
-				case SO_DCL_HS_MAX_TESSFACTOR:
-					dcl->num = this->Read32();
-					break;
-
-				case SO_DCL_HS_FORK_PHASE_INSTANCE_COUNT:
-					dcl->num = this->Read32();
-					break;
-
-				case SO_DCL_FUNCTION_BODY:
-					dcl->num = this->Read32();
-					break;
-
-				case SO_DCL_FUNCTION_TABLE:
-					dcl->num = this->Read32();
-					dcl->data.resize(dcl->num * sizeof(uint32_t));
-					for (uint32_t i = 0; i < dcl->num; ++ i)
-					{
-						(reinterpret_cast<uint32_t*>(&dcl->data[0]))[i] = this->Read32();
-					}
-					break;
+			case SO_DCL_INDEXABLE_TEMP:
+				REQUIRE_TOKENS(3);
+				dcl->op = std::make_shared<ShaderOperand>();
+				dcl->op->indices[0].disp = insn.Read32();
+				dcl->indexable_temp.num = insn.Read32();
+				dcl->indexable_temp.comps = insn.Read32();
+				break;
 
-				case SO_DCL_INTERFACE:
-					dcl->intf.id = this->Read32();
-					dcl->intf.expected_function_table_length = this->Read32();
-					{
-						uint32_t v = this->Read32();
-						dcl->intf.table_length = v & 0xffff;
-						dcl->intf.array_length = v >> 16;
-					}
-					dcl->data.resize(dcl->intf.table_length * sizeof(uint32_t));
-					for (uint32_t i = 0; i < dcl->intf.table_length; ++ i)
-					{
-						(reinterpret_cast<uint32_t*>(&dcl->data[0]))[i] = this->Read32();
-					}
-					break;
-
-				case SO_DCL_THREAD_GROUP:
-					dcl->thread_group_size[0] = this->Read32();
-					dcl->thread_group_size[1] = this->Read32();
-					dcl->thread_group_size[2] = this->Read32();
-					program->cs_thread_group_size[0] = dcl->thread_group_size[0];
-					program->cs_thread_group_size[1] = dcl->thread_group_size[1];
-					program->cs_thread_group_size[2] = dcl->thread_group_size[2];
-					break;
-
-				case SO_DCL_UNORDERED_ACCESS_VIEW_TYPED:
-					READ_OP(UNORDERED_ACCESS_VIEW);
-					this->ReadToken(&dcl->rrt);
-					break;
-
-				case SO_DCL_UNORDERED_ACCESS_VIEW_RAW:
-					READ_OP(UNORDERED_ACCESS_VIEW);
-					break;
-
-				case SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED:
-					READ_OP(UNORDERED_ACCESS_VIEW);
-					dcl->structured.stride = this->Read32();
-					break;
-
-				case SO_DCL_THREAD_GROUP_SHARED_MEMORY_RAW:
-					READ_OP(THREAD_GROUP_SHARED_MEMORY);
-					dcl->num = this->Read32();
-					break;
-
-				case SO_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED:
-					READ_OP(THREAD_GROUP_SHARED_MEMORY);
-					dcl->structured.stride = this->Read32();
-					dcl->structured.count = this->Read32();
-					break;
-
-				case SO_DCL_RESOURCE_RAW:
-					READ_OP(RESOURCE);
-					break;
-
-				case SO_DCL_RESOURCE_STRUCTURED:
-					READ_OP(RESOURCE);
-					dcl->structured.stride = this->Read32();
-					break;
-
-				case SO_DCL_STREAM:
-					READ_OP(STREAM);
-					cur_gs_stream = static_cast<uint32_t>(dcl->op->indices[0].disp);
-					program->gs_output_topology.push_back(SPT_Undefined);
-					break;
-
-				default:
-					assert_msg(false, "Unhandled declaration");
-					break;
-				}
+			case SO_DCL_CONSTANT_BUFFER:
+				READ_OP(CONSTANT_BUFFER);
+				break;
 
-				assert(tokens == insn_end);
-			}
-			else
-			{
-				if (SO_HS_DECLS == opcode)
+			case SO_DCL_GS_INPUT_PRIMITIVE:
+				program->gs_input_primitive = dcl->dcl_gs_input_primitive.primitive;
+				break;
+
+			case SO_DCL_GS_OUTPUT_PRIMITIVE_TOPOLOGY:
+				// SM4 GS has no dcl_stream, the topology belongs to stream 0
+				if (cur_gs_stream >= program->gs_output_topology.size())
 				{
-					continue;
+					program->gs_output_topology.resize(cur_gs_stream + 1, SPT_Undefined);
 				}
-				std::shared_ptr<ShaderInstruction> insn = std::make_shared<ShaderInstruction>();
-				program->insns.push_back(insn);
-				reinterpret_cast<TokenizedShaderInstruction&>(*insn) = insntok;
+				program->gs_output_topology[cur_gs_stream]
+					= dcl->dcl_gs_output_primitive_topology.primitive_topology;
+				break;
+
+			case SO_DCL_MAX_OUTPUT_VERTEX_COUNT:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				program->max_gs_output_vertex = dcl->num;
+				break;
+
+			case SO_DCL_GS_INSTANCE_COUNT:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				program->gs_instance_count = dcl->num;
+				break;
 
-				TokenizedShaderInstructionExtended exttok;
-				memcpy(&exttok, &insntok, sizeof(exttok));
-				while (exttok.extended)
+			case SO_DCL_TESS_OUTPUT_PRIMITIVE:
+				program->ds_tessellator_output_primitive
+					= static_cast<ShaderTessellatorOutputPrimitive>(dcl->dcl_tess_output_primitive.primitive & 0x7);
+				break;
+
+			case SO_DCL_TESS_PARTITIONING:
+				program->ds_tessellator_partitioning
+					= static_cast<ShaderTessellatorPartitioning>(dcl->dcl_tess_partitioning.partitioning & 0x7);
+				break;
+
+			case SO_DCL_TESS_DOMAIN:
+				program->ds_tessellator_domain = static_cast<ShaderTessellatorDomain>(dcl->dcl_tess_domain.domain & 0x7);
+				break;
+
+			case SO_DCL_OUTPUT_CONTROL_POINT_COUNT:
+				program->hs_output_control_point_count = dcl->dcl_output_control_point_count.control_points;
+				break;
+
+			case SO_DCL_INPUT_CONTROL_POINT_COUNT:
+				program->hs_input_control_point_count = dcl->dcl_input_control_point_count.control_points;
+				break;
+
+			case SO_DCL_HS_MAX_TESSFACTOR:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				break;
+
+			case SO_DCL_HS_FORK_PHASE_INSTANCE_COUNT:
+			case SO_DCL_HS_JOIN_PHASE_INSTANCE_COUNT:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				break;
+
+			case SO_DCL_FUNCTION_BODY:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				break;
+
+			case SO_DCL_FUNCTION_TABLE:
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				REQUIRE_TOKENS(dcl->num);
+				dcl->data.resize(dcl->num * sizeof(uint32_t));
+				for (uint32_t i = 0; i < dcl->num; ++ i)
 				{
-					this->ReadToken(&exttok);
-					if (SEOP_SAMPLE_CONTROLS == exttok.type)
-					{
-						insn->sample_offset[0] = exttok.sample_controls.offset_u;
-						insn->sample_offset[1] = exttok.sample_controls.offset_v;
-						insn->sample_offset[2] = exttok.sample_controls.offset_w;
-					}
-					else if (SEOP_RESOURCE_DIM == exttok.type)
-					{
-						insn->resource_target = exttok.resource_target.target;
-					}
-					else if (SEOP_RESOURCE_RETURN_TYPE == exttok.type)
-					{
-						insn->resource_return_type[0] = exttok.resource_return_type.x;
-						insn->resource_return_type[1] = exttok.resource_return_type.y;
-						insn->resource_return_type[2] = exttok.resource_return_type.z;
-						insn->resource_return_type[3] = exttok.resource_return_type.w;
-					}
+					(reinterpret_cast<uint32_t*>(&dcl->data[0]))[i] = insn.Read32();
 				}
+				break;
 
-				switch (opcode)
+			case SO_DCL_INTERFACE:
+				REQUIRE_TOKENS(3);
+				dcl->intf.id = insn.Read32();
+				dcl->intf.expected_function_table_length = insn.Read32();
 				{
-				case SO_INTERFACE_CALL:
-					insn->num = this->Read32();
-					break;
-
-				default:
-					break;
+					uint32_t v = insn.Read32();
+					dcl->intf.table_length = v & 0xffff;
+					dcl->intf.array_length = v >> 16;
+				}
+				REQUIRE_TOKENS(dcl->intf.table_length);
+				dcl->data.resize(dcl->intf.table_length * sizeof(uint32_t));
+				for (uint32_t i = 0; i < dcl->intf.table_length; ++ i)
+				{
+					(reinterpret_cast<uint32_t*>(&dcl->data[0]))[i] = insn.Read32();
 				}
+				break;
+
+			case SO_DCL_THREAD_GROUP:
+				REQUIRE_TOKENS(3);
+				dcl->thread_group_size[0] = insn.Read32();
+				dcl->thread_group_size[1] = insn.Read32();
+				dcl->thread_group_size[2] = insn.Read32();
+				program->cs_thread_group_size[0] = dcl->thread_group_size[0];
+				program->cs_thread_group_size[1] = dcl->thread_group_size[1];
+				program->cs_thread_group_size[2] = dcl->thread_group_size[2];
+				break;
+
+			case SO_DCL_UNORDERED_ACCESS_VIEW_TYPED:
+				READ_OP(UNORDERED_ACCESS_VIEW);
+				REQUIRE_TOKENS(1);
+				insn.ReadToken(&dcl->rrt);
+				break;
+
+			case SO_DCL_UNORDERED_ACCESS_VIEW_RAW:
+				READ_OP(UNORDERED_ACCESS_VIEW);
+				break;
+
+			case SO_DCL_UNORDERED_ACCESS_VIEW_STRUCTURED:
+				READ_OP(UNORDERED_ACCESS_VIEW);
+				REQUIRE_TOKENS(1);
+				dcl->structured.stride = insn.Read32();
+				break;
+
+			case SO_DCL_THREAD_GROUP_SHARED_MEMORY_RAW:
+				READ_OP(THREAD_GROUP_SHARED_MEMORY);
+				REQUIRE_TOKENS(1);
+				dcl->num = insn.Read32();
+				break;
+
+			case SO_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED:
+				READ_OP(THREAD_GROUP_SHARED_MEMORY);
+				REQUIRE_TOKENS(2);
+				dcl->structured.stride = insn.Read32();
+				dcl->structured.count = insn.Read32();
+				break;
 
-				uint32_t op_num = 0;
-				while (tokens != insn_end)
+			case SO_DCL_RESOURCE_RAW:
+				READ_OP(RESOURCE);
+				break;
+
+			case SO_DCL_RESOURCE_STRUCTURED:
+				READ_OP(RESOURCE);
+				REQUIRE_TOKENS(1);
+				dcl->structured.stride = insn.Read32();
+				break;
+
+			case SO_DCL_STREAM:
+				READ_OP(STREAM);
+				cur_gs_stream = static_cast<uint32_t>(dcl->op->indices[0].disp);
+				if (cur_gs_stream >= SM_MAX_GS_STREAMS)
 				{
-					assert(tokens < insn_end);
-					assert(op_num < SM_MAX_OPS);
-					insn->ops[op_num] = std::make_shared<ShaderOperand>();
-					this->ReadOp(*insn->ops[op_num]);
-					++ op_num;
+					return SPS_InvalidOperand;
 				}
-				insn->num_ops = op_num;
+				if (cur_gs_stream >= program->gs_output_topology.size())
+				{
+					program->gs_output_topology.resize(cur_gs_stream + 1, SPT_Undefined);
+				}
+				break;
+
+			default:
+				return SPS_InvalidOpcode;
 			}
 		}
+		else
+		{
+			if ((SO_HS_DECLS == opcode) || (SPM_Reflection == mode) || (SPM_DeclarationsOnly == mode))
+			{
+				return SPS_OK;
+			}
+			if (SPM_InstructionOffsets == mode)
+			{
+				// Phase markers are instructions too, keep the indices the same as a full parse
+				program->insn_offsets.push_back(static_cast<uint32_t>(insn_begin - program->code));
+				return SPS_OK;
+			}
+
+			std::shared_ptr<ShaderInstruction> insn_ptr = std::make_shared<ShaderInstruction>();
+			program->insns.push_back(insn_ptr);
+			status = DecodeInstruction(insntok, insn, *insn_ptr);
+		}
+
+		return status;
 	}
 
-	char const * Parse()
+	static ShaderParseStatus DecodeInstruction(TokenizedShaderInstruction const & insntok, TokenCursor& insn, ShaderInstruction& out)
 	{
-		this->ParseShader();
-		
+		reinterpret_cast<TokenizedShaderInstruction&>(out) = insntok;
+
+		TokenizedShaderInstructionExtended exttok;
+		memcpy(&exttok, &insntok, sizeof(exttok));
+		while (exttok.extended)
+		{
+			if (!insn.Require(1))
+			{
+				return SPS_TruncatedInstruction;
+			}
+			insn.ReadToken(&exttok);
+			if (SEOP_SAMPLE_CONTROLS == exttok.type)
+			{
+				out.sample_offset[0] = exttok.sample_controls.offset_u;
+				out.sample_offset[1] = exttok.sample_controls.offset_v;
+				out.sample_offset[2] = exttok.sample_controls.offset_w;
+			}
+			else if (SEOP_RESOURCE_DIM == exttok.type)
+			{
+				out.resource_target = exttok.resource_target.target;
+			}
+			else if (SEOP_RESOURCE_RETURN_TYPE == exttok.type)
+			{
+				out.resource_return_type[0] = exttok.resource_return_type.x;
+				out.resource_return_type[1] = exttok.resource_return_type.y;
+				out.resource_return_type[2] = exttok.resource_return_type.z;
+				out.resource_return_type[3] = exttok.resource_return_type.w;
+			}
+		}
+
+		switch (insntok.opcode)
+		{
+		case SO_INTERFACE_CALL:
+			REQUIRE_TOKENS(1);
+			out.num = insn.Read32();
+			break;
+
+		default:
+			break;
+		}
+
+		uint32_t op_num = 0;
+		while (!insn.AtEnd())
+		{
+			if (op_num >= SM_MAX_OPS)
+			{
+				return SPS_TooManyOperands;
+			}
+			out.ops[op_num] = std::make_shared<ShaderOperand>();
+			ShaderParseStatus status = ReadOp(insn, *out.ops[op_num]);
+			if (status != SPS_OK)
+			{
+				return status;
+			}
+			++ op_num;
+		}
+		out.num_ops = op_num;
+		if (op_num < ShaderOpcodeDescription(insntok.opcode).num_operands)
+		{
+			return SPS_MissingOperands;
+		}
+
+		return SPS_OK;
+	}
+
+	ShaderParseStatus Parse()
+	{
+		ShaderParseStatus status = this->ParseShader();
+		if (status != SPS_OK)
+		{
+			return status;
+		}
+
 		if (resource_chunk)
 		{
-			this->ParseCBAndResourceBinding();
+			status = this->ParseCBAndResourceBinding();
+			if (status != SPS_OK)
+			{
+				return this->Fail(status);
+			}
 			this->SortCBVars();
 		}
-		
+
 		if (input_signature)
 		{
 			if (FOURCC_ISG1 == input_signature->fourcc)
 			{
-				this->ParseSignature(input_signature, FOURCC_ISG1);
+				status = this->ParseSignature(input_signature, FOURCC_ISG1);
 			}
 			else
 			{
 				assert(FOURCC_ISGN == input_signature->fourcc);
-				this->ParseSignature(input_signature, FOURCC_ISGN);
+				status = this->ParseSignature(input_signature, FOURCC_ISGN);
+			}
+			if (status != SPS_OK)
+			{
+				return this->Fail(status);
 			}
 		}
 
@@ -611,154 +916,238 @@ struct ShaderParser
 		{
 			if (FOURCC_OSG1 == output_signature->fourcc)
 			{
-				this->ParseSignature(output_signature, FOURCC_OSG1);
+				status = this->ParseSignature(output_signature, FOURCC_OSG1);
 			}
 			else if (FOURCC_OSG5 == output_signature->fourcc)
 			{
-				this->ParseSignature(output_signature, FOURCC_OSG5);
+				status = this->ParseSignature(output_signature, FOURCC_OSG5);
 			}
 			else
 			{
 				assert(FOURCC_OSGN == output_signature->fourcc);
-				this->ParseSignature(output_signature, FOURCC_OSGN);
+				status = this->ParseSignature(output_signature, FOURCC_OSGN);
+			}
+			if (status != SPS_OK)
+			{
+				return this->Fail(status);
 			}
 		}
 
 		if (patch_constant_signature)
 		{
-			this->ParseSignature(patch_constant_signature, FOURCC_PCSG);
+			status = this->ParseSignature(patch_constant_signature, FOURCC_PCSG);
+			if (status != SPS_OK)
+			{
+				return this->Fail(status);
+			}
+		}
+
+		return SPS_OK;
+	}
+
+	ShaderParseStatus Fail(ShaderParseStatus status)
+	{
+		result.status = status;
+		result.insn_index = static_cast<uint32_t>(-1);
+		result.opcode = 0;
+		return status;
+	}
+
+	// Reads a type and the type trees of its members. Member offsets come from the parent.
+	// num_types bounds the types read from the whole chunk, since members of a corrupt chunk may point back at their parents.
+	ShaderParseStatus ParseType(uint32_t type_offset, uint32_t depth, uint32_t& num_types, DXBCShaderTypeDesc& desc,
+		char const *& struct_name, std::vector<DXBCShaderTypeMember>& members) const
+	{
+		// Struct types can't nest deeper than this in any real shader
+		if ((depth > 16) || (0 == num_types))
+		{
+			return SPS_InvalidResourceChunk;
+		}
+		-- num_types;
+
+		// Shader model 5 appends 4 interface tokens and the type name
+		uint32_t const type_tokens = (program->version.major >= 5) ? 9 : 4;
+		TokenCursor type_token;
+		if (!ChunkTokens(resource_chunk, type_offset, type_tokens, type_token))
+		{
+			return SPS_InvalidResourceChunk;
+		}
+
+		uint32_t token = type_token.Read32();
+		uint32_t var_class = token & 0xFFFF;
+		uint32_t type = token >> 16;
+		if ((var_class > SVC_INTERFACE_POINTER) || (type > SVT_CONSUME_STRUCTURED_BUFFER))
+		{
+			return SPS_InvalidResourceChunk;
+		}
+		desc.var_class = static_cast<ShaderVariableClass>(var_class);
+		desc.type = static_cast<ShaderVariableType>(type);
+		token = type_token.Read32();
+		desc.rows = token & 0xFFFF;
+		desc.columns = token >> 16;
+		token = type_token.Read32();
+		desc.elements = token & 0xFFFF;
+		desc.members = token >> 16;
+		desc.offset = 0;
+		desc.name = ShaderVariableTypeName(desc.type);
+		uint32_t member_offset = type_token.Read32();
+
+		struct_name = nullptr;
+		if (program->version.major >= 5)
+		{
+			type_token.Skip(4);
+			uint32_t name_offset = type_token.Read32();
+			if (name_offset && (SVC_STRUCT == desc.var_class))
+			{
+				struct_name = ChunkString(resource_chunk, name_offset);
+			}
+		}
+
+		members.clear();
+		if ((desc.members > 0) && member_offset)
+		{
+			TokenCursor member_token;
+			if (!ChunkTokens(resource_chunk, member_offset, desc.members * 3ULL, member_token))
+			{
+				return SPS_InvalidResourceChunk;
+			}
+			members.resize(desc.members);
+			for (auto& member : members)
+			{
+				member.name = ChunkString(resource_chunk, member_token.Read32());
+				if (!member.name)
+				{
+					return SPS_InvalidResourceChunk;
+				}
+				uint32_t member_type_offset = member_token.Read32();
+				uint32_t offset = member_token.Read32();
+				ShaderParseStatus status = this->ParseType(member_type_offset, depth + 1, num_types, member.type_desc,
+					member.struct_name, member.members);
+				if (status != SPS_OK)
+				{
+					return status;
+				}
+				member.type_desc.offset = offset;
+			}
 		}
 
-		return nullptr;
+		return SPS_OK;
 	}
 
-	uint32_t ParseCBAndResourceBinding() const
+	ShaderParseStatus ParseCBAndResourceBinding() const
 	{
 		assert_msg(FOURCC_RDEF == resource_chunk->fourcc, "parameter chunk is not a resource chunk,parse_constant_buffer()");
 
-		uint32_t const * res_token = reinterpret_cast<uint32_t const *>(resource_chunk + 1);
-		uint32_t const * first_token = res_token;
-		uint32_t num_cb = le2native(*res_token);
-		++ res_token;
-		uint32_t cb_offset = le2native(*res_token);
-		++ res_token;
-
-		uint32_t num_resource_bindings = le2native(*res_token);
-		++ res_token;
-		uint32_t resource_binding_offset = le2native(*res_token);
-		++ res_token;
-		uint32_t shader_model = le2native(*res_token);
-		++ res_token;
+		TokenCursor res_token;
+		if (!ChunkTokens(resource_chunk, 0, 6, res_token))
+		{
+			return SPS_InvalidResourceChunk;
+		}
+		uint32_t num_cb = res_token.Read32();
+		uint32_t cb_offset = res_token.Read32();
+
+		uint32_t num_resource_bindings = res_token.Read32();
+		uint32_t resource_binding_offset = res_token.Read32();
+		uint32_t shader_model = res_token.Read32();
 		// TODO: check here, shader_model is unused.
 		unused(shader_model);
-		uint32_t compile_flags = le2native(*res_token);
-		++ res_token;
+		uint32_t compile_flags = res_token.Read32();
 		// TODO: check here, compile_flags is unused.
 		unused(compile_flags);
 
-		uint32_t const * resource_binding_tokens = reinterpret_cast<uint32_t const *>(reinterpret_cast<char const *>(first_token) + resource_binding_offset);
+		TokenCursor resource_binding_tokens;
+		if (!ChunkTokens(resource_chunk, resource_binding_offset, num_resource_bindings * 8ULL, resource_binding_tokens))
+		{
+			return SPS_InvalidResourceChunk;
+		}
 		program->resource_bindings.resize(num_resource_bindings);
 		for (uint32_t i = 0; i < num_resource_bindings; ++ i)
 		{
 			DXBCInputBindDesc& bind = program->resource_bindings[i];
-			uint32_t name_offset = le2native(*resource_binding_tokens);
-			++ resource_binding_tokens;
-			bind.name = reinterpret_cast<char const *>(first_token) + name_offset;
-			bind.type = le2native(static_cast<ShaderInputType>(*resource_binding_tokens));
-			++ resource_binding_tokens;
-			bind.return_type = le2native(static_cast<ShaderResourceReturnType>(*resource_binding_tokens));
-			++ resource_binding_tokens;
-			bind.dimension = le2native(static_cast<ShaderSRVDimension>(*resource_binding_tokens));
-			++ resource_binding_tokens;
-			bind.num_samples = le2native(*resource_binding_tokens);
-			++ resource_binding_tokens;
-			bind.bind_point = le2native(*resource_binding_tokens);
-			++ resource_binding_tokens;
-			bind.bind_count = le2native(*resource_binding_tokens);
-			++ resource_binding_tokens;
-			bind.flags = le2native(*resource_binding_tokens);
-			++ resource_binding_tokens;
-		}
-
-		uint32_t const * cb_tokens = reinterpret_cast<uint32_t const *>(reinterpret_cast<char const *>(first_token) + cb_offset);
+			bind.name = ChunkString(resource_chunk, resource_binding_tokens.Read32());
+			if (!bind.name)
+			{
+				return SPS_InvalidResourceChunk;
+			}
+			uint32_t type = resource_binding_tokens.Read32();
+			uint32_t return_type = resource_binding_tokens.Read32();
+			uint32_t dimension = resource_binding_tokens.Read32();
+			if ((type > SIT_UNDEFINED) || (return_type > SRRT_CONTINUED) || (dimension > SSD_BUFFEREX))
+			{
+				return SPS_InvalidResourceChunk;
+			}
+			bind.type = static_cast<ShaderInputType>(type);
+			bind.return_type = static_cast<ShaderResourceReturnType>(return_type);
+			bind.dimension = static_cast<ShaderSRVDimension>(dimension);
+			bind.num_samples = resource_binding_tokens.Read32();
+			bind.bind_point = resource_binding_tokens.Read32();
+			bind.bind_count = resource_binding_tokens.Read32();
+			bind.flags = resource_binding_tokens.Read32();
+		}
+
+		TokenCursor cb_tokens;
+		if (!ChunkTokens(resource_chunk, cb_offset, num_cb * 6ULL, cb_tokens))
+		{
+			return SPS_InvalidResourceChunk;
+		}
 		program->cbuffers.resize(num_cb);
 
+		uint32_t const var_tokens = (program->version.major >= 5) ? 10 : 6;
+		uint32_t num_types = 0x10000;
 		for (uint32_t i = 0; i < num_cb; ++ i)
 		{
 			DXBCConstantBuffer& cb = program->cbuffers[i];
-			uint32_t cb_name_offset = le2native(*cb_tokens);
-			++ cb_tokens;
-			uint32_t var_count = le2native(*cb_tokens);
-			++ cb_tokens;
-			uint32_t var_offset = le2native(*cb_tokens);
-			++ cb_tokens;
-			const uint32_t* var_token = reinterpret_cast<uint32_t const *>(reinterpret_cast<char const *>(first_token) + var_offset);
+			uint32_t cb_name_offset = cb_tokens.Read32();
+			uint32_t var_count = cb_tokens.Read32();
+			uint32_t var_offset = cb_tokens.Read32();
+			TokenCursor var_token;
+			if (!ChunkTokens(resource_chunk, var_offset, static_cast<uint64_t>(var_count) * var_tokens, var_token))
+			{
+				return SPS_InvalidResourceChunk;
+			}
 			cb.vars.resize(var_count);
 			for (uint32_t j = 0; j < var_count; ++ j)
 			{
 				DXBCShaderVariable& var = cb.vars[j];
-				uint32_t var_name_offset = le2native(*var_token);
-				++ var_token;
-				var.var_desc.name = reinterpret_cast<char const *>(first_token) + var_name_offset;
-				var.var_desc.start_offset = le2native(*var_token);
-				++ var_token;
-				var.var_desc.size = le2native(*var_token);
-				++ var_token;
-				var.var_desc.flags = le2native(*var_token);
-				++ var_token;
-				uint32_t type_offset = le2native(*var_token);
-				++ var_token;
-				uint32_t default_value_offset = le2native(*var_token);
-				++ var_token;
+				var.var_desc.name = ChunkString(resource_chunk, var_token.Read32());
+				if (!var.var_desc.name)
+				{
+					return SPS_InvalidResourceChunk;
+				}
+				var.var_desc.start_offset = var_token.Read32();
+				var.var_desc.size = var_token.Read32();
+				var.var_desc.flags = var_token.Read32();
+				uint32_t type_offset = var_token.Read32();
+				uint32_t default_value_offset = var_token.Read32();
 
 				if (program->version.major >= 5)
 				{
-					var.var_desc.start_texture = le2native(*var_token);
-					++ var_token;
-					var.var_desc.texture_size = le2native(*var_token);
-					++ var_token;
-					var.var_desc.start_sampler = le2native(*var_token);
-					++ var_token;
-					var.var_desc.sampler_size = le2native(*var_token);
-					++ var_token;
-
+					var.var_desc.start_texture = var_token.Read32();
+					var.var_desc.texture_size = var_token.Read32();
+					var.var_desc.start_sampler = var_token.Read32();
+					var.var_desc.sampler_size = var_token.Read32();
 				}
 				if (default_value_offset)
 				{
-					var.var_desc.default_val = reinterpret_cast<char const *>(first_token) + default_value_offset;
+					var.var_desc.default_val = ChunkData(resource_chunk, default_value_offset, var.var_desc.size);
+					if (!var.var_desc.default_val)
+					{
+						return SPS_InvalidResourceChunk;
+					}
 				}
 				else
 				{
 					var.var_desc.default_val = nullptr;
 				}
+				var.struct_name = nullptr;
 				if (type_offset)
 				{
 					var.has_type_desc = true;
-					uint16_t const * type_token = reinterpret_cast<uint16_t const *>(reinterpret_cast<char const *>(first_token) + type_offset);
-
-					var.type_desc.var_class = static_cast<ShaderVariableClass>(le2native(*type_token));
-					++ type_token;
-
-					var.type_desc.type = static_cast<ShaderVariableType>(le2native(*type_token));
-					++ type_token;
-
-					var.type_desc.rows = le2native(*type_token);
-					++ type_token;
-					var.type_desc.columns = le2native(*type_token);
-					++ type_token;
-
-					var.type_desc.elements = le2native(*type_token);
-					++ type_token;
-					var.type_desc.members = le2native(*type_token);
-					++ type_token;
-
-					uint32_t var_member_offset = le2native(*type_token) << 16;
-					++ type_token;
-					var_member_offset |= le2native(*type_token);
-					++ type_token;
-					
-					var.type_desc.offset = var_member_offset;
-					var.type_desc.name = ShaderVariableTypeName(var.type_desc.type);
+					ShaderParseStatus status = this->ParseType(type_offset, 0, num_types, var.type_desc, var.struct_name, var.members);
+					if (status != SPS_OK)
+					{
+						return status;
+					}
 				}
 				else
 				{
@@ -766,18 +1155,24 @@ struct ShaderParser
 				}
 			}
 
-			cb.desc.name = reinterpret_cast<char const *>(first_token) + cb_name_offset;
-			cb.desc.size = *cb_tokens;
-			++ cb_tokens;
-			cb.desc.flags = *cb_tokens;
-			++ cb_tokens;
-			cb.desc.type = static_cast<ShaderCBufferType>(*cb_tokens);
-			++ cb_tokens;
+			cb.desc.name = ChunkString(resource_chunk, cb_name_offset);
+			if (!cb.desc.name)
+			{
+				return SPS_InvalidResourceChunk;
+			}
+			cb.desc.size = cb_tokens.Read32();
+			cb.desc.flags = cb_tokens.Read32();
+			uint32_t cb_type = cb_tokens.Read32();
+			if (cb_type > SCBT_RESOURCE_BIND_INFO)
+			{
+				return SPS_InvalidResourceChunk;
+			}
+			cb.desc.type = static_cast<ShaderCBufferType>(cb_type);
 			cb.desc.variables = var_count;
 			cb.bind_point = this->GetCBBindPoint(cb.desc.name);
 		}
 
-		return num_cb;
+		return SPS_OK;
 	}
 
 	uint32_t GetCBBindPoint(char const * name) const
@@ -790,11 +1185,68 @@ struct ShaderParser
 			}
 		}
 
-		assert(false);
 		return static_cast<uint32_t>(-1);
 	}
 
-	uint32_t ParseSignature(DXBCChunkSignatureHeader const * sig, uint32_t fourcc) const
+	template <typename T>
+	static ShaderParseStatus ParseSignatureElements(DXBCChunkSignatureHeader const * sig, std::vector<DXBCSignatureParamDesc>& params)
+	{
+		uint32_t offset = le2native(sig->offset);
+		uint32_t count = le2native(sig->count);
+		T const * elements = static_cast<T const *>(ChunkData(sig, offset, static_cast<uint64_t>(count) * sizeof(T)));
+		if (!elements || (offset & 3))
+		{
+			return SPS_InvalidSignature;
+		}
+
+		params.resize(count);
+		for (uint32_t i = 0; i < count; ++ i)
+		{
+			DXBCSignatureParamDesc& param = params[i];
+			param.semantic_name = ChunkString(sig, le2native(elements[i].name_offset));
+			if (!param.semantic_name)
+			{
+				return SPS_InvalidSignature;
+			}
+			param.semantic_index = le2native(elements[i].semantic_index);
+			param.system_value_type = le2native(static_cast<ShaderName>(elements[i].system_value_type));
+			uint32_t component_type = le2native(elements[i].component_type);
+			if (component_type > SRCT_FLOAT32)
+			{
+				return SPS_InvalidSignature;
+			}
+			param.component_type = static_cast<ShaderRegisterComponentType>(component_type);
+			param.register_index = le2native(elements[i].register_num);
+			param.mask = elements[i].mask;
+			param.read_write_mask = elements[i].read_write_mask;
+			param.stream = SignatureElementStream(elements[i]);
+			param.min_precision = SignatureElementMinPrecision(elements[i]);
+		}
+
+		return SPS_OK;
+	}
+
+	static uint32_t SignatureElementStream(DXBCSignatureParameterD3D10 const & /*element*/)
+	{
+		return 0;
+	}
+	template <typename T>
+	static uint32_t SignatureElementStream(T const & element)
+	{
+		return le2native(element.stream);
+	}
+
+	static uint32_t SignatureElementMinPrecision(DXBCSignatureParameterD3D11_1 const & element)
+	{
+		return le2native(element.min_precision);
+	}
+	template <typename T>
+	static uint32_t SignatureElementMinPrecision(T const & /*element*/)
+	{
+		return 0;
+	}
+
+	ShaderParseStatus ParseSignature(DXBCChunkSignatureHeader const * sig, uint32_t fourcc) const
 	{
 		std::vector<DXBCSignatureParamDesc>* params = nullptr;
 		switch (fourcc)
@@ -816,78 +1268,28 @@ struct ShaderParser
 
 		default:
 			assert(false);
-			break;
+			return SPS_InvalidSignature;
 		}
 
-		uint32_t offset = le2native(sig->offset);
-		void const * elements_base
-			= static_cast<void const *>(reinterpret_cast<uint8_t const *>(sig)
-				+ sizeof(DXBCChunkHeader) + offset);
-
-		uint32_t count = le2native(sig->count);
-		params->resize(count);
+		// count and offset live in the chunk body
+		if (le2native(sig->size) < sizeof(DXBCChunkSignatureHeader) - sizeof(DXBCChunkHeader))
+		{
+			return SPS_InvalidSignature;
+		}
 
 		if ((FOURCC_ISG1 == fourcc) || (FOURCC_OSG1 == fourcc))
 		{
-			DXBCSignatureParameterD3D11_1 const * elements
-				= reinterpret_cast<DXBCSignatureParameterD3D11_1 const *>(elements_base);
-			for (uint32_t i = 0; i < count; ++ i)
-			{
-				DXBCSignatureParamDesc& param = (*params)[i];
-				uint32_t name_offset = le2native(elements[i].name_offset);
-				param.semantic_name = reinterpret_cast<char const *>(sig) + sizeof(DXBCChunkHeader) + name_offset;
-				param.semantic_index = le2native(elements[i].semantic_index);
-				param.system_value_type = le2native(static_cast<ShaderName>(elements[i].system_value_type));
-				param.component_type = le2native(static_cast<ShaderRegisterComponentType>(elements[i].component_type));
-				param.register_index = le2native(elements[i].register_num);
-				param.mask = elements[i].mask;
-				param.read_write_mask = elements[i].read_write_mask;
-				param.stream = le2native(elements[i].stream);
-				param.min_precision = le2native(elements[i].min_precision);
-			}
+			return ParseSignatureElements<DXBCSignatureParameterD3D11_1>(sig, *params);
 		}
 		else if (FOURCC_OSG5 == fourcc)
 		{
-			DXBCSignatureParameterD3D11 const * elements
-				= reinterpret_cast<DXBCSignatureParameterD3D11 const *>(elements_base);
-			for (uint32_t i = 0; i < count; ++ i)
-			{
-				DXBCSignatureParamDesc& param = (*params)[i];
-				uint32_t name_offset = le2native(elements[i].name_offset);
-				param.semantic_name = reinterpret_cast<char const *>(sig) + sizeof(DXBCChunkHeader) + name_offset;
-				param.semantic_index = le2native(elements[i].semantic_index);
-				param.system_value_type = le2native(static_cast<ShaderName>(elements[i].system_value_type));
-				param.component_type = le2native(static_cast<ShaderRegisterComponentType>(elements[i].component_type));
-				param.register_index = le2native(elements[i].register_num);
-				param.mask = elements[i].mask;
-				param.read_write_mask = elements[i].read_write_mask;
-				param.stream = le2native(elements[i].stream);
-				param.min_precision = le2native(0);
-			}
+			return ParseSignatureElements<DXBCSignatureParameterD3D11>(sig, *params);
 		}
 		else
 		{
 			assert((FOURCC_ISGN == fourcc) || (FOURCC_OSGN == fourcc) || (FOURCC_PCSG == fourcc));
-
-			DXBCSignatureParameterD3D10 const * elements
-				= reinterpret_cast<DXBCSignatureParameterD3D10 const *>(elements_base);
-			for (uint32_t i = 0; i < count; ++ i)
-			{
-				DXBCSignatureParamDesc& param = (*params)[i];
-				uint32_t name_offset = le2native(elements[i].name_offset);
-				param.semantic_name = reinterpret_cast<char const *>(sig) + sizeof(DXBCChunkHeader) + name_offset;
-				param.semantic_index = le2native(elements[i].semantic_index);
-				param.system_value_type = le2native(static_cast<ShaderName>(elements[i].system_value_type));
-				param.component_type = le2native(static_cast<ShaderRegisterComponentType>(elements[i].component_type));
-				param.register_index = le2native(elements[i].register_num);
-				param.mask = elements[i].mask;
-				param.read_write_mask = elements[i].read_write_mask;
-				param.stream = le2native(0);
-				param.min_precision = le2native(0);
-			}
-		}
-		
-		return count;
+			return ParseSignatureElements<DXBCSignatureParameterD3D10>(sig, *params);
+		}
 	}
 
 	void SortCBVars()
@@ -903,13 +1305,37 @@ struct ShaderParser
 };
 
 std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc)
+{
+	ShaderParseResult result;
+	return ShaderParse(dxbc, result);
+}
+
+std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc, ShaderParseResult& result)
+{
+	return ShaderParse(dxbc, SPM_Full, result);
+}
+
+std::shared_ptr<ShaderProgram> ShaderParse(DXBCContainer const & dxbc, ShaderParseMode mode, ShaderParseResult& result)
 {
 	std::shared_ptr<ShaderProgram> program = std::make_shared<ShaderProgram>();
-	ShaderParser parser(dxbc, program);
-	if (!parser.Parse())
+	ShaderParser parser(dxbc, program, mode, result);
+	if (SPS_OK == parser.Parse())
 	{
 		return program;
 	}
-	
+
 	return std::shared_ptr<ShaderProgram>();
 }
+
+ShaderParseStatus ShaderDecodeInstruction(ShaderProgram const & program, uint32_t index, ShaderInstruction& insn)
+{
+	assert(index < program.insn_offsets.size());
+
+	// The instruction's length was validated by ShaderParse, and program.code still points into the DXBC blob
+	uint32_t const * insn_begin = program.code + program.insn_offsets[index];
+	TokenCursor cursor(insn_begin, program.code + program.code_size);
+	TokenizedShaderInstruction insntok;
+	cursor.ReadToken(&insntok);
+	cursor = TokenCursor(cursor.Position(), insn_begin + insntok.length);
+	return ShaderParser::DecodeInstruction(insntok, cursor, insn);
+}
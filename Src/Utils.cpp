@@ -29,47 +29,353 @@
  */
 
 #include <DXBC2GLSL/Utils.hpp>
-#include <exception>
-#include <sstream>
+#include <algorithm>
 #include <limits>
 #include <cmath>
-#include <iostream>
+#include <cstdlib>
 
 namespace
 {
-	class bad_assert : public std::exception
+	// Just enough of an unsigned big integer for the exact digit generation of FormatShortest. A double needs ~1130 bits.
+	class BigUInt
 	{
 	public:
-		bad_assert(char const * expr, char const * msg, char const * function, char const * file, long line)
+		explicit BigUInt(uint64_t value)
+			: size_(0)
 		{
-			std::cout << expr;
-			if (msg)
+			while (value != 0)
 			{
-                std::cout << ' ' << msg;
+				words_[size_] = static_cast<uint32_t>(value);
+				++ size_;
+				value >>= 32;
 			}
-            std::cout << " in " << function << ", line " << line << " of " << file;
 		}
 
-		char const * what() const noexcept
+		bool IsZero() const
 		{
-			return what_.c_str();
+			return 0 == size_;
+		}
+
+		void MulSmall(uint32_t factor)
+		{
+			uint64_t carry = 0;
+			for (uint32_t i = 0; i < size_; ++ i)
+			{
+				uint64_t const product = static_cast<uint64_t>(words_[i]) * factor + carry;
+				words_[i] = static_cast<uint32_t>(product);
+				carry = product >> 32;
+			}
+			if (carry != 0)
+			{
+				assert(size_ < MAX_WORDS);
+				words_[size_] = static_cast<uint32_t>(carry);
+				++ size_;
+			}
+		}
+
+		void MulPow10(uint32_t exponent)
+		{
+			for (; exponent >= 9; exponent -= 9)
+			{
+				this->MulSmall(1000000000);
+			}
+			static uint32_t const pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+			this->MulSmall(pow10[exponent]);
+		}
+
+		void ShiftLeft(uint32_t bits)
+		{
+			if (this->IsZero())
+			{
+				return;
+			}
+
+			uint32_t const word_shift = bits / 32;
+			uint32_t const bit_shift = bits % 32;
+			assert(size_ + word_shift + 1 <= MAX_WORDS);
+			words_[size_] = 0;
+			for (uint32_t i = size_ + 1; i > 0; -- i)
+			{
+				uint32_t const src = i - 1;
+				uint32_t word = words_[src] << bit_shift;
+				if ((bit_shift != 0) && (src > 0))
+				{
+					word |= words_[src - 1] >> (32 - bit_shift);
+				}
+				words_[src + word_shift] = word;
+			}
+			for (uint32_t i = 0; i < word_shift; ++ i)
+			{
+				words_[i] = 0;
+			}
+			size_ += word_shift + 1;
+			this->Trim();
+		}
+
+		void Add(BigUInt const & rhs)
+		{
+			uint64_t carry = 0;
+			uint32_t const size = std::max(size_, rhs.size_);
+			for (uint32_t i = 0; i < size; ++ i)
+			{
+				uint64_t const sum = carry + (i < size_ ? words_[i] : 0) + (i < rhs.size_ ? rhs.words_[i] : 0);
+				words_[i] = static_cast<uint32_t>(sum);
+				carry = sum >> 32;
+			}
+			size_ = size;
+			if (carry != 0)
+			{
+				assert(size_ < MAX_WORDS);
+				words_[size_] = static_cast<uint32_t>(carry);
+				++ size_;
+			}
+		}
+
+		// Requires *this >= rhs
+		void Sub(BigUInt const & rhs)
+		{
+			int64_t borrow = 0;
+			for (uint32_t i = 0; i < size_; ++ i)
+			{
+				int64_t const diff = static_cast<int64_t>(words_[i]) - (i < rhs.size_ ? rhs.words_[i] : 0) - borrow;
+				words_[i] = static_cast<uint32_t>(diff);
+				borrow = (diff < 0) ? 1 : 0;
+			}
+			assert(0 == borrow);
+			this->Trim();
+		}
+
+		int Compare(BigUInt const & rhs) const
+		{
+			if (size_ != rhs.size_)
+			{
+				return (size_ < rhs.size_) ? -1 : 1;
+			}
+			for (uint32_t i = size_; i > 0; -- i)
+			{
+				if (words_[i - 1] != rhs.words_[i - 1])
+				{
+					return (words_[i - 1] < rhs.words_[i - 1]) ? -1 : 1;
+				}
+			}
+			return 0;
 		}
 
 	private:
-		std::string what_;
+		void Trim()
+		{
+			while ((size_ > 0) && (0 == words_[size_ - 1]))
+			{
+				-- size_;
+			}
+		}
+
+	private:
+		static uint32_t const MAX_WORDS = 40;
+
+		uint32_t words_[MAX_WORDS];
+		uint32_t size_;
 	};
-}
 
-namespace boost
-{
-	void assertion_failed(char const * expr, char const * function, char const * file, long line)
+	int CompareSum(BigUInt const & a, BigUInt const & b, BigUInt const & c)
 	{
-		throw bad_assert(expr, nullptr, function, file, line);
+		BigUInt sum = a;
+		sum.Add(b);
+		return sum.Compare(c);
 	}
 
-	void assertion_failed_msg(char const * expr, char const * msg, char const * function, char const * file, long line)
+	// Shortest decimal digits that read back as mantissa * 2^exponent, by Steele & White's free-format algorithm on exact
+	// integers (Burger & Dybvig's formulation). value = 0.digits * 10^decimal_exponent. Round-to-nearest-even readers
+	// accept the boundaries when the mantissa is even. unequal_gaps is set for a power of 2 above the smallest normal,
+	// whose lower neighbour is half as far as the upper one.
+	std::string FormatShortest(bool negative, uint64_t mantissa, int32_t exponent, bool unequal_gaps)
 	{
-		throw bad_assert(expr, msg, function, file, line);
+		std::string ret = negative ? "-" : "";
+		if (0 == mantissa)
+		{
+			return ret + "0.0";
+		}
+		if ((exponent <= 0) && (exponent > -64) && !(mantissa & ((1ULL << -exponent) - 1)))
+		{
+			// An integer below 2^53, its neighbours are at most 1 away so nothing shorter reads back
+			uint64_t value = mantissa >> -exponent;
+			char buf[20];
+			uint32_t len = 0;
+			do
+			{
+				buf[len] = static_cast<char>('0' + value % 10);
+				++ len;
+				value /= 10;
+			} while (value != 0);
+			for (; len > 0; -- len)
+			{
+				ret += buf[len - 1];
+			}
+			return ret + ".0";
+		}
+
+		// value = r / s, the neighbours are half way at (r - m_minus) / s and (r + m_plus) / s
+		BigUInt r(mantissa);
+		BigUInt s(1);
+		BigUInt m_plus(1);
+		BigUInt m_minus(1);
+		uint32_t const gap_shift = unequal_gaps ? 2 : 1;
+		r.ShiftLeft(gap_shift);
+		s.ShiftLeft(gap_shift);
+		if (unequal_gaps)
+		{
+			m_plus.ShiftLeft(1);
+		}
+		if (exponent >= 0)
+		{
+			r.ShiftLeft(exponent);
+			m_plus.ShiftLeft(exponent);
+			m_minus.ShiftLeft(exponent);
+		}
+		else
+		{
+			s.ShiftLeft(-exponent);
+		}
+
+		bool const even = !(mantissa & 1);
+		int32_t decimal_exponent = static_cast<int32_t>(std::ceil(std::log10(std::ldexp(static_cast<double>(mantissa), exponent)) - 1e-10));
+		if (decimal_exponent >= 0)
+		{
+			s.MulPow10(decimal_exponent);
+		}
+		else
+		{
+			r.MulPow10(-decimal_exponent);
+			m_plus.MulPow10(-decimal_exponent);
+			m_minus.MulPow10(-decimal_exponent);
+		}
+		// The estimate can be off by one either way
+		for (;;)
+		{
+			int const high = CompareSum(r, m_plus, s);
+			if (even ? (high >= 0) : (high > 0))
+			{
+				s.MulSmall(10);
+				++ decimal_exponent;
+			}
+			else
+			{
+				break;
+			}
+		}
+		for (;;)
+		{
+			BigUInt high = r;
+			high.Add(m_plus);
+			high.MulSmall(10);
+			int const cmp = high.Compare(s);
+			if (even ? (cmp < 0) : (cmp <= 0))
+			{
+				r.MulSmall(10);
+				m_plus.MulSmall(10);
+				m_minus.MulSmall(10);
+				-- decimal_exponent;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		std::string digits;
+		for (;;)
+		{
+			r.MulSmall(10);
+			m_plus.MulSmall(10);
+			m_minus.MulSmall(10);
+			uint32_t digit = 0;
+			while (r.Compare(s) >= 0)
+			{
+				r.Sub(s);
+				++ digit;
+			}
+
+			int const low_cmp = r.Compare(m_minus);
+			bool const low = even ? (low_cmp <= 0) : (low_cmp < 0);
+			int const high_cmp = CompareSum(r, m_plus, s);
+			bool const high = even ? (high_cmp >= 0) : (high_cmp > 0);
+			if (!low && !high)
+			{
+				digits += static_cast<char>('0' + digit);
+				continue;
+			}
+
+			if (low && high)
+			{
+				// Both ends read back, round the digit half to even
+				BigUInt twice_r = r;
+				twice_r.ShiftLeft(1);
+				int const half = twice_r.Compare(s);
+				if ((half > 0) || ((0 == half) && (digit & 1)))
+				{
+					++ digit;
+				}
+			}
+			else if (high)
+			{
+				++ digit;
+			}
+			digits += static_cast<char>('0' + digit);
+			break;
+		}
+
+		// Plain notation from 1e-4 to 1e15, always with a point or an exponent so it stays a floating point literal
+		int32_t const num_digits = static_cast<int32_t>(digits.size());
+		if ((decimal_exponent > 0) && (decimal_exponent <= 16))
+		{
+			if (num_digits <= decimal_exponent)
+			{
+				ret += digits;
+				ret.append(decimal_exponent - num_digits, '0');
+				ret += ".0";
+			}
+			else
+			{
+				ret += digits.substr(0, decimal_exponent);
+				ret += '.';
+				ret += digits.substr(decimal_exponent);
+			}
+		}
+		else if ((decimal_exponent <= 0) && (decimal_exponent > -4))
+		{
+			ret += "0.";
+			ret.append(-decimal_exponent, '0');
+			ret += digits;
+		}
+		else
+		{
+			ret += digits[0];
+			if (num_digits > 1)
+			{
+				ret += '.';
+				ret += digits.substr(1);
+			}
+			ret += 'e';
+			int32_t const e10 = decimal_exponent - 1;
+			if (e10 < 0)
+			{
+				ret += '-';
+			}
+			uint32_t abs_e10 = std::abs(e10);
+			char buf[4];
+			uint32_t len = 0;
+			do
+			{
+				buf[len] = static_cast<char>('0' + abs_e10 % 10);
+				++ len;
+				abs_e10 /= 10;
+			} while (abs_e10 != 0);
+			for (; len > 0; -- len)
+			{
+				ret += buf[len - 1];
+			}
+		}
+		return ret;
 	}
 }
 
@@ -87,3 +393,47 @@ bool ValidFloat(float f)
 		&& ((f <= std::numeric_limits<float>::max())
 			|| (-f <= std::numeric_limits<float>::max())));
 }
+
+std::string FloatToString(float f)
+{
+	union FNUI
+	{
+		float f;
+		uint32_t ui;
+	} fnui;
+	fnui.f = f;
+
+	uint32_t const biased_exponent = (fnui.ui >> 23) & 0xFF;
+	uint32_t const fraction = fnui.ui & 0x7FFFFF;
+	assert_msg(biased_exponent != 0xFF, "Inf and NaN have no literal");
+	uint64_t mantissa = fraction;
+	int32_t exponent = -149;
+	if (biased_exponent != 0)
+	{
+		mantissa |= 0x800000;
+		exponent = static_cast<int32_t>(biased_exponent) - 150;
+	}
+	return FormatShortest((fnui.ui >> 31) != 0, mantissa, exponent, (0 == fraction) && (biased_exponent > 1));
+}
+
+std::string DoubleToString(double d)
+{
+	union DNUI
+	{
+		double d;
+		uint64_t ui;
+	} dnui;
+	dnui.d = d;
+
+	uint32_t const biased_exponent = static_cast<uint32_t>(dnui.ui >> 52) & 0x7FF;
+	uint64_t const fraction = dnui.ui & 0xFFFFFFFFFFFFFULL;
+	assert_msg(biased_exponent != 0x7FF, "Inf and NaN have no literal");
+	uint64_t mantissa = fraction;
+	int32_t exponent = -1074;
+	if (biased_exponent != 0)
+	{
+		mantissa |= 1ULL << 52;
+		exponent = static_cast<int32_t>(biased_exponent) - 1075;
+	}
+	return FormatShortest((dnui.ui >> 63) != 0, mantissa, exponent, (0 == fraction) && (biased_exponent > 1));
+}